@@ -35,6 +35,11 @@
 #include <opensubdiv/osd/types.h>
 #include <opensubdiv/version.h>
 
+#ifdef WITH_TBB
+#  include <tbb/blocked_range.h>
+#  include <tbb/parallel_for.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "internal/base/type.h"
@@ -183,6 +188,75 @@ class ConstPatchCoordWrapperBuffer : public RawDataWrapperVertexBuffer<const Pat
   }
 };
 
+// Number of stencils evaluated by a single task when stencils are evaluated in parallel.
+#define STENCILS_PER_TASK 4096
+
+// Generic stencils evaluation, uses whatever threading the evaluator itself provides.
+template<typename VERTEX_BUFFER,
+         typename STENCIL_TABLE,
+         typename EVALUATOR,
+         typename DEVICE_CONTEXT>
+bool evalStencilsInplace(VERTEX_BUFFER *buffer,
+                         const BufferDescriptor &src_desc,
+                         const BufferDescriptor &dst_desc,
+                         const STENCIL_TABLE *stencils,
+                         const EVALUATOR *eval_instance,
+                         DEVICE_CONTEXT *device_context)
+{
+  return EVALUATOR::EvalStencils(
+      buffer, src_desc, buffer, dst_desc, stencils, eval_instance, device_context);
+}
+
+// The CPU evaluator is single threaded. Stencil tables are created with factorized intermediate
+// levels, so every stencil only reads coarse vertices and writes its own refined vertex: ranges of
+// stencils are independent from each other and can be evaluated in parallel.
+template<typename VERTEX_BUFFER, typename DEVICE_CONTEXT>
+bool evalStencilsInplace(VERTEX_BUFFER *buffer,
+                         const BufferDescriptor &src_desc,
+                         const BufferDescriptor &dst_desc,
+                         const StencilTable *stencils,
+                         const CpuEvaluator * /*eval_instance*/,
+                         DEVICE_CONTEXT * /*device_context*/)
+{
+  const int num_stencils = stencils->GetNumStencils();
+  if (num_stencils == 0) {
+    return false;
+  }
+  const float *src = buffer->BindCpuBuffer();
+  float *dst = buffer->BindCpuBuffer();
+  const int *sizes = &stencils->GetSizes()[0];
+  const int *offsets = &stencils->GetOffsets()[0];
+  const int *indices = &stencils->GetControlIndices()[0];
+  const float *weights = &stencils->GetWeights()[0];
+  // Each range is evaluated as a table of its own starting at zero, so the result does not
+  // depend on how the evaluator treats non-zero start of the range.
+  auto eval_range = [&](const int start, const int end) {
+    BufferDescriptor range_dst_desc = dst_desc;
+    range_dst_desc.offset += start * dst_desc.stride;
+    CpuEvaluator::EvalStencils(src,
+                               src_desc,
+                               dst,
+                               range_dst_desc,
+                               sizes + start,
+                               offsets + start,
+                               indices + offsets[start],
+                               weights + offsets[start],
+                               0,
+                               end - start);
+  };
+#ifdef WITH_TBB
+  if (num_stencils > STENCILS_PER_TASK) {
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_stencils, STENCILS_PER_TASK),
+                      [&](const tbb::blocked_range<int> &range) {
+                        eval_range(range.begin(), range.end());
+                      });
+    return true;
+  }
+#endif
+  eval_range(0, num_stencils);
+  return true;
+}
+
 template<typename EVAL_VERTEX_BUFFER,
          typename STENCIL_TABLE,
          typename PATCH_TABLE,
@@ -234,13 +308,12 @@ class FaceVaryingVolatileEval {
         evaluator_cache_, src_face_varying_desc_, dst_face_varying_desc, device_context_);
     // in and out points to same buffer so output is put directly after coarse vertices, needed in
     // adaptive mode
-    EVALUATOR::EvalStencils(src_face_varying_data_,
-                            src_face_varying_desc_,
-                            src_face_varying_data_,
-                            dst_face_varying_desc,
-                            face_varying_stencils_,
-                            eval_instance,
-                            device_context_);
+    evalStencilsInplace(src_face_varying_data_,
+                        src_face_varying_desc_,
+                        dst_face_varying_desc,
+                        face_varying_stencils_,
+                        eval_instance,
+                        device_context_);
   }
 
   // NOTE: face_varying must point to a memory of at least float[2]*num_patch_coords.
@@ -406,26 +479,20 @@ class VolatileEvalOutput {
     dst_desc.offset += num_coarse_vertices_ * src_desc_.stride;
     const EVALUATOR *eval_instance = OpenSubdiv::Osd::GetEvaluator<EVALUATOR>(
         evaluator_cache_, src_desc_, dst_desc, device_context_);
-    EVALUATOR::EvalStencils(src_data_,
-                            src_desc_,
-                            src_data_,
-                            dst_desc,
-                            vertex_stencils_,
-                            eval_instance,
-                            device_context_);
+    evalStencilsInplace(
+        src_data_, src_desc_, dst_desc, vertex_stencils_, eval_instance, device_context_);
     // Evaluate varying data.
     if (hasVaryingData()) {
       BufferDescriptor dst_varying_desc = src_varying_desc_;
       dst_varying_desc.offset += num_coarse_vertices_ * src_varying_desc_.stride;
       eval_instance = OpenSubdiv::Osd::GetEvaluator<EVALUATOR>(
           evaluator_cache_, src_varying_desc_, dst_varying_desc, device_context_);
-      EVALUATOR::EvalStencils(src_varying_data_,
-                              src_varying_desc_,
-                              src_varying_data_,
-                              dst_varying_desc,
-                              varying_stencils_,
-                              eval_instance,
-                              device_context_);
+      evalStencilsInplace(src_varying_data_,
+                          src_varying_desc_,
+                          dst_varying_desc,
+                          varying_stencils_,
+                          eval_instance,
+                          device_context_);
     }
     // Evaluate face-varying data.
     if (hasFaceVaryingData()) {
@@ -54,21 +54,11 @@ void OpenVDBLevelSet::mesh_to_level_set(const float *vertices,
       *xform, points, triangles, quads, 1);
 }
 
-void OpenVDBLevelSet::volume_to_mesh(OpenVDBVolumeToMeshData *mesh,
-                                     const double isovalue,
-                                     const double adaptivity,
-                                     const bool relax_disoriented_triangles)
+static void volume_to_mesh_data_fill(OpenVDBVolumeToMeshData *mesh,
+                                     const std::vector<openvdb::Vec3s> &out_points,
+                                     const std::vector<openvdb::Vec3I> &out_tris,
+                                     const std::vector<openvdb::Vec4I> &out_quads)
 {
-  std::vector<openvdb::Vec3s> out_points;
-  std::vector<openvdb::Vec4I> out_quads;
-  std::vector<openvdb::Vec3I> out_tris;
-  openvdb::tools::volumeToMesh<openvdb::FloatGrid>(*this->grid,
-                                                   out_points,
-                                                   out_tris,
-                                                   out_quads,
-                                                   isovalue,
-                                                   adaptivity,
-                                                   relax_disoriented_triangles);
   mesh->vertices = (float *)MEM_malloc_arrayN(
       out_points.size(), 3 * sizeof(float), "openvdb remesher out verts");
   mesh->quads = (unsigned int *)MEM_malloc_arrayN(
@@ -103,6 +93,92 @@ void OpenVDBLevelSet::volume_to_mesh(OpenVDBVolumeToMeshData *mesh,
   }
 }
 
+void OpenVDBLevelSet::volume_to_mesh(OpenVDBVolumeToMeshData *mesh,
+                                     const double isovalue,
+                                     const double adaptivity,
+                                     const bool relax_disoriented_triangles)
+{
+  std::vector<openvdb::Vec3s> out_points;
+  std::vector<openvdb::Vec4I> out_quads;
+  std::vector<openvdb::Vec3I> out_tris;
+  openvdb::tools::volumeToMesh<openvdb::FloatGrid>(*this->grid,
+                                                   out_points,
+                                                   out_tris,
+                                                   out_quads,
+                                                   isovalue,
+                                                   adaptivity,
+                                                   relax_disoriented_triangles);
+  volume_to_mesh_data_fill(mesh, out_points, out_tris, out_quads);
+}
+
+/* Mesh the surface in the voxels from clip_min to clip_max (inclusive, in index space).
+ * Meshing the neighboring voxels separately gives the same vertices along the shared boundary,
+ * so the pieces can be merged into one mesh. */
+void OpenVDBLevelSet::volume_to_mesh_clip(OpenVDBVolumeToMeshData *mesh,
+                                          const int clip_min[3],
+                                          const int clip_max[3],
+                                          const double isovalue,
+                                          const bool relax_disoriented_triangles)
+{
+  const openvdb::CoordBBox clip_bbox(openvdb::Coord(clip_min[0], clip_min[1], clip_min[2]),
+                                     openvdb::Coord(clip_max[0], clip_max[1], clip_max[2]));
+  const openvdb::math::Transform &transform = this->grid->transform();
+
+  /* Polygons along the clip boundary use vertices from the voxels around it. */
+  openvdb::CoordBBox region_bbox = clip_bbox;
+  region_bbox.expand(2);
+  const openvdb::BBoxd region_bbox_world = transform.indexToWorld(region_bbox);
+  openvdb::FloatGrid::Ptr region = openvdb::tools::clip(*this->grid, region_bbox_world);
+
+  openvdb::BoolGrid::Ptr mask = openvdb::BoolGrid::create(false);
+  mask->setTransform(transform.copy());
+  mask->fill(clip_bbox, true, true);
+
+  openvdb::tools::VolumeToMesh mesher(isovalue, 0.0, relax_disoriented_triangles);
+  mesher.setSurfaceMask(mask, false);
+  mesher(*region);
+
+  std::vector<openvdb::Vec3s> out_points(mesher.pointListSize());
+  std::vector<openvdb::Vec4I> out_quads;
+  std::vector<openvdb::Vec3I> out_tris;
+
+  for (size_t i = 0; i < out_points.size(); i++) {
+    out_points[i] = mesher.pointList()[i];
+  }
+
+  openvdb::tools::PolygonPoolList &polygon_pools = mesher.polygonPoolList();
+  for (size_t n = 0; n < mesher.polygonPoolListSize(); n++) {
+    const openvdb::tools::PolygonPool &polygons = polygon_pools[n];
+    for (size_t i = 0; i < polygons.numQuads(); i++) {
+      out_quads.push_back(polygons.quad(i));
+    }
+    for (size_t i = 0; i < polygons.numTriangles(); i++) {
+      out_tris.push_back(polygons.triangle(i));
+    }
+  }
+
+  volume_to_mesh_data_fill(mesh, out_points, out_tris, out_quads);
+}
+
+/* Bounds of the active voxels in index space, false when there are none. */
+bool OpenVDBLevelSet::index_bounds(int r_min[3], int r_max[3])
+{
+  if (!this->grid) {
+    return false;
+  }
+
+  const openvdb::CoordBBox bbox = this->grid->evalActiveVoxelBoundingBox();
+  if (bbox.empty()) {
+    return false;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    r_min[i] = bbox.min()[i];
+    r_max[i] = bbox.max()[i];
+  }
+  return true;
+}
+
 void OpenVDBLevelSet::filter(OpenVDBLevelSet_FilterType filter_type,
                              int width,
                              float distance,
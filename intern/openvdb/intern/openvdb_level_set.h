@@ -23,6 +23,7 @@
 #include "openvdb_capi.h"
 #include <openvdb/math/FiniteDifference.h>
 #include <openvdb/openvdb.h>
+#include <openvdb/tools/Clip.h>
 #include <openvdb/tools/GridTransformer.h>
 #include <openvdb/tools/LevelSetFilter.h>
 #include <openvdb/tools/MeshToVolume.h>
@@ -48,6 +49,12 @@ struct OpenVDBLevelSet {
                       const double isovalue,
                       const double adaptivity,
                       const bool relax_disoriented_triangles);
+  void volume_to_mesh_clip(struct OpenVDBVolumeToMeshData *mesh,
+                           const int clip_min[3],
+                           const int clip_max[3],
+                           const double isovalue,
+                           const bool relax_disoriented_triangles);
+  bool index_bounds(int r_min[3], int r_max[3]);
   void filter(OpenVDBLevelSet_FilterType filter_type,
               int width,
               float distance,
@@ -127,6 +127,13 @@ void OpenVDBLevelSet_volume_to_mesh(struct OpenVDBLevelSet *level_set,
                                     const double isovalue,
                                     const double adaptivity,
                                     const bool relax_disoriented_triangles);
+void OpenVDBLevelSet_volume_to_mesh_clip(struct OpenVDBLevelSet *level_set,
+                                         struct OpenVDBVolumeToMeshData *mesh,
+                                         const int clip_min[3],
+                                         const int clip_max[3],
+                                         const double isovalue,
+                                         const bool relax_disoriented_triangles);
+bool OpenVDBLevelSet_index_bounds(struct OpenVDBLevelSet *level_set, int r_min[3], int r_max[3]);
 void OpenVDBLevelSet_filter(struct OpenVDBLevelSet *level_set,
                             OpenVDBLevelSet_FilterType filter_type,
                             int width,
@@ -274,6 +274,15 @@ bool bvhcache_has_tree(const struct BVHCache *bvh_cache, const BVHTree *tree);
 struct BVHCache *bvhcache_init(void);
 void bvhcache_free(struct BVHCache *bvh_cache);
 
+/**
+ * Trees of #BVHCache are shared between meshes with identical data.
+ */
+
+void BKE_bvhtree_shared_cache_budget_set(const size_t mem_budget);
+size_t BKE_bvhtree_shared_cache_mem_size(void);
+void BKE_bvhtree_shared_cache_free_unused(void);
+void BKE_bvhtree_shared_cache_free(void);
+
 #ifdef __cplusplus
 }
 #endif
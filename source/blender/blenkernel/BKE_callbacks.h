@@ -117,6 +117,8 @@ typedef struct bCallbackFuncStore {
   void (*func)(struct Main *, struct PointerRNA **, const int num_pointers, void *arg);
   void *arg;
   short alloc;
+  /* Optional, returns false when calling func would currently do nothing. */
+  bool (*poll)(void *arg);
 } bCallbackFuncStore;
 
 void BKE_callback_exec(struct Main *bmain,
@@ -130,6 +132,7 @@ void BKE_callback_exec_id_depsgraph(struct Main *bmain,
                                     struct Depsgraph *depsgraph,
                                     eCbEvent evt);
 void BKE_callback_add(bCallbackFuncStore *funcstore, eCbEvent evt);
+bool BKE_callback_poll(eCbEvent evt);
 
 void BKE_callback_global_init(void);
 void BKE_callback_global_finalize(void);
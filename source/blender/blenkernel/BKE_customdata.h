@@ -307,6 +307,13 @@ void CustomData_interp(const struct CustomData *source,
                        const float *sub_weights,
                        int count,
                        int dest_index);
+void CustomData_interp_batch(const struct CustomData *source,
+                             struct CustomData *dest,
+                             const int *src_indices,
+                             const float *weights,
+                             int src_count,
+                             const int *dest_indices,
+                             int dest_len);
 void CustomData_bmesh_interp_n(struct CustomData *data,
                                const void **src_blocks,
                                const float *weights,
@@ -320,6 +327,12 @@ void CustomData_bmesh_interp(struct CustomData *data,
                              const float *sub_weights,
                              int count,
                              void *dst_block);
+void CustomData_bmesh_interp_batch(struct CustomData *data,
+                                   const void **src_blocks,
+                                   const float *weights,
+                                   int count,
+                                   void **dst_blocks,
+                                   int dst_len);
 
 /* swaps the data in the element corners, to new corners with indices as
  * specified in corner_indices. for edges this is an array of length 2, for
@@ -405,6 +418,8 @@ void CustomData_set_layer_stencil_index(struct CustomData *data, int type, int n
 void CustomData_set_layer_flag(struct CustomData *data, int type, int flag);
 void CustomData_clear_layer_flag(struct CustomData *data, int type, int flag);
 
+/* Allocate a block without initializing it, e.g. so it can be filled from another thread. */
+void CustomData_bmesh_alloc_block(struct CustomData *data, void **block);
 void CustomData_bmesh_set_default(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block_data(struct CustomData *data, void *block);
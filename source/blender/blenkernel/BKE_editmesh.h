@@ -34,6 +34,7 @@ extern "C" {
 struct BMLoop;
 struct BMesh;
 struct BMPartialUpdate;
+struct BMVert;
 struct BMeshCalcTessellation_Params;
 struct BoundBox;
 struct Depsgraph;
@@ -83,8 +84,26 @@ typedef struct BMEditMesh {
    */
   char needs_flush_to_id;
 
+  /**
+   * Set when only vertex positions (and so normals) changed since the last evaluation,
+   * allowing the draw cache to keep buffers which only depend on topology.
+   * See #BKE_editmesh_deform_update_tag.
+   */
+  char deform_update;
+  /** Faces using the moved vertices, only valid for #EM_DEFORM_UPDATE_RANGE. */
+  int deform_update_face_range[2];
+
 } BMEditMesh;
 
+/** #BMEditMesh.deform_update */
+enum {
+  EM_DEFORM_UPDATE_NONE = 0,
+  /** Only faces in #BMEditMesh.deform_update_face_range use moved vertices. */
+  EM_DEFORM_UPDATE_RANGE = 1,
+  /** Any vertex may have moved (including loose vertices and wire edges). */
+  EM_DEFORM_UPDATE_ALL = 2,
+};
+
 /* editmesh.c */
 void BKE_editmesh_looptri_calc_ex(BMEditMesh *em,
                                   const struct BMeshCalcTessellation_Params *params);
@@ -98,6 +117,10 @@ void BKE_editmesh_looptri_and_normals_calc_with_partial(BMEditMesh *em,
 
 void BKE_editmesh_looptri_and_normals_calc(BMEditMesh *em);
 
+void BKE_editmesh_deform_update_tag(BMEditMesh *em, const struct BMVert *v);
+void BKE_editmesh_deform_update_tag_all(BMEditMesh *em);
+void BKE_editmesh_deform_update_clear(BMEditMesh *em);
+
 BMEditMesh *BKE_editmesh_create(BMesh *bm, const bool do_tessellate);
 BMEditMesh *BKE_editmesh_copy(BMEditMesh *em);
 BMEditMesh *BKE_editmesh_from_object(struct Object *ob);
@@ -155,6 +155,8 @@ enum {
   G_DEBUG_XR_TIME = (1 << 20),               /* XR/OpenXR timing messages */
 
   G_DEBUG_GHOST = (1 << 21), /* Debug GHOST module. */
+
+  G_DEBUG_DEPSGRAPH_TIMELINE = (1 << 22), /* record depsgraph per-operation evaluation timeline */
 };
 
 #define G_DEBUG_ALL \
@@ -44,7 +44,9 @@ struct MDisps;
 struct MEdge;
 struct MFace;
 struct MLoop;
+struct MLoopFanCache;
 struct MLoopTri;
+struct MLoopTriNgonCache;
 struct MLoopUV;
 struct MPoly;
 struct MVert;
@@ -297,6 +299,17 @@ void BKE_mesh_recalc_looptri_with_normals(const struct MLoop *mloop,
                                           int totpoly,
                                           struct MLoopTri *mlooptri,
                                           const float (*poly_normals)[3]);
+void BKE_mesh_recalc_looptri_ex(const struct MLoop *mloop,
+                                const struct MPoly *mpoly,
+                                const struct MVert *mvert,
+                                int totloop,
+                                int totpoly,
+                                struct MLoopTri *mlooptri,
+                                const float (*poly_normals)[3],
+                                struct MLoopTriNgonCache **ngon_cache);
+
+struct MLoopTriNgonCache *BKE_mesh_looptri_ngon_cache_share(struct Mesh *mesh_src);
+void BKE_mesh_looptri_ngon_cache_release(struct MLoopTriNgonCache **ngon_cache);
 
 /* *** mesh_evaluate.c *** */
 
@@ -453,6 +466,25 @@ void BKE_mesh_normals_loop_split(const struct MVert *mverts,
                                  MLoopNorSpaceArray *r_lnors_spacearr,
                                  short (*clnors_data)[2],
                                  int *r_loop_to_poly);
+void BKE_mesh_normals_loop_split_ex(const struct MVert *mverts,
+                                    const int numVerts,
+                                    struct MEdge *medges,
+                                    const int numEdges,
+                                    struct MLoop *mloops,
+                                    float (*r_loopnors)[3],
+                                    const int numLoops,
+                                    struct MPoly *mpolys,
+                                    const float (*polynors)[3],
+                                    const int numPolys,
+                                    const bool use_split_normals,
+                                    const float split_angle,
+                                    MLoopNorSpaceArray *r_lnors_spacearr,
+                                    short (*clnors_data)[2],
+                                    int *r_loop_to_poly,
+                                    struct MLoopFanCache **fan_cache);
+
+struct MLoopFanCache *BKE_mesh_loop_fan_cache_share(struct Mesh *mesh_src);
+void BKE_mesh_loop_fan_cache_release(struct MLoopFanCache **fan_cache);
 
 void BKE_mesh_normals_loop_custom_set(const struct MVert *mverts,
                                       const int numVerts,
@@ -48,6 +48,9 @@ struct Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain(struct Mesh *mesh,
                                                   float voxel_size,
                                                   float adaptivity,
                                                   float isovalue);
+struct Mesh *BKE_mesh_remesh_voxel_tiled_to_mesh_nomain(struct Mesh *mesh,
+                                                        float voxel_size,
+                                                        float isovalue);
 struct Mesh *BKE_mesh_remesh_quadriflow_to_mesh_nomain(struct Mesh *mesh,
                                                        int target_faces,
                                                        int seed,
@@ -26,6 +26,7 @@
 #include "BLI_bitmap.h"
 #include "BLI_utildefines.h"
 #include "DNA_brush_enums.h"
+#include "DNA_listBase.h"
 #include "DNA_object_enums.h"
 
 #ifdef __cplusplus
@@ -350,6 +351,16 @@ typedef struct SculptPersistentBase {
   float disp;
 } SculptPersistentBase;
 
+/* Geodesic distances from a set of initial vertices, see `sculpt_geodesic.c`. */
+typedef struct SculptGeodesicCache {
+  struct SculptGeodesicCache *next, *prev;
+  /* Sorted indices of the initial vertices. */
+  int *initial_vertices;
+  int initial_vertices_len;
+  float limit_radius;
+  float *dists;
+} SculptGeodesicCache;
+
 typedef struct SculptVertexInfo {
   /* Indexed by vertex, stores and ID of its topologically connected component. */
   int *connected_component;
@@ -564,6 +575,10 @@ typedef struct SculptSession {
   /* This is freed with the PBVH, so it is always in sync with the mesh. */
   SculptPersistentBase *persistent_base;
 
+  /* Geodesic distances of recently used initial vertices, most recent first.
+   * This is freed with the PBVH, so it is always in sync with the mesh topology. */
+  ListBase geodesic_cache;
+
   SculptVertexInfo vertex_info;
   SculptFakeNeighbors fake_neighbors;
 
@@ -617,6 +632,7 @@ typedef struct SculptSession {
 void BKE_sculptsession_free(struct Object *ob);
 void BKE_sculptsession_free_deformMats(struct SculptSession *ss);
 void BKE_sculptsession_free_vwpaint_data(struct SculptSession *ss);
+void BKE_sculptsession_free_geodesic_cache(struct SculptSession *ss);
 void BKE_sculptsession_bm_to_me(struct Object *ob, bool reorder);
 void BKE_sculptsession_bm_to_me_for_render(struct Object *object);
 
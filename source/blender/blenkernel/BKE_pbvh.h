@@ -101,6 +101,7 @@ typedef void (*BKE_pbvh_SearchNearestCallback)(PBVHNode *node, void *data, float
 /* Building */
 
 PBVH *BKE_pbvh_new(void);
+void BKE_pbvh_build_leaf_limit_set(PBVH *pbvh, int leaf_limit);
 void BKE_pbvh_build_mesh(PBVH *pbvh,
                          const struct Mesh *mesh,
                          const struct MPoly *mpoly,
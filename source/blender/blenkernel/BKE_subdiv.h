@@ -164,6 +164,19 @@ typedef struct SubdivDisplacement {
   void *user_data;
 } SubdivDisplacement;
 
+/* Cheap fingerprint of the topology a subdivision surface was created for.
+ * Allows to skip full topology comparison when mesh topology did not change. */
+typedef struct SubdivTopologyHash {
+  int num_vertices;
+  int num_edges;
+  int num_loops;
+  int num_faces;
+  int num_uv_layers;
+  /* Two independent hashes of the topology, to make collisions very unlikely. */
+  uint32_t hash[2];
+  bool is_valid;
+} SubdivTopologyHash;
+
 /* This structure contains everything needed to construct subdivided surface.
  * It does not specify storage, memory layout or anything else.
  * It is possible to create different storage's (like, grid based CPU side
@@ -184,6 +197,8 @@ typedef struct Subdiv {
   struct SubdivDisplacement *displacement_evaluator;
   /* Statistics for debugging. */
   SubdivStats stats;
+  /* Hash of the mesh topology, only valid when created from a mesh. */
+  SubdivTopologyHash topology_hash;
 
   /* Cached values, are not supposed to be accessed directly. */
   struct {
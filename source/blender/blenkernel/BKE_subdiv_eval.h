@@ -30,6 +30,7 @@ extern "C" {
 #endif
 
 struct Mesh;
+struct OpenSubdiv_PatchCoord;
 struct Subdiv;
 
 /* Returns true if evaluator is ready for use. */
@@ -145,6 +146,19 @@ void BKE_subdiv_eval_limit_patch_resolution_point_and_short_normal(struct Subdiv
                                                                    const int normal_offset,
                                                                    const int normal_stride);
 
+/* Batched queries.
+ *
+ * Evaluate limit surface at multiple points at once, which avoids per-point overhead of the
+ * evaluator. Output arrays are to have num_patch_coords elements. Derivatives are optional. */
+
+void BKE_subdiv_eval_limit_points_and_derivatives(
+    struct Subdiv *subdiv,
+    const struct OpenSubdiv_PatchCoord *patch_coords,
+    const int num_patch_coords,
+    float (*r_P)[3],
+    float (*r_dPdu)[3],
+    float (*r_dPdv)[3]);
+
 #ifdef __cplusplus
 }
 #endif
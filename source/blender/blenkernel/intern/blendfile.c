@@ -46,6 +46,7 @@
 #include "BKE_blender_version.h"
 #include "BKE_blendfile.h"
 #include "BKE_bpath.h"
+#include "BKE_bvhutils.h"
 #include "BKE_colorband.h"
 #include "BKE_context.h"
 #include "BKE_global.h"
@@ -282,6 +283,12 @@ static void setup_app_data(bContext *C,
   //  CTX_wm_manager_set(C, NULL);
   BKE_blender_globals_clear();
 
+  /* Trees of the meshes freed with the old file are unlikely to be used again, unlike on undo
+   * where unchanged meshes are read back with the same data. */
+  if (mode != LOAD_UNDO) {
+    BKE_bvhtree_shared_cache_free_unused();
+  }
+
   bmain = G_MAIN = bfd->main;
   bfd->main = NULL;
 
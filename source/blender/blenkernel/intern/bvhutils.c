@@ -29,25 +29,566 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_pointcloud_types.h"
 
+#include "BLI_bitmap.h"
+#include "BLI_ghash.h"
+#include "BLI_hash.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
+#include "BLI_listbase.h"
 #include "BLI_math.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_bvhutils.h"
+#include "BKE_customdata.h"
 #include "BKE_editmesh.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_runtime.h"
 
 #include "MEM_guardedalloc.h"
 
+/* -------------------------------------------------------------------- */
+/** \name Shared BVHCache
+ *
+ * Trees stored in the #BVHCache of a mesh are also registered in a global cache, keyed by a hash
+ * of the data they were built from. When another mesh uses the same data (a copy-on-write copy,
+ * or an evaluated mesh referencing the coordinates of its input) the tree is reused instead of
+ * being rebuilt. Evaluated meshes owning their coordinates (deformed or otherwise modified) don't
+ * use the cache, see #bvhtree_shared_mesh_supported.
+ *
+ * The total size of the shared cache (trees and a copy of their key data) stays within its memory
+ * budget: least recently used trees without users are freed first, trees which don't fit are not
+ * shared. Trees without users are also freed when a file is loaded.
+ * \{ */
+
+/* Default budget of the shared cache, see #BKE_bvhtree_shared_cache_budget_set. */
+#define BVH_SHARED_CACHE_BUDGET_DEFAULT ((size_t)256 * 1024 * 1024)
+
+/* Number of elements of key data hashed, copied or compared in a single task. */
+#define BVH_SHARED_KEY_BLOCK_SIZE 4096
+
+struct BVHSharedKeySource;
+
+/** Write the key data of element `i` into `r_elem`. */
+typedef void (*BVHSharedKeyElemFn)(const struct BVHSharedKeySource *source,
+                                   const int i,
+                                   void *r_elem);
+
+/** Arrays the key data of a tree is read from. */
+typedef struct BVHSharedKeySource {
+  const MVert *vert;
+  const MEdge *edge;
+  const MLoop *mloop;
+  const MLoopTri *looptri;
+  const BLI_bitmap *mask;
+  BVHSharedKeyElemFn elem_fn;
+  size_t elem_size;
+} BVHSharedKeySource;
+
+typedef struct BVHSharedTreeKey {
+  /** Hash of the parameters and the data, the tree is stored under it. */
+  uint hash;
+  BVHCacheType type;
+  int elems_num;
+  float epsilon;
+  int tree_type;
+  int axis;
+  /** Size of the key data: the elements followed by the mask (if any). */
+  size_t data_size;
+  /** Only set while looking up or inserting a tree, the arrays aren't owned. */
+  BVHSharedKeySource source;
+} BVHSharedTreeKey;
+
+typedef struct BVHSharedTree {
+  struct BVHSharedTree *next, *prev;
+  BVHSharedTreeKey key;
+  /** Copy of the key data, compared exactly when the hash of a looked up key matches. */
+  void *data;
+  BVHTree *tree;
+  /** Size of the tree and the key data. */
+  size_t mem_size;
+  /** Number of #BVHCache using this tree. */
+  int users;
+} BVHSharedTree;
+
+static struct {
+  /** #BVHSharedTree, most recently used first. */
+  ListBase trees;
+  /** #BVHSharedTree by the hash of their key, created on first use. */
+  GHash *trees_by_hash;
+  size_t mem_size;
+  size_t mem_budget;
+  ThreadMutex mutex;
+} bvh_shared_cache = {
+    .trees = {NULL, NULL},
+    .trees_by_hash = NULL,
+    .mem_size = 0,
+    .mem_budget = BVH_SHARED_CACHE_BUDGET_DEFAULT,
+    .mutex = BLI_MUTEX_INITIALIZER,
+};
+
+/* Key data of a single element, the elements are followed by a copy of the mask (if any). */
+typedef struct BVHSharedEdgeData {
+  uint v[2];
+  float co[2][3];
+} BVHSharedEdgeData;
+
+typedef struct BVHSharedLoopTriData {
+  uint v[3];
+  float co[3][3];
+} BVHSharedLoopTriData;
+
+#define BVH_SHARED_KEY_ELEM_SIZE_MAX sizeof(BVHSharedLoopTriData)
+
+static void bvhtree_shared_key_vert_elem(const BVHSharedKeySource *source,
+                                         const int i,
+                                         void *r_elem)
+{
+  copy_v3_v3(r_elem, source->vert[i].co);
+}
+
+static void bvhtree_shared_key_edge_elem(const BVHSharedKeySource *source,
+                                         const int i,
+                                         void *r_elem)
+{
+  BVHSharedEdgeData *edge_data = r_elem;
+  const MEdge *edge = &source->edge[i];
+  edge_data->v[0] = edge->v1;
+  edge_data->v[1] = edge->v2;
+  copy_v3_v3(edge_data->co[0], source->vert[edge->v1].co);
+  copy_v3_v3(edge_data->co[1], source->vert[edge->v2].co);
+}
+
+static void bvhtree_shared_key_looptri_elem(const BVHSharedKeySource *source,
+                                            const int i,
+                                            void *r_elem)
+{
+  BVHSharedLoopTriData *looptri_data = r_elem;
+  for (int j = 0; j < 3; j++) {
+    const uint v = source->mloop[source->looptri[i].tri[j]].v;
+    looptri_data->v[j] = v;
+    copy_v3_v3(looptri_data->co[j], source->vert[v].co);
+  }
+}
+
+typedef enum eBVHSharedKeyOp {
+  BVH_SHARED_KEY_HASH,
+  BVH_SHARED_KEY_COPY,
+  BVH_SHARED_KEY_COMPARE,
+} eBVHSharedKeyOp;
+
+typedef struct BVHSharedKeyTaskData {
+  const BVHSharedTreeKey *key;
+  eBVHSharedKeyOp op;
+  /** Key data written by #BVH_SHARED_KEY_COPY or read by #BVH_SHARED_KEY_COMPARE. */
+  void *data;
+  /** Result of each block. */
+  uint *block_hash;
+  bool *block_equal;
+} BVHSharedKeyTaskData;
+
+static void bvhtree_shared_key_block_cb(void *__restrict userdata,
+                                        const int block,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHSharedKeyTaskData *data = userdata;
+  const BVHSharedKeySource *source = &data->key->source;
+  const size_t elem_size = source->elem_size;
+  const int start = block * BVH_SHARED_KEY_BLOCK_SIZE;
+  const int end = min_ii(start + BVH_SHARED_KEY_BLOCK_SIZE, data->key->elems_num);
+  char elem[BVH_SHARED_KEY_ELEM_SIZE_MAX];
+
+  switch (data->op) {
+    case BVH_SHARED_KEY_HASH: {
+      BLI_HashMurmur2A mm2;
+      BLI_hash_mm2a_init(&mm2, (uint32_t)block);
+      for (int i = start; i < end; i++) {
+        source->elem_fn(source, i, elem);
+        BLI_hash_mm2a_add(&mm2, (const uchar *)elem, elem_size);
+      }
+      data->block_hash[block] = BLI_hash_mm2a_end(&mm2);
+      break;
+    }
+    case BVH_SHARED_KEY_COPY:
+      for (int i = start; i < end; i++) {
+        source->elem_fn(source, i, (char *)data->data + (size_t)i * elem_size);
+      }
+      break;
+    case BVH_SHARED_KEY_COMPARE:
+      data->block_equal[block] = true;
+      for (int i = start; i < end; i++) {
+        source->elem_fn(source, i, elem);
+        if (memcmp(elem, (const char *)data->data + (size_t)i * elem_size, elem_size) != 0) {
+          data->block_equal[block] = false;
+          break;
+        }
+      }
+      break;
+  }
+}
+
+/**
+ * Run `op` on all elements of the key, in parallel blocks of #BVH_SHARED_KEY_BLOCK_SIZE.
+ * \return The number of blocks.
+ */
+static int bvhtree_shared_key_blocks_run(BVHSharedKeyTaskData *data)
+{
+  const int blocks_num = (data->key->elems_num + BVH_SHARED_KEY_BLOCK_SIZE - 1) /
+                         BVH_SHARED_KEY_BLOCK_SIZE;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, blocks_num, data, bvhtree_shared_key_block_cb, &settings);
+  return blocks_num;
+}
+
+/**
+ * Set up the `key` to read from `source` and hash it, the data is read in place
+ * and only copied once a tree is stored for the key.
+ */
+static void bvhtree_shared_key_init(BVHSharedTreeKey *key,
+                                    const BVHSharedKeySource *source,
+                                    const BVHCacheType type,
+                                    const int elems_num,
+                                    const float epsilon,
+                                    const int tree_type,
+                                    const int axis)
+{
+  BLI_assert(source->elem_size <= BVH_SHARED_KEY_ELEM_SIZE_MAX);
+  const size_t mask_size = source->mask ? BLI_BITMAP_SIZE(elems_num) : 0;
+
+  memset(key, 0, sizeof(*key));
+  key->type = type;
+  key->elems_num = elems_num;
+  key->epsilon = epsilon;
+  key->tree_type = tree_type;
+  key->axis = axis;
+  key->data_size = source->elem_size * (size_t)elems_num + mask_size;
+  key->source = *source;
+
+  BVHSharedKeyTaskData data = {.key = key, .op = BVH_SHARED_KEY_HASH};
+  data.block_hash = MEM_mallocN(
+      sizeof(*data.block_hash) * (size_t)(elems_num / BVH_SHARED_KEY_BLOCK_SIZE + 1), __func__);
+  const int blocks_num = bvhtree_shared_key_blocks_run(&data);
+
+  /* Combine the hashes of the blocks in order, with the parameters and the mask. */
+  uint hash = BLI_hash_int_2d((uint)type, (uint)elems_num);
+  hash = BLI_hash_int_2d(hash, (uint)tree_type * 32 + (uint)axis);
+  hash = BLI_hash_int_2d(hash, (uint)key->data_size);
+  for (int i = 0; i < blocks_num; i++) {
+    hash = BLI_hash_int_2d(hash, data.block_hash[i]);
+  }
+  if (source->mask) {
+    hash = BLI_hash_int_2d(hash, BLI_hash_mm2((const uchar *)source->mask, mask_size, 0));
+  }
+  key->hash = hash;
+  MEM_freeN(data.block_hash);
+}
+
+static bool bvhtree_shared_key_params_eq(const BVHSharedTreeKey *a, const BVHSharedTreeKey *b)
+{
+  return (a->hash == b->hash) && (a->type == b->type) && (a->elems_num == b->elems_num) &&
+         (a->epsilon == b->epsilon) && (a->tree_type == b->tree_type) && (a->axis == b->axis) &&
+         (a->data_size == b->data_size);
+}
+
+/** Compare the data `key` is read from with a copy of the key data. */
+static bool bvhtree_shared_key_data_eq(const BVHSharedTreeKey *key, const void *key_data)
+{
+  const size_t elems_size = key->source.elem_size * (size_t)key->elems_num;
+  if (key->source.mask &&
+      memcmp(key->source.mask, (const char *)key_data + elems_size, key->data_size - elems_size)) {
+    return false;
+  }
+
+  BVHSharedKeyTaskData data = {
+      .key = key, .op = BVH_SHARED_KEY_COMPARE, .data = (void *)key_data};
+  data.block_equal = MEM_mallocN(
+      sizeof(*data.block_equal) * (size_t)(key->elems_num / BVH_SHARED_KEY_BLOCK_SIZE + 1),
+      __func__);
+  const int blocks_num = bvhtree_shared_key_blocks_run(&data);
+  bool is_equal = true;
+  for (int i = 0; i < blocks_num && is_equal; i++) {
+    is_equal = data.block_equal[i];
+  }
+  MEM_freeN(data.block_equal);
+  return is_equal;
+}
+
+/** Copy the data `key` is read from. */
+static void *bvhtree_shared_key_data_copy(const BVHSharedTreeKey *key)
+{
+  void *key_data = MEM_mallocN(max_zz(key->data_size, 1), __func__);
+  BVHSharedKeyTaskData data = {.key = key, .op = BVH_SHARED_KEY_COPY, .data = key_data};
+  bvhtree_shared_key_blocks_run(&data);
+
+  const size_t elems_size = key->source.elem_size * (size_t)key->elems_num;
+  if (key->source.mask) {
+    memcpy((char *)key_data + elems_size, key->source.mask, key->data_size - elems_size);
+  }
+  return key_data;
+}
+
+static void bvhtree_shared_key_from_verts(BVHSharedTreeKey *key,
+                                          const BVHCacheType type,
+                                          const MVert *vert,
+                                          const int verts_num,
+                                          const BLI_bitmap *verts_mask,
+                                          const float epsilon,
+                                          const int tree_type,
+                                          const int axis)
+{
+  const BVHSharedKeySource source = {
+      .vert = vert,
+      .mask = verts_mask,
+      .elem_fn = bvhtree_shared_key_vert_elem,
+      .elem_size = sizeof(float[3]),
+  };
+  bvhtree_shared_key_init(key, &source, type, verts_num, epsilon, tree_type, axis);
+}
+
+static void bvhtree_shared_key_from_edges(BVHSharedTreeKey *key,
+                                          const BVHCacheType type,
+                                          const MVert *vert,
+                                          const MEdge *edge,
+                                          const int edges_num,
+                                          const BLI_bitmap *edges_mask,
+                                          const float epsilon,
+                                          const int tree_type,
+                                          const int axis)
+{
+  const BVHSharedKeySource source = {
+      .vert = vert,
+      .edge = edge,
+      .mask = edges_mask,
+      .elem_fn = bvhtree_shared_key_edge_elem,
+      .elem_size = sizeof(BVHSharedEdgeData),
+  };
+  bvhtree_shared_key_init(key, &source, type, edges_num, epsilon, tree_type, axis);
+}
+
+static void bvhtree_shared_key_from_looptri(BVHSharedTreeKey *key,
+                                            const BVHCacheType type,
+                                            const MVert *vert,
+                                            const MLoop *mloop,
+                                            const MLoopTri *looptri,
+                                            const int looptri_num,
+                                            const BLI_bitmap *looptri_mask,
+                                            const float epsilon,
+                                            const int tree_type,
+                                            const int axis)
+{
+  const BVHSharedKeySource source = {
+      .vert = vert,
+      .mloop = mloop,
+      .looptri = looptri,
+      .mask = looptri_mask,
+      .elem_fn = bvhtree_shared_key_looptri_elem,
+      .elem_size = sizeof(BVHSharedLoopTriData),
+  };
+  bvhtree_shared_key_init(key, &source, type, looptri_num, epsilon, tree_type, axis);
+}
+
+/**
+ * Whether trees of `mesh` are looked up in and added to the shared cache.
+ */
+static bool bvhtree_shared_mesh_supported(Mesh *mesh)
+{
+  /* Original meshes and their copy-on-write copies. */
+  if ((mesh->id.tag & LIB_TAG_COPIED_ON_WRITE_EVAL_RESULT) == 0 &&
+      ((mesh->id.tag & LIB_TAG_NO_MAIN) == 0 || (mesh->id.tag & LIB_TAG_COPIED_ON_WRITE))) {
+    return true;
+  }
+  /* Other meshes only while they reference the coordinates of the mesh they're copied from,
+   * deforming the coordinates duplicates them first. Data written during evaluation rarely
+   * matches a stored tree, looking it up would only cost hashing it. */
+  return CustomData_is_referenced_layer(&mesh->vdata, CD_MVERT);
+}
+
+static void bvhtree_shared_cache_remove(BVHSharedTree *shared)
+{
+  bvh_shared_cache.mem_size -= shared->mem_size;
+  BLI_remlink(&bvh_shared_cache.trees, shared);
+  BLI_ghash_remove(
+      bvh_shared_cache.trees_by_hash, POINTER_FROM_UINT(shared->key.hash), NULL, NULL);
+  BLI_bvhtree_free(shared->tree);
+  MEM_freeN(shared->data);
+  MEM_freeN(shared);
+}
+
+/**
+ * Free unused trees until `mem_size_add` more bytes fit in `mem_budget`.
+ * Must be called with the lock held.
+ */
+static void bvhtree_shared_cache_trim(const size_t mem_size_add, const size_t mem_budget)
+{
+  BVHSharedTree *shared = bvh_shared_cache.trees.last;
+  while (shared && bvh_shared_cache.mem_size + mem_size_add > mem_budget) {
+    BVHSharedTree *shared_prev = shared->prev;
+    if (shared->users == 0) {
+      bvhtree_shared_cache_remove(shared);
+    }
+    shared = shared_prev;
+  }
+}
+
+static BVHSharedTree *bvhtree_shared_find(const BVHSharedTreeKey *key)
+{
+  if (bvh_shared_cache.trees_by_hash == NULL) {
+    return NULL;
+  }
+  BVHSharedTree *shared = BLI_ghash_lookup(bvh_shared_cache.trees_by_hash,
+                                           POINTER_FROM_UINT(key->hash));
+  if (shared && bvhtree_shared_key_params_eq(&shared->key, key)) {
+    return shared;
+  }
+  return NULL;
+}
+
+static void bvhtree_shared_release(BVHSharedTree *shared)
+{
+  BLI_mutex_lock(&bvh_shared_cache.mutex);
+  BLI_assert(shared->users > 0);
+  shared->users--;
+  bvhtree_shared_cache_trim(0, bvh_shared_cache.mem_budget);
+  BLI_mutex_unlock(&bvh_shared_cache.mutex);
+}
+
+/**
+ * Find a tree built from data matching the `key`, adding a user to it.
+ *
+ * The key data is compared without holding the lock, the tree can't be freed meanwhile
+ * since it has a user.
+ */
+static BVHSharedTree *bvhtree_shared_acquire(const BVHSharedTreeKey *key)
+{
+  BLI_mutex_lock(&bvh_shared_cache.mutex);
+  BVHSharedTree *shared = bvhtree_shared_find(key);
+  if (shared) {
+    shared->users++;
+    BLI_remlink(&bvh_shared_cache.trees, shared);
+    BLI_addhead(&bvh_shared_cache.trees, shared);
+  }
+  BLI_mutex_unlock(&bvh_shared_cache.mutex);
+
+  if (shared && !bvhtree_shared_key_data_eq(key, shared->data)) {
+    /* Hash collision. */
+    bvhtree_shared_release(shared);
+    shared = NULL;
+  }
+  return shared;
+}
+
+/**
+ * Register a newly built tree in the shared cache with one user.
+ *
+ * \return NULL when the tree isn't shared (it doesn't fit in the budget, is NULL or another tree
+ * is stored under the same hash), the caller owns it then.
+ */
+static BVHSharedTree *bvhtree_shared_insert(const BVHSharedTreeKey *key, BVHTree *tree)
+{
+  if (tree == NULL) {
+    return NULL;
+  }
+
+  /* Copy the key data before the tree can be found by other threads. */
+  void *key_data = bvhtree_shared_key_data_copy(key);
+  const size_t mem_size = BLI_bvhtree_get_mem_size(tree) + key->data_size;
+
+  BLI_mutex_lock(&bvh_shared_cache.mutex);
+  if (bvh_shared_cache.trees_by_hash == NULL) {
+    bvh_shared_cache.trees_by_hash = BLI_ghash_int_new(__func__);
+  }
+  /* Either another thread stored a tree for the same data in the meantime, or the hashes collide.
+   * Both are rare enough to not share this tree rather than comparing the data under the lock. */
+  bool is_shared = !BLI_ghash_haskey(bvh_shared_cache.trees_by_hash,
+                                     POINTER_FROM_UINT(key->hash));
+  if (is_shared) {
+    bvhtree_shared_cache_trim(mem_size, bvh_shared_cache.mem_budget);
+    is_shared = bvh_shared_cache.mem_size + mem_size <= bvh_shared_cache.mem_budget;
+  }
+  if (!is_shared) {
+    BLI_mutex_unlock(&bvh_shared_cache.mutex);
+    MEM_freeN(key_data);
+    return NULL;
+  }
+
+  BVHSharedTree *shared = MEM_mallocN(sizeof(*shared), __func__);
+  shared->key = *key;
+  memset(&shared->key.source, 0, sizeof(shared->key.source));
+  shared->data = key_data;
+  shared->tree = tree;
+  shared->mem_size = mem_size;
+  shared->users = 1;
+  BLI_addhead(&bvh_shared_cache.trees, shared);
+  BLI_ghash_insert(bvh_shared_cache.trees_by_hash, POINTER_FROM_UINT(key->hash), shared);
+  bvh_shared_cache.mem_size += mem_size;
+  BLI_mutex_unlock(&bvh_shared_cache.mutex);
+  return shared;
+}
+
+/**
+ * Set the maximum size (in bytes) of the shared tree cache, including trees in use.
+ * Trees which don't fit are built per mesh, zero disables sharing trees.
+ */
+void BKE_bvhtree_shared_cache_budget_set(const size_t mem_budget)
+{
+  BLI_mutex_lock(&bvh_shared_cache.mutex);
+  bvh_shared_cache.mem_budget = mem_budget;
+  bvhtree_shared_cache_trim(0, mem_budget);
+  BLI_mutex_unlock(&bvh_shared_cache.mutex);
+}
+
+/**
+ * Size (in bytes) of the trees in the shared cache and their key data.
+ */
+size_t BKE_bvhtree_shared_cache_mem_size(void)
+{
+  BLI_mutex_lock(&bvh_shared_cache.mutex);
+  const size_t mem_size = bvh_shared_cache.mem_size;
+  BLI_mutex_unlock(&bvh_shared_cache.mutex);
+  return mem_size;
+}
+
+/**
+ * Free all trees of the shared cache without users, e.g. when the meshes they were built for
+ * are freed by loading another file.
+ */
+void BKE_bvhtree_shared_cache_free_unused(void)
+{
+  BLI_mutex_lock(&bvh_shared_cache.mutex);
+  bvhtree_shared_cache_trim(0, 0);
+  BLI_mutex_unlock(&bvh_shared_cache.mutex);
+}
+
+/**
+ * Free all trees of the shared cache, only to be called once meshes using them are freed.
+ */
+void BKE_bvhtree_shared_cache_free(void)
+{
+  BLI_mutex_lock(&bvh_shared_cache.mutex);
+  LISTBASE_FOREACH_MUTABLE (BVHSharedTree *, shared, &bvh_shared_cache.trees) {
+    BLI_assert(shared->users == 0);
+    bvhtree_shared_cache_remove(shared);
+  }
+  BLI_assert(bvh_shared_cache.mem_size == 0);
+  if (bvh_shared_cache.trees_by_hash) {
+    BLI_ghash_free(bvh_shared_cache.trees_by_hash, NULL, NULL);
+    bvh_shared_cache.trees_by_hash = NULL;
+  }
+  BLI_mutex_unlock(&bvh_shared_cache.mutex);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BVHCache
  * \{ */
 
 typedef struct BVHCacheItem {
   bool is_filled;
+  /** When set, the tree is owned by the shared cache, see #bvhtree_shared_release. */
+  BVHSharedTree *shared;
   BVHTree *tree;
 } BVHCacheItem;
 
@@ -139,11 +680,15 @@ BVHCache *bvhcache_init(void)
  * A call to this assumes that there was no previous cached tree of the given type
  * \warning The #BVHTree can be NULL.
  */
-static void bvhcache_insert(BVHCache *bvh_cache, BVHTree *tree, BVHCacheType type)
+static void bvhcache_insert(BVHCache *bvh_cache,
+                            BVHTree *tree,
+                            BVHCacheType type,
+                            BVHSharedTree *shared)
 {
   BVHCacheItem *item = &bvh_cache->items[type];
   BLI_assert(!item->is_filled);
   item->tree = tree;
+  item->shared = shared;
   item->is_filled = true;
 }
 
@@ -154,7 +699,12 @@ void bvhcache_free(BVHCache *bvh_cache)
 {
   for (BVHCacheType index = 0; index < BVHTREE_MAX_ITEM; index++) {
     BVHCacheItem *item = &bvh_cache->items[index];
-    BLI_bvhtree_free(item->tree);
+    if (item->shared) {
+      bvhtree_shared_release(item->shared);
+    }
+    else {
+      BLI_bvhtree_free(item->tree);
+    }
     item->tree = NULL;
   }
   BLI_mutex_end(&bvh_cache->mutex);
@@ -672,7 +1222,7 @@ BVHTree *bvhtree_from_editmesh_verts_ex(BVHTreeFromEditMesh *data,
 
       /* Save on cache for later use */
       /* printf("BVHTree built and saved on cache\n"); */
-      bvhcache_insert(*bvh_cache_p, tree, bvh_cache_type);
+      bvhcache_insert(*bvh_cache_p, tree, bvh_cache_type, NULL);
       data->cached = true;
     }
     bvhcache_unlock(*bvh_cache_p, lock_started);
@@ -702,26 +1252,22 @@ BVHTree *bvhtree_from_editmesh_verts(
       data, em, NULL, -1, epsilon, tree_type, axis, 0, NULL, NULL);
 }
 
-/**
- * Builds a bvh tree where nodes are the given vertices (note: does not copy given mverts!).
- * \param vert_allocated: if true, vert freeing will be done when freeing data.
- * \param verts_mask: if not null, true elements give which vert to add to BVH tree.
- * \param verts_num_active: if >= 0, number of active verts to add to BVH tree
- * (else will be computed from mask).
- */
-BVHTree *bvhtree_from_mesh_verts_ex(BVHTreeFromMesh *data,
-                                    const MVert *vert,
-                                    const int verts_num,
-                                    const bool vert_allocated,
-                                    const BLI_bitmap *verts_mask,
-                                    int verts_num_active,
-                                    float epsilon,
-                                    int tree_type,
-                                    int axis,
-                                    const BVHCacheType bvh_cache_type,
-                                    BVHCache **bvh_cache_p,
-                                    ThreadMutex *mesh_eval_mutex)
+/** \param use_shared: Use the shared tree cache, only with a `bvh_cache_p`. */
+static BVHTree *bvhtree_from_mesh_verts_ex_impl(BVHTreeFromMesh *data,
+                                                const MVert *vert,
+                                                const int verts_num,
+                                                const bool vert_allocated,
+                                                const BLI_bitmap *verts_mask,
+                                                int verts_num_active,
+                                                float epsilon,
+                                                int tree_type,
+                                                int axis,
+                                                const BVHCacheType bvh_cache_type,
+                                                BVHCache **bvh_cache_p,
+                                                ThreadMutex *mesh_eval_mutex,
+                                                const bool use_shared)
 {
+  BLI_assert(!use_shared || bvh_cache_p);
   bool in_cache = false;
   bool lock_started = false;
   BVHTree *tree = NULL;
@@ -730,15 +1276,31 @@ BVHTree *bvhtree_from_mesh_verts_ex(BVHTreeFromMesh *data,
   }
 
   if (in_cache == false) {
-    tree = bvhtree_from_mesh_verts_create_tree(
-        epsilon, tree_type, axis, vert, verts_num, verts_mask, verts_num_active);
-    bvhtree_balance(tree, bvh_cache_p != NULL);
+    BVHSharedTreeKey shared_key;
+    BVHSharedTree *shared = NULL;
+    if (use_shared) {
+      bvhtree_shared_key_from_verts(
+          &shared_key, bvh_cache_type, vert, verts_num, verts_mask, epsilon, tree_type, axis);
+      shared = bvhtree_shared_acquire(&shared_key);
+    }
+
+    if (shared) {
+      tree = shared->tree;
+    }
+    else {
+      tree = bvhtree_from_mesh_verts_create_tree(
+          epsilon, tree_type, axis, vert, verts_num, verts_mask, verts_num_active);
+      bvhtree_balance(tree, bvh_cache_p != NULL);
+      if (use_shared) {
+        shared = bvhtree_shared_insert(&shared_key, tree);
+      }
+    }
 
     if (bvh_cache_p) {
       /* Save on cache for later use */
       /* printf("BVHTree built and saved on cache\n"); */
       BVHCache *bvh_cache = *bvh_cache_p;
-      bvhcache_insert(bvh_cache, tree, bvh_cache_type);
+      bvhcache_insert(bvh_cache, tree, bvh_cache_type, shared);
       in_cache = true;
     }
   }
@@ -753,6 +1315,41 @@ BVHTree *bvhtree_from_mesh_verts_ex(BVHTreeFromMesh *data,
   return tree;
 }
 
+/**
+ * Builds a bvh tree where nodes are the given vertices (note: does not copy given mverts!).
+ * \param vert_allocated: if true, vert freeing will be done when freeing data.
+ * \param verts_mask: if not null, true elements give which vert to add to BVH tree.
+ * \param verts_num_active: if >= 0, number of active verts to add to BVH tree
+ * (else will be computed from mask).
+ */
+BVHTree *bvhtree_from_mesh_verts_ex(BVHTreeFromMesh *data,
+                                    const MVert *vert,
+                                    const int verts_num,
+                                    const bool vert_allocated,
+                                    const BLI_bitmap *verts_mask,
+                                    int verts_num_active,
+                                    float epsilon,
+                                    int tree_type,
+                                    int axis,
+                                    const BVHCacheType bvh_cache_type,
+                                    BVHCache **bvh_cache_p,
+                                    ThreadMutex *mesh_eval_mutex)
+{
+  return bvhtree_from_mesh_verts_ex_impl(data,
+                                         vert,
+                                         verts_num,
+                                         vert_allocated,
+                                         verts_mask,
+                                         verts_num_active,
+                                         epsilon,
+                                         tree_type,
+                                         axis,
+                                         bvh_cache_type,
+                                         bvh_cache_p,
+                                         mesh_eval_mutex,
+                                         false);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -884,7 +1481,7 @@ BVHTree *bvhtree_from_editmesh_edges_ex(BVHTreeFromEditMesh *data,
       bvhtree_balance(tree, true);
       /* Save on cache for later use */
       /* printf("BVHTree built and saved on cache\n"); */
-      bvhcache_insert(bvh_cache, tree, bvh_cache_type);
+      bvhcache_insert(bvh_cache, tree, bvh_cache_type, NULL);
       data->cached = true;
     }
     bvhcache_unlock(bvh_cache, lock_started);
@@ -914,29 +1511,24 @@ BVHTree *bvhtree_from_editmesh_edges(
       data, em, NULL, -1, epsilon, tree_type, axis, 0, NULL, NULL);
 }
 
-/**
- * Builds a bvh tree where nodes are the given edges .
- * \param vert, vert_allocated: if true, elem freeing will be done when freeing data.
- * \param edge, edge_allocated: if true, elem freeing will be done when freeing data.
- * \param edges_mask: if not null, true elements give which vert to add to BVH tree.
- * \param edges_num_active: if >= 0, number of active edges to add to BVH tree
- * (else will be computed from mask).
- */
-BVHTree *bvhtree_from_mesh_edges_ex(BVHTreeFromMesh *data,
-                                    const MVert *vert,
-                                    const bool vert_allocated,
-                                    const MEdge *edge,
-                                    const int edges_num,
-                                    const bool edge_allocated,
-                                    const BLI_bitmap *edges_mask,
-                                    int edges_num_active,
-                                    float epsilon,
-                                    int tree_type,
-                                    int axis,
-                                    const BVHCacheType bvh_cache_type,
-                                    BVHCache **bvh_cache_p,
-                                    ThreadMutex *mesh_eval_mutex)
+/** \param use_shared: Use the shared tree cache, only with a `bvh_cache_p`. */
+static BVHTree *bvhtree_from_mesh_edges_ex_impl(BVHTreeFromMesh *data,
+                                                const MVert *vert,
+                                                const bool vert_allocated,
+                                                const MEdge *edge,
+                                                const int edges_num,
+                                                const bool edge_allocated,
+                                                const BLI_bitmap *edges_mask,
+                                                int edges_num_active,
+                                                float epsilon,
+                                                int tree_type,
+                                                int axis,
+                                                const BVHCacheType bvh_cache_type,
+                                                BVHCache **bvh_cache_p,
+                                                ThreadMutex *mesh_eval_mutex,
+                                                const bool use_shared)
 {
+  BLI_assert(!use_shared || bvh_cache_p);
   bool in_cache = false;
   bool lock_started = false;
   BVHTree *tree = NULL;
@@ -945,21 +1537,40 @@ BVHTree *bvhtree_from_mesh_edges_ex(BVHTreeFromMesh *data,
   }
 
   if (in_cache == false) {
-    tree = bvhtree_from_mesh_edges_create_tree(
-        vert, edge, edges_num, edges_mask, edges_num_active, epsilon, tree_type, axis);
+    BVHSharedTreeKey shared_key;
+    BVHSharedTree *shared = NULL;
+    if (use_shared) {
+      bvhtree_shared_key_from_edges(&shared_key,
+                                    bvh_cache_type,
+                                    vert,
+                                    edge,
+                                    edges_num,
+                                    edges_mask,
+                                    epsilon,
+                                    tree_type,
+                                    axis);
+      shared = bvhtree_shared_acquire(&shared_key);
+    }
 
-    if (bvh_cache_p) {
-      bvhtree_balance(tree, true);
+    if (shared) {
+      tree = shared->tree;
+    }
+    else {
+      tree = bvhtree_from_mesh_edges_create_tree(
+          vert, edge, edges_num, edges_mask, edges_num_active, epsilon, tree_type, axis);
+      bvhtree_balance(tree, bvh_cache_p != NULL);
+      if (use_shared) {
+        shared = bvhtree_shared_insert(&shared_key, tree);
+      }
+    }
 
+    if (bvh_cache_p) {
       BVHCache *bvh_cache = *bvh_cache_p;
       /* Save on cache for later use */
       /* printf("BVHTree built and saved on cache\n"); */
-      bvhcache_insert(bvh_cache, tree, bvh_cache_type);
+      bvhcache_insert(bvh_cache, tree, bvh_cache_type, shared);
       in_cache = true;
     }
-    else {
-      bvhtree_balance(tree, false);
-    }
   }
 
   if (bvh_cache_p) {
@@ -973,6 +1584,46 @@ BVHTree *bvhtree_from_mesh_edges_ex(BVHTreeFromMesh *data,
   return tree;
 }
 
+/**
+ * Builds a bvh tree where nodes are the given edges .
+ * \param vert, vert_allocated: if true, elem freeing will be done when freeing data.
+ * \param edge, edge_allocated: if true, elem freeing will be done when freeing data.
+ * \param edges_mask: if not null, true elements give which vert to add to BVH tree.
+ * \param edges_num_active: if >= 0, number of active edges to add to BVH tree
+ * (else will be computed from mask).
+ */
+BVHTree *bvhtree_from_mesh_edges_ex(BVHTreeFromMesh *data,
+                                    const MVert *vert,
+                                    const bool vert_allocated,
+                                    const MEdge *edge,
+                                    const int edges_num,
+                                    const bool edge_allocated,
+                                    const BLI_bitmap *edges_mask,
+                                    int edges_num_active,
+                                    float epsilon,
+                                    int tree_type,
+                                    int axis,
+                                    const BVHCacheType bvh_cache_type,
+                                    BVHCache **bvh_cache_p,
+                                    ThreadMutex *mesh_eval_mutex)
+{
+  return bvhtree_from_mesh_edges_ex_impl(data,
+                                         vert,
+                                         vert_allocated,
+                                         edge,
+                                         edges_num,
+                                         edge_allocated,
+                                         edges_mask,
+                                         edges_num_active,
+                                         epsilon,
+                                         tree_type,
+                                         axis,
+                                         bvh_cache_type,
+                                         bvh_cache_p,
+                                         mesh_eval_mutex,
+                                         false);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1088,7 +1739,7 @@ BVHTree *bvhtree_from_mesh_faces_ex(BVHTreeFromMesh *data,
       /* Save on cache for later use */
       /* printf("BVHTree built and saved on cache\n"); */
       BVHCache *bvh_cache = *bvh_cache_p;
-      bvhcache_insert(bvh_cache, tree, bvh_cache_type);
+      bvhcache_insert(bvh_cache, tree, bvh_cache_type, NULL);
       in_cache = true;
     }
   }
@@ -1261,7 +1912,7 @@ BVHTree *bvhtree_from_editmesh_looptri_ex(BVHTreeFromEditMesh *data,
 
       /* Save on cache for later use */
       /* printf("BVHTree built and saved on cache\n"); */
-      bvhcache_insert(bvh_cache, tree, bvh_cache_type);
+      bvhcache_insert(bvh_cache, tree, bvh_cache_type, NULL);
     }
     bvhcache_unlock(bvh_cache, lock_started);
   }
@@ -1288,28 +1939,26 @@ BVHTree *bvhtree_from_editmesh_looptri(
       data, em, NULL, -1, epsilon, tree_type, axis, 0, NULL, NULL);
 }
 
-/**
- * Builds a bvh tree where nodes are the looptri faces of the given dm
- *
- * \note for editmesh this is currently a duplicate of bvhtree_from_mesh_faces_ex
- */
-BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
-                                      const struct MVert *vert,
-                                      const bool vert_allocated,
-                                      const struct MLoop *mloop,
-                                      const bool loop_allocated,
-                                      const struct MLoopTri *looptri,
-                                      const int looptri_num,
-                                      const bool looptri_allocated,
-                                      const BLI_bitmap *looptri_mask,
-                                      int looptri_num_active,
-                                      float epsilon,
-                                      int tree_type,
-                                      int axis,
-                                      const BVHCacheType bvh_cache_type,
-                                      BVHCache **bvh_cache_p,
-                                      ThreadMutex *mesh_eval_mutex)
+/** \param use_shared: Use the shared tree cache, only with a `bvh_cache_p`. */
+static BVHTree *bvhtree_from_mesh_looptri_ex_impl(BVHTreeFromMesh *data,
+                                                  const struct MVert *vert,
+                                                  const bool vert_allocated,
+                                                  const struct MLoop *mloop,
+                                                  const bool loop_allocated,
+                                                  const struct MLoopTri *looptri,
+                                                  const int looptri_num,
+                                                  const bool looptri_allocated,
+                                                  const BLI_bitmap *looptri_mask,
+                                                  int looptri_num_active,
+                                                  float epsilon,
+                                                  int tree_type,
+                                                  int axis,
+                                                  const BVHCacheType bvh_cache_type,
+                                                  BVHCache **bvh_cache_p,
+                                                  ThreadMutex *mesh_eval_mutex,
+                                                  const bool use_shared)
 {
+  BLI_assert(!use_shared || bvh_cache_p);
   bool in_cache = false;
   bool lock_started = false;
   BVHTree *tree = NULL;
@@ -1318,22 +1967,46 @@ BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
   }
 
   if (in_cache == false) {
-    /* Setup BVHTreeFromMesh */
-    tree = bvhtree_from_mesh_looptri_create_tree(epsilon,
-                                                 tree_type,
-                                                 axis,
-                                                 vert,
-                                                 mloop,
-                                                 looptri,
-                                                 looptri_num,
-                                                 looptri_mask,
-                                                 looptri_num_active);
+    BVHSharedTreeKey shared_key;
+    BVHSharedTree *shared = NULL;
+    if (use_shared) {
+      bvhtree_shared_key_from_looptri(&shared_key,
+                                      bvh_cache_type,
+                                      vert,
+                                      mloop,
+                                      looptri,
+                                      looptri_num,
+                                      looptri_mask,
+                                      epsilon,
+                                      tree_type,
+                                      axis);
+      shared = bvhtree_shared_acquire(&shared_key);
+    }
 
-    bvhtree_balance(tree, bvh_cache_p != NULL);
+    if (shared) {
+      tree = shared->tree;
+    }
+    else {
+      /* Setup BVHTreeFromMesh */
+      tree = bvhtree_from_mesh_looptri_create_tree(epsilon,
+                                                   tree_type,
+                                                   axis,
+                                                   vert,
+                                                   mloop,
+                                                   looptri,
+                                                   looptri_num,
+                                                   looptri_mask,
+                                                   looptri_num_active);
+
+      bvhtree_balance(tree, bvh_cache_p != NULL);
+      if (use_shared) {
+        shared = bvhtree_shared_insert(&shared_key, tree);
+      }
+    }
 
     if (bvh_cache_p) {
       BVHCache *bvh_cache = *bvh_cache_p;
-      bvhcache_insert(bvh_cache, tree, bvh_cache_type);
+      bvhcache_insert(bvh_cache, tree, bvh_cache_type, shared);
       in_cache = true;
     }
   }
@@ -1356,6 +2029,47 @@ BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
   return tree;
 }
 
+/**
+ * Builds a bvh tree where nodes are the looptri faces of the given dm
+ *
+ * \note for editmesh this is currently a duplicate of bvhtree_from_mesh_faces_ex
+ */
+BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
+                                      const struct MVert *vert,
+                                      const bool vert_allocated,
+                                      const struct MLoop *mloop,
+                                      const bool loop_allocated,
+                                      const struct MLoopTri *looptri,
+                                      const int looptri_num,
+                                      const bool looptri_allocated,
+                                      const BLI_bitmap *looptri_mask,
+                                      int looptri_num_active,
+                                      float epsilon,
+                                      int tree_type,
+                                      int axis,
+                                      const BVHCacheType bvh_cache_type,
+                                      BVHCache **bvh_cache_p,
+                                      ThreadMutex *mesh_eval_mutex)
+{
+  return bvhtree_from_mesh_looptri_ex_impl(data,
+                                           vert,
+                                           vert_allocated,
+                                           mloop,
+                                           loop_allocated,
+                                           looptri,
+                                           looptri_num,
+                                           looptri_allocated,
+                                           looptri_mask,
+                                           looptri_num_active,
+                                           epsilon,
+                                           tree_type,
+                                           axis,
+                                           bvh_cache_type,
+                                           bvh_cache_p,
+                                           mesh_eval_mutex,
+                                           false);
+}
+
 static BLI_bitmap *loose_verts_map_get(const MEdge *medge,
                                        int edges_num,
                                        const MVert *UNUSED(mvert),
@@ -1446,6 +2160,7 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
   BVHTree *tree = NULL;
   BVHCache **bvh_cache_p = (BVHCache **)&mesh->runtime.bvh_cache;
   ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
+  const bool use_shared = bvhtree_shared_mesh_supported(mesh);
 
   bool is_cached = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, NULL, NULL);
 
@@ -1467,18 +2182,19 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
               mesh->medge, mesh->totedge, mesh->mvert, verts_len, &loose_vert_len);
         }
 
-        tree = bvhtree_from_mesh_verts_ex(data,
-                                          mesh->mvert,
-                                          verts_len,
-                                          false,
-                                          loose_verts_mask,
-                                          loose_vert_len,
-                                          0.0f,
-                                          tree_type,
-                                          6,
-                                          bvh_cache_type,
-                                          bvh_cache_p,
-                                          mesh_eval_mutex);
+        tree = bvhtree_from_mesh_verts_ex_impl(data,
+                                               mesh->mvert,
+                                               verts_len,
+                                               false,
+                                               loose_verts_mask,
+                                               loose_vert_len,
+                                               0.0f,
+                                               tree_type,
+                                               6,
+                                               bvh_cache_type,
+                                               bvh_cache_p,
+                                               mesh_eval_mutex,
+                                               use_shared);
 
         if (loose_verts_mask != NULL) {
           MEM_freeN(loose_verts_mask);
@@ -1501,20 +2217,21 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
           loose_edges_mask = loose_edges_map_get(mesh->medge, edges_len, &loose_edges_len);
         }
 
-        tree = bvhtree_from_mesh_edges_ex(data,
-                                          mesh->mvert,
-                                          false,
-                                          mesh->medge,
-                                          edges_len,
-                                          false,
-                                          loose_edges_mask,
-                                          loose_edges_len,
-                                          0.0,
-                                          tree_type,
-                                          6,
-                                          bvh_cache_type,
-                                          bvh_cache_p,
-                                          mesh_eval_mutex);
+        tree = bvhtree_from_mesh_edges_ex_impl(data,
+                                               mesh->mvert,
+                                               false,
+                                               mesh->medge,
+                                               edges_len,
+                                               false,
+                                               loose_edges_mask,
+                                               loose_edges_len,
+                                               0.0,
+                                               tree_type,
+                                               6,
+                                               bvh_cache_type,
+                                               bvh_cache_p,
+                                               mesh_eval_mutex,
+                                               use_shared);
 
         if (loose_edges_mask != NULL) {
           MEM_freeN(loose_edges_mask);
@@ -1567,22 +2284,23 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
               mesh->mpoly, looptri_len, &looptri_mask_active_len);
         }
 
-        tree = bvhtree_from_mesh_looptri_ex(data,
-                                            mesh->mvert,
-                                            false,
-                                            mesh->mloop,
-                                            false,
-                                            mlooptri,
-                                            looptri_len,
-                                            false,
-                                            looptri_mask,
-                                            looptri_mask_active_len,
-                                            0.0,
-                                            tree_type,
-                                            6,
-                                            bvh_cache_type,
-                                            bvh_cache_p,
-                                            mesh_eval_mutex);
+        tree = bvhtree_from_mesh_looptri_ex_impl(data,
+                                                 mesh->mvert,
+                                                 false,
+                                                 mesh->mloop,
+                                                 false,
+                                                 mlooptri,
+                                                 looptri_len,
+                                                 false,
+                                                 looptri_mask,
+                                                 looptri_mask_active_len,
+                                                 0.0,
+                                                 tree_type,
+                                                 6,
+                                                 bvh_cache_type,
+                                                 bvh_cache_p,
+                                                 mesh_eval_mutex,
+                                                 use_shared);
 
         if (looptri_mask != NULL) {
           MEM_freeN(looptri_mask);
@@ -0,0 +1,118 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_task.h"
+
+#include "BKE_bvhutils.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+namespace blender::bke::tests {
+
+/* A grid of `size * size` quads. */
+static Mesh *grid_mesh_create(const int size)
+{
+  const int verts_len = (size + 1) * (size + 1);
+  Mesh *mesh = BKE_mesh_new_nomain(verts_len, 0, 0, size * size * 4, size * size);
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      MVert &mv = mesh->mvert[y * (size + 1) + x];
+      mv.co[0] = (float)x;
+      mv.co[1] = (float)y;
+      mv.co[2] = 0.0f;
+    }
+  }
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int i = y * size + x;
+      const int v = y * (size + 1) + x;
+      mesh->mpoly[i].loopstart = i * 4;
+      mesh->mpoly[i].totloop = 4;
+      MLoop *ml = &mesh->mloop[i * 4];
+      ml[0].v = v;
+      ml[1].v = v + 1;
+      ml[2].v = v + size + 2;
+      ml[3].v = v + size + 1;
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+static BVHTree *mesh_looptri_tree_get(Mesh *mesh)
+{
+  BVHTreeFromMesh treedata;
+  BVHTree *tree = BKE_bvhtree_from_mesh_get(&treedata, mesh, BVHTREE_FROM_LOOPTRI, 2);
+  free_bvhtree_from_mesh(&treedata);
+  return tree;
+}
+
+TEST(bvhutils, SharedCache)
+{
+  BKE_idtype_init();
+  BLI_task_scheduler_init();
+
+  Mesh *mesh = grid_mesh_create(64);
+
+  /* Copies referencing the same coordinates share their trees. */
+  Mesh *mesh_ref_a = BKE_mesh_copy_for_eval(mesh, true);
+  Mesh *mesh_ref_b = BKE_mesh_copy_for_eval(mesh, true);
+  BVHTree *tree_a = mesh_looptri_tree_get(mesh_ref_a);
+  ASSERT_NE(tree_a, nullptr);
+  const size_t mem_size = BKE_bvhtree_shared_cache_mem_size();
+  EXPECT_GT(mem_size, 0);
+  EXPECT_EQ(mesh_looptri_tree_get(mesh_ref_b), tree_a);
+  EXPECT_EQ(BKE_bvhtree_shared_cache_mem_size(), mem_size);
+
+  /* Meshes owning their (deformed) coordinates don't use the cache. */
+  Mesh *mesh_deform = BKE_mesh_copy_for_eval(mesh, false);
+  mesh_deform->mvert[0].co[2] = 1.0f;
+  BVHTree *tree_deform = mesh_looptri_tree_get(mesh_deform);
+  EXPECT_NE(tree_deform, tree_a);
+  EXPECT_EQ(BKE_bvhtree_shared_cache_mem_size(), mem_size);
+
+  /* Copies referencing the deformed coordinates use the cache again, with a tree of their own. */
+  Mesh *mesh_deform_ref = BKE_mesh_copy_for_eval(mesh_deform, true);
+  EXPECT_NE(mesh_looptri_tree_get(mesh_deform_ref), tree_a);
+  EXPECT_EQ(BKE_bvhtree_shared_cache_mem_size(), mem_size * 2);
+  EXPECT_NE(mesh_looptri_tree_get(mesh_deform_ref), tree_deform);
+
+  /* Unused trees are kept until the budget is lowered or they are freed explicitly. */
+  BKE_id_free(nullptr, mesh_ref_a);
+  BKE_id_free(nullptr, mesh_ref_b);
+  EXPECT_EQ(BKE_bvhtree_shared_cache_mem_size(), mem_size * 2);
+  BKE_bvhtree_shared_cache_budget_set(mem_size);
+  EXPECT_EQ(BKE_bvhtree_shared_cache_mem_size(), mem_size);
+  BKE_bvhtree_shared_cache_free_unused();
+  EXPECT_EQ(BKE_bvhtree_shared_cache_mem_size(), mem_size);
+
+  BKE_id_free(nullptr, mesh_deform_ref);
+  BKE_bvhtree_shared_cache_free_unused();
+  EXPECT_EQ(BKE_bvhtree_shared_cache_mem_size(), 0);
+
+  BKE_id_free(nullptr, mesh_deform);
+  BKE_id_free(nullptr, mesh);
+  BKE_bvhtree_shared_cache_free();
+
+  BLI_task_scheduler_exit();
+}
+
+}  // namespace blender::bke::tests
@@ -80,6 +80,18 @@ void BKE_callback_add(bCallbackFuncStore *funcstore, eCbEvent evt)
   BLI_addtail(lb, funcstore);
 }
 
+/* Check whether executing the callbacks of the event would call anything. */
+bool BKE_callback_poll(eCbEvent evt)
+{
+  ListBase *lb = &callback_slots[evt];
+  LISTBASE_FOREACH (bCallbackFuncStore *, funcstore, lb) {
+    if (funcstore->poll == NULL || funcstore->poll(funcstore->arg)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void BKE_callback_global_init(void)
 {
   /* do nothing */
@@ -124,8 +124,8 @@ static BVHTree *bvhtree_build_from_cloth(ClothModifierData *clmd, float epsilon)
     }
   }
 
-  /* balance tree */
-  BLI_bvhtree_balance(bvhtree);
+  /* Linear build: the tree is rebuilt whenever the deformation degrades it too much. */
+  BLI_bvhtree_balance_ex(bvhtree, BVH_BALANCE_LINEAR);
 
   return bvhtree;
 }
@@ -187,7 +187,7 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
         }
       }
 
-      BLI_bvhtree_update_tree(bvhtree);
+      BLI_bvhtree_update_tree_ex(bvhtree, BVH_REBUILD_COST_RATIO_DEFAULT);
     }
   }
   else {
@@ -205,7 +205,7 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
         }
       }
 
-      BLI_bvhtree_update_tree(bvhtree);
+      BLI_bvhtree_update_tree_ex(bvhtree, BVH_REBUILD_COST_RATIO_DEFAULT);
     }
   }
 }
@@ -129,8 +129,8 @@ BVHTree *bvhtree_build_from_mvert(const MVert *mvert,
     BLI_bvhtree_insert(tree, i, co[0], 3);
   }
 
-  /* balance tree */
-  BLI_bvhtree_balance(tree);
+  /* Morton order build, cheap enough to redo when #BLI_bvhtree_update_tree_ex rebuilds. */
+  BLI_bvhtree_balance_ex(tree, BVH_BALANCE_LINEAR);
 
   return tree;
 }
@@ -181,7 +181,7 @@ void bvhtree_update_from_mvert(BVHTree *bvhtree,
     }
   }
 
-  BLI_bvhtree_update_tree(bvhtree);
+  BLI_bvhtree_update_tree_ex(bvhtree, BVH_REBUILD_COST_RATIO_DEFAULT);
 }
 
 /* ***************************
@@ -3016,6 +3016,133 @@ void CustomData_free_elem(CustomData *data, int index, int count)
 
 #define SOURCE_BUF_SIZE 100
 
+/* -------------------------------------------------------------------- */
+/* Typed interpolation kernels.
+ *
+ * Layers which interpolate as a weighted sum of floats are handled here instead of calling
+ * #LayerTypeInfo.interp for every element, with the number of floats known at compile time so
+ * the loops can be unrolled and vectorized. */
+
+/* Number of floats of a layer which interpolates as a weighted sum, zero for other layers. */
+static int customData_interp_float_len(const LayerTypeInfo *typeInfo)
+{
+  if (ELEM(typeInfo->interp, layerInterp_propFloat, layerInterp_paint_mask, layerInterp_bweight)) {
+    return 1;
+  }
+  if (typeInfo->interp == layerInterp_propfloat2) {
+    return 2;
+  }
+  if (ELEM(typeInfo->interp, layerInterp_propfloat3, layerInterp_shapekey)) {
+    return 3;
+  }
+  if (typeInfo->interp == layerInterp_propcol) {
+    return 4;
+  }
+  return 0;
+}
+
+BLI_INLINE void customData_interp_float_elem(const void **sources,
+                                             const float *weights,
+                                             const int count,
+                                             float *dest,
+                                             const int len)
+{
+  float result[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < count; i++) {
+    const float *src = sources[i];
+    const float interp_weight = weights[i];
+    for (int j = 0; j < len; j++) {
+      result[j] += src[j] * interp_weight;
+    }
+  }
+  /* Delay writing to the destination in case dest is in sources. */
+  for (int j = 0; j < len; j++) {
+    dest[j] = result[j];
+  }
+}
+
+BLI_INLINE void customData_interp_float_array(const float *src_data,
+                                              const int *src_indices,
+                                              const float *weights,
+                                              const int src_count,
+                                              float *dst_data,
+                                              const int *dest_indices,
+                                              const int dest_len,
+                                              const int len)
+{
+  for (int i = 0; i < dest_len; i++) {
+    const int *elem_indices = &src_indices[(size_t)i * src_count];
+    const float *elem_weights = &weights[(size_t)i * src_count];
+    float result[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int k = 0; k < src_count; k++) {
+      const float *src = &src_data[(size_t)elem_indices[k] * len];
+      for (int j = 0; j < len; j++) {
+        result[j] += src[j] * elem_weights[k];
+      }
+    }
+    float *dst = &dst_data[(size_t)dest_indices[i] * len];
+    for (int j = 0; j < len; j++) {
+      dst[j] = result[j];
+    }
+  }
+}
+
+/* Interpolate one element of a layer with #customData_interp_float_len \a len. */
+static void customData_interp_floats(
+    const void **sources, const float *weights, int count, void *dest, const int len)
+{
+  switch (len) {
+    case 1:
+      customData_interp_float_elem(sources, weights, count, dest, 1);
+      break;
+    case 2:
+      customData_interp_float_elem(sources, weights, count, dest, 2);
+      break;
+    case 3:
+      customData_interp_float_elem(sources, weights, count, dest, 3);
+      break;
+    case 4:
+      customData_interp_float_elem(sources, weights, count, dest, 4);
+      break;
+    default:
+      BLI_assert_unreachable();
+      break;
+  }
+}
+
+/* Interpolate many elements of an array layer with #customData_interp_float_len \a len. */
+static void customData_interp_floats_array(const void *src_data,
+                                           const int *src_indices,
+                                           const float *weights,
+                                           int src_count,
+                                           void *dst_data,
+                                           const int *dest_indices,
+                                           int dest_len,
+                                           const int len)
+{
+  switch (len) {
+    case 1:
+      customData_interp_float_array(
+          src_data, src_indices, weights, src_count, dst_data, dest_indices, dest_len, 1);
+      break;
+    case 2:
+      customData_interp_float_array(
+          src_data, src_indices, weights, src_count, dst_data, dest_indices, dest_len, 2);
+      break;
+    case 3:
+      customData_interp_float_array(
+          src_data, src_indices, weights, src_count, dst_data, dest_indices, dest_len, 3);
+      break;
+    case 4:
+      customData_interp_float_array(
+          src_data, src_indices, weights, src_count, dst_data, dest_indices, dest_len, 4);
+      break;
+    default:
+      BLI_assert_unreachable();
+      break;
+  }
+}
+
 /**
  * Interpolate given custom data source items into a single destination one.
  *
@@ -3087,12 +3214,15 @@ void CustomData_interp(const CustomData *source,
         sources[j] = POINTER_OFFSET(src_data, (size_t)src_indices[j] * typeInfo->size);
       }
 
-      typeInfo->interp(
-          sources,
-          weights,
-          sub_weights,
-          count,
-          POINTER_OFFSET(dest->layers[dest_i].data, (size_t)dest_index * typeInfo->size));
+      void *dst_data = POINTER_OFFSET(dest->layers[dest_i].data,
+                                      (size_t)dest_index * typeInfo->size);
+      const int float_len = customData_interp_float_len(typeInfo);
+      if (float_len != 0) {
+        customData_interp_floats(sources, weights, count, dst_data, float_len);
+      }
+      else {
+        typeInfo->interp(sources, weights, sub_weights, count, dst_data);
+      }
 
       /* if there are multiple source & dest layers of the same type,
        * we don't want to copy all source layers to the same dest, so
@@ -3110,6 +3240,93 @@ void CustomData_interp(const CustomData *source,
   }
 }
 
+/**
+ * Interpolate many destination items at once, a layer at a time. Every destination item is
+ * interpolated from \a src_count source items, layers with a typed kernel (see
+ * #customData_interp_float_len) don't dispatch through #LayerTypeInfo.interp per item.
+ *
+ * \param src_indices: The \a src_count source items of every destination item.
+ * \param weights: The \a src_count weights of every destination item.
+ * \param dest_indices: The destination items, they must not be used as sources.
+ */
+void CustomData_interp_batch(const CustomData *source,
+                             CustomData *dest,
+                             const int *src_indices,
+                             const float *weights,
+                             int src_count,
+                             const int *dest_indices,
+                             int dest_len)
+{
+  BLI_assert(weights != NULL);
+  if (src_count <= 0 || dest_len <= 0) {
+    return;
+  }
+
+  const void *source_buf[SOURCE_BUF_SIZE];
+  const void **sources = source_buf;
+
+  if (src_count > SOURCE_BUF_SIZE) {
+    sources = MEM_malloc_arrayN(src_count, sizeof(*sources), __func__);
+  }
+
+  /* interpolates a layer at a time */
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(source->layers[src_i].type);
+    if (!typeInfo->interp) {
+      continue;
+    }
+
+    /* find the first dest layer with type >= the source type
+     * (this should work because layers are ordered by type)
+     */
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      dest_i++;
+    }
+
+    /* if there are no more dest layers, we're done */
+    if (dest_i >= dest->totlayer) {
+      break;
+    }
+
+    if (dest->layers[dest_i].type != source->layers[src_i].type) {
+      continue;
+    }
+
+    const void *src_data = source->layers[src_i].data;
+    void *dst_data = dest->layers[dest_i].data;
+
+    const int float_len = customData_interp_float_len(typeInfo);
+    if (float_len != 0) {
+      customData_interp_floats_array(
+          src_data, src_indices, weights, src_count, dst_data, dest_indices, dest_len, float_len);
+    }
+    else {
+      for (int i = 0; i < dest_len; i++) {
+        const int *elem_indices = &src_indices[(size_t)i * src_count];
+        for (int j = 0; j < src_count; j++) {
+          sources[j] = POINTER_OFFSET(src_data, (size_t)elem_indices[j] * typeInfo->size);
+        }
+        typeInfo->interp(sources,
+                         &weights[(size_t)i * src_count],
+                         NULL,
+                         src_count,
+                         POINTER_OFFSET(dst_data, (size_t)dest_indices[i] * typeInfo->size));
+      }
+    }
+
+    /* if there are multiple source & dest layers of the same type,
+     * we don't want to copy all source layers to the same dest, so
+     * increment dest_i
+     */
+    dest_i++;
+  }
+
+  if (src_count > SOURCE_BUF_SIZE) {
+    MEM_freeN((void *)sources);
+  }
+}
+
 /**
  * Swap data inside each item, for all layers.
  * This only applies to item types that may store several sub-item data
@@ -3647,7 +3864,7 @@ void CustomData_bmesh_free_block_data(CustomData *data, void *block)
   }
 }
 
-static void CustomData_bmesh_alloc_block(CustomData *data, void **block)
+void CustomData_bmesh_alloc_block(CustomData *data, void **block)
 {
   if (*block) {
     CustomData_bmesh_free_block(data, block);
@@ -4081,8 +4298,20 @@ void CustomData_bmesh_interp(CustomData *data,
       for (int j = 0; j < count; j++) {
         sources[j] = POINTER_OFFSET(src_blocks[j], layer->offset);
       }
-      CustomData_bmesh_interp_n(
-          data, sources, weights, sub_weights, count, POINTER_OFFSET(dst_block, layer->offset), i);
+      const int float_len = customData_interp_float_len(typeInfo);
+      if (float_len != 0) {
+        customData_interp_floats(
+            sources, weights, count, POINTER_OFFSET(dst_block, layer->offset), float_len);
+      }
+      else {
+        CustomData_bmesh_interp_n(data,
+                                  sources,
+                                  weights,
+                                  sub_weights,
+                                  count,
+                                  POINTER_OFFSET(dst_block, layer->offset),
+                                  i);
+      }
     }
   }
 
@@ -4094,6 +4323,60 @@ void CustomData_bmesh_interp(CustomData *data,
   }
 }
 
+/**
+ * Interpolate many blocks from the same source blocks at once, a layer at a time,
+ * e.g. all loops of a face from the loops of another face.
+ *
+ * \param weights: The \a count weights of every destination block.
+ * \param dst_blocks: The destination blocks, they must not be used as sources.
+ */
+void CustomData_bmesh_interp_batch(CustomData *data,
+                                   const void **src_blocks,
+                                   const float *weights,
+                                   int count,
+                                   void **dst_blocks,
+                                   int dst_len)
+{
+  BLI_assert(weights != NULL);
+  if (count <= 0 || dst_len <= 0) {
+    return;
+  }
+
+  void *source_buf[SOURCE_BUF_SIZE];
+  const void **sources = (const void **)source_buf;
+
+  if (count > SOURCE_BUF_SIZE) {
+    sources = MEM_malloc_arrayN(count, sizeof(*sources), __func__);
+  }
+
+  /* interpolates a layer at a time */
+  for (int i = 0; i < data->totlayer; i++) {
+    CustomDataLayer *layer = &data->layers[i];
+    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+    if (!typeInfo->interp) {
+      continue;
+    }
+    for (int j = 0; j < count; j++) {
+      sources[j] = POINTER_OFFSET(src_blocks[j], layer->offset);
+    }
+    const int float_len = customData_interp_float_len(typeInfo);
+    for (int k = 0; k < dst_len; k++) {
+      void *dst = POINTER_OFFSET(dst_blocks[k], layer->offset);
+      const float *elem_weights = &weights[(size_t)k * count];
+      if (float_len != 0) {
+        customData_interp_floats(sources, elem_weights, count, dst, float_len);
+      }
+      else {
+        typeInfo->interp(sources, elem_weights, NULL, count, dst);
+      }
+    }
+  }
+
+  if (count > SOURCE_BUF_SIZE) {
+    MEM_freeN((void *)sources);
+  }
+}
+
 /**
  * \param use_default_init: initializes data which can't be copied,
  * typically you'll want to use this if the BM_xxx create function
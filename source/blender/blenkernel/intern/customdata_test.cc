@@ -0,0 +1,58 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_customdata.h"
+
+#include "DNA_customdata_types.h"
+
+namespace blender::bke::tests {
+
+static const int TOTELEM = 16;
+
+static void customdata_test_init(CustomData *data)
+{
+  CustomData_reset(data);
+  float *values = (float *)CustomData_add_layer(data, CD_BWEIGHT, CD_CALLOC, nullptr, TOTELEM);
+  for (int i = 0; i < TOTELEM; i++) {
+    values[i] = (float)i;
+  }
+}
+
+TEST(customdata, interp_batch)
+{
+  CustomData data_src, data_dst;
+  customdata_test_init(&data_src);
+  CustomData_copy(&data_src, &data_dst, CD_MASK_BWEIGHT, CD_DUPLICATE, TOTELEM);
+
+  const int src_indices[4] = {0, 2, 4, 8};
+  const float weights[4] = {0.5f, 0.5f, 0.25f, 0.75f};
+  const int dest_indices[2] = {1, 3};
+  CustomData_interp_batch(&data_src, &data_dst, src_indices, weights, 2, dest_indices, 2);
+
+  const float *values = (const float *)CustomData_get_layer(&data_dst, CD_BWEIGHT);
+  EXPECT_EQ(values[0], 0.0f);
+  EXPECT_EQ(values[1], 1.0f);
+  EXPECT_EQ(values[2], 2.0f);
+  EXPECT_EQ(values[3], 7.0f);
+
+  CustomData_free(&data_src, TOTELEM);
+  CustomData_free(&data_dst, TOTELEM);
+}
+
+}  // namespace blender::bke::tests
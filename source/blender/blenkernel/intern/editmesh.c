@@ -68,6 +68,7 @@ BMEditMesh *BKE_editmesh_copy(BMEditMesh *em)
    * in that case it makes more sense to do the
    * tessellation only when/if that copy ends up getting used. */
   em_copy->looptris = NULL;
+  em_copy->deform_update = EM_DEFORM_UPDATE_NONE;
 
   /* Copy various settings. */
   em_copy->selectmode = em->selectmode;
@@ -209,6 +210,63 @@ void BKE_editmesh_looptri_and_normals_calc_with_partial(BMEditMesh *em,
                                          });
 }
 
+/**
+ * Tag the faces using \a v as only being deformed, so the next evaluation can update
+ * positions and normals without rebuilding data that depends on topology.
+ *
+ * \note The caller is still responsible for tagging the mesh for a geometry update.
+ * Topology changes must clear this, see #BKE_editmesh_deform_update_clear.
+ */
+void BKE_editmesh_deform_update_tag(BMEditMesh *em, const BMVert *v)
+{
+  if (em->deform_update == EM_DEFORM_UPDATE_ALL) {
+    return;
+  }
+  /* Loose geometry is stored after the loops, use a range of faces only. */
+  if ((v->e == NULL) || (em->bm->elem_index_dirty & BM_FACE)) {
+    BKE_editmesh_deform_update_tag_all(em);
+    return;
+  }
+
+  int range[2] = {INT_MAX, INT_MIN};
+  const BMEdge *e_iter, *e_first;
+  e_iter = e_first = v->e;
+  do {
+    if (e_iter->l == NULL) {
+      BKE_editmesh_deform_update_tag_all(em);
+      return;
+    }
+    const BMLoop *l_iter, *l_first;
+    l_iter = l_first = e_iter->l;
+    do {
+      const int f_index = BM_elem_index_get(l_iter->f);
+      range[0] = min_ii(range[0], f_index);
+      range[1] = max_ii(range[1], f_index + 1);
+    } while ((l_iter = l_iter->radial_next) != l_first);
+  } while ((e_iter = BM_DISK_EDGE_NEXT(e_iter, v)) != e_first);
+
+  if (em->deform_update == EM_DEFORM_UPDATE_NONE) {
+    copy_v2_v2_int(em->deform_update_face_range, range);
+    em->deform_update = EM_DEFORM_UPDATE_RANGE;
+  }
+  else {
+    em->deform_update_face_range[0] = min_ii(em->deform_update_face_range[0], range[0]);
+    em->deform_update_face_range[1] = max_ii(em->deform_update_face_range[1], range[1]);
+  }
+}
+
+void BKE_editmesh_deform_update_tag_all(BMEditMesh *em)
+{
+  em->deform_update = EM_DEFORM_UPDATE_ALL;
+  em->deform_update_face_range[0] = 0;
+  em->deform_update_face_range[1] = em->bm->totface;
+}
+
+void BKE_editmesh_deform_update_clear(BMEditMesh *em)
+{
+  em->deform_update = EM_DEFORM_UPDATE_NONE;
+}
+
 void BKE_editmesh_free_derivedmesh(BMEditMesh *em)
 {
   if (em->mesh_eval_cage) {
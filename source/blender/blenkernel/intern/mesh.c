@@ -143,6 +143,12 @@ static void mesh_copy_data(Main *bmain, ID *id_dst, const ID *id_src, const int
 
   mesh_dst->mselect = MEM_dupallocN(mesh_dst->mselect);
 
+  /* Copies are usually only deformed, so they can reuse caches which depend on topology. */
+  if (mesh_src->flag & ME_AUTOSMOOTH) {
+    mesh_dst->runtime.loop_fan_cache = BKE_mesh_loop_fan_cache_share((Mesh *)mesh_src);
+  }
+  mesh_dst->runtime.looptri_ngon_cache = BKE_mesh_looptri_ngon_cache_share((Mesh *)mesh_src);
+
   /* TODO Do we want to add flag to prevent this? */
   if (mesh_src->key && (flag & LIB_ID_COPY_SHAPEKEY)) {
     BKE_id_copy_ex(bmain, &mesh_src->key->id, (ID **)&mesh_dst->key, flag);
@@ -1410,6 +1416,7 @@ void BKE_mesh_material_remap(Mesh *me, const uint *remap, uint remap_len)
 
 void BKE_mesh_smooth_flag_set(Mesh *me, const bool use_smooth)
 {
+  BKE_mesh_loop_fan_cache_release(&me->runtime.loop_fan_cache);
   if (use_smooth) {
     for (int i = 0; i < me->totpoly; i++) {
       me->mpoly[i].flag |= ME_SMOOTH;
@@ -1839,21 +1846,22 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
     free_polynors = true;
   }
 
-  BKE_mesh_normals_loop_split(mesh->mvert,
-                              mesh->totvert,
-                              mesh->medge,
-                              mesh->totedge,
-                              mesh->mloop,
-                              r_loopnors,
-                              mesh->totloop,
-                              mesh->mpoly,
-                              (const float(*)[3])polynors,
-                              mesh->totpoly,
-                              use_split_normals,
-                              split_angle,
-                              r_lnors_spacearr,
-                              clnors,
-                              NULL);
+  BKE_mesh_normals_loop_split_ex(mesh->mvert,
+                                 mesh->totvert,
+                                 mesh->medge,
+                                 mesh->totedge,
+                                 mesh->mloop,
+                                 r_loopnors,
+                                 mesh->totloop,
+                                 mesh->mpoly,
+                                 (const float(*)[3])polynors,
+                                 mesh->totpoly,
+                                 use_split_normals,
+                                 split_angle,
+                                 r_lnors_spacearr,
+                                 clnors,
+                                 NULL,
+                                 &mesh->runtime.loop_fan_cache);
 
   if (free_polynors) {
     MEM_freeN(polynors);
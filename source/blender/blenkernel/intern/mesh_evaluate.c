@@ -819,111 +819,130 @@ typedef struct LoopSplitTaskDataCommon {
 /* See comment about edge_to_loops below. */
 #define IS_EDGE_SHARP(_e2l) (ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID))
 
-static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
-                                 const bool check_angle,
-                                 const float split_angle,
-                                 const bool do_sharp_edges_tag)
-{
-  const MVert *mverts = data->mverts;
-  const MEdge *medges = data->medges;
-  const MLoop *mloops = data->mloops;
-
-  const MPoly *mpolys = data->mpolys;
-
-  const int numEdges = data->numEdges;
-  const int numPolys = data->numPolys;
-
-  float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
-  const float(*polynors)[3] = data->polynors;
+typedef struct EdgesSharpTagData {
+  LoopSplitTaskDataCommon *common_data;
+  /** Number of loops using each edge, the first two of them are stored in edge_to_loops. */
+  int *edge_users;
+  float split_angle_cos;
+  bool check_angle;
+  bool do_sharp_edges_tag;
+} EdgesSharpTagData;
+
+static void mesh_edges_sharp_tag_polys_cb(void *__restrict userdata,
+                                          const int mp_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EdgesSharpTagData *data = userdata;
+  LoopSplitTaskDataCommon *common_data = data->common_data;
+  const MVert *mverts = common_data->mverts;
+  const MLoop *mloops = common_data->mloops;
+  float(*loopnors)[3] = common_data->loopnors; /* Note: loopnors may be NULL here. */
+  int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  int *loop_to_poly = common_data->loop_to_poly;
 
-  int(*edge_to_loops)[2] = data->edge_to_loops;
-  int *loop_to_poly = data->loop_to_poly;
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_end_index = mp->loopstart + mp->totloop;
+  for (int ml_index = mp->loopstart; ml_index < ml_end_index; ml_index++) {
+    const MLoop *ml = &mloops[ml_index];
 
-  BLI_bitmap *sharp_edges = do_sharp_edges_tag ? BLI_BITMAP_NEW(numEdges, __func__) : NULL;
+    loop_to_poly[ml_index] = mp_index;
 
-  const MPoly *mp;
-  int mp_index;
+    /* Pre-populate all loop normals as if their verts were all-smooth,
+     * this way we don't have to compute those later!
+     */
+    if (loopnors) {
+      normal_short_to_float_v3(loopnors[ml_index], mverts[ml->v].no);
+    }
 
-  const float split_angle_cos = check_angle ? cosf(split_angle) : -1.0f;
+    /* Only the first two loops using an edge are needed, any more makes it sharp anyway. */
+    const int slot = atomic_fetch_and_add_int32(&data->edge_users[ml->e], 1);
+    if (slot < 2) {
+      edge_to_loops[ml->e][slot] = ml_index;
+    }
+  }
+}
 
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    const MLoop *ml_curr;
-    int *e2l;
-    int ml_curr_index = mp->loopstart;
-    const int ml_last_index = (ml_curr_index + mp->totloop) - 1;
+static void mesh_edges_sharp_tag_edges_cb(void *__restrict userdata,
+                                          const int me_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EdgesSharpTagData *data = userdata;
+  LoopSplitTaskDataCommon *common_data = data->common_data;
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  const float(*polynors)[3] = common_data->polynors;
+  int *e2l = common_data->edge_to_loops[me_index];
 
-    ml_curr = &mloops[ml_curr_index];
+  switch (data->edge_users[me_index]) {
+    case 0:
+      /* Loose edge, both loop indices are left to zero. */
+      return;
+    case 1:
+      /* Boundary edge, tag it as unset (or invalid for flat faces). */
+      e2l[1] = (mpolys[loop_to_poly[e2l[0]]].flag & ME_SMOOTH) ? INDEX_UNSET : INDEX_INVALID;
+      return;
+    case 2:
+      break;
+    default:
+      /* More than two loops using this edge, tag as sharp. */
+      e2l[1] = INDEX_INVALID;
+      return;
+  }
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
-      e2l = edge_to_loops[ml_curr->e];
+  /* Keep the result independent from the order in which the loops were registered. Also ensures
+   * the second loop index is never zero. */
+  if (e2l[0] > e2l[1]) {
+    SWAP(int, e2l[0], e2l[1]);
+  }
 
-      loop_to_poly[ml_curr_index] = mp_index;
+  MEdge *me = (MEdge *)&common_data->medges[me_index];
+  const int mp_index_a = loop_to_poly[e2l[0]];
+  const int mp_index_b = loop_to_poly[e2l[1]];
+  const bool is_angle_sharp = (data->check_angle &&
+                               dot_v3v3(polynors[mp_index_a], polynors[mp_index_b]) <
+                                   data->split_angle_cos);
 
-      /* Pre-populate all loop normals as if their verts were all-smooth,
-       * this way we don't have to compute those later!
-       */
-      if (loopnors) {
-        normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
-      }
+  /* An edge is sharp if it is tagged as such, or one of its faces is not smooth,
+   * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
+   * same vertex, or angle between both its polys' normals is above split_angle value.
+   */
+  if (!(mpolys[mp_index_a].flag & ME_SMOOTH) || !(mpolys[mp_index_b].flag & ME_SMOOTH) ||
+      (me->flag & ME_SHARP) || mloops[e2l[0]].v == mloops[e2l[1]].v || is_angle_sharp) {
+    e2l[1] = INDEX_INVALID;
 
-      /* Check whether current edge might be smooth or sharp */
-      if ((e2l[0] | e2l[1]) == 0) {
-        /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
-        e2l[0] = ml_curr_index;
-        /* We have to check this here too, else we might miss some flat faces!!! */
-        e2l[1] = (mp->flag & ME_SMOOTH) ? INDEX_UNSET : INDEX_INVALID;
-      }
-      else if (e2l[1] == INDEX_UNSET) {
-        const bool is_angle_sharp = (check_angle &&
-                                     dot_v3v3(polynors[loop_to_poly[e2l[0]]], polynors[mp_index]) <
-                                         split_angle_cos);
-
-        /* Second loop using this edge, time to test its sharpness.
-         * An edge is sharp if it is tagged as such, or its face is not smooth,
-         * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
-         * same vertex, or angle between both its polys' normals is above split_angle value.
-         */
-        if (!(mp->flag & ME_SMOOTH) || (medges[ml_curr->e].flag & ME_SHARP) ||
-            ml_curr->v == mloops[e2l[0]].v || is_angle_sharp) {
-          /* Note: we are sure that loop != 0 here ;) */
-          e2l[1] = INDEX_INVALID;
-
-          /* We want to avoid tagging edges as sharp when it is already defined as such by
-           * other causes than angle threshold... */
-          if (do_sharp_edges_tag && is_angle_sharp) {
-            BLI_BITMAP_SET(sharp_edges, ml_curr->e, true);
-          }
-        }
-        else {
-          e2l[1] = ml_curr_index;
-        }
-      }
-      else if (!IS_EDGE_SHARP(e2l)) {
-        /* More than two loops using this edge, tag as sharp if not yet done. */
-        e2l[1] = INDEX_INVALID;
-
-        /* We want to avoid tagging edges as sharp when it is already defined as such by
-         * other causes than angle threshold... */
-        if (do_sharp_edges_tag) {
-          BLI_BITMAP_SET(sharp_edges, ml_curr->e, false);
-        }
-      }
-      /* Else, edge is already 'disqualified' (i.e. sharp)! */
+    /* We want to avoid tagging edges as sharp when it is already defined as such by
+     * other causes than angle threshold... */
+    if (data->do_sharp_edges_tag && is_angle_sharp) {
+      me->flag |= ME_SHARP;
     }
   }
+}
 
-  /* If requested, do actual tagging of edges as sharp in another loop. */
-  if (do_sharp_edges_tag) {
-    MEdge *me;
-    int me_index;
-    for (me = (MEdge *)medges, me_index = 0; me_index < numEdges; me++, me_index++) {
-      if (BLI_BITMAP_TEST(sharp_edges, me_index)) {
-        me->flag |= ME_SHARP;
-      }
-    }
+static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
+                                 const bool check_angle,
+                                 const float split_angle,
+                                 const bool do_sharp_edges_tag)
+{
+  EdgesSharpTagData tag_data = {
+      .common_data = data,
+      .edge_users = MEM_calloc_arrayN((size_t)data->numEdges, sizeof(int), __func__),
+      .split_angle_cos = check_angle ? cosf(split_angle) : -1.0f,
+      .check_angle = check_angle,
+      .do_sharp_edges_tag = do_sharp_edges_tag,
+  };
 
-    MEM_freeN(sharp_edges);
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  /* First register the loops using each edge, then decide about the sharpness of every edge. */
+  BLI_task_parallel_range(
+      0, data->numPolys, &tag_data, mesh_edges_sharp_tag_polys_cb, &settings);
+  BLI_task_parallel_range(
+      0, data->numEdges, &tag_data, mesh_edges_sharp_tag_edges_cb, &settings);
+
+  MEM_freeN(tag_data.edge_users);
 }
 
 /**
@@ -1311,55 +1330,56 @@ static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
   }
 }
 
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
-{
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
-
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
-
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
-      break;
-    }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
-  }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
-}
+/** A single loop or smooth fan of loops sharing the same normal, see #loop_split_generator. */
+typedef struct LoopSplitFan {
+  int ml_curr_index;
+  int ml_prev_index;
+  int mp_index;
+  bool is_single;
+} LoopSplitFan;
+
+/* Flags of #LoopSplitGeneratorData.loop_fan_flags, only ever added atomically. */
+enum {
+  /** The loop is the start of a single loop 'fan'. */
+  LOOP_SPLIT_FAN_SINGLE = (1 << 0),
+  /** The loop is the start of a smooth fan. */
+  LOOP_SPLIT_FAN_FAN = (1 << 1),
+  /** The smooth fan of the loop was completely walked, it doesn't need to be walked again. */
+  LOOP_SPLIT_FAN_WALKED = (1 << 2),
+};
+
+typedef struct LoopSplitGeneratorData {
+  LoopSplitTaskDataCommon *common_data;
+  /** LOOP_SPLIT_FAN_ flags for every loop. */
+  char *loop_fan_flags;
+} LoopSplitGeneratorData;
 
 /**
- * Check whether given loop is part of an unknown-so-far cyclic smooth fan, or not.
- * Needed because cyclic smooth fans have no obvious 'entry point',
- * and yet we need to walk them once, and only once.
+ * Walk the smooth fan around the vertex of given loop, whose previous edge is smooth.
+ * Needed because cyclic smooth fans have no obvious 'entry point', and yet we need to walk them
+ * once, and only once: the loop of the fan with the lowest index is used as its start, which does
+ * not depend on the order in which loops are checked.
+ *
+ * All loops of the fan are tagged as walked (unless it was stopped by a fan already walked), so
+ * each fan is walked once in total (more only when threads happen to walk it at the same time).
+ *
+ * \return The start of the cyclic smooth fan, or -1 when the fan is not cyclic.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
-{
+static int loop_split_generator_cyclic_smooth_fan_walk(LoopSplitGeneratorData *data,
+                                                       const int *e2l_prev,
+                                                       const MLoop *ml_curr,
+                                                       const MLoop *ml_prev,
+                                                       const int ml_curr_index,
+                                                       const int ml_prev_index,
+                                                       const int mp_curr_index)
+{
+  const LoopSplitTaskDataCommon *common_data = data->common_data;
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  char *loop_fan_flags = data->loop_fan_flags;
+
   const uint mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
   const int *e2lfan_curr;
   const MLoop *mlfan_curr;
@@ -1367,24 +1387,24 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   int mlfan_curr_index, mlfan_vert_index, mpfan_curr_index;
 
   e2lfan_curr = e2l_prev;
-  if (IS_EDGE_SHARP(e2lfan_curr)) {
-    /* Sharp loop, so not a cyclic smooth fan... */
-    return false;
-  }
-
   mlfan_curr = ml_prev;
   mlfan_curr_index = ml_prev_index;
   mlfan_vert_index = ml_curr_index;
   mpfan_curr_index = mp_curr_index;
 
+  BLI_assert(!IS_EDGE_SHARP(e2lfan_curr));
   BLI_assert(mlfan_curr_index >= 0);
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  BLI_assert(!BLI_BITMAP_TEST(skip_loops, mlfan_vert_index));
-  BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+  int ml_start_index = -1;
+  int ml_min_index = ml_curr_index;
+  int steps = 0;
+  bool is_complete = false;
 
-  while (true) {
+  /* Walking can not take more steps than there are loops, unless the fan does not lead back to
+   * the initial loop, which can only happen with invalid geometry. */
+  while (steps < common_data->numLoops) {
     /* Find next loop of the smooth fan. */
     BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
                                                 mpolys,
@@ -1395,226 +1415,363 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
                                                 &mlfan_curr_index,
                                                 &mlfan_vert_index,
                                                 &mpfan_curr_index);
+    steps++;
 
     e2lfan_curr = edge_to_loops[mlfan_curr->e];
 
     if (IS_EDGE_SHARP(e2lfan_curr)) {
       /* Sharp loop/edge, so not a cyclic smooth fan... */
-      return false;
+      is_complete = true;
+      break;
     }
     /* Smooth loop/edge... */
-    if (BLI_BITMAP_TEST(skip_loops, mlfan_vert_index)) {
-      if (mlfan_vert_index == ml_curr_index) {
-        /* We walked around a whole cyclic smooth fan without finding any already-processed loop,
-         * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
-        return true;
-      }
-      /* ... already checked in some previous looping, we can abort. */
-      return false;
+    if (mlfan_vert_index == ml_curr_index) {
+      /* We walked around a whole cyclic smooth fan. */
+      ml_start_index = ml_min_index;
+      is_complete = true;
+      break;
+    }
+    if (loop_fan_flags[mlfan_vert_index] & LOOP_SPLIT_FAN_WALKED) {
+      /* ... this fan is handled by a walk which already completed. */
+      break;
     }
+    ml_min_index = min_ii(ml_min_index, mlfan_vert_index);
+  }
 
-    /* ... we can skip it in future, and keep checking the smooth fan. */
-    BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+  if (ml_start_index != -1) {
+    atomic_fetch_and_or_char(&loop_fan_flags[ml_start_index], LOOP_SPLIT_FAN_FAN);
   }
+
+  /* Only tag the loops once the outcome is known, another walk stopping at them relies on it.
+   * A walk which doesn't complete (with invalid geometry) is not reused either. */
+  if (is_complete || steps < common_data->numLoops) {
+    e2lfan_curr = e2l_prev;
+    mlfan_curr = ml_prev;
+    mlfan_curr_index = ml_prev_index;
+    mlfan_vert_index = ml_curr_index;
+    mpfan_curr_index = mp_curr_index;
+    for (int step = 0; step < steps; step++) {
+      atomic_fetch_and_or_char(&loop_fan_flags[mlfan_vert_index], LOOP_SPLIT_FAN_WALKED);
+      BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
+                                                  mpolys,
+                                                  loop_to_poly,
+                                                  e2lfan_curr,
+                                                  mv_pivot_index,
+                                                  &mlfan_curr,
+                                                  &mlfan_curr_index,
+                                                  &mlfan_vert_index,
+                                                  &mpfan_curr_index);
+      e2lfan_curr = edge_to_loops[mlfan_curr->e];
+    }
+  }
+
+  return ml_start_index;
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
+static void loop_split_generator_polys_cb(void *__restrict userdata,
+                                          const int mp_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
-  float(*loopnors)[3] = common_data->loopnors;
-
+  LoopSplitGeneratorData *data = userdata;
+  LoopSplitTaskDataCommon *common_data = data->common_data;
   const MLoop *mloops = common_data->mloops;
   const MPoly *mpolys = common_data->mpolys;
-  const int *loop_to_poly = common_data->loop_to_poly;
   const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+
+  const MPoly *mp = &mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_prev_index = ml_last_index;
+
+  for (int ml_curr_index = mp->loopstart; ml_curr_index <= ml_last_index; ml_curr_index++) {
+    const MLoop *ml_curr = &mloops[ml_curr_index];
+    const MLoop *ml_prev = &mloops[ml_prev_index];
+    const int *e2l_curr = edge_to_loops[ml_curr->e];
+    const int *e2l_prev = edge_to_loops[ml_prev->e];
+
+    /* We *do not need* to check/tag loops as already computed!
+     * Due to the fact a loop only links to one of its two edges,
+     * a same fan *will never be walked more than once!*
+     * Since we consider edges having neighbor polys with inverted
+     * (flipped) normals as sharp, we are sure that no fan will be skipped,
+     * even only considering the case (sharp curr_edge, smooth prev_edge),
+     * and not the alternative (smooth curr_edge, sharp prev_edge).
+     * All this due/thanks to link between normals and loop ordering (i.e. winding).
+     *
+     * A smooth edge, we have to check for cyclic smooth fan case,
+     * unless the fan of this loop was walked already. */
+    if (IS_EDGE_SHARP(e2l_curr)) {
+      atomic_fetch_and_or_char(&data->loop_fan_flags[ml_curr_index],
+                               IS_EDGE_SHARP(e2l_prev) ? LOOP_SPLIT_FAN_SINGLE :
+                                                         LOOP_SPLIT_FAN_FAN);
+    }
+    else if (!IS_EDGE_SHARP(e2l_prev) &&
+             !(data->loop_fan_flags[ml_curr_index] & LOOP_SPLIT_FAN_WALKED)) {
+      loop_split_generator_cyclic_smooth_fan_walk(
+          data, e2l_prev, ml_curr, ml_prev, ml_curr_index, ml_prev_index, mp_index);
+    }
+
+    ml_prev_index = ml_curr_index;
+  }
+}
+
+/**
+ * Find all single loops and smooth fans, which only depends on the topology and sharp edges.
+ * Looking for fans is done in parallel, after which they are gathered in order of their first
+ * loop, so that the result does not depend on threading.
+ */
+static LoopSplitFan *loop_split_generator(LoopSplitTaskDataCommon *common_data, int *r_fans_len)
+{
+  const MPoly *mpolys = common_data->mpolys;
   const int numLoops = common_data->numLoops;
   const int numPolys = common_data->numPolys;
 
-  const MPoly *mp;
-  int mp_index;
+#ifdef DEBUG_TIME
+  TIMEIT_START_AVERAGED(loop_split_generator);
+#endif
 
-  const MLoop *ml_curr;
-  const MLoop *ml_prev;
-  int ml_curr_index;
-  int ml_prev_index;
+  LoopSplitGeneratorData data = {
+      .common_data = common_data,
+      .loop_fan_flags = MEM_calloc_arrayN((size_t)numLoops, sizeof(char), __func__),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, numPolys, &data, loop_split_generator_polys_cb, &settings);
 
-  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
+  int fans_len = 0;
+  for (int ml_index = 0; ml_index < numLoops; ml_index++) {
+    fans_len += (data.loop_fan_flags[ml_index] &
+                 (LOOP_SPLIT_FAN_SINGLE | LOOP_SPLIT_FAN_FAN)) != 0;
+  }
 
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
+  LoopSplitFan *fans = MEM_malloc_arrayN((size_t)max_ii(fans_len, 1), sizeof(*fans), __func__);
+  int fan_index = 0;
+  for (int mp_index = 0; mp_index < numPolys; mp_index++) {
+    const MPoly *mp = &mpolys[mp_index];
+    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+    int ml_prev_index = ml_last_index;
+    for (int ml_curr_index = mp->loopstart; ml_curr_index <= ml_last_index; ml_curr_index++) {
+      const char fan_flag = data.loop_fan_flags[ml_curr_index];
+      if (fan_flag & (LOOP_SPLIT_FAN_SINGLE | LOOP_SPLIT_FAN_FAN)) {
+        LoopSplitFan *fan = &fans[fan_index++];
+        fan->ml_curr_index = ml_curr_index;
+        fan->ml_prev_index = ml_prev_index;
+        fan->mp_index = mp_index;
+        fan->is_single = (fan_flag & LOOP_SPLIT_FAN_SINGLE) != 0;
+      }
+      ml_prev_index = ml_curr_index;
+    }
+  }
+  BLI_assert(fan_index == fans_len);
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
+  MEM_freeN(data.loop_fan_flags);
 
 #ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_generator);
+  TIMEIT_END_AVERAGED(loop_split_generator);
 #endif
 
-  if (!pool) {
-    if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+  *r_fans_len = fans_len;
+  return fans;
+}
+
+typedef struct LoopSplitFansData {
+  LoopSplitTaskDataCommon *common_data;
+  const LoopSplitFan *fans;
+  /** Lnor spaces of all fans, when they are requested. */
+  MLoopNorSpace *lnor_spaces;
+} LoopSplitFansData;
+
+typedef struct LoopSplitFansTLS {
+  /** Temp edge vectors stack, only used when computing lnor spacearr. */
+  BLI_Stack *edge_vectors;
+} LoopSplitFansTLS;
+
+static void loop_split_fans_cb(void *__restrict userdata,
+                               const int fan_index,
+                               const TaskParallelTLS *__restrict tls)
+{
+  LoopSplitFansData *data = userdata;
+  LoopSplitTaskDataCommon *common_data = data->common_data;
+  LoopSplitFansTLS *tls_data = tls->userdata_chunk;
+  const LoopSplitFan *fan = &data->fans[fan_index];
+
+  LoopSplitTaskData task_data = {NULL};
+  task_data.ml_curr = &common_data->mloops[fan->ml_curr_index];
+  task_data.ml_prev = &common_data->mloops[fan->ml_prev_index];
+  task_data.ml_curr_index = fan->ml_curr_index;
+  task_data.ml_prev_index = fan->ml_prev_index;
+  task_data.mp_index = fan->mp_index;
+  if (fan->is_single) {
+    task_data.lnor = &common_data->loopnors[fan->ml_curr_index];
+  }
+  else {
+    /* Also tag as 'fan' task. */
+    task_data.e2l_prev = common_data->edge_to_loops[task_data.ml_prev->e];
+    if (common_data->lnors_spacearr && tls_data->edge_vectors == NULL) {
+      tls_data->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
     }
   }
+  if (data->lnor_spaces) {
+    task_data.lnor_space = &data->lnor_spaces[fan_index];
+  }
 
-  /* We now know edges that can be smoothed (with their vector, and their two loops),
-   * and edges that will be hard! Now, time to generate the normals.
-   */
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    float(*lnors)[3];
-    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
-    ml_curr_index = mp->loopstart;
-    ml_prev_index = ml_last_index;
+  loop_split_worker_do(common_data, &task_data, tls_data->edge_vectors);
+}
 
-    ml_curr = &mloops[ml_curr_index];
-    ml_prev = &mloops[ml_prev_index];
-    lnors = &loopnors[ml_curr_index];
+static void loop_split_fans_free(const void *__restrict UNUSED(userdata),
+                                 void *__restrict chunk)
+{
+  LoopSplitFansTLS *tls_data = chunk;
+  if (tls_data->edge_vectors) {
+    BLI_stack_free(tls_data->edge_vectors);
+  }
+}
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++, lnors++) {
-      const int *e2l_curr = edge_to_loops[ml_curr->e];
-      const int *e2l_prev = edge_to_loops[ml_prev->e];
+/* -------------------------------------------------------------------- */
+/** \name Loop Fans Cache
+ *
+ * Which loops belong to which smooth fan only depends on the topology and on the sharp edges,
+ * as long as sharpness does not depend on the angle between faces (e.g. with custom normals).
+ * Meshes which are only deformed can then reuse the fans, and only their normals and lnor spaces
+ * are computed again.
+ *
+ * The cache is shared between copies of a mesh, which reference the loops, polys and edges of
+ * the original unless they change them. Fans are only reused for the same arrays (and sizes) they
+ * were computed from, code editing these arrays in place must release the cache of the mesh.
+ * \{ */
 
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
-#endif
+typedef struct MLoopFanTopology {
+  int (*edge_to_loops)[2];
+  int *loop_to_poly;
+  LoopSplitFan *fans;
+  int fans_len;
 
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
-       * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
-      }
-      else {
-        LoopSplitTaskData *data, data_local;
+  int numEdges;
+  int numLoops;
+  int numPolys;
 
-        //              printf("PROCESSING!\n");
+  /* The arrays the fans were computed from, only compared with the ones of a mesh. */
+  const MEdge *medges;
+  const MLoop *mloops;
+  const MPoly *mpolys;
+} MLoopFanTopology;
 
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
-          }
-          data = &data_buff[data_idx];
-        }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
-        }
+typedef struct MLoopFanCache {
+  int users;
+  /** Written once, replaced by a new cache when the topology of a user changes. */
+  MLoopFanTopology *topology;
+} MLoopFanCache;
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
-#endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
+static bool loop_fan_topology_matches(const MLoopFanTopology *topology,
+                                      const MEdge *medges,
+                                      const int numEdges,
+                                      const MLoop *mloops,
+                                      const int numLoops,
+                                      const MPoly *mpolys,
+                                      const int numPolys)
+{
+  return topology->medges == medges && topology->mloops == mloops &&
+         topology->mpolys == mpolys && topology->numEdges == numEdges &&
+         topology->numLoops == numLoops && topology->numPolys == numPolys;
+}
 
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
-        }
-      }
+static void loop_fan_topology_free(MLoopFanTopology *topology)
+{
+  MEM_freeN(topology->edge_to_loops);
+  MEM_freeN(topology->loop_to_poly);
+  MEM_freeN(topology->fans);
+  MEM_freeN(topology);
+}
 
-      ml_prev = ml_curr;
-      ml_prev_index = ml_curr_index;
+static MLoopFanCache *loop_fan_cache_new(void)
+{
+  MLoopFanCache *cache = MEM_callocN(sizeof(*cache), __func__);
+  cache->users = 1;
+  return cache;
+}
+
+/**
+ * Get a reference to the cache of \a mesh_src for a copy of it, creating an empty one if needed.
+ */
+MLoopFanCache *BKE_mesh_loop_fan_cache_share(Mesh *mesh_src)
+{
+  MLoopFanCache *cache = mesh_src->runtime.loop_fan_cache;
+  if (cache == NULL) {
+    /* The same mesh might be copied by multiple threads at once. */
+    MLoopFanCache *new_cache = loop_fan_cache_new();
+    cache = atomic_cas_ptr((void **)&mesh_src->runtime.loop_fan_cache, NULL, new_cache);
+    if (cache == NULL) {
+      cache = new_cache;
+    }
+    else {
+      MEM_freeN(new_cache);
     }
   }
+  atomic_add_and_fetch_int32(&cache->users, 1);
+  return cache;
+}
 
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
+/**
+ * Also used to invalidate the cached fans of a mesh, when its loops, polys or edges are edited
+ * in place.
+ */
+void BKE_mesh_loop_fan_cache_release(MLoopFanCache **fan_cache)
+{
+  MLoopFanCache *cache = *fan_cache;
+  if (cache == NULL) {
+    return;
   }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
+  *fan_cache = NULL;
+  if (atomic_sub_and_fetch_int32(&cache->users, 1) != 0) {
+    return;
+  }
+  if (cache->topology) {
+    loop_fan_topology_free(cache->topology);
   }
-  MEM_freeN(skip_loops);
+  MEM_freeN(cache);
+}
 
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_generator);
-#endif
+/* Store given topology in the cache, taking ownership of it. */
+static void loop_fan_cache_store(MLoopFanCache **fan_cache, MLoopFanTopology *topology)
+{
+  MLoopFanCache *cache = *fan_cache;
+  if (cache != NULL &&
+      atomic_cas_ptr((void **)&cache->topology, NULL, topology) == NULL) {
+    return;
+  }
+  /* Topology of this mesh differs from the other users of the cache. */
+  BKE_mesh_loop_fan_cache_release(fan_cache);
+  cache = loop_fan_cache_new();
+  cache->topology = topology;
+  *fan_cache = cache;
 }
 
+/** \} */
+
 /**
  * Compute split normals, i.e. vertex normals associated with each poly (hence 'loop normals').
  * Useful to materialize sharp edges (or non-smooth faces) without actually modifying the geometry
  * (splitting edges).
+ *
+ * \param fan_cache: Optional cache of the smooth fans, see #BKE_mesh_loop_fan_cache_share.
  */
-void BKE_mesh_normals_loop_split(const MVert *mverts,
-                                 const int UNUSED(numVerts),
-                                 MEdge *medges,
-                                 const int numEdges,
-                                 MLoop *mloops,
-                                 float (*r_loopnors)[3],
-                                 const int numLoops,
-                                 MPoly *mpolys,
-                                 const float (*polynors)[3],
-                                 const int numPolys,
-                                 const bool use_split_normals,
-                                 const float split_angle,
-                                 MLoopNorSpaceArray *r_lnors_spacearr,
-                                 short (*clnors_data)[2],
-                                 int *r_loop_to_poly)
+void BKE_mesh_normals_loop_split_ex(const MVert *mverts,
+                                    const int UNUSED(numVerts),
+                                    MEdge *medges,
+                                    const int numEdges,
+                                    MLoop *mloops,
+                                    float (*r_loopnors)[3],
+                                    const int numLoops,
+                                    MPoly *mpolys,
+                                    const float (*polynors)[3],
+                                    const int numPolys,
+                                    const bool use_split_normals,
+                                    const float split_angle,
+                                    MLoopNorSpaceArray *r_lnors_spacearr,
+                                    short (*clnors_data)[2],
+                                    int *r_loop_to_poly,
+                                    MLoopFanCache **fan_cache)
 {
   /* For now this is not supported.
    * If we do not use split normals, we do not generate anything fancy! */
@@ -1651,27 +1808,6 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
     return;
   }
 
-  /**
-   * Mapping edge -> loops.
-   * If that edge is used by more than two loops (polys),
-   * it is always sharp (and tagged as such, see below).
-   * We also use the second loop index as a kind of flag:
-   *
-   * - smooth edge: > 0.
-   * - sharp edge: < 0 (INDEX_INVALID || INDEX_UNSET).
-   * - unset: INDEX_UNSET.
-   *
-   * Note that currently we only have two values for second loop of sharp edges.
-   * However, if needed, we can store the negated value of loop index instead of INDEX_INVALID
-   * to retrieve the real value later in code).
-   * Note also that loose edges always have both values set to 0! */
-  int(*edge_to_loops)[2] = MEM_calloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
-
-  /* Simple mapping from a loop to its polygon index. */
-  int *loop_to_poly = r_loop_to_poly ?
-                          r_loop_to_poly :
-                          MEM_malloc_arrayN((size_t)numLoops, sizeof(*loop_to_poly), __func__);
-
   /* When using custom loop normals, disable the angle feature! */
   const bool check_angle = (split_angle < (float)M_PI) && (clnors_data == NULL);
 
@@ -1689,6 +1825,22 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
     BKE_lnor_spacearr_init(r_lnors_spacearr, numLoops, MLNOR_SPACEARR_LOOP_INDEX);
   }
 
+  /* Fans only depend on the topology when sharp edges do not depend on the geometry. */
+  const bool use_fan_cache = (fan_cache != NULL) && !check_angle;
+  MLoopFanTopology *topology = NULL;
+  if (use_fan_cache) {
+    MLoopFanTopology *cached_topology = (*fan_cache) ? (*fan_cache)->topology : NULL;
+    if (cached_topology && loop_fan_topology_matches(cached_topology,
+                                                     medges,
+                                                     numEdges,
+                                                     mloops,
+                                                     numLoops,
+                                                     mpolys,
+                                                     numPolys)) {
+      topology = cached_topology;
+    }
+  }
+
   /* Init data common to all tasks. */
   LoopSplitTaskDataCommon common_data = {
       .lnors_spacearr = r_lnors_spacearr,
@@ -1698,34 +1850,105 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
       .medges = medges,
       .mloops = mloops,
       .mpolys = mpolys,
-      .edge_to_loops = edge_to_loops,
-      .loop_to_poly = loop_to_poly,
       .polynors = polynors,
       .numEdges = numEdges,
       .numLoops = numLoops,
       .numPolys = numPolys,
   };
 
-  /* This first loop check which edges are actually smooth, and compute edge vectors. */
-  mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
+  LoopSplitFan *fans;
+  int fans_len;
+  if (topology) {
+    common_data.edge_to_loops = topology->edge_to_loops;
+    common_data.loop_to_poly = topology->loop_to_poly;
+    fans = topology->fans;
+    fans_len = topology->fans_len;
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
+    /* Pre-populate all loop normals as if their verts were all-smooth. */
+    for (int ml_index = 0; ml_index < numLoops; ml_index++) {
+      normal_short_to_float_v3(r_loopnors[ml_index], mverts[mloops[ml_index].v].no);
+    }
   }
   else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
+    /**
+     * Mapping edge -> loops.
+     * If that edge is used by more than two loops (polys),
+     * it is always sharp (and tagged as such, see below).
+     * We also use the second loop index as a kind of flag:
+     *
+     * - smooth edge: > 0.
+     * - sharp edge: < 0 (INDEX_INVALID || INDEX_UNSET).
+     * - unset: INDEX_UNSET.
+     *
+     * Note that currently we only have two values for second loop of sharp edges.
+     * However, if needed, we can store the negated value of loop index instead of INDEX_INVALID
+     * to retrieve the real value later in code).
+     * Note also that loose edges always have both values set to 0! */
+    common_data.edge_to_loops = MEM_calloc_arrayN(
+        (size_t)numEdges, sizeof(*common_data.edge_to_loops), __func__);
 
-    loop_split_generator(task_pool, &common_data);
+    /* Simple mapping from a loop to its polygon index. */
+    common_data.loop_to_poly = (r_loop_to_poly && !use_fan_cache) ?
+                                   r_loop_to_poly :
+                                   MEM_malloc_arrayN((size_t)numLoops, sizeof(int), __func__);
 
-    BLI_task_pool_work_and_wait(task_pool);
+    /* This first loop check which edges are actually smooth, and compute edge vectors. */
+    mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
 
-    BLI_task_pool_free(task_pool);
+    fans = loop_split_generator(&common_data, &fans_len);
   }
 
-  MEM_freeN(edge_to_loops);
-  if (!r_loop_to_poly) {
-    MEM_freeN(loop_to_poly);
+  if (r_loop_to_poly && r_loop_to_poly != common_data.loop_to_poly) {
+    memcpy(r_loop_to_poly, common_data.loop_to_poly, sizeof(int) * (size_t)numLoops);
+  }
+
+  /* We now know edges that can be smoothed (with their vector, and their two loops),
+   * and edges that will be hard! Now, time to generate the normals.
+   */
+  LoopSplitFansData fans_data = {
+      .common_data = &common_data,
+      .fans = fans,
+      .lnor_spaces = NULL,
+  };
+  if (r_lnors_spacearr) {
+    /* Memarena is not thread-safe, so allocate the spaces of all fans at once. */
+    fans_data.lnor_spaces = BLI_memarena_calloc(
+        r_lnors_spacearr->mem, sizeof(MLoopNorSpace) * (size_t)max_ii(fans_len, 1));
+    r_lnors_spacearr->num_spaces += fans_len;
+  }
+
+  LoopSplitFansTLS tls_data = {NULL};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE;
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = loop_split_fans_free;
+  BLI_task_parallel_range(0, fans_len, &fans_data, loop_split_fans_cb, &settings);
+
+  if (topology == NULL) {
+    if (use_fan_cache) {
+      topology = MEM_mallocN(sizeof(*topology), __func__);
+      topology->edge_to_loops = common_data.edge_to_loops;
+      topology->loop_to_poly = common_data.loop_to_poly;
+      topology->fans = fans;
+      topology->fans_len = fans_len;
+      topology->numEdges = numEdges;
+      topology->numLoops = numLoops;
+      topology->numPolys = numPolys;
+      topology->medges = medges;
+      topology->mloops = mloops;
+      topology->mpolys = mpolys;
+      loop_fan_cache_store(fan_cache, topology);
+    }
+    else {
+      MEM_freeN(common_data.edge_to_loops);
+      if (common_data.loop_to_poly != r_loop_to_poly) {
+        MEM_freeN(common_data.loop_to_poly);
+      }
+      MEM_freeN(fans);
+    }
   }
 
   if (r_lnors_spacearr) {
@@ -1739,6 +1962,40 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
 #endif
 }
 
+void BKE_mesh_normals_loop_split(const MVert *mverts,
+                                 const int numVerts,
+                                 MEdge *medges,
+                                 const int numEdges,
+                                 MLoop *mloops,
+                                 float (*r_loopnors)[3],
+                                 const int numLoops,
+                                 MPoly *mpolys,
+                                 const float (*polynors)[3],
+                                 const int numPolys,
+                                 const bool use_split_normals,
+                                 const float split_angle,
+                                 MLoopNorSpaceArray *r_lnors_spacearr,
+                                 short (*clnors_data)[2],
+                                 int *r_loop_to_poly)
+{
+  BKE_mesh_normals_loop_split_ex(mverts,
+                                 numVerts,
+                                 medges,
+                                 numEdges,
+                                 mloops,
+                                 r_loopnors,
+                                 numLoops,
+                                 mpolys,
+                                 polynors,
+                                 numPolys,
+                                 use_split_normals,
+                                 split_angle,
+                                 r_lnors_spacearr,
+                                 clnors_data,
+                                 r_loop_to_poly,
+                                 NULL);
+}
+
 #undef INDEX_UNSET
 #undef INDEX_INVALID
 #undef IS_EDGE_SHARP
@@ -2047,6 +2304,9 @@ static void mesh_set_custom_normals(Mesh *mesh, float (*r_custom_nors)[3], const
   short(*clnors)[2];
   const int numloops = mesh->totloop;
 
+  /* Edges get tagged sharp while setting the custom normals. */
+  BKE_mesh_loop_fan_cache_release(&mesh->runtime.loop_fan_cache);
+
   clnors = CustomData_get_layer(&mesh->ldata, CD_CUSTOMLOOPNORMAL);
   if (clnors != NULL) {
     memset(clnors, 0, sizeof(*clnors) * (size_t)numloops);
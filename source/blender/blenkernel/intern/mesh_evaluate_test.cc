@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_linklist.h"
+#include "BLI_math.h"
+#include "BLI_task.h"
+
+#include "BKE_mesh.h"
+
+namespace blender::bke::tests {
+
+/* A torus of quads: all vertices away from sharp edges and flat faces have cyclic smooth fans. */
+struct TorusMesh {
+  int u_len, v_len;
+  Array<MVert> verts;
+  Array<MEdge> edges;
+  Array<MLoop> loops;
+  Array<MPoly> polys;
+  Array<float3> poly_normals;
+
+  TorusMesh(const int u_len, const int v_len)
+      : u_len(u_len),
+        v_len(v_len),
+        verts(u_len * v_len),
+        edges(u_len * v_len * 2),
+        loops(u_len * v_len * 4),
+        polys(u_len * v_len),
+        poly_normals(u_len * v_len)
+  {
+    for (int u = 0; u < u_len; u++) {
+      for (int v = 0; v < v_len; v++) {
+        const int i = vert_index(u, v);
+        edges[i * 2] = {};
+        edges[i * 2].v1 = i;
+        edges[i * 2].v2 = vert_index(u + 1, v);
+        edges[i * 2 + 1] = {};
+        edges[i * 2 + 1].v1 = i;
+        edges[i * 2 + 1].v2 = vert_index(u, v + 1);
+        /* A ring of sharp edges. */
+        if (u == 0) {
+          edges[i * 2 + 1].flag |= ME_SHARP;
+        }
+
+        MPoly &mp = polys[i];
+        mp = {};
+        mp.loopstart = i * 4;
+        mp.totloop = 4;
+        /* A ring of flat faces. */
+        mp.flag = (u == u_len / 2) ? 0 : ME_SMOOTH;
+
+        MLoop *ml = &loops[i * 4];
+        ml[0] = {(uint)i, (uint)(i * 2)};
+        ml[1] = {(uint)vert_index(u + 1, v), (uint)(vert_index(u + 1, v) * 2 + 1)};
+        ml[2] = {(uint)vert_index(u + 1, v + 1), (uint)(vert_index(u, v + 1) * 2)};
+        ml[3] = {(uint)vert_index(u, v + 1), (uint)(i * 2 + 1)};
+      }
+    }
+    deform(0.0f);
+  }
+
+  int vert_index(const int u, const int v) const
+  {
+    return (u % u_len) * v_len + (v % v_len);
+  }
+
+  /* Split the fan of a vertex with two sharp edges along u. */
+  void sharp_edges_add(const int u, const int v)
+  {
+    edges[vert_index(u, v) * 2].flag |= ME_SHARP;
+    edges[vert_index(u + 1, v) * 2].flag |= ME_SHARP;
+  }
+
+  /* Move the vertices without changing the topology. */
+  void deform(const float offset)
+  {
+    for (int u = 0; u < u_len; u++) {
+      for (int v = 0; v < v_len; v++) {
+        const float a = (float)u / u_len * (float)M_PI * 2.0f;
+        const float b = (float)v / v_len * (float)M_PI * 2.0f;
+        const float r = 0.5f + 0.1f * sinf(a * 3.0f + offset);
+        MVert &mv = verts[vert_index(u, v)];
+        mv = {};
+        mv.co[0] = (2.0f + r * cosf(b)) * cosf(a);
+        mv.co[1] = (2.0f + r * cosf(b)) * sinf(a);
+        mv.co[2] = r * sinf(b) + offset * 0.1f * cosf(a);
+      }
+    }
+    BKE_mesh_calc_normals_poly(verts.data(),
+                               nullptr,
+                               verts.size(),
+                               loops.data(),
+                               polys.data(),
+                               loops.size(),
+                               polys.size(),
+                               (float(*)[3])poly_normals.data(),
+                               false);
+  }
+
+  Array<float3> loop_normals(MLoopFanCache **fan_cache,
+                             MLoopNorSpaceArray *r_lnors_spacearr = nullptr)
+  {
+    Array<float3> normals(loops.size());
+    BKE_mesh_normals_loop_split_ex(verts.data(),
+                                   verts.size(),
+                                   edges.data(),
+                                   edges.size(),
+                                   loops.data(),
+                                   (float(*)[3])normals.data(),
+                                   loops.size(),
+                                   polys.data(),
+                                   (const float(*)[3])poly_normals.data(),
+                                   polys.size(),
+                                   true,
+                                   (float)M_PI,
+                                   r_lnors_spacearr,
+                                   nullptr,
+                                   nullptr,
+                                   fan_cache);
+    return normals;
+  }
+};
+
+static void expect_normals_eq(const Array<float3> &a, const Array<float3> &b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (const int i : a.index_range()) {
+    EXPECT_V3_NEAR(a[i], b[i], 1e-6f);
+  }
+}
+
+/* Split normals computed from cached fans must match the ones computed without a cache. */
+TEST(mesh_evaluate, NormalsLoopSplitFanCache)
+{
+  BLI_task_scheduler_init();
+
+  /* Enough loops for the fans to be found by multiple threads. */
+  TorusMesh mesh(128, 96);
+  MLoopFanCache *fan_cache = nullptr;
+
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+  expect_normals_eq(mesh.loop_normals(&fan_cache, &lnors_spacearr), mesh.loop_normals(nullptr));
+  EXPECT_NE(fan_cache, nullptr);
+
+  /* Away from sharp edges and flat faces, all loops of a vertex are in one cyclic smooth fan. */
+  int cyclic_fans_num = 0;
+  for (const int i : mesh.loops.index_range()) {
+    const int u = (int)mesh.loops[i].v / mesh.v_len;
+    ASSERT_NE(lnors_spacearr.lspacearr[i], nullptr);
+    if (u > 1 && u < mesh.u_len / 2 - 1) {
+      EXPECT_EQ(BLI_linklist_count(lnors_spacearr.lspacearr[i]->loops), 4);
+      cyclic_fans_num += (lnors_spacearr.lspacearr[i]->loops->link == POINTER_FROM_INT(i));
+    }
+  }
+  EXPECT_EQ(cyclic_fans_num, (mesh.u_len / 2 - 3) * mesh.v_len);
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+
+  /* Deformation reuses the cached fans. */
+  mesh.deform(1.0f);
+  expect_normals_eq(mesh.loop_normals(&fan_cache), mesh.loop_normals(nullptr));
+
+  /* Other arrays don't reuse the cached fans, even with the same sizes. */
+  TorusMesh mesh_other(128, 96);
+  mesh_other.sharp_edges_add(40, 20);
+  expect_normals_eq(mesh_other.loop_normals(&fan_cache), mesh_other.loop_normals(nullptr));
+
+  /* Changing sharp edges or smooth flags in place requires releasing the cached fans. */
+  mesh.sharp_edges_add(40, 20);
+  BKE_mesh_loop_fan_cache_release(&fan_cache);
+  expect_normals_eq(mesh.loop_normals(&fan_cache), mesh.loop_normals(nullptr));
+  mesh.polys[mesh.vert_index(80, 10)].flag &= ~ME_SMOOTH;
+  BKE_mesh_loop_fan_cache_release(&fan_cache);
+  mesh.deform(2.0f);
+  expect_normals_eq(mesh.loop_normals(&fan_cache), mesh.loop_normals(nullptr));
+
+  BKE_mesh_loop_fan_cache_release(&fan_cache);
+  EXPECT_EQ(fan_cache, nullptr);
+
+  BLI_task_scheduler_exit();
+}
+
+}  // namespace blender::bke::tests
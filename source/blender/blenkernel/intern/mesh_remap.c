@@ -115,6 +115,54 @@ static bool mesh_remap_bvhtree_query_raycast(BVHTreeFromMesh *treedata,
   return false;
 }
 
+/**
+ * Batched version of #mesh_remap_bvhtree_query_nearest, querying all \a verts_dst at once.
+ *
+ * \param r_vcos_dst: The coordinates of \a verts_dst in tree space.
+ * \return An array of \a numverts_dst items, with an index of -1 when no source was found within
+ * \a max_dist_sq.
+ */
+static BVHTreeNearest *mesh_remap_bvhtree_query_nearest_verts(
+    BVHTreeFromMesh *treedata,
+    const SpaceTransform *space_transform,
+    const MVert *verts_dst,
+    const int numverts_dst,
+    const float max_dist_sq,
+    float (**r_vcos_dst)[3])
+{
+  float(*vcos_dst)[3] = MEM_mallocN(sizeof(*vcos_dst) * (size_t)numverts_dst, __func__);
+  BVHTreeNearest *nearest = MEM_mallocN(sizeof(*nearest) * (size_t)numverts_dst, __func__);
+
+  for (int i = 0; i < numverts_dst; i++) {
+    copy_v3_v3(vcos_dst[i], verts_dst[i].co);
+
+    /* Convert the vertex to tree coordinates, if needed. */
+    if (space_transform) {
+      BLI_space_transform_apply(space_transform, vcos_dst[i]);
+    }
+
+    nearest[i].index = -1;
+    nearest[i].dist_sq = max_dist_sq;
+  }
+
+  BLI_bvhtree_find_nearest_batch(treedata->tree,
+                                 (const float(*)[3])vcos_dst,
+                                 numverts_dst,
+                                 nearest,
+                                 treedata->nearest_callback,
+                                 treedata,
+                                 0);
+
+  for (int i = 0; i < numverts_dst; i++) {
+    if (nearest[i].dist_sq > max_dist_sq) {
+      nearest[i].index = -1;
+    }
+  }
+
+  *r_vcos_dst = vcos_dst;
+  return nearest;
+}
+
 /** \} */
 
 /**
@@ -139,27 +187,20 @@ float BKE_mesh_remap_calc_difference_from_mesh(const SpaceTransform *space_trans
                                                Mesh *me_src)
 {
   BVHTreeFromMesh treedata = {NULL};
-  BVHTreeNearest nearest = {0};
-  float hit_dist;
+  BVHTreeNearest *nearest;
+  float(*vcos_dst)[3];
 
   float result = 0.0f;
   int i;
 
   BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
-  nearest.index = -1;
 
-  for (i = 0; i < numverts_dst; i++) {
-    float tmp_co[3];
-
-    copy_v3_v3(tmp_co, verts_dst[i].co);
+  nearest = mesh_remap_bvhtree_query_nearest_verts(
+      &treedata, space_transform, verts_dst, numverts_dst, FLT_MAX, &vcos_dst);
 
-    /* Convert the vertex to tree coordinates, if needed. */
-    if (space_transform) {
-      BLI_space_transform_apply(space_transform, tmp_co);
-    }
-
-    if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, FLT_MAX, &hit_dist)) {
-      result += 1.0f / (hit_dist + 1.0f);
+  for (i = 0; i < numverts_dst; i++) {
+    if (nearest[i].index != -1) {
+      result += 1.0f / (sqrtf(nearest[i].dist_sq) + 1.0f);
     }
     else {
       /* No source for this dest vertex! */
@@ -167,6 +208,9 @@ float BKE_mesh_remap_calc_difference_from_mesh(const SpaceTransform *space_trans
     }
   }
 
+  MEM_freeN(nearest);
+  MEM_freeN(vcos_dst);
+
   result = ((float)numverts_dst / result) - 1.0f;
 
 #if 0
@@ -523,57 +567,58 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
   }
   else {
     BVHTreeFromMesh treedata = {NULL};
-    BVHTreeNearest nearest = {0};
     BVHTreeRayHit rayhit = {0};
     float hit_dist;
     float tmp_co[3], tmp_no[3];
 
     if (mode == MREMAP_MODE_VERT_NEAREST) {
-      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
-      nearest.index = -1;
+      BVHTreeNearest *nearest_dst;
+      float(*vcos_dst)[3];
 
-      for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, verts_dst[i].co);
+      BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+      nearest_dst = mesh_remap_bvhtree_query_nearest_verts(
+          &treedata, space_transform, verts_dst, numverts_dst, max_dist_sq, &vcos_dst);
 
-        if (mesh_remap_bvhtree_query_nearest(
-                &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest.index, &full_weight);
+      for (i = 0; i < numverts_dst; i++) {
+        if (nearest_dst[i].index != -1) {
+          hit_dist = sqrtf(nearest_dst[i].dist_sq);
+          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest_dst[i].index, &full_weight);
         }
         else {
           /* No source for this dest vertex! */
           BKE_mesh_remap_item_define_invalid(r_map, i);
         }
       }
+
+      MEM_freeN(nearest_dst);
+      MEM_freeN(vcos_dst);
     }
     else if (ELEM(mode, MREMAP_MODE_VERT_EDGE_NEAREST, MREMAP_MODE_VERT_EDGEINTERP_NEAREST)) {
       MEdge *edges_src = me_src->medge;
       float(*vcos_src)[3] = BKE_mesh_vert_coords_alloc(me_src, NULL);
 
+      BVHTreeNearest *nearest_dst;
+      float(*vcos_dst)[3];
+
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
-      nearest.index = -1;
 
-      for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, verts_dst[i].co);
+      nearest_dst = mesh_remap_bvhtree_query_nearest_verts(
+          &treedata, space_transform, verts_dst, numverts_dst, max_dist_sq, &vcos_dst);
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+      for (i = 0; i < numverts_dst; i++) {
+        const float *tmp_co_dst = vcos_dst[i];
 
-        if (mesh_remap_bvhtree_query_nearest(
-                &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-          MEdge *me = &edges_src[nearest.index];
+        if (nearest_dst[i].index != -1) {
+          MEdge *me = &edges_src[nearest_dst[i].index];
           const float *v1cos = vcos_src[me->v1];
           const float *v2cos = vcos_src[me->v2];
 
+          hit_dist = sqrtf(nearest_dst[i].dist_sq);
+
           if (mode == MREMAP_MODE_VERT_EDGE_NEAREST) {
-            const float dist_v1 = len_squared_v3v3(tmp_co, v1cos);
-            const float dist_v2 = len_squared_v3v3(tmp_co, v2cos);
+            const float dist_v1 = len_squared_v3v3(tmp_co_dst, v1cos);
+            const float dist_v2 = len_squared_v3v3(tmp_co_dst, v2cos);
             const int index = (int)((dist_v1 > dist_v2) ? me->v2 : me->v1);
             mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &index, &full_weight);
           }
@@ -585,7 +630,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
             indices[1] = (int)me->v2;
 
             /* Weight is inverse of point factor here... */
-            weights[0] = line_point_factor_v3(tmp_co, v2cos, v1cos);
+            weights[0] = line_point_factor_v3(tmp_co_dst, v2cos, v1cos);
             CLAMP(weights[0], 0.0f, 1.0f);
             weights[1] = 1.0f - weights[0];
 
@@ -598,6 +643,8 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
         }
       }
 
+      MEM_freeN(nearest_dst);
+      MEM_freeN(vcos_dst);
       MEM_freeN(vcos_src);
     }
     else if (ELEM(mode,
@@ -651,27 +698,27 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
         }
       }
       else {
-        nearest.index = -1;
+        BVHTreeNearest *nearest_dst;
+        float(*vcos_dst)[3];
 
-        for (i = 0; i < numverts_dst; i++) {
-          copy_v3_v3(tmp_co, verts_dst[i].co);
+        nearest_dst = mesh_remap_bvhtree_query_nearest_verts(
+            &treedata, space_transform, verts_dst, numverts_dst, max_dist_sq, &vcos_dst);
 
-          /* Convert the vertex to tree coordinates, if needed. */
-          if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-          }
+        for (i = 0; i < numverts_dst; i++) {
+          const BVHTreeNearest *nearest = &nearest_dst[i];
 
-          if (mesh_remap_bvhtree_query_nearest(
-                  &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-            const MLoopTri *lt = &treedata.looptri[nearest.index];
+          if (nearest->index != -1) {
+            const MLoopTri *lt = &treedata.looptri[nearest->index];
             MPoly *mp = &polys_src[lt->poly];
 
+            hit_dist = sqrtf(nearest->dist_sq);
+
             if (mode == MREMAP_MODE_VERT_POLY_NEAREST) {
               int index;
               mesh_remap_interp_poly_data_get(mp,
                                               loops_src,
                                               (const float(*)[3])vcos_src,
-                                              nearest.co,
+                                              nearest->co,
                                               &tmp_buff_size,
                                               &vcos,
                                               false,
@@ -686,7 +733,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
               const int sources_num = mesh_remap_interp_poly_data_get(mp,
                                                                       loops_src,
                                                                       (const float(*)[3])vcos_src,
-                                                                      nearest.co,
+                                                                      nearest->co,
                                                                       &tmp_buff_size,
                                                                       &vcos,
                                                                       false,
@@ -703,6 +750,9 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
             BKE_mesh_remap_item_define_invalid(r_map, i);
           }
         }
+
+        MEM_freeN(nearest_dst);
+        MEM_freeN(vcos_dst);
       }
 
       MEM_freeN(vcos_src);
@@ -30,8 +30,11 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_spatial_hash.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_mesh_types.h"
@@ -312,6 +315,240 @@ Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain(Mesh *mesh,
   return new_mesh;
 }
 
+#ifdef WITH_OPENVDB
+
+/* Number of voxels along each side of the blocks meshed in parallel by the tiled remesher. */
+#  define REMESH_TILE_SIZE 128
+
+typedef struct RemeshTilesData {
+  struct OpenVDBLevelSet *level_set;
+  double isovalue;
+  int bounds_min[3];
+  int tiles_len[3];
+  struct OpenVDBVolumeToMeshData *tiles;
+} RemeshTilesData;
+
+static void remesh_tile_bounds(const RemeshTilesData *data,
+                               const int tile_index,
+                               int r_min[3],
+                               int r_max[3])
+{
+  const int tile[3] = {
+      tile_index % data->tiles_len[0],
+      (tile_index / data->tiles_len[0]) % data->tiles_len[1],
+      tile_index / (data->tiles_len[0] * data->tiles_len[1]),
+  };
+  for (int axis = 0; axis < 3; axis++) {
+    r_min[axis] = data->bounds_min[axis] + tile[axis] * REMESH_TILE_SIZE;
+    r_max[axis] = r_min[axis] + REMESH_TILE_SIZE - 1;
+  }
+}
+
+static void remesh_tile_to_mesh_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RemeshTilesData *data = userdata;
+  int clip_min[3], clip_max[3];
+  remesh_tile_bounds(data, i, clip_min, clip_max);
+  OpenVDBLevelSet_volume_to_mesh_clip(
+      data->level_set, &data->tiles[i], clip_min, clip_max, data->isovalue, false);
+}
+
+/**
+ * Join the meshes of all tiles, merging the vertices along the tile boundaries
+ * (each tile generates its own copy of them).
+ */
+static Mesh *remesh_tiles_to_mesh_nomain(const RemeshTilesData *data,
+                                         const int tiles_num,
+                                         const float voxel_size)
+{
+  int verts_num = 0;
+  for (int i = 0; i < tiles_num; i++) {
+    verts_num += data->tiles[i].totvertices;
+  }
+
+  float(*vert_coords)[3] = MEM_malloc_arrayN((size_t)verts_num, sizeof(*vert_coords), __func__);
+  BLI_bitmap *verts_boundary = BLI_BITMAP_NEW(verts_num, __func__);
+  int *vert_merge_map = MEM_malloc_arrayN((size_t)verts_num, sizeof(*vert_merge_map), __func__);
+
+  int vert_offset = 0;
+  for (int i = 0; i < tiles_num; i++) {
+    const struct OpenVDBVolumeToMeshData *tile = &data->tiles[i];
+    int clip_min[3], clip_max[3];
+    remesh_tile_bounds(data, i, clip_min, clip_max);
+
+    for (int j = 0; j < tile->totvertices; j++) {
+      const int v = vert_offset + j;
+      copy_v3_v3(vert_coords[v], &tile->vertices[j * 3]);
+      vert_merge_map[v] = -1;
+
+      /* Only vertices in the voxels next to the tile boundary can be shared. */
+      for (int axis = 0; axis < 3; axis++) {
+        const float co_index = vert_coords[v][axis] / voxel_size;
+        if ((co_index < (float)clip_min[axis] + 1.5f) ||
+            (co_index > (float)clip_max[axis] - 1.5f)) {
+          BLI_BITMAP_ENABLE(verts_boundary, v);
+          break;
+        }
+      }
+    }
+    vert_offset += tile->totvertices;
+  }
+
+  /* Shared vertices are calculated from the same voxels so they match exactly. */
+  BLI_spatial_hash_3d_calc_duplicates((const float(*)[3])vert_coords,
+                                      verts_num,
+                                      verts_boundary,
+                                      voxel_size * 1e-4f,
+                                      vert_merge_map);
+  MEM_freeN(verts_boundary);
+
+  /* Map to the merge target, then only keep used vertices. */
+  BLI_bitmap *verts_used = BLI_BITMAP_NEW(verts_num, __func__);
+  for (int v = 0; v < verts_num; v++) {
+    if (vert_merge_map[v] == -1) {
+      vert_merge_map[v] = v;
+    }
+  }
+
+  int polys_num = 0, loops_num = 0;
+  vert_offset = 0;
+  for (int i = 0; i < tiles_num; i++) {
+    const struct OpenVDBVolumeToMeshData *tile = &data->tiles[i];
+    for (int j = 0; j < tile->totquads; j++) {
+      const uint *quad = &tile->quads[j * 4];
+      for (int k = 0; k < 4; k++) {
+        BLI_BITMAP_ENABLE(verts_used, vert_merge_map[vert_offset + (int)quad[k]]);
+      }
+    }
+    for (int j = 0; j < tile->tottriangles; j++) {
+      const uint *tri = &tile->triangles[j * 3];
+      for (int k = 0; k < 3; k++) {
+        BLI_BITMAP_ENABLE(verts_used, vert_merge_map[vert_offset + (int)tri[k]]);
+      }
+    }
+    polys_num += tile->totquads + tile->tottriangles;
+    loops_num += (tile->totquads * 4) + (tile->tottriangles * 3);
+    vert_offset += tile->totvertices;
+  }
+
+  int *vert_index = MEM_malloc_arrayN((size_t)verts_num, sizeof(*vert_index), __func__);
+  int verts_used_num = 0;
+  for (int v = 0; v < verts_num; v++) {
+    vert_index[v] = BLI_BITMAP_TEST(verts_used, v) ? verts_used_num++ : -1;
+  }
+  MEM_freeN(verts_used);
+
+  Mesh *mesh = BKE_mesh_new_nomain(verts_used_num, 0, 0, loops_num, polys_num);
+
+  for (int v = 0; v < verts_num; v++) {
+    if (vert_index[v] != -1) {
+      copy_v3_v3(mesh->mvert[vert_index[v]].co, vert_coords[v]);
+    }
+  }
+  MEM_freeN(vert_coords);
+
+  MPoly *mp = mesh->mpoly;
+  MLoop *ml = mesh->mloop;
+  vert_offset = 0;
+  for (int i = 0; i < tiles_num; i++) {
+    const struct OpenVDBVolumeToMeshData *tile = &data->tiles[i];
+#  define TILE_VERT_INDEX(v) vert_index[vert_merge_map[vert_offset + (int)(v)]]
+
+    for (int j = 0; j < tile->totquads; j++, mp++, ml += 4) {
+      mp->loopstart = (int)(ml - mesh->mloop);
+      mp->totloop = 4;
+
+      ml[0].v = TILE_VERT_INDEX(tile->quads[j * 4 + 3]);
+      ml[1].v = TILE_VERT_INDEX(tile->quads[j * 4 + 2]);
+      ml[2].v = TILE_VERT_INDEX(tile->quads[j * 4 + 1]);
+      ml[3].v = TILE_VERT_INDEX(tile->quads[j * 4]);
+    }
+
+    for (int j = 0; j < tile->tottriangles; j++, mp++, ml += 3) {
+      mp->loopstart = (int)(ml - mesh->mloop);
+      mp->totloop = 3;
+
+      ml[0].v = TILE_VERT_INDEX(tile->triangles[j * 3 + 2]);
+      ml[1].v = TILE_VERT_INDEX(tile->triangles[j * 3 + 1]);
+      ml[2].v = TILE_VERT_INDEX(tile->triangles[j * 3]);
+    }
+
+#  undef TILE_VERT_INDEX
+    vert_offset += tile->totvertices;
+  }
+
+  MEM_freeN(vert_index);
+  MEM_freeN(vert_merge_map);
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+
+  return mesh;
+}
+
+#endif /* WITH_OPENVDB */
+
+/**
+ * A version of #BKE_mesh_remesh_voxel_to_mesh_nomain which generates the new mesh in blocks of
+ * voxels in parallel, without the copies of the whole output needed to mesh the volume at once.
+ * Adaptivity isn't supported, since the simplified blocks wouldn't match along their boundaries.
+ */
+Mesh *BKE_mesh_remesh_voxel_tiled_to_mesh_nomain(Mesh *mesh, float voxel_size, float isovalue)
+{
+  Mesh *new_mesh = NULL;
+#ifdef WITH_OPENVDB
+  struct OpenVDBTransform *xform = OpenVDBTransform_create();
+  OpenVDBTransform_create_linear_transform(xform, (double)voxel_size);
+  struct OpenVDBLevelSet *level_set = BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(mesh,
+                                                                                        xform);
+
+  RemeshTilesData data = {
+      .level_set = level_set,
+      .isovalue = (double)isovalue,
+  };
+  int bounds_max[3];
+  if (OpenVDBLevelSet_index_bounds(level_set, data.bounds_min, bounds_max)) {
+    int tiles_num = 1;
+    for (int axis = 0; axis < 3; axis++) {
+      const int voxels_len = bounds_max[axis] - data.bounds_min[axis] + 1;
+      data.tiles_len[axis] = (voxels_len + REMESH_TILE_SIZE - 1) / REMESH_TILE_SIZE;
+      tiles_num *= data.tiles_len[axis];
+    }
+    data.tiles = MEM_calloc_arrayN((size_t)tiles_num, sizeof(*data.tiles), __func__);
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0, tiles_num, &data, remesh_tile_to_mesh_cb, &settings);
+
+    /* The volume isn't needed anymore, free it before building the result. */
+    OpenVDBLevelSet_free(level_set);
+    level_set = NULL;
+
+    new_mesh = remesh_tiles_to_mesh_nomain(&data, tiles_num, voxel_size);
+
+    for (int i = 0; i < tiles_num; i++) {
+      MEM_freeN(data.tiles[i].quads);
+      MEM_freeN(data.tiles[i].vertices);
+      if (data.tiles[i].tottriangles > 0) {
+        MEM_freeN(data.tiles[i].triangles);
+      }
+    }
+    MEM_freeN(data.tiles);
+  }
+
+  if (level_set) {
+    OpenVDBLevelSet_free(level_set);
+  }
+  OpenVDBTransform_free(xform);
+#else
+  UNUSED_VARS(mesh, voxel_size, isovalue);
+#endif
+  return new_mesh;
+}
+
 void BKE_mesh_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
 {
   BVHTreeFromMesh bvhtree = {
@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_math.h"
+#include "BLI_task.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_remesh_voxel.h"
+
+#ifdef WITH_OPENVDB
+
+namespace blender::bke::tests {
+
+/* A closed torus of quads. */
+static Mesh *torus_mesh_create(const int u_len, const int v_len)
+{
+  Mesh *mesh = BKE_mesh_new_nomain(u_len * v_len, 0, 0, u_len * v_len * 4, u_len * v_len);
+  auto vert_index = [&](const int u, const int v) { return (u % u_len) * v_len + (v % v_len); };
+
+  for (int u = 0; u < u_len; u++) {
+    for (int v = 0; v < v_len; v++) {
+      const float a = (float)u / u_len * (float)M_PI * 2.0f;
+      const float b = (float)v / v_len * (float)M_PI * 2.0f;
+      const int i = vert_index(u, v);
+      MVert &mv = mesh->mvert[i];
+      mv.co[0] = (1.0f + 0.4f * cosf(b)) * cosf(a);
+      mv.co[1] = (1.0f + 0.4f * cosf(b)) * sinf(a);
+      mv.co[2] = 0.4f * sinf(b);
+
+      MPoly &mp = mesh->mpoly[i];
+      mp.loopstart = i * 4;
+      mp.totloop = 4;
+
+      MLoop *ml = &mesh->mloop[i * 4];
+      ml[0].v = i;
+      ml[1].v = vert_index(u + 1, v);
+      ml[2].v = vert_index(u + 1, v + 1);
+      ml[3].v = vert_index(u, v + 1);
+    }
+  }
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+  return mesh;
+}
+
+static void expect_mesh_watertight(const Mesh *mesh)
+{
+  Array<int> edge_users(mesh->totedge, 0);
+  for (int i = 0; i < mesh->totloop; i++) {
+    edge_users[mesh->mloop[i].e]++;
+  }
+  for (const int i : edge_users.index_range()) {
+    EXPECT_EQ(edge_users[i], 2);
+  }
+
+  Array<bool> vert_used(mesh->totvert, false);
+  for (int i = 0; i < mesh->totloop; i++) {
+    vert_used[mesh->mloop[i].v] = true;
+  }
+  for (const int i : vert_used.index_range()) {
+    EXPECT_TRUE(vert_used[i]);
+  }
+}
+
+/* Meshing the level set in tiles must give the same surface as meshing it at once. */
+TEST(mesh_remesh_voxel, Tiled)
+{
+  BKE_idtype_init();
+  BLI_task_scheduler_init();
+
+  Mesh *mesh = torus_mesh_create(96, 32);
+
+  /* A few hundred voxels across, so the torus is split over multiple tiles. */
+  const float voxel_size = 0.01f;
+  Mesh *mesh_remesh = BKE_mesh_remesh_voxel_to_mesh_nomain(mesh, voxel_size, 0.0f, 0.0f);
+  Mesh *mesh_remesh_tiled = BKE_mesh_remesh_voxel_tiled_to_mesh_nomain(mesh, voxel_size, 0.0f);
+  ASSERT_NE(mesh_remesh, nullptr);
+  ASSERT_NE(mesh_remesh_tiled, nullptr);
+
+  EXPECT_EQ(mesh_remesh_tiled->totvert, mesh_remesh->totvert);
+  EXPECT_EQ(mesh_remesh_tiled->totedge, mesh_remesh->totedge);
+  EXPECT_EQ(mesh_remesh_tiled->totpoly, mesh_remesh->totpoly);
+  expect_mesh_watertight(mesh_remesh);
+  expect_mesh_watertight(mesh_remesh_tiled);
+
+  BKE_id_free(nullptr, mesh_remesh_tiled);
+  BKE_id_free(nullptr, mesh_remesh);
+  BKE_id_free(nullptr, mesh);
+
+  BLI_task_scheduler_exit();
+}
+
+}  // namespace blender::bke::tests
+
+#endif /* WITH_OPENVDB */
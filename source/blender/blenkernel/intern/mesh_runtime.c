@@ -68,6 +68,8 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   memset(&runtime->looptris, 0, sizeof(runtime->looptris));
   runtime->bvh_cache = NULL;
   runtime->shrinkwrap_data = NULL;
+  runtime->loop_fan_cache = NULL;
+  runtime->looptri_ngon_cache = NULL;
 
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
@@ -88,6 +90,8 @@ void BKE_mesh_runtime_clear_cache(Mesh *mesh)
   BKE_mesh_runtime_clear_geometry(mesh);
   BKE_mesh_batch_cache_free(mesh);
   BKE_mesh_runtime_clear_edit_data(mesh);
+  BKE_mesh_loop_fan_cache_release(&mesh->runtime.loop_fan_cache);
+  BKE_mesh_looptri_ngon_cache_release(&mesh->runtime.looptri_ngon_cache);
 }
 
 /* This is a ported copy of DM_ensure_looptri_data(dm) */
@@ -130,12 +134,14 @@ void BKE_mesh_runtime_looptri_recalc(Mesh *mesh)
   mesh_ensure_looptri_data(mesh);
   BLI_assert(mesh->totpoly == 0 || mesh->runtime.looptris.array_wip != NULL);
 
-  BKE_mesh_recalc_looptri(mesh->mloop,
-                          mesh->mpoly,
-                          mesh->mvert,
-                          mesh->totloop,
-                          mesh->totpoly,
-                          mesh->runtime.looptris.array_wip);
+  BKE_mesh_recalc_looptri_ex(mesh->mloop,
+                             mesh->mpoly,
+                             mesh->mvert,
+                             mesh->totloop,
+                             mesh->totpoly,
+                             mesh->runtime.looptris.array_wip,
+                             NULL,
+                             &mesh->runtime.looptri_ngon_cache);
 
   BLI_assert(mesh->runtime.looptris.array == NULL);
   atomic_cas_ptr((void **)&mesh->runtime.looptris.array,
@@ -238,6 +244,7 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
     mesh->runtime.bvh_cache = NULL;
   }
   MEM_SAFE_FREE(mesh->runtime.looptris.array);
+  BKE_mesh_loop_fan_cache_release(&mesh->runtime.loop_fan_cache);
   /* TODO(sergey): Does this really belong here? */
   if (mesh->runtime.subdiv_ccg != NULL) {
     BKE_subdiv_ccg_destroy(mesh->runtime.subdiv_ccg);
@@ -44,6 +44,8 @@
 
 #include "BLI_strict_flags.h"
 
+#include "atomic_ops.h"
+
 /** Compared against total loops. */
 #define MESH_FACE_TESSELLATE_THREADED_LIMIT 4096
 
@@ -712,6 +714,347 @@ static void mesh_recalc_looptri__multi_threaded(const MLoop *mloop,
                           &settings);
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Ngon Tessellation Cache
+ *
+ * Tessellating ngons is much more expensive than triangles and quads, while copies of a mesh often
+ * keep the same topology and positions. The triangles of ngons are cached and shared between
+ * copies of a mesh, so only triangles and quads are tessellated again.
+ *
+ * The vertices of the cached ngons are compared with the mesh while tessellating, and ngons are
+ * counted along with triangles and quads. When they differ, the cached triangles are discarded
+ * and the mesh is tessellated again.
+ *
+ * Cached triangles of an ngon are only used when the positions of its vertices are exactly the
+ * ones it was tessellated with, so the result never depends on which copies were tessellated
+ * first. Moved ngons are tessellated again (without updating the cache).
+ * \{ */
+
+typedef struct MLoopTriNgon {
+  int poly_index;
+  /** Index of the first triangle of the ngon in #MLoopTriNgonTopology.tris. */
+  int tri_index;
+  /** Index of the first vertex of the ngon in #MLoopTriNgonTopology.verts. */
+  int vert_index;
+  int totloop;
+} MLoopTriNgon;
+
+typedef struct MLoopTriNgonTopology {
+  MLoopTriNgon *ngons;
+  int ngons_len;
+  /** Triangles of all ngons, as loop indices relative to the start of their polygon. */
+  uint (*tris)[3];
+  /** Vertices of all ngons, to check they are unchanged. */
+  uint *verts;
+  /** Positions of #verts the triangles were calculated with. */
+  float (*cos)[3];
+
+  int totloop;
+  int totpoly;
+} MLoopTriNgonTopology;
+
+typedef struct MLoopTriNgonCache {
+  int users;
+  /** Written once, replaced by a new cache when the topology of a user changes. */
+  MLoopTriNgonTopology *topology;
+} MLoopTriNgonCache;
+
+static MLoopTriNgonTopology *looptri_ngon_topology_create(const MLoop *mloop,
+                                                          const MPoly *mpoly,
+                                                          const MVert *mvert,
+                                                          int totloop,
+                                                          int totpoly,
+                                                          const MLoopTri *mlooptri)
+{
+  int ngons_len = 0, tris_len = 0, verts_len = 0;
+  for (int poly_index = 0; poly_index < totpoly; poly_index++) {
+    if (mpoly[poly_index].totloop > 4) {
+      ngons_len++;
+      tris_len += mpoly[poly_index].totloop - 2;
+      verts_len += mpoly[poly_index].totloop;
+    }
+  }
+
+  MLoopTriNgonTopology *topology = MEM_callocN(sizeof(*topology), __func__);
+  topology->ngons = MEM_malloc_arrayN(
+      (size_t)max_ii(ngons_len, 1), sizeof(*topology->ngons), __func__);
+  topology->tris = MEM_malloc_arrayN((size_t)max_ii(tris_len, 1), sizeof(uint[3]), __func__);
+  topology->verts = MEM_malloc_arrayN((size_t)max_ii(verts_len, 1), sizeof(uint), __func__);
+  topology->cos = MEM_malloc_arrayN((size_t)max_ii(verts_len, 1), sizeof(float[3]), __func__);
+  topology->ngons_len = ngons_len;
+  topology->totloop = totloop;
+  topology->totpoly = totpoly;
+
+  MLoopTriNgon *ngon = topology->ngons;
+  int tri_index = 0, vert_index = 0;
+  for (int poly_index = 0; poly_index < totpoly; poly_index++) {
+    const MPoly *mp = &mpoly[poly_index];
+    if (mp->totloop <= 4) {
+      continue;
+    }
+    ngon->poly_index = poly_index;
+    ngon->tri_index = tri_index;
+    ngon->vert_index = vert_index;
+    ngon->totloop = mp->totloop;
+    ngon++;
+
+    for (int j = 0; j < mp->totloop; j++, vert_index++) {
+      topology->verts[vert_index] = mloop[mp->loopstart + j].v;
+      copy_v3_v3(topology->cos[vert_index], mvert[topology->verts[vert_index]].co);
+    }
+
+    const MLoopTri *mlt = &mlooptri[poly_to_tri_count(poly_index, mp->loopstart)];
+    for (int j = 0; j < mp->totloop - 2; j++, mlt++, tri_index++) {
+      for (int k = 0; k < 3; k++) {
+        topology->tris[tri_index][k] = mlt->tri[k] - (uint)mp->loopstart;
+      }
+    }
+  }
+  BLI_assert(tri_index == tris_len);
+
+  return topology;
+}
+
+static void looptri_ngon_topology_free(MLoopTriNgonTopology *topology)
+{
+  MEM_freeN(topology->ngons);
+  MEM_freeN(topology->tris);
+  MEM_freeN(topology->verts);
+  MEM_freeN(topology->cos);
+  MEM_freeN(topology);
+}
+
+static MLoopTriNgonCache *looptri_ngon_cache_new(void)
+{
+  MLoopTriNgonCache *cache = MEM_callocN(sizeof(*cache), __func__);
+  cache->users = 1;
+  return cache;
+}
+
+/**
+ * Get a reference to the ngon cache of \a mesh_src for a copy of it, creating an empty one if
+ * needed.
+ */
+MLoopTriNgonCache *BKE_mesh_looptri_ngon_cache_share(Mesh *mesh_src)
+{
+  MLoopTriNgonCache *cache = mesh_src->runtime.looptri_ngon_cache;
+  if (cache == NULL) {
+    /* The same mesh might be copied by multiple threads at once. */
+    MLoopTriNgonCache *new_cache = looptri_ngon_cache_new();
+    cache = atomic_cas_ptr((void **)&mesh_src->runtime.looptri_ngon_cache, NULL, new_cache);
+    if (cache == NULL) {
+      cache = new_cache;
+    }
+    else {
+      MEM_freeN(new_cache);
+    }
+  }
+  atomic_add_and_fetch_int32(&cache->users, 1);
+  return cache;
+}
+
+void BKE_mesh_looptri_ngon_cache_release(MLoopTriNgonCache **ngon_cache)
+{
+  MLoopTriNgonCache *cache = *ngon_cache;
+  if (cache == NULL) {
+    return;
+  }
+  *ngon_cache = NULL;
+  if (atomic_sub_and_fetch_int32(&cache->users, 1) != 0) {
+    return;
+  }
+  if (cache->topology) {
+    looptri_ngon_topology_free(cache->topology);
+  }
+  MEM_freeN(cache);
+}
+
+/* Store given topology in the cache, taking ownership of it. */
+static void looptri_ngon_cache_store(MLoopTriNgonCache **ngon_cache,
+                                     MLoopTriNgonTopology *topology)
+{
+  MLoopTriNgonCache *cache = *ngon_cache;
+  if (cache != NULL && atomic_cas_ptr((void **)&cache->topology, NULL, topology) == NULL) {
+    return;
+  }
+  /* Topology of this mesh differs from the other users of the cache. */
+  BKE_mesh_looptri_ngon_cache_release(ngon_cache);
+  cache = looptri_ngon_cache_new();
+  cache->topology = topology;
+  *ngon_cache = cache;
+}
+
+struct TessellationNgonUserData {
+  const MLoop *mloop;
+  const MPoly *mpoly;
+  const MVert *mvert;
+  const MLoopTriNgonTopology *topology;
+
+  /** Output array. */
+  MLoopTri *mlooptri;
+
+  /** Optional pre-calculated polygon normals array. */
+  const float (*poly_normals)[3];
+};
+
+struct TessellationCachedUserTLS {
+  /** First, so the callbacks tessellating single faces can use it. */
+  struct TessellationUserTLS tess;
+  int ngons_len;
+  /** Some ngons differ from the cached ones. */
+  bool is_changed;
+};
+
+static void mesh_calc_tessellation_cached_reduce_fn(const void *__restrict UNUSED(userdata),
+                                                    void *__restrict chunk_join,
+                                                    void *__restrict chunk)
+{
+  struct TessellationCachedUserTLS *tls_join = chunk_join;
+  const struct TessellationCachedUserTLS *tls_data = chunk;
+  tls_join->ngons_len += tls_data->ngons_len;
+  tls_join->is_changed |= tls_data->is_changed;
+}
+
+static void mesh_calc_tessellation_for_tri_or_quad_fn(void *__restrict userdata,
+                                                      const int index,
+                                                      const TaskParallelTLS *__restrict tls)
+{
+  const struct TessellationUserData *data = userdata;
+  if (data->mpoly[index].totloop > 4) {
+    /* Handled from the cached ngons, which must all be found here. */
+    struct TessellationCachedUserTLS *tls_data = tls->userdata_chunk;
+    tls_data->ngons_len++;
+    return;
+  }
+  if (data->poly_normals) {
+    mesh_calc_tessellation_for_face_with_normal_fn(userdata, index, tls);
+  }
+  else {
+    mesh_calc_tessellation_for_face_fn(userdata, index, tls);
+  }
+}
+
+static void mesh_calc_tessellation_for_cached_ngon_fn(void *__restrict userdata,
+                                                      const int index,
+                                                      const TaskParallelTLS *__restrict tls)
+{
+  const struct TessellationNgonUserData *data = userdata;
+  struct TessellationCachedUserTLS *tls_data = tls->userdata_chunk;
+  const MLoopTriNgon *ngon = &data->topology->ngons[index];
+  const MPoly *mp = &data->mpoly[ngon->poly_index];
+  const MLoop *ml = &data->mloop[mp->loopstart];
+  const uint(*tris)[3] = &data->topology->tris[ngon->tri_index];
+  const uint totfilltri = (uint)mp->totloop - 2;
+
+  if (mp->totloop != ngon->totloop) {
+    tls_data->is_changed = true;
+    return;
+  }
+  const uint *verts = &data->topology->verts[ngon->vert_index];
+  for (int j = 0; j < mp->totloop; j++) {
+    if (ml[j].v != verts[j]) {
+      tls_data->is_changed = true;
+      return;
+    }
+  }
+
+  /* Compare bits, so the cached triangles are exactly the ones this ngon would get. */
+  const float(*cos)[3] = &data->topology->cos[ngon->vert_index];
+  bool is_moved = false;
+  for (int j = 0; j < mp->totloop; j++) {
+    if (memcmp(data->mvert[ml[j].v].co, cos[j], sizeof(float[3])) != 0) {
+      is_moved = true;
+      break;
+    }
+  }
+
+  MLoopTri *mlt = &data->mlooptri[poly_to_tri_count(ngon->poly_index, mp->loopstart)];
+  if (is_moved) {
+    /* Same as tessellating without the cache. */
+    mesh_calc_tessellation_for_face_impl(
+        data->mloop,
+        data->mpoly,
+        data->mvert,
+        (uint)ngon->poly_index,
+        mlt,
+        &tls_data->tess.pf_arena,
+        data->poly_normals != NULL,
+        data->poly_normals ? data->poly_normals[ngon->poly_index] : NULL);
+    return;
+  }
+
+  const uint loopstart = (uint)mp->loopstart;
+  for (uint j = 0; j < totfilltri; j++, mlt++) {
+    ARRAY_SET_ITEMS(
+        mlt->tri, loopstart + tris[j][0], loopstart + tris[j][1], loopstart + tris[j][2]);
+    mlt->poly = (uint)ngon->poly_index;
+  }
+}
+
+/**
+ * Tessellate using the cached ngons.
+ *
+ * \return False when the ngons of the mesh differ from the cached ones, \a mlooptri must be
+ * tessellated again in that case.
+ */
+static bool mesh_recalc_looptri__cached_ngons(const MLoop *mloop,
+                                              const MPoly *mpoly,
+                                              const MVert *mvert,
+                                              int totloop,
+                                              int totpoly,
+                                              MLoopTri *mlooptri,
+                                              const float (*poly_normals)[3],
+                                              const MLoopTriNgonTopology *topology)
+{
+  /* Reset before each range: the chunk holds the reduced result of the previous one. */
+  struct TessellationCachedUserTLS tls_data = {{NULL}};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (totloop >= MESH_FACE_TESSELLATE_THREADED_LIMIT);
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_reduce = mesh_calc_tessellation_cached_reduce_fn;
+  settings.func_free = mesh_calc_tessellation_for_face_free_fn;
+
+  struct TessellationUserData data = {
+      .mloop = mloop,
+      .mpoly = mpoly,
+      .mvert = mvert,
+      .mlooptri = mlooptri,
+      .poly_normals = poly_normals,
+  };
+  BLI_task_parallel_range(
+      0, totpoly, &data, mesh_calc_tessellation_for_tri_or_quad_fn, &settings);
+  if (tls_data.ngons_len != topology->ngons_len) {
+    return false;
+  }
+
+  struct TessellationNgonUserData ngon_data = {
+      .mloop = mloop,
+      .mpoly = mpoly,
+      .mvert = mvert,
+      .topology = topology,
+      .mlooptri = mlooptri,
+      .poly_normals = poly_normals,
+  };
+  /* Ngons are expensive compared to the overhead of threading. */
+  settings.use_threading = true;
+  settings.min_iter_per_thread = 64;
+  tls_data = (struct TessellationCachedUserTLS){{NULL}};
+  BLI_task_parallel_range(
+      0, topology->ngons_len, &ngon_data, mesh_calc_tessellation_for_cached_ngon_fn, &settings);
+  return !tls_data.is_changed;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Loop Tessellation API
+ * \{ */
+
 /**
  * Calculate tessellation into #MLoopTri which exist only for this purpose.
  */
@@ -757,4 +1100,40 @@ void BKE_mesh_recalc_looptri_with_normals(const MLoop *mloop,
   }
 }
 
+/**
+ * A version of #BKE_mesh_recalc_looptri which reuses the triangles of ngons stored in
+ * \a ngon_cache while the topology and their positions are unchanged,
+ * see #BKE_mesh_looptri_ngon_cache_share.
+ *
+ * \param poly_normals: Optional pre-calculated polygon normals.
+ */
+void BKE_mesh_recalc_looptri_ex(const MLoop *mloop,
+                                const MPoly *mpoly,
+                                const MVert *mvert,
+                                int totloop,
+                                int totpoly,
+                                MLoopTri *mlooptri,
+                                const float (*poly_normals)[3],
+                                MLoopTriNgonCache **ngon_cache)
+{
+  const MLoopTriNgonTopology *topology = (*ngon_cache) ? (*ngon_cache)->topology : NULL;
+  if (topology && topology->totloop == totloop && topology->totpoly == totpoly &&
+      mesh_recalc_looptri__cached_ngons(
+          mloop, mpoly, mvert, totloop, totpoly, mlooptri, poly_normals, topology)) {
+    return;
+  }
+
+  if (totloop < MESH_FACE_TESSELLATE_THREADED_LIMIT) {
+    mesh_recalc_looptri__single_threaded(
+        mloop, mpoly, mvert, totloop, totpoly, mlooptri, poly_normals);
+  }
+  else {
+    mesh_recalc_looptri__multi_threaded(
+        mloop, mpoly, mvert, totloop, totpoly, mlooptri, poly_normals);
+  }
+  looptri_ngon_cache_store(
+      ngon_cache,
+      looptri_ngon_topology_create(mloop, mpoly, mvert, totloop, totpoly, mlooptri));
+}
+
 /** \} */
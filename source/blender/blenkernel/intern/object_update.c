@@ -352,9 +352,18 @@ void BKE_object_eval_uber_transform(Depsgraph *depsgraph, Object *object)
 void BKE_object_data_batch_cache_dirty_tag(ID *object_data)
 {
   switch (GS(object_data->name)) {
-    case ID_ME:
-      BKE_mesh_batch_cache_dirty_tag((struct Mesh *)object_data, BKE_MESH_BATCH_DIRTY_ALL);
+    case ID_ME: {
+      Mesh *mesh = (Mesh *)object_data;
+      BMEditMesh *em = mesh->edit_mesh;
+      if ((em != NULL) && (em->deform_update != EM_DEFORM_UPDATE_NONE)) {
+        BKE_mesh_batch_cache_dirty_tag(mesh, BKE_MESH_BATCH_DIRTY_DEFORM);
+        BKE_editmesh_deform_update_clear(em);
+      }
+      else {
+        BKE_mesh_batch_cache_dirty_tag(mesh, BKE_MESH_BATCH_DIRTY_ALL);
+      }
       break;
+    }
     case ID_LT:
       BKE_lattice_batch_cache_dirty_tag((struct Lattice *)object_data,
                                         BKE_LATTICE_BATCH_DIRTY_ALL);
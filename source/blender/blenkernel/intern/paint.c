@@ -1406,6 +1406,18 @@ void BKE_sculptsession_bm_to_me(Object *ob, bool reorder)
   }
 }
 
+/* Cached geodesic distances are only valid for the current coordinates and face visibility,
+ * call when either of them changes. */
+void BKE_sculptsession_free_geodesic_cache(SculptSession *ss)
+{
+  LISTBASE_FOREACH_MUTABLE (SculptGeodesicCache *, geodesic_cache, &ss->geodesic_cache) {
+    MEM_freeN(geodesic_cache->initial_vertices);
+    MEM_freeN(geodesic_cache->dists);
+    MEM_freeN(geodesic_cache);
+  }
+  BLI_listbase_clear(&ss->geodesic_cache);
+}
+
 static void sculptsession_free_pbvh(Object *object)
 {
   SculptSession *ss = object->sculpt;
@@ -1435,6 +1447,8 @@ static void sculptsession_free_pbvh(Object *object)
 
   MEM_SAFE_FREE(ss->preview_vert_index_list);
 
+  BKE_sculptsession_free_geodesic_cache(ss);
+
   MEM_SAFE_FREE(ss->vertex_info.connected_component);
   MEM_SAFE_FREE(ss->vertex_info.boundary);
 
@@ -26,6 +26,7 @@
 #include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_rand.h"
+#include "BLI_sort_utils.h"
 #include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
@@ -50,6 +51,10 @@
 #include <limits.h>
 
 #define LEAF_LIMIT 10000
+/* Number of bins used to find the best split with the surface area heuristic. */
+#define BUILD_SAH_BINS 16
+/* Nodes with more primitives are bounded and binned using multiple threads. */
+#define BUILD_THREADED_PRIMS_MIN 65536
 
 //#define PERFCNTRS
 
@@ -249,42 +254,35 @@ void pbvh_grow_nodes(PBVH *pbvh, int totnode)
   pbvh->totnode = totnode;
 }
 
-/* Add a vertex to the map, with a positive value for unique vertices and
- * a negative value for additional vertices */
-static int map_insert_vert(
-    PBVH *pbvh, GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex)
+/* Returns the index of \a value in the sorted \a array. */
+static int sorted_index_find(const int *array, int len, int value)
 {
-  void *key, **value_p;
-
-  key = POINTER_FROM_INT(vertex);
-  if (!BLI_ghash_ensure_p(map, key, &value_p)) {
-    int value_i;
-    if (BLI_BITMAP_TEST(pbvh->vert_bitmap, vertex) == 0) {
-      BLI_BITMAP_ENABLE(pbvh->vert_bitmap, vertex);
-      value_i = *uniq_verts;
-      (*uniq_verts)++;
+  int lo = 0, hi = len - 1;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (array[mid] < value) {
+      lo = mid + 1;
     }
     else {
-      value_i = ~(*face_verts);
-      (*face_verts)++;
+      hi = mid;
     }
-    *value_p = POINTER_FROM_INT(value_i);
-    return value_i;
   }
-
-  return POINTER_AS_INT(*value_p);
+  BLI_assert(array[lo] == value);
+  return lo;
 }
 
-/* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
+/* Find vertices used by the faces in this node and update the draw buffers.
+ *
+ * A vertex is unique to the node with the lowest index using it (see #build_vert_owner_set).
+ * Faces and vertices are sorted by index, so nodes access mesh data in memory order. */
+static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node, const int *vert_owner)
 {
   bool has_visible = false;
 
-  node->uniq_verts = node->face_verts = 0;
-  const int totface = node->totprim;
+  const int node_index = (int)(node - pbvh->nodes);
+  const int totface = (int)node->totprim;
 
-  /* reserve size is rough guess */
-  GHash *map = BLI_ghash_int_new_ex("build_mesh_leaf_node gh", 2 * totface);
+  qsort(node->prim_indices, (size_t)totface, sizeof(int), BLI_sortutil_cmp_int);
 
   int(*face_vert_indices)[3] = MEM_mallocN(sizeof(int[3]) * totface, "bvh node face vert indices");
 
@@ -294,11 +292,11 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
     has_visible = true;
   }
 
+  int *verts = MEM_mallocN(sizeof(int[3]) * totface, __func__);
   for (int i = 0; i < totface; i++) {
     const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
     for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          pbvh, map, &node->face_verts, &node->uniq_verts, pbvh->mloop[lt->tri[j]].v);
+      verts[i * 3 + j] = (int)pbvh->mloop[lt->tri[j]].v;
     }
 
     if (has_visible == false) {
@@ -308,38 +306,50 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
     }
   }
 
-  int *vert_indices = MEM_callocN(sizeof(int) * (node->uniq_verts + node->face_verts),
-                                  "bvh node vert indices");
-  node->vert_indices = vert_indices;
+  qsort(verts, (size_t)totface * 3, sizeof(int), BLI_sortutil_cmp_int);
+  int verts_len = 0;
+  for (int i = 0; i < totface * 3; i++) {
+    if (verts_len == 0 || verts[verts_len - 1] != verts[i]) {
+      verts[verts_len++] = verts[i];
+    }
+  }
 
   /* Build the vertex list, unique verts first */
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, map) {
-    void *value = BLI_ghashIterator_getValue(&gh_iter);
-    int ndx = POINTER_AS_INT(value);
-
-    if (ndx < 0) {
-      ndx = -ndx + node->uniq_verts - 1;
+  int *vert_indices = MEM_mallocN(sizeof(int) * verts_len, "bvh node vert indices");
+  int uniq_verts = 0, face_verts = 0;
+  for (int i = 0; i < verts_len; i++) {
+    if (vert_owner[verts[i]] == node_index) {
+      vert_indices[uniq_verts++] = verts[i];
+    }
+  }
+  for (int i = 0; i < verts_len; i++) {
+    if (vert_owner[verts[i]] != node_index) {
+      vert_indices[uniq_verts + face_verts++] = verts[i];
     }
-
-    vert_indices[ndx] = POINTER_AS_INT(BLI_ghashIterator_getKey(&gh_iter));
   }
+  node->vert_indices = vert_indices;
+  node->uniq_verts = (unsigned int)uniq_verts;
+  node->face_verts = (unsigned int)face_verts;
 
   for (int i = 0; i < totface; i++) {
-    const int sides = 3;
-
-    for (int j = 0; j < sides; j++) {
-      if (face_vert_indices[i][j] < 0) {
-        face_vert_indices[i][j] = -face_vert_indices[i][j] + node->uniq_verts - 1;
+    const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+    for (int j = 0; j < 3; j++) {
+      const int v = (int)pbvh->mloop[lt->tri[j]].v;
+      if (vert_owner[v] == node_index) {
+        face_vert_indices[i][j] = sorted_index_find(vert_indices, uniq_verts, v);
+      }
+      else {
+        face_vert_indices[i][j] = uniq_verts +
+                                  sorted_index_find(vert_indices + uniq_verts, face_verts, v);
       }
     }
   }
 
+  MEM_freeN(verts);
+
   BKE_pbvh_node_mark_rebuild_draw(node);
 
   BKE_pbvh_node_fully_hidden_set(node, !has_visible);
-
-  BLI_ghash_free(map, NULL, NULL);
 }
 
 static void update_vb(PBVH *pbvh, PBVHNode *node, BBC *prim_bbc, int offset, int count)
@@ -412,24 +422,6 @@ static void build_grid_leaf_node(PBVH *pbvh, PBVHNode *node)
   BKE_pbvh_node_mark_rebuild_draw(node);
 }
 
-static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, int count)
-{
-  pbvh->nodes[node_index].flag |= PBVH_Leaf;
-
-  pbvh->nodes[node_index].prim_indices = pbvh->prim_indices + offset;
-  pbvh->nodes[node_index].totprim = count;
-
-  /* Still need vb for searches */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
-  if (pbvh->looptri) {
-    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
-  }
-  else {
-    build_grid_leaf_node(pbvh, pbvh->nodes + node_index);
-  }
-}
-
 /* Return zero if all primitives in the node can be drawn with the
  * same material (including flat/smooth shading), non-zero otherwise */
 static bool leaf_needs_material_split(PBVH *pbvh, int offset, int count)
@@ -464,73 +456,393 @@ static bool leaf_needs_material_split(PBVH *pbvh, int offset, int count)
   return false;
 }
 
-/* Recursively build a node in the tree
- *
- * vb is the voxel box around all of the primitives contained in
- * this node.
+/* -------------------------------------------------------------------- */
+/** \name Tree Build
  *
- * cb is the bounding box around all the centroids of the primitives
- * contained in this node
+ * The tree is built in three steps:
+ * - Primitives are partitioned recursively into a temporary tree of #PBVHBuildNode,
+ *   large sub-trees are partitioned in parallel tasks.
+ * - The temporary tree is flattened into #PBVH.nodes, in the same order as a recursive build.
+ * - Leaf nodes are filled in parallel, internal node bounds are accumulated from their children.
+ * \{ */
+
+typedef struct PBVHBuildNode {
+  /** Both children are NULL for leaf nodes. */
+  struct PBVHBuildNode *children[2];
+  /** Range in #PBVH.prim_indices. */
+  int offset, count;
+} PBVHBuildNode;
+
+typedef struct PBVHBuildData {
+  PBVH *pbvh;
+  const BBC *prim_bbc;
+} PBVHBuildData;
+
+typedef struct PBVHBuildBin {
+  BB bb;
+  int count;
+} PBVHBuildBin;
+
+typedef struct PBVHBuildBins {
+  PBVHBuildBin bins[BUILD_SAH_BINS];
+} PBVHBuildBins;
+
+typedef struct PBVHBuildRangeData {
+  const int *prim_indices;
+  const BBC *prim_bbc;
+  /* Binning of primitive centroids along an axis. */
+  int axis;
+  float bin_min, bin_scale;
+} PBVHBuildRangeData;
+
+static float BB_surface_area(const BB *bb)
+{
+  float dim[3];
+  sub_v3_v3v3(dim, bb->bmax, bb->bmin);
+  return dim[0] * dim[1] + dim[1] * dim[2] + dim[2] * dim[0];
+}
+
+BLI_INLINE int build_bin_index(const PBVHBuildRangeData *data, const float centroid[3])
+{
+  const int bin = (int)((centroid[data->axis] - data->bin_min) * data->bin_scale);
+  return clamp_i(bin, 0, BUILD_SAH_BINS - 1);
+}
+
+static void build_centroid_bounds_cb(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict tls)
+{
+  const PBVHBuildRangeData *data = userdata;
+  BB *cb = tls->userdata_chunk;
+  BB_expand(cb, data->prim_bbc[data->prim_indices[i]].bcentroid);
+}
+
+static void build_centroid_bounds_reduce(const void *__restrict UNUSED(userdata),
+                                         void *__restrict chunk_join,
+                                         void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
+}
+
+static void build_bins_cb(void *__restrict userdata,
+                          const int i,
+                          const TaskParallelTLS *__restrict tls)
+{
+  const PBVHBuildRangeData *data = userdata;
+  PBVHBuildBins *bins = tls->userdata_chunk;
+  const BBC *bbc = &data->prim_bbc[data->prim_indices[i]];
+  PBVHBuildBin *bin = &bins->bins[build_bin_index(data, bbc->bcentroid)];
+  BB_expand_with_bb(&bin->bb, (BB *)bbc);
+  bin->count++;
+}
+
+static void build_bins_reduce(const void *__restrict UNUSED(userdata),
+                              void *__restrict chunk_join,
+                              void *__restrict chunk)
+{
+  PBVHBuildBins *bins_join = chunk_join;
+  PBVHBuildBins *bins = chunk;
+  for (int i = 0; i < BUILD_SAH_BINS; i++) {
+    BB_expand_with_bb(&bins_join->bins[i].bb, &bins->bins[i].bb);
+    bins_join->bins[i].count += bins->bins[i].count;
+  }
+}
+
+static void build_range_settings(TaskParallelSettings *settings, const int count)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (count >= BUILD_THREADED_PRIMS_MIN);
+  settings->min_iter_per_thread = BUILD_THREADED_PRIMS_MIN / 4;
+}
+
+/* Bounding box around the centroids of the primitives in a range. */
+static void build_centroid_bounds(
+    const PBVH *pbvh, const BBC *prim_bbc, int offset, int count, BB *r_cb)
+{
+  PBVHBuildRangeData data = {
+      .prim_indices = pbvh->prim_indices + offset,
+      .prim_bbc = prim_bbc,
+  };
+  BB_reset(r_cb);
+
+  TaskParallelSettings settings;
+  build_range_settings(&settings, count);
+  BB cb_chunk;
+  BB_reset(&cb_chunk);
+  settings.userdata_chunk = &cb_chunk;
+  settings.userdata_chunk_size = sizeof(cb_chunk);
+  settings.func_reduce = build_centroid_bounds_reduce;
+  BLI_task_parallel_range(0, count, &data, build_centroid_bounds_cb, &settings);
+  *r_cb = cb_chunk;
+}
+
+/* Returns the index of the first element on the right of the partition,
+ * or -1 when no split leaves enough primitives on both sides.
  *
- * offset and start indicate a range in the array of primitive indices
- */
+ * Primitives are binned along the widest axis of their centroids, the split between bins
+ * with the lowest surface area heuristic cost is used. Splits leaving less than a quarter
+ * of the primitives on one side are skipped, keeping leaves of similar sizes and the depth
+ * of the tree logarithmic. */
+static int partition_indices_sah(PBVH *pbvh, const BBC *prim_bbc, const BB *cb, int lo, int hi)
+{
+  const int count = hi - lo + 1;
+  const int axis = BB_widest_axis(cb);
+  const float extent = cb->bmax[axis] - cb->bmin[axis];
+  if (!(extent > 0.0f)) {
+    return -1;
+  }
+
+  PBVHBuildRangeData data = {
+      .prim_indices = pbvh->prim_indices + lo,
+      .prim_bbc = prim_bbc,
+      .axis = axis,
+      .bin_min = cb->bmin[axis],
+      .bin_scale = (float)BUILD_SAH_BINS / extent,
+  };
 
-static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int offset, int count)
+  PBVHBuildBins bins;
+  for (int i = 0; i < BUILD_SAH_BINS; i++) {
+    BB_reset(&bins.bins[i].bb);
+    bins.bins[i].count = 0;
+  }
+  TaskParallelSettings settings;
+  build_range_settings(&settings, count);
+  settings.userdata_chunk = &bins;
+  settings.userdata_chunk_size = sizeof(bins);
+  settings.func_reduce = build_bins_reduce;
+  BLI_task_parallel_range(0, count, &data, build_bins_cb, &settings);
+
+  /* Cost of the right side of a split before each bin. */
+  float cost_right[BUILD_SAH_BINS];
+  int count_right[BUILD_SAH_BINS];
+  BB bb;
+  BB_reset(&bb);
+  int n = 0;
+  for (int i = BUILD_SAH_BINS - 1; i > 0; i--) {
+    BB_expand_with_bb(&bb, &bins.bins[i].bb);
+    n += bins.bins[i].count;
+    cost_right[i] = BB_surface_area(&bb) * (float)n;
+    count_right[i] = n;
+  }
+
+  const int count_min = max_ii(count / 4, 1);
+  int split = -1;
+  float split_cost = FLT_MAX;
+  BB_reset(&bb);
+  n = 0;
+  for (int i = 0; i < BUILD_SAH_BINS - 1; i++) {
+    BB_expand_with_bb(&bb, &bins.bins[i].bb);
+    n += bins.bins[i].count;
+    if ((n < count_min) || (count_right[i + 1] < count_min)) {
+      continue;
+    }
+    const float cost = BB_surface_area(&bb) * (float)n + cost_right[i + 1];
+    if (cost < split_cost) {
+      split_cost = cost;
+      split = i;
+    }
+  }
+
+  if (split == -1) {
+    return -1;
+  }
+
+  int *prim_indices = pbvh->prim_indices;
+  int i = lo, j = hi;
+  while (i <= j) {
+    if (build_bin_index(&data, prim_bbc[prim_indices[i]].bcentroid) <= split) {
+      i++;
+    }
+    else {
+      SWAP(int, prim_indices[i], prim_indices[j]);
+      j--;
+    }
+  }
+  return i;
+}
+
+static void build_node_task(TaskPool *__restrict pool, void *taskdata);
+
+/* Partition the primitives of a node, adding children until leaf nodes are reached.
+ * Children which are split further are partitioned in new tasks of the \a pool. */
+static void build_node(PBVHBuildData *data, PBVHBuildNode *bnode, TaskPool *pool)
 {
+  PBVH *pbvh = data->pbvh;
+  const int offset = bnode->offset;
+  const int count = bnode->count;
   int end;
-  BB cb_backing;
 
   /* Decide whether this is a leaf or not */
-  const bool below_leaf_limit = count <= pbvh->leaf_limit;
-  if (below_leaf_limit) {
+  if (count <= pbvh->leaf_limit) {
     if (!leaf_needs_material_split(pbvh, offset, count)) {
-      build_leaf(pbvh, node_index, prim_bbc, offset, count);
       return;
     }
+    /* Partition primitives by material */
+    end = partition_indices_material(pbvh, offset, offset + count - 1);
+  }
+  else {
+    BB cb;
+    build_centroid_bounds(pbvh, data->prim_bbc, offset, count, &cb);
+    end = partition_indices_sah(pbvh, data->prim_bbc, &cb, offset, offset + count - 1);
+    if (end == -1) {
+      /* Fall back to splitting at the middle of the widest axis. */
+      const int axis = BB_widest_axis(&cb);
+      end = partition_indices(pbvh->prim_indices,
+                              offset,
+                              offset + count - 1,
+                              axis,
+                              (cb.bmax[axis] + cb.bmin[axis]) * 0.5f,
+                              (BBC *)data->prim_bbc);
+    }
+    if (ELEM(end, offset, offset + count)) {
+      /* All centroids are the same, any split will do. */
+      end = offset + count / 2;
+    }
   }
 
   /* Add two child nodes */
-  pbvh->nodes[node_index].children_offset = pbvh->totnode;
-  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
-
-  /* Update parent node bounding box */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
-  if (!below_leaf_limit) {
-    /* Find axis with widest range of primitive centroids */
-    if (!cb) {
-      cb = &cb_backing;
-      BB_reset(cb);
-      for (int i = offset + count - 1; i >= offset; i--) {
-        BB_expand(cb, prim_bbc[pbvh->prim_indices[i]].bcentroid);
-      }
+  for (int i = 0; i < 2; i++) {
+    PBVHBuildNode *child = MEM_callocN(sizeof(*child), __func__);
+    child->offset = (i == 0) ? offset : end;
+    child->count = (i == 0) ? end - offset : offset + count - end;
+    bnode->children[i] = child;
+  }
+
+  /* Build children */
+  for (int i = 0; i < 2; i++) {
+    PBVHBuildNode *child = bnode->children[i];
+    if (pool && child->count > pbvh->leaf_limit) {
+      BLI_task_pool_push(pool, build_node_task, child, false, NULL);
+    }
+    else {
+      build_node(data, child, pool);
+    }
+  }
+}
+
+static void build_node_task(TaskPool *__restrict pool, void *taskdata)
+{
+  PBVHBuildData *data = BLI_task_pool_user_data(pool);
+  build_node(data, taskdata, pool);
+}
+
+/* Copy the temporary tree into #PBVH.nodes, freeing it. */
+static void build_flatten(PBVH *pbvh, PBVHBuildNode *bnode, int node_index)
+{
+  if (bnode->children[0] == NULL) {
+    PBVHNode *node = &pbvh->nodes[node_index];
+    node->flag |= PBVH_Leaf;
+    node->prim_indices = pbvh->prim_indices + bnode->offset;
+    node->totprim = (unsigned int)bnode->count;
+  }
+  else {
+    const int children_offset = pbvh->totnode;
+    pbvh->nodes[node_index].children_offset = children_offset;
+    pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
+
+    build_flatten(pbvh, bnode->children[0], children_offset);
+    build_flatten(pbvh, bnode->children[1], children_offset + 1);
+  }
+  MEM_freeN(bnode);
+}
+
+typedef struct PBVHBuildLeavesData {
+  PBVH *pbvh;
+  const BBC *prim_bbc;
+  const int *leaves;
+  int *vert_owner;
+} PBVHBuildLeavesData;
+
+/* Atomically keep the lowest node index using a vertex. */
+BLI_INLINE void build_vert_owner_set(int *vert_owner, int node_index)
+{
+  int owner = *vert_owner;
+  while (node_index < owner) {
+    const int owner_prev = atomic_cas_int32(vert_owner, owner, node_index);
+    if (owner_prev == owner) {
+      break;
     }
-    const int axis = BB_widest_axis(cb);
+    owner = owner_prev;
+  }
+}
 
-    /* Partition primitives along that axis */
-    end = partition_indices(pbvh->prim_indices,
-                            offset,
-                            offset + count - 1,
-                            axis,
-                            (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
-                            prim_bbc);
+static void build_leaves_bounds_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeavesData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  const int node_index = data->leaves[i];
+  PBVHNode *node = &pbvh->nodes[node_index];
+
+  /* Still need vb for searches */
+  const int offset = (int)(node->prim_indices - pbvh->prim_indices);
+  update_vb(pbvh, node, (BBC *)data->prim_bbc, offset, (int)node->totprim);
+
+  if (pbvh->looptri) {
+    for (int p = 0; p < (int)node->totprim; p++) {
+      const MLoopTri *lt = &pbvh->looptri[node->prim_indices[p]];
+      for (int j = 0; j < 3; j++) {
+        build_vert_owner_set(&data->vert_owner[pbvh->mloop[lt->tri[j]].v], node_index);
+      }
+    }
   }
   else {
-    /* Partition primitives by material */
-    end = partition_indices_material(pbvh, offset, offset + count - 1);
+    qsort(node->prim_indices, node->totprim, sizeof(int), BLI_sortutil_cmp_int);
+    build_grid_leaf_node(pbvh, node);
   }
+}
 
-  /* Build children */
-  build_sub(pbvh, pbvh->nodes[node_index].children_offset, NULL, prim_bbc, offset, end - offset);
-  build_sub(pbvh,
-            pbvh->nodes[node_index].children_offset + 1,
-            NULL,
-            prim_bbc,
-            end,
-            offset + count - end);
+static void build_leaves_mesh_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeavesData *data = userdata;
+  build_mesh_leaf_node(data->pbvh, &data->pbvh->nodes[data->leaves[i]], data->vert_owner);
+}
+
+static void build_leaves(PBVH *pbvh, const BBC *prim_bbc)
+{
+  int *leaves = MEM_mallocN(sizeof(int) * pbvh->totnode, __func__);
+  int leaves_len = 0;
+  for (int i = 0; i < pbvh->totnode; i++) {
+    if (pbvh->nodes[i].flag & PBVH_Leaf) {
+      leaves[leaves_len++] = i;
+    }
+  }
+
+  PBVHBuildLeavesData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+      .leaves = leaves,
+  };
+  if (pbvh->looptri) {
+    data.vert_owner = MEM_malloc_arrayN(pbvh->totvert, sizeof(int), __func__);
+    copy_vn_i(data.vert_owner, pbvh->totvert, INT_MAX);
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, leaves_len, &data, build_leaves_bounds_cb, &settings);
+
+  if (pbvh->looptri) {
+    BLI_task_parallel_range(0, leaves_len, &data, build_leaves_mesh_cb, &settings);
+    MEM_freeN(data.vert_owner);
+  }
+  MEM_freeN(leaves);
+
+  /* Children are always stored after their parent. */
+  for (int i = pbvh->totnode - 1; i >= 0; i--) {
+    PBVHNode *node = &pbvh->nodes[i];
+    if (!(node->flag & PBVH_Leaf)) {
+      node->vb = pbvh->nodes[node->children_offset].vb;
+      BB_expand_with_bb(&node->vb, &pbvh->nodes[node->children_offset + 1].vb);
+      node->orig_vb = node->vb;
+    }
+  }
 }
 
-static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
+static void pbvh_build(PBVH *pbvh, const BBC *prim_bbc, int totprim)
 {
   if (totprim != pbvh->totprim) {
     pbvh->totprim = totprim;
@@ -551,10 +863,99 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
     }
   }
 
+  PBVHBuildData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  PBVHBuildNode *root = MEM_callocN(sizeof(*root), __func__);
+  root->count = totprim;
+
+  if (totprim > pbvh->leaf_limit) {
+    TaskPool *pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+    BLI_task_pool_push(pool, build_node_task, root, false, NULL);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
+  else {
+    build_node(&data, root, NULL);
+  }
+
   pbvh->totnode = 1;
-  build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+  build_flatten(pbvh, root, 0);
+
+  build_leaves(pbvh, prim_bbc);
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Primitive Bounds
+ * \{ */
+
+typedef struct PBVHBuildPrimBoundsData {
+  const PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHBuildPrimBoundsData;
+
+static void build_prim_bounds_mesh_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildPrimBoundsData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const MLoopTri *lt = &pbvh->looptri[i];
+  const int sides = 3;
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < sides; j++) {
+    BB_expand((BB *)bbc, pbvh->verts[pbvh->mloop[lt->tri[j]].v].co);
+  }
+
+  BBC_update_centroid(bbc);
+}
+
+static void build_prim_bounds_grids_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildPrimBoundsData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const CCGKey *key = &pbvh->gridkey;
+  CCGElem *grid = pbvh->grids[i];
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < key->grid_area; j++) {
+    BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+  }
+
+  BBC_update_centroid(bbc);
+}
+
+/* For each primitive, store the AABB and the AABB centroid */
+static BBC *build_prim_bounds(const PBVH *pbvh, int totprim)
+{
+  PBVHBuildPrimBoundsData data = {
+      .pbvh = pbvh,
+      .prim_bbc = MEM_mallocN(sizeof(BBC) * totprim, "prim_bbc"),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0,
+                          totprim,
+                          &data,
+                          pbvh->looptri ? build_prim_bounds_mesh_cb : build_prim_bounds_grids_cb,
+                          &settings);
+  return data.prim_bbc;
+}
+
+/** \} */
+
 /**
  * Do a full rebuild with on Mesh data structure.
  *
@@ -573,18 +974,14 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
                          const MLoopTri *looptri,
                          int looptri_num)
 {
-  BBC *prim_bbc = NULL;
-  BB cb;
-
   pbvh->mesh = mesh;
   pbvh->type = PBVH_FACES;
   pbvh->mpoly = mpoly;
   pbvh->mloop = mloop;
   pbvh->looptri = looptri;
   pbvh->verts = verts;
-  pbvh->vert_bitmap = BLI_BITMAP_NEW(totvert, "bvh->vert_bitmap");
   pbvh->totvert = totvert;
-  pbvh->leaf_limit = LEAF_LIMIT;
+  pbvh->leaf_limit = (pbvh->build_leaf_limit > 0) ? pbvh->build_leaf_limit : LEAF_LIMIT;
   pbvh->vdata = vdata;
   pbvh->ldata = ldata;
   pbvh->pdata = pdata;
@@ -592,33 +989,11 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->face_sets_color_seed = mesh->face_sets_color_seed;
   pbvh->face_sets_color_default = mesh->face_sets_color_default;
 
-  BB_reset(&cb);
-
-  /* For each face, store the AABB and the AABB centroid */
-  prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
-
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[pbvh->mloop[lt->tri[j]].v].co);
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
-
   if (looptri_num) {
-    pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
+    BBC *prim_bbc = build_prim_bounds(pbvh, looptri_num);
+    pbvh_build(pbvh, prim_bbc, looptri_num);
+    MEM_freeN(prim_bbc);
   }
-
-  MEM_freeN(prim_bbc);
-  MEM_freeN(pbvh->vert_bitmap);
 }
 
 /* Do a full rebuild with on Grids data structure */
@@ -639,34 +1014,15 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   pbvh->totgrid = totgrid;
   pbvh->gridkey = *key;
   pbvh->grid_hidden = grid_hidden;
-  pbvh->leaf_limit = max_ii(LEAF_LIMIT / (gridsize * gridsize), 1);
-
-  BB cb;
-  BB_reset(&cb);
-
-  /* For each grid, store the AABB and the AABB centroid */
-  BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
-
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  pbvh->leaf_limit = max_ii(
+      ((pbvh->build_leaf_limit > 0) ? pbvh->build_leaf_limit : LEAF_LIMIT) / (gridsize * gridsize),
+      1);
 
   if (totgrid) {
-    pbvh_build(pbvh, &cb, prim_bbc, totgrid);
+    BBC *prim_bbc = build_prim_bounds(pbvh, totgrid);
+    pbvh_build(pbvh, prim_bbc, totgrid);
+    MEM_freeN(prim_bbc);
   }
-
-  MEM_freeN(prim_bbc);
 }
 
 PBVH *BKE_pbvh_new(void)
@@ -676,6 +1032,16 @@ PBVH *BKE_pbvh_new(void)
   return pbvh;
 }
 
+/**
+ * Set the number of primitives in leaf nodes for the following builds, for benchmarking.
+ * It's the number of triangles for meshes, dynamic topology faces or grid elements for
+ * multi-resolution (which is divided by the grid area). Zero uses the default.
+ */
+void BKE_pbvh_build_leaf_limit_set(PBVH *pbvh, int leaf_limit)
+{
+  pbvh->build_leaf_limit = leaf_limit;
+}
+
 void BKE_pbvh_free(PBVH *pbvh)
 {
   for (int i = 0; i < pbvh->totnode; i++) {
@@ -2658,7 +3024,7 @@ void BKE_pbvh_update_normals(PBVH *pbvh, struct SubdivCCG *subdiv_ccg)
 
   if (totnode > 0) {
     if (pbvh->type == PBVH_BMESH) {
-      pbvh_bmesh_normals_update(nodes, totnode);
+      pbvh_bmesh_normals_update(pbvh, nodes, totnode);
     }
     else if (pbvh->type == PBVH_FACES) {
       pbvh_faces_update_normals(pbvh, nodes, totnode);
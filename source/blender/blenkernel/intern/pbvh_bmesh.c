@@ -25,6 +25,7 @@
 #include "BLI_heap_simple.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_DerivedMesh.h"
@@ -746,6 +747,21 @@ typedef struct EdgeQueue {
 #endif
 } EdgeQueue;
 
+/* Edges found in one node while creating the queue.
+ *
+ * Nodes are scanned in parallel, edges are only read and may be found more than once. They are
+ * inserted into the queue afterwards in node order, giving the same queue as a serial scan. */
+typedef struct EdgeQueueCandidate {
+  BMEdge *e;
+  float priority;
+} EdgeQueueCandidate;
+
+typedef struct EdgeQueueCandidates {
+  EdgeQueueCandidate *data;
+  int len;
+  int len_alloc;
+} EdgeQueueCandidates;
+
 typedef struct {
   EdgeQueue *q;
   BLI_mempool *pool;
@@ -753,6 +769,8 @@ typedef struct {
   int cd_vert_mask_offset;
   int cd_vert_node_offset;
   int cd_face_node_offset;
+  /* Edges to insert while updating the topology. */
+  EdgeQueueCandidates candidates;
 } EdgeQueueContext;
 
 /* only tag'd edges are in the queue */
@@ -856,39 +874,63 @@ static void edge_queue_insert(EdgeQueueContext *eq_ctx, BMEdge *e, float priorit
   }
 }
 
-static void long_edge_queue_edge_add(EdgeQueueContext *eq_ctx, BMEdge *e)
+static void edge_queue_candidate_add(EdgeQueueCandidates *candidates, BMEdge *e, float priority)
 {
+  if (candidates->len == candidates->len_alloc) {
+    candidates->len_alloc = max_ii(candidates->len_alloc * 2, 64);
+    candidates->data = MEM_reallocN(candidates->data,
+                                    sizeof(*candidates->data) * (size_t)candidates->len_alloc);
+  }
+  EdgeQueueCandidate *candidate = &candidates->data[candidates->len++];
+  candidate->e = e;
+  candidate->priority = priority;
+}
+
+/* Insert candidates in their order, skipping edges which are already in the queue. */
+static void edge_queue_candidates_insert(EdgeQueueContext *eq_ctx,
+                                         EdgeQueueCandidates *candidates)
+{
+  for (int i = 0; i < candidates->len; i++) {
+    BMEdge *e = candidates->data[i].e;
 #ifdef USE_EDGEQUEUE_TAG
-  if (EDGE_QUEUE_TEST(e) == false)
-#endif
-  {
-    const float len_sq = BM_edge_calc_length_squared(e);
-    if (len_sq > eq_ctx->q->limit_len_squared) {
-      edge_queue_insert(eq_ctx, e, -len_sq);
+    if (EDGE_QUEUE_TEST(e)) {
+      continue;
     }
+#endif
+    edge_queue_insert(eq_ctx, e, candidates->data[i].priority);
+  }
+  candidates->len = 0;
+}
+
+static void long_edge_queue_edge_add(const EdgeQueue *q,
+                                     EdgeQueueCandidates *candidates,
+                                     BMEdge *e)
+{
+  const float len_sq = BM_edge_calc_length_squared(e);
+  if (len_sq > q->limit_len_squared) {
+    edge_queue_candidate_add(candidates, e, -len_sq);
   }
 }
 
 #ifdef USE_EDGEQUEUE_EVEN_SUBDIV
-static void long_edge_queue_edge_add_recursive(
-    EdgeQueueContext *eq_ctx, BMLoop *l_edge, BMLoop *l_end, const float len_sq, float limit_len)
+static void long_edge_queue_edge_add_recursive(const EdgeQueue *q,
+                                               EdgeQueueCandidates *candidates,
+                                               BMLoop *l_edge,
+                                               BMLoop *l_end,
+                                               const float len_sq,
+                                               float limit_len)
 {
   BLI_assert(len_sq > square_f(limit_len));
 
 #  ifdef USE_EDGEQUEUE_FRONTFACE
-  if (eq_ctx->q->use_view_normal) {
-    if (dot_v3v3(l_edge->f->no, eq_ctx->q->view_normal) < 0.0f) {
+  if (q->use_view_normal) {
+    if (dot_v3v3(l_edge->f->no, q->view_normal) < 0.0f) {
       return;
     }
   }
 #  endif
 
-#  ifdef USE_EDGEQUEUE_TAG
-  if (EDGE_QUEUE_TEST(l_edge->e) == false)
-#  endif
-  {
-    edge_queue_insert(eq_ctx, l_edge->e, -len_sq);
-  }
+  edge_queue_candidate_add(candidates, l_edge->e, -len_sq);
 
   /* temp support previous behavior! */
   if (UNLIKELY(G.debug_value == 1234)) {
@@ -915,8 +957,12 @@ static void long_edge_queue_edge_add_recursive(
         float len_sq_other = BM_edge_calc_length_squared(l_adjacent[i]->e);
         if (len_sq_other > max_ff(len_sq_cmp, limit_len_sq)) {
           //                  edge_queue_insert(eq_ctx, l_adjacent[i]->e, -len_sq_other);
-          long_edge_queue_edge_add_recursive(
-              eq_ctx, l_adjacent[i]->radial_next, l_adjacent[i], len_sq_other, limit_len);
+          long_edge_queue_edge_add_recursive(q,
+                                             candidates,
+                                             l_adjacent[i]->radial_next,
+                                             l_adjacent[i],
+                                             len_sq_other,
+                                             limit_len);
         }
       }
     } while ((l_iter = l_iter->radial_next) != l_end);
@@ -927,69 +973,135 @@ static void long_edge_queue_edge_add_recursive(
 }
 #endif /* USE_EDGEQUEUE_EVEN_SUBDIV */
 
-static void short_edge_queue_edge_add(EdgeQueueContext *eq_ctx, BMEdge *e)
+static void short_edge_queue_edge_add(const EdgeQueue *q,
+                                      EdgeQueueCandidates *candidates,
+                                      BMEdge *e)
 {
-#ifdef USE_EDGEQUEUE_TAG
-  if (EDGE_QUEUE_TEST(e) == false)
-#endif
-  {
-    const float len_sq = BM_edge_calc_length_squared(e);
-    if (len_sq < eq_ctx->q->limit_len_squared) {
-      edge_queue_insert(eq_ctx, e, len_sq);
-    }
+  const float len_sq = BM_edge_calc_length_squared(e);
+  if (len_sq < q->limit_len_squared) {
+    edge_queue_candidate_add(candidates, e, len_sq);
   }
 }
 
-static void long_edge_queue_face_add(EdgeQueueContext *eq_ctx, BMFace *f)
+static void long_edge_queue_face_add(const EdgeQueue *q,
+                                     EdgeQueueCandidates *candidates,
+                                     BMFace *f)
 {
 #ifdef USE_EDGEQUEUE_FRONTFACE
-  if (eq_ctx->q->use_view_normal) {
-    if (dot_v3v3(f->no, eq_ctx->q->view_normal) < 0.0f) {
+  if (q->use_view_normal) {
+    if (dot_v3v3(f->no, q->view_normal) < 0.0f) {
       return;
     }
   }
 #endif
 
-  if (eq_ctx->q->edge_queue_tri_in_range(eq_ctx->q, f)) {
+  if (q->edge_queue_tri_in_range(q, f)) {
     /* Check each edge of the face */
     BMLoop *l_first = BM_FACE_FIRST_LOOP(f);
     BMLoop *l_iter = l_first;
     do {
 #ifdef USE_EDGEQUEUE_EVEN_SUBDIV
       const float len_sq = BM_edge_calc_length_squared(l_iter->e);
-      if (len_sq > eq_ctx->q->limit_len_squared) {
+      if (len_sq > q->limit_len_squared) {
         long_edge_queue_edge_add_recursive(
-            eq_ctx, l_iter->radial_next, l_iter, len_sq, eq_ctx->q->limit_len);
+            q, candidates, l_iter->radial_next, l_iter, len_sq, q->limit_len);
       }
 #else
-      long_edge_queue_edge_add(eq_ctx, l_iter->e);
+      long_edge_queue_edge_add(q, candidates, l_iter->e);
 #endif
     } while ((l_iter = l_iter->next) != l_first);
   }
 }
 
-static void short_edge_queue_face_add(EdgeQueueContext *eq_ctx, BMFace *f)
+static void short_edge_queue_face_add(const EdgeQueue *q,
+                                      EdgeQueueCandidates *candidates,
+                                      BMFace *f)
 {
 #ifdef USE_EDGEQUEUE_FRONTFACE
-  if (eq_ctx->q->use_view_normal) {
-    if (dot_v3v3(f->no, eq_ctx->q->view_normal) < 0.0f) {
+  if (q->use_view_normal) {
+    if (dot_v3v3(f->no, q->view_normal) < 0.0f) {
       return;
     }
   }
 #endif
 
-  if (eq_ctx->q->edge_queue_tri_in_range(eq_ctx->q, f)) {
+  if (q->edge_queue_tri_in_range(q, f)) {
     BMLoop *l_iter;
     BMLoop *l_first;
 
     /* Check each edge of the face */
     l_iter = l_first = BM_FACE_FIRST_LOOP(f);
     do {
-      short_edge_queue_edge_add(eq_ctx, l_iter->e);
+      short_edge_queue_edge_add(q, candidates, l_iter->e);
     } while ((l_iter = l_iter->next) != l_first);
   }
 }
 
+typedef struct EdgeQueueNodesData {
+  const EdgeQueue *q;
+  PBVHNode **nodes;
+  EdgeQueueCandidates *candidates;
+  bool use_long_edges;
+} EdgeQueueNodesData;
+
+static void edge_queue_nodes_task_cb(void *__restrict userdata,
+                                     const int n,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EdgeQueueNodesData *data = userdata;
+  EdgeQueueCandidates *candidates = &data->candidates[n];
+  GSetIterator gs_iter;
+
+  /* Check each face */
+  GSET_ITER (gs_iter, data->nodes[n]->bm_faces) {
+    BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
+
+    if (data->use_long_edges) {
+      long_edge_queue_face_add(data->q, candidates, f);
+    }
+    else {
+      short_edge_queue_face_add(data->q, candidates, f);
+    }
+  }
+}
+
+/* Scan leaf nodes marked for topology update in parallel, then insert the found edges. */
+static void edge_queue_nodes_add(EdgeQueueContext *eq_ctx, PBVH *pbvh, const bool use_long_edges)
+{
+  PBVHNode **nodes = MEM_mallocN(sizeof(*nodes) * (size_t)max_ii(pbvh->totnode, 1), __func__);
+  int totnode = 0;
+
+  for (int n = 0; n < pbvh->totnode; n++) {
+    PBVHNode *node = &pbvh->nodes[n];
+
+    /* Check leaf nodes marked for topology update */
+    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
+        !(node->flag & PBVH_FullyHidden)) {
+      nodes[totnode++] = node;
+    }
+  }
+
+  EdgeQueueNodesData data = {
+      .q = eq_ctx->q,
+      .nodes = nodes,
+      .candidates = MEM_callocN(sizeof(EdgeQueueCandidates) * (size_t)max_ii(totnode, 1),
+                                __func__),
+      .use_long_edges = use_long_edges,
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, totnode);
+  BLI_task_parallel_range(0, totnode, &data, edge_queue_nodes_task_cb, &settings);
+
+  for (int n = 0; n < totnode; n++) {
+    edge_queue_candidates_insert(eq_ctx, &data.candidates[n]);
+    MEM_SAFE_FREE(data.candidates[n].data);
+  }
+
+  MEM_freeN(data.candidates);
+  MEM_freeN(nodes);
+}
+
 /* Create a priority queue containing vertex pairs connected by a long
  * edge as defined by PBVH.bm_max_edge_len.
  *
@@ -1035,22 +1147,7 @@ static void long_edge_queue_create(EdgeQueueContext *eq_ctx,
   pbvh_bmesh_edge_tag_verify(pbvh);
 #endif
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        long_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_nodes_add(eq_ctx, pbvh, true);
 }
 
 /* Create a priority queue containing vertex pairs connected by a
@@ -1094,22 +1191,7 @@ static void short_edge_queue_create(EdgeQueueContext *eq_ctx,
     eq_ctx->q->edge_queue_tri_in_range = edge_queue_tri_in_sphere;
   }
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        short_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_nodes_add(eq_ctx, pbvh, false);
 }
 
 /*************************** Topology update **************************/
@@ -1199,7 +1281,8 @@ static void pbvh_bmesh_split_edge(EdgeQueueContext *eq_ctx,
     v_tri[2] = v_opp;
     bm_edges_from_tri(pbvh->bm, v_tri, e_tri);
     f_new = pbvh_bmesh_face_create(pbvh, ni, v_tri, e_tri, f_adj);
-    long_edge_queue_face_add(eq_ctx, f_new);
+    long_edge_queue_face_add(eq_ctx->q, &eq_ctx->candidates, f_new);
+    edge_queue_candidates_insert(eq_ctx, &eq_ctx->candidates);
 
     v_tri[0] = v_new;
     v_tri[1] = v2;
@@ -1208,7 +1291,8 @@ static void pbvh_bmesh_split_edge(EdgeQueueContext *eq_ctx,
     e_tri[2] = e_tri[1]; /* switched */
     e_tri[1] = BM_edge_create(pbvh->bm, v_tri[1], v_tri[2], NULL, BM_CREATE_NO_DOUBLE);
     f_new = pbvh_bmesh_face_create(pbvh, ni, v_tri, e_tri, f_adj);
-    long_edge_queue_face_add(eq_ctx, f_new);
+    long_edge_queue_face_add(eq_ctx->q, &eq_ctx->candidates, f_new);
+    edge_queue_candidates_insert(eq_ctx, &eq_ctx->candidates);
 
     /* Delete original */
     pbvh_bmesh_face_remove(pbvh, f_adj);
@@ -1224,8 +1308,9 @@ static void pbvh_bmesh_split_edge(EdgeQueueContext *eq_ctx,
       BMEdge *e2;
 
       BM_ITER_ELEM (e2, &bm_iter, v_opp, BM_EDGES_OF_VERT) {
-        long_edge_queue_edge_add(eq_ctx, e2);
+        long_edge_queue_edge_add(eq_ctx->q, &eq_ctx->candidates, e2);
       }
+      edge_queue_candidates_insert(eq_ctx, &eq_ctx->candidates);
     }
   }
 
@@ -1656,27 +1741,66 @@ bool pbvh_bmesh_node_nearest_to_ray(PBVHNode *node,
   return hit;
 }
 
-void pbvh_bmesh_normals_update(PBVHNode **nodes, int totnode)
+static void pbvh_bmesh_normals_update_faces_task_cb(void *__restrict userdata,
+                                                    const int n,
+                                                    const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  for (int n = 0; n < totnode; n++) {
-    PBVHNode *node = nodes[n];
+  PBVHNode *node = ((PBVHNode **)userdata)[n];
 
-    if (node->flag & PBVH_UpdateNormals) {
-      GSetIterator gs_iter;
+  if (node->flag & PBVH_UpdateNormals) {
+    GSetIterator gs_iter;
 
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BM_face_normal_update(BLI_gsetIterator_getKey(&gs_iter));
-      }
-      GSET_ITER (gs_iter, node->bm_unique_verts) {
-        BM_vert_normal_update(BLI_gsetIterator_getKey(&gs_iter));
-      }
-      /* This should be unneeded normally */
-      GSET_ITER (gs_iter, node->bm_other_verts) {
-        BM_vert_normal_update(BLI_gsetIterator_getKey(&gs_iter));
+    GSET_ITER (gs_iter, node->bm_faces) {
+      BM_face_normal_update(BLI_gsetIterator_getKey(&gs_iter));
+    }
+  }
+}
+
+static void pbvh_bmesh_normals_update_verts_task_cb(void *__restrict userdata,
+                                                    const int n,
+                                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHNode *node = ((PBVHNode **)userdata)[n];
+
+  if (node->flag & PBVH_UpdateNormals) {
+    GSetIterator gs_iter;
+
+    GSET_ITER (gs_iter, node->bm_unique_verts) {
+      BM_vert_normal_update(BLI_gsetIterator_getKey(&gs_iter));
+    }
+  }
+}
+
+/* Faces belong to a single node, so nodes are updated in parallel. Vertex normals use faces of
+ * neighbor nodes, they are updated once all face normals are.
+ *
+ * Only unique vertices are updated in parallel, other vertices of a node are unique to another
+ * node which might be updated at the same time. They are updated afterwards, when that node is
+ * not updated already. */
+void pbvh_bmesh_normals_update(PBVH *pbvh, PBVHNode **nodes, int totnode)
+{
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, totnode);
+  BLI_task_parallel_range(0, totnode, nodes, pbvh_bmesh_normals_update_faces_task_cb, &settings);
+  BLI_task_parallel_range(0, totnode, nodes, pbvh_bmesh_normals_update_verts_task_cb, &settings);
+
+  for (int n = 0; n < totnode; n++) {
+    PBVHNode *node = nodes[n];
+    if (!(node->flag & PBVH_UpdateNormals)) {
+      continue;
+    }
+    GSetIterator gs_iter;
+    GSET_ITER (gs_iter, node->bm_other_verts) {
+      BMVert *v = BLI_gsetIterator_getKey(&gs_iter);
+      if (!(pbvh_bmesh_node_from_vert(pbvh, v)->flag & PBVH_UpdateNormals)) {
+        BM_vert_normal_update(v);
       }
-      node->flag &= ~PBVH_UpdateNormals;
     }
   }
+
+  for (int n = 0; n < totnode; n++) {
+    nodes[n]->flag &= ~PBVH_UpdateNormals;
+  }
 }
 
 struct FastNodeBuildInfo {
@@ -1893,7 +2017,7 @@ void BKE_pbvh_build_bmesh(PBVH *pbvh,
   pbvh->bm_log = log;
 
   /* TODO: choose leaf limit better */
-  pbvh->leaf_limit = 100;
+  pbvh->leaf_limit = (pbvh->build_leaf_limit > 0) ? pbvh->build_leaf_limit : 100;
 
   if (smooth_shading) {
     pbvh->flags |= PBVH_DYNTOPO_SMOOTH_SHADING;
@@ -1992,6 +2116,7 @@ bool BKE_pbvh_bmesh_update_topology(PBVH *pbvh,
     modified |= pbvh_bmesh_collapse_short_edges(&eq_ctx, pbvh, &deleted_faces);
     BLI_heapsimple_free(q.heap, NULL);
     BLI_mempool_destroy(queue_pool);
+    MEM_SAFE_FREE(eq_ctx.candidates.data);
   }
 
   if (mode & PBVH_Subdivide) {
@@ -2011,6 +2136,7 @@ bool BKE_pbvh_bmesh_update_topology(PBVH *pbvh,
     modified |= pbvh_bmesh_subdivide_long_edges(&eq_ctx, pbvh, &edge_loops);
     BLI_heapsimple_free(q.heap, NULL);
     BLI_mempool_destroy(queue_pool);
+    MEM_SAFE_FREE(eq_ctx.candidates.data);
   }
 
   /* Unmark nodes */
@@ -127,6 +127,8 @@ struct PBVH {
   int totvert;
 
   int leaf_limit;
+  /** Leaf limit requested for the next build, see #BKE_pbvh_build_leaf_limit_set. */
+  int build_leaf_limit;
 
   /* Mesh data */
   const struct Mesh *mesh;
@@ -150,10 +152,6 @@ struct PBVH {
   int totgrid;
   BLI_bitmap **grid_hidden;
 
-  /* Only used during BVH build and update,
-   * don't need to remain valid after */
-  BLI_bitmap *vert_bitmap;
-
 #ifdef PERFCNTRS
   int perf_modified;
 #endif
@@ -233,4 +231,4 @@ bool pbvh_bmesh_node_nearest_to_ray(PBVHNode *node,
                                     float *dist_sq,
                                     bool use_original);
 
-void pbvh_bmesh_normals_update(PBVHNode **nodes, int totnode);
+void pbvh_bmesh_normals_update(PBVH *pbvh, PBVHNode **nodes, int totnode);
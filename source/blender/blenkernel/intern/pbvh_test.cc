@@ -0,0 +1,175 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_bitmap.h"
+#include "BLI_ghash.h"
+#include "BLI_math.h"
+#include "BLI_task.h"
+
+#include "BKE_ccg.h"
+#include "BKE_mesh.h"
+#include "BKE_pbvh.h"
+
+extern "C" {
+#include "pbvh_intern.h"
+}
+
+namespace blender::bke::tests {
+
+/* A wavy grid of `size * size` quads. */
+struct GridMesh {
+  Mesh mesh = {};
+  Array<MVert> verts;
+  Array<MLoop> loops;
+  Array<MPoly> polys;
+  Array<MLoopTri> looptris;
+
+  GridMesh(const int size)
+      : verts((size + 1) * (size + 1)),
+        loops(size * size * 4),
+        polys(size * size),
+        looptris(size * size * 2)
+  {
+    for (int y = 0; y <= size; y++) {
+      for (int x = 0; x <= size; x++) {
+        MVert &mv = verts[y * (size + 1) + x];
+        mv = {};
+        mv.co[0] = (float)x;
+        mv.co[1] = (float)y;
+        mv.co[2] = 5.0f * sinf(x * 0.1f) * cosf(y * 0.13f);
+      }
+    }
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        const int i = y * size + x;
+        const uint v = (uint)(y * (size + 1) + x);
+        polys[i] = {};
+        polys[i].loopstart = i * 4;
+        polys[i].totloop = 4;
+        const uint quad[4] = {v, v + 1, v + size + 2, v + size + 1};
+        for (int j = 0; j < 4; j++) {
+          loops[i * 4 + j] = {quad[j], 0};
+        }
+      }
+    }
+    BKE_mesh_recalc_looptri(loops.data(),
+                            polys.data(),
+                            verts.data(),
+                            loops.size(),
+                            polys.size(),
+                            looptris.data());
+  }
+
+  PBVH *pbvh_build(const int leaf_limit)
+  {
+    /* Owned by the PBVH. */
+    MLoopTri *pbvh_looptris = static_cast<MLoopTri *>(
+        MEM_malloc_arrayN(looptris.size(), sizeof(MLoopTri), __func__));
+    memcpy(pbvh_looptris, looptris.data(), sizeof(MLoopTri) * looptris.size());
+
+    PBVH *pbvh = BKE_pbvh_new();
+    BKE_pbvh_build_leaf_limit_set(pbvh, leaf_limit);
+    BKE_pbvh_build_mesh(pbvh,
+                        &mesh,
+                        polys.data(),
+                        loops.data(),
+                        verts.data(),
+                        verts.size(),
+                        nullptr,
+                        nullptr,
+                        nullptr,
+                        pbvh_looptris,
+                        looptris.size());
+    return pbvh;
+  }
+};
+
+static bool bb_contains_bb(const BB &bb, const BB &bb_inner)
+{
+  for (int axis = 0; axis < 3; axis++) {
+    if (bb_inner.bmin[axis] < bb.bmin[axis] || bb_inner.bmax[axis] > bb.bmax[axis]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool bb_contains_co(const BB &bb, const float co[3])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    if (co[axis] < bb.bmin[axis] || co[axis] > bb.bmax[axis]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Every triangle is in exactly one leaf, which contains it, and every vertex is unique to exactly
+ * one leaf. Bounds of nodes contain the bounds of their children. */
+TEST(pbvh, BuildMesh)
+{
+  BLI_task_scheduler_init();
+
+  GridMesh grid(160);
+  for (const int leaf_limit : {1, 64, 0}) {
+    PBVH *pbvh = grid.pbvh_build(leaf_limit);
+    const int leaf_limit_max = (leaf_limit > 0) ? leaf_limit : pbvh->leaf_limit;
+
+    Array<int> vert_leaves(grid.verts.size(), 0);
+    Array<int> tri_leaves(grid.looptris.size(), 0);
+    for (int i = 0; i < pbvh->totnode; i++) {
+      const PBVHNode &node = pbvh->nodes[i];
+      if (!(node.flag & PBVH_Leaf)) {
+        EXPECT_TRUE(bb_contains_bb(node.vb, pbvh->nodes[node.children_offset].vb));
+        EXPECT_TRUE(bb_contains_bb(node.vb, pbvh->nodes[node.children_offset + 1].vb));
+        continue;
+      }
+
+      EXPECT_GT(node.totprim, 0u);
+      EXPECT_LE(node.totprim, (uint)leaf_limit_max);
+      for (uint j = 0; j < node.totprim; j++) {
+        const MLoopTri &lt = grid.looptris[node.prim_indices[j]];
+        tri_leaves[node.prim_indices[j]]++;
+        for (int k = 0; k < 3; k++) {
+          EXPECT_TRUE(bb_contains_co(node.vb, grid.verts[grid.loops[lt.tri[k]].v].co));
+        }
+      }
+      for (uint j = 0; j < node.uniq_verts; j++) {
+        vert_leaves[node.vert_indices[j]]++;
+      }
+    }
+
+    for (const int i : tri_leaves.index_range()) {
+      EXPECT_EQ(tri_leaves[i], 1);
+    }
+    for (const int i : vert_leaves.index_range()) {
+      EXPECT_EQ(vert_leaves[i], 1);
+    }
+
+    BKE_pbvh_free(pbvh);
+  }
+
+  BLI_task_scheduler_exit();
+}
+
+}  // namespace blender::bke::tests
@@ -99,6 +99,21 @@ typedef struct ShrinkwrapCalcCBData {
 
   float *proj_axis;
   SpaceTransform *local2aux;
+
+  /* Used by batched nearest queries. */
+  float (*tree_cos)[3];
+  float *weights;
+  BVHTreeNearest *nearest;
+
+  /* Used by batched normal projection. */
+  const struct ShrinkwrapProjectPass *pass;
+  float (*proj_cos)[3];
+  float (*proj_nos)[3];
+  float (*ray_cos)[3];
+  float (*ray_dirs)[3];
+  BVHTreeRayHit *hits;
+  BVHTreeRayHit *ray_hits;
+  bool *hits_is_aux;
 } ShrinkwrapCalcCBData;
 
 /* Checks if the modifier needs target normals with these settings. */
@@ -346,55 +361,91 @@ void BKE_shrinkwrap_compute_boundary_data(struct Mesh *mesh)
 }
 
 /**
- * Shrink-wrap to the nearest vertex
- *
- * it builds a #BVHTree of vertices we can attach to and then
- * for each vertex performs a nearest vertex search on the tree
+ * Convert the vertices to target space and initialize the batched nearest queries,
+ * vertices without influence get a zero search distance so they're skipped.
  */
-static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
-                                                 const int i,
-                                                 const TaskParallelTLS *__restrict tls)
+static void shrinkwrap_calc_tree_coords_cb_ex(void *__restrict userdata,
+                                              const int i,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
 {
   ShrinkwrapCalcCBData *data = userdata;
 
   ShrinkwrapCalcData *calc = data->calc;
-  BVHTreeFromMesh *treeData = &data->tree->treeData;
-  BVHTreeNearest *nearest = tls->userdata_chunk;
+  BVHTreeNearest *nearest = &data->nearest[i];
 
-  float *co = calc->vertexCos[i];
-  float tmp_co[3];
+  float *tmp_co = data->tree_cos[i];
   float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
 
   if (calc->invert_vgroup) {
     weight = 1.0f - weight;
   }
 
-  if (weight == 0.0f) {
-    return;
-  }
+  data->weights[i] = weight;
+  nearest->index = -1;
+  nearest->dist_sq = (weight == 0.0f) ? 0.0f : FLT_MAX;
 
   /* Convert the vertex to tree coordinates */
   if (calc->vert) {
     copy_v3_v3(tmp_co, calc->vert[i].co);
   }
   else {
-    copy_v3_v3(tmp_co, co);
+    copy_v3_v3(tmp_co, calc->vertexCos[i]);
   }
   BLI_space_transform_apply(&calc->local2target, tmp_co);
+}
 
-  /* Use local proximity heuristics (to reduce the nearest search)
-   *
-   * If we already had an hit before.. we assume this vertex is going to have a close hit to that
-   * other vertex so we can initiate the "nearest.dist" with the expected value to that last hit.
-   * This will lead in pruning of the search tree. */
-  if (nearest->index != -1) {
-    nearest->dist_sq = len_squared_v3v3(tmp_co, nearest->co);
-  }
-  else {
-    nearest->dist_sq = FLT_MAX;
-  }
+/**
+ * Run the nearest queries for all vertices at once, see #BLI_bvhtree_find_nearest_batch.
+ * The results are stored in `data->nearest`, `data->tree_cos` and `data->weights`.
+ */
+static void shrinkwrap_calc_nearest_batch(ShrinkwrapCalcCBData *data)
+{
+  ShrinkwrapCalcData *calc = data->calc;
+  BVHTreeFromMesh *treeData = &data->tree->treeData;
 
-  BLI_bvhtree_find_nearest(treeData->tree, tmp_co, nearest, treeData->nearest_callback, treeData);
+  data->tree_cos = MEM_mallocN(sizeof(*data->tree_cos) * (size_t)calc->numVerts, __func__);
+  data->weights = MEM_mallocN(sizeof(*data->weights) * (size_t)calc->numVerts, __func__);
+  data->nearest = MEM_mallocN(sizeof(*data->nearest) * (size_t)calc->numVerts, __func__);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
+  BLI_task_parallel_range(0, calc->numVerts, data, shrinkwrap_calc_tree_coords_cb_ex, &settings);
+
+  BLI_bvhtree_find_nearest_batch(data->tree->bvh,
+                                 (const float(*)[3])data->tree_cos,
+                                 calc->numVerts,
+                                 data->nearest,
+                                 treeData->nearest_callback,
+                                 treeData,
+                                 0);
+}
+
+static void shrinkwrap_calc_nearest_batch_free(ShrinkwrapCalcCBData *data)
+{
+  MEM_SAFE_FREE(data->tree_cos);
+  MEM_SAFE_FREE(data->weights);
+  MEM_SAFE_FREE(data->nearest);
+}
+
+/**
+ * Shrink-wrap to the nearest vertex
+ *
+ * it builds a #BVHTree of vertices we can attach to and then
+ * performs a nearest vertex search on the tree for all vertices at once
+ */
+static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
+                                                 const int i,
+                                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapCalcCBData *data = userdata;
+
+  ShrinkwrapCalcData *calc = data->calc;
+  const BVHTreeNearest *nearest = &data->nearest[i];
+
+  float *co = calc->vertexCos[i];
+  float tmp_co[3];
+  float weight = data->weights[i];
 
   /* Found the nearest vertex */
   if (nearest->index != -1) {
@@ -415,86 +466,56 @@ static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
 
 static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
 {
-  BVHTreeNearest nearest = NULL_BVHTreeNearest;
-
-  /* Setup nearest */
-  nearest.index = -1;
-  nearest.dist_sq = FLT_MAX;
-
   ShrinkwrapCalcCBData data = {
       .calc = calc,
       .tree = calc->tree,
   };
+
+  shrinkwrap_calc_nearest_batch(&data);
+
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
-  settings.userdata_chunk = &nearest;
-  settings.userdata_chunk_size = sizeof(nearest);
   BLI_task_parallel_range(
       0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_cb_ex, &settings);
+
+  shrinkwrap_calc_nearest_batch_free(&data);
 }
 
-/*
- * This function raycast a single vertex and updates the hit if the "hit" is considered valid.
- * Returns true if "hit" was updated.
- * Opts control whether an hit is valid or not
- * Supported options are:
- * - MOD_SHRINKWRAP_CULL_TARGET_FRONTFACE (front faces hits are ignored)
- * - MOD_SHRINKWRAP_CULL_TARGET_BACKFACE (back faces hits are ignored)
- */
-bool BKE_shrinkwrap_project_normal(char options,
-                                   const float vert[3],
-                                   const float dir[3],
-                                   const float ray_radius,
-                                   const SpaceTransform *transf,
-                                   ShrinkwrapTreeData *tree,
-                                   BVHTreeRayHit *hit)
+/* Ray of #BKE_shrinkwrap_project_normal in the space of the tree. */
+static void shrinkwrap_project_normal_ray(const float vert[3],
+                                          const float dir[3],
+                                          const SpaceTransform *transf,
+                                          float r_co[3],
+                                          float r_no[3])
 {
-  /* don't use this because this dist value could be incompatible
-   * this value used by the callback for comparing previous/new dist values.
-   * also, at the moment there is no need to have a corrected 'dist' value */
-  // #define USE_DIST_CORRECT
-
-  float tmp_co[3], tmp_no[3];
-  const float *co, *no;
-  BVHTreeRayHit hit_tmp;
-
-  /* Copy from hit (we need to convert hit rays from one space coordinates to the other */
-  memcpy(&hit_tmp, hit, sizeof(hit_tmp));
+  copy_v3_v3(r_co, vert);
+  copy_v3_v3(r_no, dir);
 
   /* Apply space transform (TODO readjust dist) */
   if (transf) {
-    copy_v3_v3(tmp_co, vert);
-    BLI_space_transform_apply(transf, tmp_co);
-    co = tmp_co;
-
-    copy_v3_v3(tmp_no, dir);
-    BLI_space_transform_apply_normal(transf, tmp_no);
-    no = tmp_no;
-
-#ifdef USE_DIST_CORRECT
-    hit_tmp.dist *= mat4_to_scale(((SpaceTransform *)transf)->local2target);
-#endif
+    BLI_space_transform_apply(transf, r_co);
+    BLI_space_transform_apply_normal(transf, r_no);
   }
-  else {
-    co = vert;
-    no = dir;
-  }
-
-  hit_tmp.index = -1;
-
-  BLI_bvhtree_ray_cast(
-      tree->bvh, co, no, ray_radius, &hit_tmp, tree->treeData.raycast_callback, &tree->treeData);
+}
 
-  if (hit_tmp.index != -1) {
+/* Update `hit` from the ray cast result `hit_tmp` of #BKE_shrinkwrap_project_normal
+ * when it is considered valid, `hit_tmp` is modified. */
+static bool shrinkwrap_project_normal_hit(char options,
+                                          const float dir[3],
+                                          const SpaceTransform *transf,
+                                          BVHTreeRayHit *hit_tmp,
+                                          BVHTreeRayHit *hit)
+{
+  if (hit_tmp->index != -1) {
     /* invert the normal first so face culling works on rotated objects */
     if (transf) {
-      BLI_space_transform_invert_normal(transf, hit_tmp.no);
+      BLI_space_transform_invert_normal(transf, hit_tmp->no);
     }
 
     if (options & MOD_SHRINKWRAP_CULL_TARGET_MASK) {
       /* apply backface */
-      const float dot = dot_v3v3(dir, hit_tmp.no);
+      const float dot = dot_v3v3(dir, hit_tmp->no);
       if (((options & MOD_SHRINKWRAP_CULL_TARGET_FRONTFACE) && dot <= 0.0f) ||
           ((options & MOD_SHRINKWRAP_CULL_TARGET_BACKFACE) && dot >= 0.0f)) {
         return false; /* Ignore hit */
@@ -503,104 +524,185 @@ bool BKE_shrinkwrap_project_normal(char options,
 
     if (transf) {
       /* Inverting space transform (TODO make coeherent with the initial dist readjust) */
-      BLI_space_transform_invert(transf, hit_tmp.co);
-#ifdef USE_DIST_CORRECT
-      hit_tmp.dist = len_v3v3(vert, hit_tmp.co);
-#endif
+      BLI_space_transform_invert(transf, hit_tmp->co);
     }
 
-    BLI_assert(hit_tmp.dist <= hit->dist);
+    BLI_assert(hit_tmp->dist <= hit->dist);
 
-    memcpy(hit, &hit_tmp, sizeof(hit_tmp));
+    memcpy(hit, hit_tmp, sizeof(*hit_tmp));
     return true;
   }
   return false;
 }
 
-static void shrinkwrap_calc_normal_projection_cb_ex(void *__restrict userdata,
-                                                    const int i,
-                                                    const TaskParallelTLS *__restrict tls)
+/*
+ * This function raycast a single vertex and updates the hit if the "hit" is considered valid.
+ * Returns true if "hit" was updated.
+ * Opts control whether an hit is valid or not
+ * Supported options are:
+ * - MOD_SHRINKWRAP_CULL_TARGET_FRONTFACE (front faces hits are ignored)
+ * - MOD_SHRINKWRAP_CULL_TARGET_BACKFACE (back faces hits are ignored)
+ */
+bool BKE_shrinkwrap_project_normal(char options,
+                                   const float vert[3],
+                                   const float dir[3],
+                                   const float ray_radius,
+                                   const SpaceTransform *transf,
+                                   ShrinkwrapTreeData *tree,
+                                   BVHTreeRayHit *hit)
 {
-  ShrinkwrapCalcCBData *data = userdata;
+  float co[3], no[3];
+  BVHTreeRayHit hit_tmp;
 
-  ShrinkwrapCalcData *calc = data->calc;
-  ShrinkwrapTreeData *tree = data->tree;
-  ShrinkwrapTreeData *aux_tree = data->aux_tree;
+  /* Copy from hit (we need to convert hit rays from one space coordinates to the other */
+  memcpy(&hit_tmp, hit, sizeof(hit_tmp));
 
-  float *proj_axis = data->proj_axis;
-  SpaceTransform *local2aux = data->local2aux;
+  shrinkwrap_project_normal_ray(vert, dir, transf, co, no);
 
-  BVHTreeRayHit *hit = tls->userdata_chunk;
+  hit_tmp.index = -1;
 
-  const float proj_limit_squared = calc->smd->projLimit * calc->smd->projLimit;
-  float *co = calc->vertexCos[i];
-  float tmp_co[3], tmp_no[3];
+  BLI_bvhtree_ray_cast(
+      tree->bvh, co, no, ray_radius, &hit_tmp, tree->treeData.raycast_callback, &tree->treeData);
+
+  return shrinkwrap_project_normal_hit(options, dir, transf, &hit_tmp, hit);
+}
+
+/**
+ * One ray cast of every vertex, to a single target in a single direction.
+ */
+typedef struct ShrinkwrapProjectPass {
+  ShrinkwrapTreeData *tree;
+  const SpaceTransform *transf;
+  char options;
+  bool is_negative;
+  bool is_aux;
+} ShrinkwrapProjectPass;
+
+static void shrinkwrap_calc_normal_projection_init_cb_ex(
+    void *__restrict userdata, const int i, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapCalcCBData *data = userdata;
+  ShrinkwrapCalcData *calc = data->calc;
   float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
 
   if (calc->invert_vgroup) {
     weight = 1.0f - weight;
   }
-
-  if (weight == 0.0f) {
-    return;
-  }
+  data->weights[i] = weight;
 
   if (calc->vert != NULL && calc->smd->projAxis == MOD_SHRINKWRAP_PROJECT_OVER_NORMAL) {
     /* calc->vert contains verts from evaluated mesh. */
     /* These coordinates are deformed by vertexCos only for normal projection
      * (to get correct normals) for other cases calc->verts contains undeformed coordinates and
      * vertexCos should be used */
-    copy_v3_v3(tmp_co, calc->vert[i].co);
-    normal_short_to_float_v3(tmp_no, calc->vert[i].no);
+    copy_v3_v3(data->proj_cos[i], calc->vert[i].co);
+    normal_short_to_float_v3(data->proj_nos[i], calc->vert[i].no);
   }
   else {
-    copy_v3_v3(tmp_co, co);
-    copy_v3_v3(tmp_no, proj_axis);
+    copy_v3_v3(data->proj_cos[i], calc->vertexCos[i]);
+    copy_v3_v3(data->proj_nos[i], data->proj_axis);
   }
 
+  BVHTreeRayHit *hit = &data->hits[i];
   hit->index = -1;
-
   /* TODO: we should use FLT_MAX here, but sweepsphere code isn't prepared for that */
   hit->dist = BVH_RAYCAST_DIST_MAX;
+  data->hits_is_aux[i] = false;
+}
 
-  bool is_aux = false;
+static void shrinkwrap_calc_normal_projection_dir(const ShrinkwrapCalcCBData *data,
+                                                  const int i,
+                                                  float r_dir[3])
+{
+  if (data->pass->is_negative) {
+    negate_v3_v3(r_dir, data->proj_nos[i]);
+  }
+  else {
+    copy_v3_v3(r_dir, data->proj_nos[i]);
+  }
+}
 
-  /* Project over positive direction of axis */
-  if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_POS_DIR) {
-    if (aux_tree) {
-      if (BKE_shrinkwrap_project_normal(0, tmp_co, tmp_no, 0.0, local2aux, aux_tree, hit)) {
-        is_aux = true;
-      }
-    }
+static void shrinkwrap_calc_normal_projection_ray_cb_ex(
+    void *__restrict userdata, const int i, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapCalcCBData *data = userdata;
+  float dir[3];
+  shrinkwrap_calc_normal_projection_dir(data, i, dir);
+  shrinkwrap_project_normal_ray(
+      data->proj_cos[i], dir, data->pass->transf, data->ray_cos[i], data->ray_dirs[i]);
+
+  BVHTreeRayHit *hit_tmp = &data->ray_hits[i];
+  memcpy(hit_tmp, &data->hits[i], sizeof(*hit_tmp));
+  hit_tmp->index = -1;
+  /* Skip the ray of vertices which aren't affected. */
+  if (data->weights[i] == 0.0f) {
+    hit_tmp->dist = 0.0f;
+  }
+}
 
-    if (BKE_shrinkwrap_project_normal(
-            calc->smd->shrinkOpts, tmp_co, tmp_no, 0.0, &calc->local2target, tree, hit)) {
-      is_aux = false;
-    }
+static void shrinkwrap_calc_normal_projection_hit_cb_ex(
+    void *__restrict userdata, const int i, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapCalcCBData *data = userdata;
+  const ShrinkwrapProjectPass *pass = data->pass;
+  float dir[3];
+  shrinkwrap_calc_normal_projection_dir(data, i, dir);
+  if (shrinkwrap_project_normal_hit(
+          pass->options, dir, pass->transf, &data->ray_hits[i], &data->hits[i])) {
+    data->hits_is_aux[i] = pass->is_aux;
   }
+}
 
-  /* Project over negative direction of axis */
-  if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_NEG_DIR) {
-    float inv_no[3];
-    negate_v3_v3(inv_no, tmp_no);
+/**
+ * Run the ray casts of a pass for all vertices at once, see #BLI_bvhtree_ray_cast_batch.
+ * Casting the passes in the order #BKE_shrinkwrap_project_normal is called for each vertex
+ * gives the same hits.
+ */
+static void shrinkwrap_calc_normal_projection_pass(ShrinkwrapCalcCBData *data,
+                                                   const ShrinkwrapProjectPass *pass,
+                                                   const TaskParallelSettings *settings)
+{
+  ShrinkwrapCalcData *calc = data->calc;
+  data->pass = pass;
 
-    char options = calc->smd->shrinkOpts;
+  BLI_task_parallel_range(
+      0, calc->numVerts, data, shrinkwrap_calc_normal_projection_ray_cb_ex, settings);
+  BLI_bvhtree_ray_cast_batch(pass->tree->bvh,
+                             (const float(*)[3])data->ray_cos,
+                             (const float(*)[3])data->ray_dirs,
+                             calc->numVerts,
+                             0.0f,
+                             data->ray_hits,
+                             pass->tree->treeData.raycast_callback,
+                             &pass->tree->treeData,
+                             BVH_RAYCAST_DEFAULT);
+  BLI_task_parallel_range(
+      0, calc->numVerts, data, shrinkwrap_calc_normal_projection_hit_cb_ex, settings);
 
-    if ((options & MOD_SHRINKWRAP_INVERT_CULL_TARGET) &&
-        (options & MOD_SHRINKWRAP_CULL_TARGET_MASK)) {
-      options ^= MOD_SHRINKWRAP_CULL_TARGET_MASK;
-    }
+  data->pass = NULL;
+}
 
-    if (aux_tree) {
-      if (BKE_shrinkwrap_project_normal(0, tmp_co, inv_no, 0.0, local2aux, aux_tree, hit)) {
-        is_aux = true;
-      }
-    }
+static void shrinkwrap_calc_normal_projection_cb_ex(void *__restrict userdata,
+                                                    const int i,
+                                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapCalcCBData *data = userdata;
 
-    if (BKE_shrinkwrap_project_normal(
-            options, tmp_co, inv_no, 0.0, &calc->local2target, tree, hit)) {
-      is_aux = false;
-    }
+  ShrinkwrapCalcData *calc = data->calc;
+  ShrinkwrapTreeData *tree = data->tree;
+  ShrinkwrapTreeData *aux_tree = data->aux_tree;
+
+  SpaceTransform *local2aux = data->local2aux;
+
+  BVHTreeRayHit *hit = &data->hits[i];
+
+  const float proj_limit_squared = calc->smd->projLimit * calc->smd->projLimit;
+  float *co = calc->vertexCos[i];
+  const float *tmp_co = data->proj_cos[i];
+  const float weight = data->weights[i];
+
+  if (weight == 0.0f) {
+    return;
   }
 
   /* don't set the initial dist (which is more efficient),
@@ -612,7 +714,7 @@ static void shrinkwrap_calc_normal_projection_cb_ex(void *__restrict userdata,
   }
 
   if (hit->index != -1) {
-    if (is_aux) {
+    if (data->hits_is_aux[i]) {
       BKE_shrinkwrap_snap_point_to_surface(aux_tree,
                                            local2aux,
                                            calc->smd->shrinkMode,
@@ -646,11 +748,6 @@ static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc)
 
   /* Raycast and tree stuff */
 
-  /** \note 'hit.dist' is kept in the targets space, this is only used
-   * for finding the best hit, to get the real dist,
-   * measure the len_v3v3() from the input coord to hit.co */
-  BVHTreeRayHit hit;
-
   /* auxiliary target */
   Mesh *auxMesh = NULL;
   ShrinkwrapTreeData *aux_tree = NULL;
@@ -712,15 +809,58 @@ static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc)
       .proj_axis = proj_axis,
       .local2aux = &local2aux,
   };
+  const size_t verts_num = (size_t)calc->numVerts;
+  data.weights = MEM_mallocN(sizeof(*data.weights) * verts_num, __func__);
+  data.proj_cos = MEM_mallocN(sizeof(*data.proj_cos) * verts_num, __func__);
+  data.proj_nos = MEM_mallocN(sizeof(*data.proj_nos) * verts_num, __func__);
+  data.ray_cos = MEM_mallocN(sizeof(*data.ray_cos) * verts_num, __func__);
+  data.ray_dirs = MEM_mallocN(sizeof(*data.ray_dirs) * verts_num, __func__);
+  /** \note 'hit.dist' is kept in the targets space, this is only used
+   * for finding the best hit, to get the real dist,
+   * measure the len_v3v3() from the input coord to hit.co */
+  data.hits = MEM_mallocN(sizeof(*data.hits) * verts_num, __func__);
+  data.ray_hits = MEM_mallocN(sizeof(*data.ray_hits) * verts_num, __func__);
+  data.hits_is_aux = MEM_mallocN(sizeof(*data.hits_is_aux) * verts_num, __func__);
+
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
-  settings.userdata_chunk = &hit;
-  settings.userdata_chunk_size = sizeof(hit);
+  BLI_task_parallel_range(
+      0, calc->numVerts, &data, shrinkwrap_calc_normal_projection_init_cb_ex, &settings);
+
+  /* Project over positive direction of axis, then over the negative direction. */
+  char options_neg = calc->smd->shrinkOpts;
+  if ((options_neg & MOD_SHRINKWRAP_INVERT_CULL_TARGET) &&
+      (options_neg & MOD_SHRINKWRAP_CULL_TARGET_MASK)) {
+    options_neg ^= MOD_SHRINKWRAP_CULL_TARGET_MASK;
+  }
+  const ShrinkwrapProjectPass passes[] = {
+      {aux_tree, &local2aux, 0, false, true},
+      {calc->tree, &calc->local2target, calc->smd->shrinkOpts, false, false},
+      {aux_tree, &local2aux, 0, true, true},
+      {calc->tree, &calc->local2target, options_neg, true, false},
+  };
+  for (int i = 0; i < (int)ARRAY_SIZE(passes); i++) {
+    const ShrinkwrapProjectPass *pass = &passes[i];
+    const char dir_flag = pass->is_negative ? MOD_SHRINKWRAP_PROJECT_ALLOW_NEG_DIR :
+                                              MOD_SHRINKWRAP_PROJECT_ALLOW_POS_DIR;
+    if (pass->tree && (calc->smd->shrinkOpts & dir_flag)) {
+      shrinkwrap_calc_normal_projection_pass(&data, pass, &settings);
+    }
+  }
+
   BLI_task_parallel_range(
       0, calc->numVerts, &data, shrinkwrap_calc_normal_projection_cb_ex, &settings);
 
   /* free data structures */
+  MEM_freeN(data.weights);
+  MEM_freeN(data.proj_cos);
+  MEM_freeN(data.proj_nos);
+  MEM_freeN(data.ray_cos);
+  MEM_freeN(data.ray_dirs);
+  MEM_freeN(data.hits);
+  MEM_freeN(data.ray_hits);
+  MEM_freeN(data.hits_is_aux);
   if (aux_tree) {
     BKE_shrinkwrap_free_tree(aux_tree);
   }
@@ -1382,8 +1522,60 @@ void BKE_shrinkwrap_snap_point_to_surface(const struct ShrinkwrapTreeData *tree,
   }
 }
 
+/**
+ * Batched version of #shrinkwrap_calc_nearest_surface_point_cb_ex,
+ * applying the results of #shrinkwrap_calc_nearest_batch.
+ */
+static void shrinkwrap_calc_nearest_surface_point_batch_cb_ex(
+    void *__restrict userdata, const int i, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapCalcCBData *data = userdata;
+
+  ShrinkwrapCalcData *calc = data->calc;
+  const BVHTreeNearest *nearest = &data->nearest[i];
+
+  float *co = calc->vertexCos[i];
+  float *tmp_co = data->tree_cos[i];
+
+  /* Found the nearest vertex */
+  if (nearest->index != -1) {
+    BKE_shrinkwrap_snap_point_to_surface(data->tree,
+                                         NULL,
+                                         calc->smd->shrinkMode,
+                                         nearest->index,
+                                         nearest->co,
+                                         nearest->no,
+                                         calc->keepDist,
+                                         tmp_co,
+                                         tmp_co);
+
+    /* Convert the coordinates back to mesh coordinates */
+    BLI_space_transform_invert(&calc->local2target, tmp_co);
+    interp_v3_v3v3(co, co, tmp_co, data->weights[i]); /* linear interpolation */
+  }
+}
+
 static void shrinkwrap_calc_nearest_surface_point(ShrinkwrapCalcData *calc)
 {
+  if (calc->smd->shrinkType != MOD_SHRINKWRAP_TARGET_PROJECT) {
+    /* Plain nearest surface queries can all run at once. */
+    ShrinkwrapCalcCBData data = {
+        .calc = calc,
+        .tree = calc->tree,
+    };
+
+    shrinkwrap_calc_nearest_batch(&data);
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
+    BLI_task_parallel_range(
+        0, calc->numVerts, &data, shrinkwrap_calc_nearest_surface_point_batch_cb_ex, &settings);
+
+    shrinkwrap_calc_nearest_batch_free(&data);
+    return;
+  }
+
   BVHTreeNearest nearest = NULL_BVHTreeNearest;
 
   /* Setup nearest */
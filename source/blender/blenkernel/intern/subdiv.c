@@ -27,8 +27,11 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_modifier_types.h"
 
+#include "BLI_hash_mm2a.h"
 #include "BLI_utildefines.h"
 
+#include "BKE_customdata.h"
+
 #include "MEM_guardedalloc.h"
 
 #include "subdiv_converter.h"
@@ -96,6 +99,70 @@ bool BKE_subdiv_settings_equal(const SubdivSettings *settings_a, const SubdivSet
           settings_a->fvar_linear_interpolation == settings_b->fvar_linear_interpolation);
 }
 
+/* ============================= TOPOLOGY HASH ============================== */
+
+/* Only data which affects topology refiner is hashed: vertex positions and other attributes
+ * are ignored, so that deforming meshes keep re-using the same topology refiner. */
+static void subdiv_topology_hash_calc(const SubdivSettings *settings,
+                                      const Mesh *mesh,
+                                      SubdivTopologyHash *r_topology_hash)
+{
+  BLI_HashMurmur2A mm2[2];
+  BLI_hash_mm2a_init(&mm2[0], 0);
+  BLI_hash_mm2a_init(&mm2[1], 0x9e3779b9u);
+  for (int i = 0; i < ARRAY_SIZE(mm2); i++) {
+    BLI_hash_mm2a_add_int(&mm2[i], settings->use_creases);
+    BLI_hash_mm2a_add(&mm2[i], (const uchar *)mesh->mloop, sizeof(MLoop) * mesh->totloop);
+  }
+  const MPoly *mpoly = mesh->mpoly;
+  for (int poly_index = 0; poly_index < mesh->totpoly; poly_index++) {
+    for (int i = 0; i < ARRAY_SIZE(mm2); i++) {
+      BLI_hash_mm2a_add_int(&mm2[i], mpoly[poly_index].loopstart);
+      BLI_hash_mm2a_add_int(&mm2[i], mpoly[poly_index].totloop);
+    }
+  }
+  const MEdge *medge = mesh->medge;
+  for (int edge_index = 0; edge_index < mesh->totedge; edge_index++) {
+    const int crease = settings->use_creases ? medge[edge_index].crease : 0;
+    for (int i = 0; i < ARRAY_SIZE(mm2); i++) {
+      BLI_hash_mm2a_add_int(&mm2[i], (int)medge[edge_index].v1);
+      BLI_hash_mm2a_add_int(&mm2[i], (int)medge[edge_index].v2);
+      BLI_hash_mm2a_add_int(&mm2[i], crease);
+    }
+  }
+  /* Face-varying topology depends on which corners share UV coordinates. */
+  const int num_uv_layers = CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV);
+  for (int layer_index = 0; layer_index < num_uv_layers; layer_index++) {
+    const MLoopUV *mloopuv = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+    for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+      for (int i = 0; i < ARRAY_SIZE(mm2); i++) {
+        BLI_hash_mm2a_add(&mm2[i], (const uchar *)mloopuv[loop_index].uv, sizeof(float[2]));
+      }
+    }
+  }
+  r_topology_hash->num_vertices = mesh->totvert;
+  r_topology_hash->num_edges = mesh->totedge;
+  r_topology_hash->num_loops = mesh->totloop;
+  r_topology_hash->num_faces = mesh->totpoly;
+  r_topology_hash->num_uv_layers = num_uv_layers;
+  r_topology_hash->hash[0] = BLI_hash_mm2a_end(&mm2[0]);
+  r_topology_hash->hash[1] = BLI_hash_mm2a_end(&mm2[1]);
+  r_topology_hash->is_valid = true;
+}
+
+static bool subdiv_topology_hash_equal(const SubdivTopologyHash *topology_hash_a,
+                                       const SubdivTopologyHash *topology_hash_b)
+{
+  return (topology_hash_a->is_valid && topology_hash_b->is_valid &&
+          topology_hash_a->num_vertices == topology_hash_b->num_vertices &&
+          topology_hash_a->num_edges == topology_hash_b->num_edges &&
+          topology_hash_a->num_loops == topology_hash_b->num_loops &&
+          topology_hash_a->num_faces == topology_hash_b->num_faces &&
+          topology_hash_a->num_uv_layers == topology_hash_b->num_uv_layers &&
+          topology_hash_a->hash[0] == topology_hash_b->hash[0] &&
+          topology_hash_a->hash[1] == topology_hash_b->hash[1]);
+}
+
 /* ============================== CONSTRUCTION ============================== */
 
 /* Creation from scratch. */
@@ -138,6 +205,7 @@ Subdiv *BKE_subdiv_new_from_mesh(const SubdivSettings *settings, const Mesh *mes
   BKE_subdiv_converter_init_for_mesh(&converter, settings, mesh);
   Subdiv *subdiv = BKE_subdiv_new_from_converter(settings, &converter);
   BKE_subdiv_converter_free(&converter);
+  subdiv_topology_hash_calc(settings, mesh, &subdiv->topology_hash);
   return subdiv;
 }
 
@@ -177,10 +245,28 @@ Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
                                     const SubdivSettings *settings,
                                     const Mesh *mesh)
 {
+  /* Fast path: when the mesh topology hash matches the one of the existing subdivision there is
+   * no need to create a converter and do a full topology comparison. */
+  SubdivTopologyHash topology_hash;
+  if (subdiv != NULL) {
+    BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_COMPARE);
+  }
+  subdiv_topology_hash_calc(settings, mesh, &topology_hash);
+  if (subdiv != NULL) {
+    BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_COMPARE);
+    if (subdiv->topology_refiner != NULL &&
+        BKE_subdiv_settings_equal(&subdiv->settings, settings) &&
+        subdiv_topology_hash_equal(&subdiv->topology_hash, &topology_hash)) {
+      return subdiv;
+    }
+  }
   OpenSubdiv_Converter converter;
   BKE_subdiv_converter_init_for_mesh(&converter, settings, mesh);
   subdiv = BKE_subdiv_update_from_converter(subdiv, settings, &converter);
   BKE_subdiv_converter_free(&converter);
+  if (subdiv != NULL) {
+    subdiv->topology_hash = topology_hash;
+  }
   return subdiv;
 }
 
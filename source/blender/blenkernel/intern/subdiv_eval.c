@@ -35,6 +35,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "opensubdiv_capi_type.h"
 #include "opensubdiv_evaluator_capi.h"
 #include "opensubdiv_topology_refiner_capi.h"
 
@@ -395,3 +396,36 @@ void BKE_subdiv_eval_limit_patch_resolution_point_and_short_normal(Subdiv *subdi
     }
   }
 }
+
+/* ============================ Batched queries ============================= */
+
+void BKE_subdiv_eval_limit_points_and_derivatives(Subdiv *subdiv,
+                                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                                  const int num_patch_coords,
+                                                  float (*r_P)[3],
+                                                  float (*r_dPdu)[3],
+                                                  float (*r_dPdv)[3])
+{
+  subdiv->evaluator->evaluatePatchesLimit(subdiv->evaluator,
+                                          patch_coords,
+                                          num_patch_coords,
+                                          (float *)r_P,
+                                          (float *)r_dPdu,
+                                          (float *)r_dPdv);
+  if (r_dPdu == NULL || r_dPdv == NULL) {
+    return;
+  }
+  /* Degenerate derivatives are handled the same way as for the single point queries. */
+  for (int i = 0; i < num_patch_coords; i++) {
+    if ((is_zero_v3(r_dPdu[i]) || is_zero_v3(r_dPdv[i])) || equals_v3v3(r_dPdu[i], r_dPdv[i])) {
+      const OpenSubdiv_PatchCoord *patch_coord = &patch_coords[i];
+      BKE_subdiv_eval_limit_point_and_derivatives(subdiv,
+                                                  patch_coord->ptex_face,
+                                                  patch_coord->u,
+                                                  patch_coord->v,
+                                                  r_P[i],
+                                                  r_dPdu[i],
+                                                  r_dPdv[i]);
+    }
+  }
+}
@@ -31,6 +31,7 @@
 
 #include "BLI_alloca.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_key.h"
@@ -41,6 +42,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "opensubdiv_capi_type.h"
+
 /* -------------------------------------------------------------------- */
 /** \name Subdivision Context
  * \{ */
@@ -76,6 +79,10 @@ typedef struct SubdivMeshContext {
    * when it's not possible is when displacement is used. */
   bool can_evaluate_normals;
   bool have_displacement;
+  /* Patch coordinates of inner vertices, indexed by subdivided vertex index. Positions of those
+   * vertices are evaluated in batches after the traversal. Vertices which are evaluated during
+   * traversal have ptex_face set to -1. */
+  OpenSubdiv_PatchCoord *vertex_patch_coords;
 } SubdivMeshContext;
 
 static void subdiv_mesh_ctx_cache_uv_layers(SubdivMeshContext *ctx)
@@ -113,10 +120,23 @@ static void subdiv_mesh_prepare_accumulator(SubdivMeshContext *ctx, int num_vert
       sizeof(*ctx->accumulated_counters), num_vertices, "subdiv accumulated counters");
 }
 
+static void subdiv_mesh_prepare_batch_evaluation(SubdivMeshContext *ctx, int num_vertices)
+{
+  if (ctx->subdiv->evaluator == NULL) {
+    return;
+  }
+  ctx->vertex_patch_coords = MEM_malloc_arrayN(
+      num_vertices, sizeof(*ctx->vertex_patch_coords), "subdiv vertex patch coords");
+  for (int i = 0; i < num_vertices; i++) {
+    ctx->vertex_patch_coords[i].ptex_face = -1;
+  }
+}
+
 static void subdiv_mesh_context_free(SubdivMeshContext *ctx)
 {
   MEM_SAFE_FREE(ctx->accumulated_normals);
   MEM_SAFE_FREE(ctx->accumulated_counters);
+  MEM_SAFE_FREE(ctx->vertex_patch_coords);
 }
 
 /** \} */
@@ -275,20 +295,16 @@ static void vertex_interpolation_from_corner(const SubdivMeshContext *ctx,
         coarse_mloop[first_loop_index].v,
         coarse_mloop[last_loop_index].v,
     };
-    CustomData_interp(vertex_data,
-                      &vertex_interpolation->vertex_data_storage,
-                      first_indices,
-                      weights,
-                      NULL,
-                      2,
-                      1);
-    CustomData_interp(vertex_data,
-                      &vertex_interpolation->vertex_data_storage,
-                      last_indices,
-                      weights,
-                      NULL,
-                      2,
-                      3);
+    const int src_indices[4] = {UNPACK2(first_indices), UNPACK2(last_indices)};
+    const float src_weights[4] = {UNPACK2(weights), UNPACK2(weights)};
+    const int dest_indices[2] = {1, 3};
+    CustomData_interp_batch(vertex_data,
+                            &vertex_interpolation->vertex_data_storage,
+                            src_indices,
+                            src_weights,
+                            2,
+                            dest_indices,
+                            2);
   }
 }
 
@@ -405,10 +421,16 @@ static void loop_interpolation_from_corner(const SubdivMeshContext *ctx,
         loops_of_ptex.last_loop - coarse_mloop,
         loops_of_ptex.first_loop - coarse_mloop,
     };
-    CustomData_interp(
-        loop_data, &loop_interpolation->loop_data_storage, first_indices, weights, NULL, 2, 1);
-    CustomData_interp(
-        loop_data, &loop_interpolation->loop_data_storage, last_indices, weights, NULL, 2, 3);
+    const int src_indices[4] = {UNPACK2(first_indices), UNPACK2(last_indices)};
+    const float src_weights[4] = {UNPACK2(weights), UNPACK2(weights)};
+    const int dest_indices[2] = {1, 3};
+    CustomData_interp_batch(loop_data,
+                            &loop_interpolation->loop_data_storage,
+                            src_indices,
+                            src_weights,
+                            2,
+                            dest_indices,
+                            2);
   }
 }
 
@@ -526,6 +548,7 @@ static bool subdiv_mesh_topology_info(const SubdivForeachContext *foreach_contex
       subdiv_context->coarse_mesh, num_vertices, num_edges, 0, num_loops, num_polygons, mask);
   subdiv_mesh_ctx_cache_custom_data_layers(subdiv_context);
   subdiv_mesh_prepare_accumulator(subdiv_context, num_vertices);
+  subdiv_mesh_prepare_batch_evaluation(subdiv_context, num_vertices);
   return true;
 }
 
@@ -792,8 +815,17 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
   subdiv_vertex_data_interpolate(ctx, subdiv_vert, &tls->vertex_interpolation, u, v);
-  eval_final_point_and_vertex_normal(
-      subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
+  if (ctx->vertex_patch_coords != NULL) {
+    /* Position and normal are evaluated later on, see subdiv_mesh_eval_batched_vertices(). */
+    OpenSubdiv_PatchCoord *patch_coord = &ctx->vertex_patch_coords[subdiv_vertex_index];
+    patch_coord->ptex_face = ptex_face_index;
+    patch_coord->u = u;
+    patch_coord->v = v;
+  }
+  else {
+    eval_final_point_and_vertex_normal(
+        subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
+  }
   subdiv_mesh_tag_center_vertex(coarse_poly, subdiv_vert, u, v);
 }
 
@@ -1156,6 +1188,78 @@ static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batched vertex evaluation
+ *
+ * Inner vertices are the majority of the subdivided vertices. Instead of evaluating them one by
+ * one during traversal, their patch coordinates are stored and the limit surface is evaluated for
+ * whole ranges of vertices at once, in parallel.
+ * \{ */
+
+#define SUBDIV_MESH_EVAL_BATCH_SIZE 256
+
+static void subdiv_mesh_eval_batch_cb(void *__restrict userdata,
+                                      const int batch_index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SubdivMeshContext *ctx = userdata;
+  Subdiv *subdiv = ctx->subdiv;
+  MVert *subdiv_mvert = ctx->subdiv_mesh->mvert;
+  const int start_vertex_index = batch_index * SUBDIV_MESH_EVAL_BATCH_SIZE;
+  const int end_vertex_index = min_ii(start_vertex_index + SUBDIV_MESH_EVAL_BATCH_SIZE,
+                                      ctx->subdiv_mesh->totvert);
+  OpenSubdiv_PatchCoord patch_coords[SUBDIV_MESH_EVAL_BATCH_SIZE];
+  int vertex_indices[SUBDIV_MESH_EVAL_BATCH_SIZE];
+  int num_patch_coords = 0;
+  for (int i = start_vertex_index; i < end_vertex_index; i++) {
+    if (ctx->vertex_patch_coords[i].ptex_face != -1) {
+      patch_coords[num_patch_coords] = ctx->vertex_patch_coords[i];
+      vertex_indices[num_patch_coords] = i;
+      num_patch_coords++;
+    }
+  }
+  if (num_patch_coords == 0) {
+    return;
+  }
+  float P[SUBDIV_MESH_EVAL_BATCH_SIZE][3];
+  float dPdu[SUBDIV_MESH_EVAL_BATCH_SIZE][3];
+  float dPdv[SUBDIV_MESH_EVAL_BATCH_SIZE][3];
+  BKE_subdiv_eval_limit_points_and_derivatives(
+      subdiv, patch_coords, num_patch_coords, P, dPdu, dPdv);
+  for (int i = 0; i < num_patch_coords; i++) {
+    MVert *subdiv_vert = &subdiv_mvert[vertex_indices[i]];
+    if (ctx->have_displacement) {
+      const OpenSubdiv_PatchCoord *patch_coord = &patch_coords[i];
+      float D[3];
+      BKE_subdiv_eval_displacement(
+          subdiv, patch_coord->ptex_face, patch_coord->u, patch_coord->v, dPdu[i], dPdv[i], D);
+      add_v3_v3v3(subdiv_vert->co, P[i], D);
+    }
+    else {
+      float N[3];
+      copy_v3_v3(subdiv_vert->co, P[i]);
+      cross_v3_v3v3(N, dPdu[i], dPdv[i]);
+      normalize_v3(N);
+      normal_float_to_short_v3(subdiv_vert->no, N);
+    }
+  }
+}
+
+static void subdiv_mesh_eval_batched_vertices(SubdivMeshContext *ctx)
+{
+  if (ctx->vertex_patch_coords == NULL) {
+    return;
+  }
+  const int num_batches = (ctx->subdiv_mesh->totvert + SUBDIV_MESH_EVAL_BATCH_SIZE - 1) /
+                          SUBDIV_MESH_EVAL_BATCH_SIZE;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 4;
+  BLI_task_parallel_range(0, num_batches, ctx, subdiv_mesh_eval_batch_cb, &settings);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Initialization
  * \{ */
@@ -1227,6 +1331,7 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   foreach_context.user_data_tls_size = sizeof(SubdivMeshTLS);
   foreach_context.user_data_tls = &tls;
   BKE_subdiv_foreach_subdiv_geometry(subdiv, &foreach_context, settings, coarse_mesh);
+  subdiv_mesh_eval_batched_vertices(&subdiv_context);
   BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   Mesh *result = subdiv_context.subdiv_mesh;
   // BKE_mesh_validate(result, true, true);
@@ -36,6 +36,8 @@
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
  * - Range Query:
  *   #BLI_bvhtree_range_query
+ * - Batched nearest point & ray-cast (many queries at once):
+ *   #BLI_bvhtree_find_nearest_batch, #BLI_bvhtree_ray_cast_batch
  */
 
 #include "MEM_guardedalloc.h"
@@ -44,6 +46,8 @@
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
+#include "BLI_sort_utils.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -100,11 +104,13 @@ struct BVHTree {
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* kdop type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quadtree) */
+  char balance_flag;            /* flag passed to #BLI_bvhtree_balance_ex, used to rebuild */
+  float cost_balance;           /* #bvhtree_cost when balanced, to detect degraded trees */
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 56) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 40),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
@@ -701,6 +707,10 @@ typedef struct BVHDivNodesData {
   int depth;
   int i;
   int first_of_next_level;
+
+  /* Leafs are already sorted (see #bvhtree_sort_leafs_morton),
+   * only link the nodes, bounds are calculated afterwards by #bvhtree_refit. */
+  bool use_presorted_leafs;
 } BVHDivNodesData;
 
 static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
@@ -718,28 +728,30 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
   int parent_leafs_begin = implicit_leafs_index(data->data, data->depth, parent_level_index);
   int parent_leafs_end = implicit_leafs_index(data->data, data->depth, parent_level_index + 1);
 
-  /* This calculates the bounding box of this branch
-   * and chooses the largest axis as the axis to divide leafs */
-  refit_kdop_hull(data->tree, parent, parent_leafs_begin, parent_leafs_end);
-  split_axis = get_largest_axis(parent->bv);
-
-  /* Save split axis (this can be used on ray-tracing to speedup the query time) */
-  parent->main_axis = split_axis / 2;
-
-  /* Split the children along the split_axis, note: its not needed to sort the whole leafs array
-   * Only to assure that the elements are partitioned on a way that each child takes the elements
-   * it would take in case the whole array was sorted.
-   * Split_leafs takes care of that "sort" problem. */
-  nth_positions[0] = parent_leafs_begin;
-  nth_positions[data->tree_type] = parent_leafs_end;
-  for (k = 1; k < data->tree_type; k++) {
-    const int child_index = j * data->tree_type + data->tree_offset + k;
-    /* child level index */
-    const int child_level_index = child_index - data->first_of_next_level;
-    nth_positions[k] = implicit_leafs_index(data->data, data->depth + 1, child_level_index);
-  }
+  if (!data->use_presorted_leafs) {
+    /* This calculates the bounding box of this branch
+     * and chooses the largest axis as the axis to divide leafs */
+    refit_kdop_hull(data->tree, parent, parent_leafs_begin, parent_leafs_end);
+    split_axis = get_largest_axis(parent->bv);
 
-  split_leafs(data->leafs_array, nth_positions, data->tree_type, split_axis);
+    /* Save split axis (this can be used on ray-tracing to speedup the query time) */
+    parent->main_axis = split_axis / 2;
+
+    /* Split the children along the split_axis, note: its not needed to sort the whole leafs
+     * array Only to assure that the elements are partitioned on a way that each child takes the
+     * elements it would take in case the whole array was sorted.
+     * Split_leafs takes care of that "sort" problem. */
+    nth_positions[0] = parent_leafs_begin;
+    nth_positions[data->tree_type] = parent_leafs_end;
+    for (k = 1; k < data->tree_type; k++) {
+      const int child_index = j * data->tree_type + data->tree_offset + k;
+      /* child level index */
+      const int child_level_index = child_index - data->first_of_next_level;
+      nth_positions[k] = implicit_leafs_index(data->data, data->depth + 1, child_level_index);
+    }
+
+    split_leafs(data->leafs_array, nth_positions, data->tree_type, split_axis);
+  }
 
   /* Setup children and totnode counters
    * Not really needed but currently most of BVH code
@@ -790,7 +802,8 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
 static void non_recursive_bvh_div_nodes(const BVHTree *tree,
                                         BVHNode *branches_array,
                                         BVHNode **leafs_array,
-                                        int num_leafs)
+                                        int num_leafs,
+                                        const bool use_presorted_leafs)
 {
   int i;
 
@@ -832,6 +845,7 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
       .first_of_next_level = 0,
       .depth = 0,
       .i = 0,
+      .use_presorted_leafs = use_presorted_leafs,
   };
 
   /* Loop tree levels (log N) loops */
@@ -863,6 +877,339 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Linear (Morton Sorted) Build
+ *
+ * Instead of splitting the leafs at every branch, sort them once along a Morton curve
+ * through their centers, so the implicit tree only needs to be linked and refit.
+ * This is faster to build (all steps run in parallel) at the cost of a slightly lower
+ * tree quality, see #BVH_BALANCE_LINEAR.
+ * \{ */
+
+/* Bits per axis used for the Morton code of the leafs. */
+#define BVH_MORTON_BITS 10
+/* Number of bits sorted per radix sort pass (the passes must cover `3 * BVH_MORTON_BITS`). */
+#define BVH_RADIX_BITS 8
+#define BVH_RADIX_SIZE (1 << BVH_RADIX_BITS)
+#define BVH_RADIX_PASSES 4
+/* Number of ranges the leafs are split into to sort them in parallel. */
+#define BVH_RADIX_CHUNKS 64
+
+typedef struct BVHMortonLeaf {
+  uint key;
+  BVHNode *node;
+} BVHMortonLeaf;
+
+typedef struct BVHMortonSortData {
+  const BVHTree *tree;
+  BVHMortonLeaf *leafs;
+  BVHMortonLeaf *leafs_tmp;
+  int leafs_len;
+  int chunk_len;
+
+  /* Bounds of the leaf centers, on the first 3 axes of the tree. */
+  float center_min[3];
+  float center_scale[3];
+
+  int shift;
+  uint (*offsets)[BVH_RADIX_SIZE];
+} BVHMortonSortData;
+
+/**
+ * Spread the lower 10 bits of \a v so there are two zero bits between each of them.
+ */
+static uint bvh_morton_expand_bits(uint v)
+{
+  v = (v * 0x00010001u) & 0xFF0000FFu;
+  v = (v * 0x00000101u) & 0x0F00F00Fu;
+  v = (v * 0x00000011u) & 0xC30C30C3u;
+  v = (v * 0x00000005u) & 0x49249249u;
+  return v;
+}
+
+static void bvh_morton_leaf_center(const BVHTree *tree, const BVHNode *node, float r_center[3])
+{
+  const float *bv = node->bv + (tree->start_axis * 2);
+  for (int j = 0; j < 3; j++, bv += 2) {
+    r_center[j] = (bv[0] + bv[1]) * 0.5f;
+  }
+}
+
+static void bvh_morton_key_task_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHMortonSortData *data = userdata;
+  BVHMortonLeaf *leaf = &data->leafs[i];
+  float center[3];
+  uint key = 0;
+
+  bvh_morton_leaf_center(data->tree, leaf->node, center);
+  for (int j = 0; j < 3; j++) {
+    const uint cell = (uint)((center[j] - data->center_min[j]) * data->center_scale[j]);
+    key |= bvh_morton_expand_bits(cell) << j;
+  }
+  leaf->key = key;
+}
+
+static void bvh_radix_count_task_cb(void *__restrict userdata,
+                                    const int chunk,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHMortonSortData *data = userdata;
+  uint *counts = data->offsets[chunk];
+  const int begin = chunk * data->chunk_len;
+  const int end = min_ii(begin + data->chunk_len, data->leafs_len);
+
+  memset(counts, 0, sizeof(*data->offsets));
+  for (int i = begin; i < end; i++) {
+    counts[(data->leafs[i].key >> data->shift) & (BVH_RADIX_SIZE - 1)]++;
+  }
+}
+
+static void bvh_radix_scatter_task_cb(void *__restrict userdata,
+                                      const int chunk,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHMortonSortData *data = userdata;
+  uint *offsets = data->offsets[chunk];
+  const int begin = chunk * data->chunk_len;
+  const int end = min_ii(begin + data->chunk_len, data->leafs_len);
+
+  for (int i = begin; i < end; i++) {
+    const uint digit = (data->leafs[i].key >> data->shift) & (BVH_RADIX_SIZE - 1);
+    data->leafs_tmp[offsets[digit]++] = data->leafs[i];
+  }
+}
+
+/**
+ * Sort the leafs of \a tree (in `tree->nodes`) along a Morton curve,
+ * using a parallel least significant digit radix sort.
+ */
+static void bvhtree_sort_leafs_morton(BVHTree *tree)
+{
+  const int leafs_len = tree->totleaf;
+  const bool use_threading = (leafs_len > KDOPBVH_THREAD_LEAF_THRESHOLD);
+
+  BVHMortonSortData data = {
+      .tree = tree,
+      .leafs_len = leafs_len,
+  };
+
+  data.leafs = MEM_mallocN(sizeof(*data.leafs) * (size_t)leafs_len, __func__);
+  data.leafs_tmp = MEM_mallocN(sizeof(*data.leafs_tmp) * (size_t)leafs_len, __func__);
+
+  float center_max[3];
+  INIT_MINMAX(data.center_min, center_max);
+  for (int i = 0; i < leafs_len; i++) {
+    float center[3];
+    data.leafs[i].node = tree->nodes[i];
+    bvh_morton_leaf_center(tree, tree->nodes[i], center);
+    minmax_v3v3_v3(data.center_min, center_max, center);
+  }
+
+  const float cells = (float)((1 << BVH_MORTON_BITS) - 1);
+  for (int j = 0; j < 3; j++) {
+    const float size = center_max[j] - data.center_min[j];
+    data.center_scale[j] = (size > FLT_EPSILON) ? cells / size : 0.0f;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = use_threading;
+  BLI_task_parallel_range(0, leafs_len, &data, bvh_morton_key_task_cb, &settings);
+
+  /* Radix sort, each pass counts the digits per chunk, then scatters the chunks in order,
+   * so the sort is stable. */
+  const int chunks_len = use_threading ? BVH_RADIX_CHUNKS : 1;
+  data.chunk_len = (leafs_len + chunks_len - 1) / chunks_len;
+  data.offsets = MEM_mallocN(sizeof(*data.offsets) * (size_t)chunks_len, __func__);
+
+  settings.min_iter_per_thread = 1;
+
+  BLI_STATIC_ASSERT(BVH_RADIX_PASSES * BVH_RADIX_BITS >= 3 * BVH_MORTON_BITS,
+                    "radix sort must cover all key bits")
+  for (int pass = 0; pass < BVH_RADIX_PASSES; pass++) {
+    data.shift = pass * BVH_RADIX_BITS;
+    BLI_task_parallel_range(0, chunks_len, &data, bvh_radix_count_task_cb, &settings);
+
+    uint offset = 0;
+    for (int digit = 0; digit < BVH_RADIX_SIZE; digit++) {
+      for (int chunk = 0; chunk < chunks_len; chunk++) {
+        const uint count = data.offsets[chunk][digit];
+        data.offsets[chunk][digit] = offset;
+        offset += count;
+      }
+    }
+
+    BLI_task_parallel_range(0, chunks_len, &data, bvh_radix_scatter_task_cb, &settings);
+    SWAP(BVHMortonLeaf *, data.leafs, data.leafs_tmp);
+  }
+
+  for (int i = 0; i < leafs_len; i++) {
+    tree->nodes[i] = data.leafs[i].node;
+  }
+
+  MEM_freeN(data.offsets);
+  MEM_freeN(data.leafs);
+  MEM_freeN(data.leafs_tmp);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Refit & Tree Quality
+ * \{ */
+
+/**
+ * Surface area of the bounds (using the first 3 axes of the K-DOP).
+ */
+static float bvhtree_node_area(const BVHTree *tree, const BVHNode *node)
+{
+  const float *bv = node->bv + (tree->start_axis * 2);
+  const float x = max_ff(bv[1] - bv[0], 0.0f);
+  const float y = max_ff(bv[3] - bv[2], 0.0f);
+  const float z = max_ff(bv[5] - bv[4], 0.0f);
+  return x * y + y * z + z * x;
+}
+
+static void bvhtree_area_reduce(const void *__restrict UNUSED(userdata),
+                                void *__restrict chunk_join,
+                                void *__restrict chunk)
+{
+  *(float *)chunk_join += *(const float *)chunk;
+}
+
+typedef struct BVHRefitData {
+  BVHTree *tree;
+  /* Offset from the implicit branch index to `tree->nodes`. */
+  int nodes_offset;
+  bool use_main_axis;
+} BVHRefitData;
+
+static void bvhtree_refit_task_cb(void *__restrict userdata,
+                                  const int j,
+                                  const TaskParallelTLS *__restrict tls)
+{
+  BVHRefitData *data = userdata;
+  BVHNode *node = data->tree->nodes[data->nodes_offset + j];
+
+  node_join(data->tree, node);
+  if (data->use_main_axis) {
+    node->main_axis = get_largest_axis(node->bv) / 2;
+  }
+  if (tls->userdata_chunk) {
+    *(float *)tls->userdata_chunk += bvhtree_node_area(data->tree, node);
+  }
+}
+
+/**
+ * Bottom-up update of all branch bounds, one level of the implicit tree at a time
+ * (all branches of a level only depend on deeper levels so they can be joined in parallel).
+ *
+ * \param use_main_axis: Also set the #BVHNode.main_axis, when the tree wasn't built by splitting.
+ * \param r_area_sum: Optionally sum the area of all branches while refitting,
+ * see #bvhtree_cost.
+ */
+static void bvhtree_refit(BVHTree *tree, const bool use_main_axis, float *r_area_sum)
+{
+  const int tree_type = tree->tree_type;
+  const int tree_offset = 2 - tree->tree_type;
+  const int num_branches = tree->totbranch;
+
+  /* Implicit branch indices start at 1. */
+  BVHRefitData data = {
+      .tree = tree,
+      .nodes_offset = tree->totleaf - 1,
+      .use_main_axis = use_main_axis,
+  };
+
+  int levels[32];
+  int levels_len = 0;
+  for (int i = 1; i <= num_branches && levels_len < (int)ARRAY_SIZE(levels) - 1;
+       i = i * tree_type + tree_offset) {
+    levels[levels_len++] = i;
+  }
+  levels[levels_len] = num_branches + 1;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  float level_area_sum;
+  if (r_area_sum) {
+    *r_area_sum = 0.0f;
+    settings.userdata_chunk = &level_area_sum;
+    settings.userdata_chunk_size = sizeof(level_area_sum);
+    settings.func_reduce = bvhtree_area_reduce;
+  }
+
+  for (int level = levels_len - 1; level >= 0; level--) {
+    const int i_start = levels[level];
+    const int i_stop = min_ii(levels[level + 1], num_branches + 1);
+    /* The chunk is copied for each task, so it must start at zero for every level. */
+    level_area_sum = 0.0f;
+    settings.use_threading = ((i_stop - i_start) * tree_type > KDOPBVH_THREAD_LEAF_THRESHOLD);
+    BLI_task_parallel_range(i_start, i_stop, &data, bvhtree_refit_task_cb, &settings);
+    if (r_area_sum) {
+      *r_area_sum += level_area_sum;
+    }
+  }
+}
+
+typedef struct BVHCostData {
+  const BVHTree *tree;
+} BVHCostData;
+
+static void bvhtree_cost_task_cb(void *__restrict userdata,
+                                 const int j,
+                                 const TaskParallelTLS *__restrict tls)
+{
+  const BVHCostData *data = userdata;
+  float *area_sum = tls->userdata_chunk;
+  *area_sum += bvhtree_node_area(data->tree, data->tree->nodes[data->tree->totleaf + j]);
+}
+
+/**
+ * Surface area heuristic cost of the tree: the summed area of all branches relative to the root,
+ * so it doesn't change when the whole tree is scaled.
+ * Refitting a deforming tree makes its branches overlap more, increasing this cost.
+ */
+static float bvhtree_cost_from_area_sum(const BVHTree *tree, const float area_sum)
+{
+  if (tree->totleaf == 0) {
+    return 0.0f;
+  }
+
+  const float root_area = bvhtree_node_area(tree, tree->nodes[tree->totleaf]);
+  if (root_area < FLT_EPSILON) {
+    return 0.0f;
+  }
+  return area_sum / root_area;
+}
+
+static float bvhtree_cost(const BVHTree *tree)
+{
+  if (tree->totleaf == 0) {
+    return 0.0f;
+  }
+
+  BVHCostData data = {
+      .tree = tree,
+  };
+  float area_sum = 0.0f;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.userdata_chunk = &area_sum;
+  settings.userdata_chunk_size = sizeof(area_sum);
+  settings.func_reduce = bvhtree_area_reduce;
+  BLI_task_parallel_range(0, tree->totbranch, &data, bvhtree_cost_task_cb, &settings);
+
+  return bvhtree_cost_from_area_sum(tree, area_sum);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -953,17 +1300,21 @@ void BLI_bvhtree_free(BVHTree *tree)
   }
 }
 
-void BLI_bvhtree_balance(BVHTree *tree)
+/**
+ * Build the tree from the inserted leafs (and their current bounds).
+ */
+static void bvhtree_balance(BVHTree *tree, const int flag)
 {
   BVHNode **leafs_array = tree->nodes;
+  const bool use_linear = (flag & BVH_BALANCE_LINEAR) && (tree->totleaf > 1);
 
-  /* This function should only be called once
-   * (some big bug goes here if its being called more than once per tree) */
-  BLI_assert(tree->totbranch == 0);
+  if (use_linear) {
+    bvhtree_sort_leafs_morton(tree);
+  }
 
   /* Build the implicit tree */
   non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf, use_linear);
 
   /* current code expects the branches to be linked to the nodes array
    * we perform that linkage here */
@@ -972,6 +1323,33 @@ void BLI_bvhtree_balance(BVHTree *tree)
     tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
   }
 
+  tree->balance_flag = (char)flag;
+  if (use_linear) {
+    float area_sum;
+    bvhtree_refit(tree, true, &area_sum);
+    tree->cost_balance = bvhtree_cost_from_area_sum(tree, area_sum);
+  }
+  else {
+    tree->cost_balance = bvhtree_cost(tree);
+  }
+}
+
+void BLI_bvhtree_balance(BVHTree *tree)
+{
+  BLI_bvhtree_balance_ex(tree, 0);
+}
+
+/**
+ * \param flag: #BVH_BALANCE_LINEAR to sort the leafs instead of splitting them at every branch.
+ */
+void BLI_bvhtree_balance_ex(BVHTree *tree, const int flag)
+{
+  /* This function should only be called once
+   * (some big bug goes here if its being called more than once per tree) */
+  BLI_assert(tree->totbranch == 0);
+
+  bvhtree_balance(tree, flag);
+
 #ifdef USE_SKIP_LINKS
   build_skip_links(tree, tree->nodes[tree->totleaf], NULL, NULL);
 #endif
@@ -1045,15 +1423,48 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
 {
   /* Update bottom=>top
    * TRICKY: the way we build the tree all the children have an index greater than the parent
-   * This allows us todo a bottom up update by starting on the bigger numbered branch. */
+   * This allows us todo a bottom up update, one level at a time starting with the deepest. */
+  bvhtree_refit(tree, false, NULL);
+}
 
-  BVHNode **root = tree->nodes + tree->totleaf;
-  BVHNode **index = tree->nodes + tree->totleaf + tree->totbranch - 1;
+/**
+ * A version of #BLI_bvhtree_update_tree that rebuilds the tree
+ * when refitting made it degrade too much (leafs moved far from where they were balanced).
+ *
+ * \param rebuild_cost_ratio: Rebuild when #BLI_bvhtree_get_cost_ratio exceeds this value,
+ * see #BVH_REBUILD_COST_RATIO_DEFAULT. Zero to only refit (as #BLI_bvhtree_update_tree does).
+ * \return true when the tree was rebuilt.
+ */
+bool BLI_bvhtree_update_tree_ex(BVHTree *tree, const float rebuild_cost_ratio)
+{
+  if (rebuild_cost_ratio <= 0.0f || tree->cost_balance == 0.0f) {
+    bvhtree_refit(tree, false, NULL);
+    return false;
+  }
 
-  for (; index >= root; index--) {
-    node_join(tree, *index);
+  /* The cost is summed while refitting, instead of visiting all branches again. */
+  float area_sum;
+  bvhtree_refit(tree, false, &area_sum);
+
+  if (bvhtree_cost_from_area_sum(tree, area_sum) / tree->cost_balance > rebuild_cost_ratio) {
+    bvhtree_balance(tree, tree->balance_flag);
+    return true;
   }
+  return false;
 }
+
+/**
+ * Quality of the tree compared to when it was balanced, using the surface area heuristic.
+ * 1.0 for a tree that was just balanced, higher values mean more expensive queries.
+ */
+float BLI_bvhtree_get_cost_ratio(const BVHTree *tree)
+{
+  if (tree->cost_balance == 0.0f) {
+    return 1.0f;
+  }
+  return bvhtree_cost(tree) / tree->cost_balance;
+}
+
 /**
  * Number of times #BLI_bvhtree_insert has been called.
  * mainly useful for asserts functions to check we added the correct number.
@@ -1076,6 +1487,19 @@ float BLI_bvhtree_get_epsilon(const BVHTree *tree)
   return tree->epsilon;
 }
 
+/**
+ * Approximate number of bytes used by the tree (allocated for its current number of leafs).
+ */
+size_t BLI_bvhtree_get_mem_size(const BVHTree *tree)
+{
+  const size_t numnodes = (size_t)(tree->totleaf +
+                                   implicit_needed_branches(tree->tree_type, tree->totleaf) +
+                                   tree->tree_type);
+  return sizeof(BVHTree) + numnodes * (sizeof(BVHNode) + sizeof(BVHNode *) +
+                                       sizeof(BVHNode *) * (size_t)tree->tree_type +
+                                       sizeof(float) * (size_t)tree->axis);
+}
+
 /**
  * This function returns the bounding box of the BVH tree.
  */
@@ -2077,6 +2501,493 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_find_nearest_batch / BLI_bvhtree_ray_cast_batch
+ *
+ * Run the same query for many points or rays at once.
+ *
+ * Queries are sorted along a Morton curve so neighboring queries end up in the same packet,
+ * each packet then traverses the tree once, testing all of its queries against a node together.
+ * The per-lane loops are written over flat arrays so the compiler can vectorize them.
+ * Packets are distributed over threads, so callbacks must be thread-safe.
+ *
+ * \{ */
+
+/* Number of queries traversing the tree together, must not exceed the bits in an `uint`. */
+#define BVH_BATCH_PACKET_SIZE 8
+/* Bits per axis used to quantize query locations for sorting. */
+#define BVH_BATCH_MORTON_BITS 9
+
+BLI_STATIC_ASSERT(BVH_BATCH_PACKET_SIZE <= sizeof(uint) * 8, "packet lanes must fit in a mask")
+
+typedef struct BVHBatchData {
+  const BVHTree *tree;
+
+  const float (*co)[3];
+  const float (*dir)[3];
+  float radius;
+
+  BVHTreeNearest *nearest;
+  BVHTreeRayHit *hit;
+
+  /* Query indices, sorted for coherence. */
+  const int *order;
+  int order_len;
+
+  BVHTree_NearestPointCallback nearest_callback;
+  BVHTree_RayCastCallback raycast_callback;
+  void *userdata;
+  int flag;
+} BVHBatchData;
+
+typedef struct BVHNearestPacket {
+  int lanes_len;
+  /* Structure of arrays copies of the per-lane data, used for the node tests. */
+  float co[3][BVH_BATCH_PACKET_SIZE];
+  float dist_sq[BVH_BATCH_PACKET_SIZE];
+
+  BVHNearestData data[BVH_BATCH_PACKET_SIZE];
+} BVHNearestPacket;
+
+typedef struct BVHRayCastPacket {
+  int lanes_len;
+  /* Structure of arrays copies of the per-lane data, used for the node tests. */
+  float origin[3][BVH_BATCH_PACKET_SIZE];
+  float idot_axis[3][BVH_BATCH_PACKET_SIZE];
+  float dist[BVH_BATCH_PACKET_SIZE];
+  float radius;
+
+  BVHRayCastData data[BVH_BATCH_PACKET_SIZE];
+} BVHRayCastPacket;
+
+/**
+ * Spread the lower 10 bits of \a v so there are two zero bits between each of them.
+ */
+static uint bvh_batch_morton_expand_bits(uint v)
+{
+  v = (v * 0x00010001u) & 0xFF0000FFu;
+  v = (v * 0x00000101u) & 0x0F00F00Fu;
+  v = (v * 0x00000011u) & 0xC30C30C3u;
+  v = (v * 0x00000005u) & 0x49249249u;
+  return v;
+}
+
+/**
+ * Return the query indices sorted along a Morton curve through \a co,
+ * when \a dir is given, the direction octant is used as the most significant key.
+ */
+static int *bvh_batch_sort_order(const float (*co)[3], const float (*dir)[3], const int co_len)
+{
+  int *order = MEM_mallocN(sizeof(*order) * (size_t)co_len, __func__);
+
+  if (co_len <= BVH_BATCH_PACKET_SIZE) {
+    for (int i = 0; i < co_len; i++) {
+      order[i] = i;
+    }
+    return order;
+  }
+
+  float min[3], max[3], scale[3];
+  INIT_MINMAX(min, max);
+  for (int i = 0; i < co_len; i++) {
+    minmax_v3v3_v3(min, max, co[i]);
+  }
+
+  const float cells = (float)((1 << BVH_BATCH_MORTON_BITS) - 1);
+  for (int j = 0; j < 3; j++) {
+    const float size = max[j] - min[j];
+    scale[j] = (size > FLT_EPSILON) ? cells / size : 0.0f;
+  }
+
+  struct SortIntByInt *keys = MEM_mallocN(sizeof(*keys) * (size_t)co_len, __func__);
+  for (int i = 0; i < co_len; i++) {
+    uint key = 0;
+    for (int j = 0; j < 3; j++) {
+      const uint cell = (uint)((co[i][j] - min[j]) * scale[j]);
+      key |= bvh_batch_morton_expand_bits(cell) << j;
+    }
+    if (dir) {
+      const uint octant = (dir[i][0] < 0.0f ? 1u : 0u) | (dir[i][1] < 0.0f ? 2u : 0u) |
+                          (dir[i][2] < 0.0f ? 4u : 0u);
+      key |= octant << (3 * BVH_BATCH_MORTON_BITS);
+    }
+    keys[i].sort_value = (int)key;
+    keys[i].data = i;
+  }
+
+  qsort(keys, (size_t)co_len, sizeof(*keys), BLI_sortutil_cmp_int);
+
+  for (int i = 0; i < co_len; i++) {
+    order[i] = keys[i].data;
+  }
+  MEM_freeN(keys);
+
+  return order;
+}
+
+/**
+ * Return the mask of lanes in \a mask whose nearest point may lie inside \a node.
+ */
+static uint bvh_packet_nearest_test(const BVHNearestPacket *packet,
+                                    const BVHNode *node,
+                                    const uint mask)
+{
+  const float *bv = node->bv;
+  float dist_sq[BVH_BATCH_PACKET_SIZE];
+
+  for (int lane = 0; lane < BVH_BATCH_PACKET_SIZE; lane++) {
+    dist_sq[lane] = 0.0f;
+  }
+  for (int axis = 0; axis < 3; axis++, bv += 2) {
+    for (int lane = 0; lane < BVH_BATCH_PACKET_SIZE; lane++) {
+      const float val = packet->co[axis][lane];
+      const float delta = max_ff(max_ff(bv[0] - val, val - bv[1]), 0.0f);
+      dist_sq[lane] += delta * delta;
+    }
+  }
+
+  uint result = 0;
+  for (int lane = 0; lane < BVH_BATCH_PACKET_SIZE; lane++) {
+    result |= (uint)(dist_sq[lane] < packet->dist_sq[lane]) << lane;
+  }
+  return result & mask;
+}
+
+static void bvh_packet_find_nearest_dfs(BVHNearestPacket *packet,
+                                        const BVHNode *node,
+                                        const uint mask)
+{
+  if (node->totnode == 0) {
+    for (int lane = 0; lane < packet->lanes_len; lane++) {
+      if (mask & (1u << lane)) {
+        BVHNearestData *data = &packet->data[lane];
+        if (data->callback) {
+          data->callback(data->userdata, node->index, data->co, &data->nearest);
+        }
+        else {
+          data->nearest.index = node->index;
+          data->nearest.dist_sq = calc_nearest_point_squared(
+              data->proj, (BVHNode *)node, data->nearest.co);
+        }
+        packet->dist_sq[lane] = data->nearest.dist_sq;
+      }
+    }
+  }
+  else {
+    /* Same heuristic as #dfs_find_nearest_dfs, using the first active lane. */
+    const BVHNearestData *data = &packet->data[bitscan_forward_uint(mask)];
+
+    if (data->proj[node->main_axis] <= node->children[0]->bv[node->main_axis * 2 + 1]) {
+      for (int i = 0; i != node->totnode; i++) {
+        const uint mask_child = bvh_packet_nearest_test(packet, node->children[i], mask);
+        if (mask_child) {
+          bvh_packet_find_nearest_dfs(packet, node->children[i], mask_child);
+        }
+      }
+    }
+    else {
+      for (int i = node->totnode - 1; i >= 0; i--) {
+        const uint mask_child = bvh_packet_nearest_test(packet, node->children[i], mask);
+        if (mask_child) {
+          bvh_packet_find_nearest_dfs(packet, node->children[i], mask_child);
+        }
+      }
+    }
+  }
+}
+
+static void bvhtree_find_nearest_batch_task_cb(void *__restrict userdata,
+                                               const int packet_index,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHBatchData *batch = userdata;
+  const BVHTree *tree = batch->tree;
+  BVHNode *root = tree->nodes[tree->totleaf];
+
+  const int *order = &batch->order[packet_index * BVH_BATCH_PACKET_SIZE];
+  BVHNearestPacket packet;
+  packet.lanes_len = min_ii(BVH_BATCH_PACKET_SIZE,
+                            batch->order_len - packet_index * BVH_BATCH_PACKET_SIZE);
+
+  for (int lane = 0; lane < BVH_BATCH_PACKET_SIZE; lane++) {
+    if (lane < packet.lanes_len) {
+      BVHNearestData *data = &packet.data[lane];
+      const int i = order[lane];
+
+      data->tree = tree;
+      data->co = batch->co[i];
+      data->callback = batch->nearest_callback;
+      data->userdata = batch->userdata;
+      for (axis_t axis_iter = tree->start_axis; axis_iter != tree->stop_axis; axis_iter++) {
+        data->proj[axis_iter] = dot_v3v3(data->co, bvhtree_kdop_axes[axis_iter]);
+      }
+      memcpy(&data->nearest, &batch->nearest[i], sizeof(data->nearest));
+
+      for (int axis = 0; axis < 3; axis++) {
+        packet.co[axis][lane] = data->co[axis];
+      }
+      packet.dist_sq[lane] = data->nearest.dist_sq;
+    }
+    else {
+      /* Unused lanes never pass a node test. */
+      for (int axis = 0; axis < 3; axis++) {
+        packet.co[axis][lane] = 0.0f;
+      }
+      packet.dist_sq[lane] = -FLT_MAX;
+    }
+  }
+
+  if (batch->flag & BVH_NEAREST_OPTIMAL_ORDER) {
+    /* Priority queue traversal is per query, only benefit from sorting & threading. */
+    for (int lane = 0; lane < packet.lanes_len; lane++) {
+      heap_find_nearest_begin(&packet.data[lane], root);
+    }
+  }
+  else {
+    const uint mask_all = (1u << packet.lanes_len) - 1;
+    const uint mask = bvh_packet_nearest_test(&packet, root, mask_all);
+    if (mask) {
+      bvh_packet_find_nearest_dfs(&packet, root, mask);
+    }
+  }
+
+  for (int lane = 0; lane < packet.lanes_len; lane++) {
+    memcpy(&batch->nearest[order[lane]], &packet.data[lane].nearest, sizeof(BVHTreeNearest));
+  }
+}
+
+/**
+ * Find the nearest node for each of the \a co_len coordinates,
+ * this gives the same results as calling #BLI_bvhtree_find_nearest_ex for each coordinate.
+ *
+ * \param r_nearest: Array of \a co_len items, used as input and output the same way
+ * the `nearest` argument of #BLI_bvhtree_find_nearest_ex is.
+ * A query can be skipped by setting its `dist_sq` to zero.
+ * \param callback: Must be thread-safe.
+ */
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    const int co_len,
+                                    BVHTreeNearest *r_nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    int flag)
+{
+  if (co_len == 0 || tree->nodes[tree->totleaf] == NULL) {
+    return;
+  }
+
+  int *order = bvh_batch_sort_order(co, NULL, co_len);
+
+  BVHBatchData batch = {
+      .tree = tree,
+      .co = co,
+      .nearest = r_nearest,
+      .order = order,
+      .order_len = co_len,
+      .nearest_callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  const int packets_len = (co_len + BVH_BATCH_PACKET_SIZE - 1) / BVH_BATCH_PACKET_SIZE;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (co_len > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  BLI_task_parallel_range(0, packets_len, &batch, bvhtree_find_nearest_batch_task_cb, &settings);
+
+  MEM_freeN(order);
+}
+
+/**
+ * Return the mask of lanes in \a mask whose ray may hit \a node closer than their current hit.
+ * This is a conservative test, leafs are tested again per lane (see #bvh_packet_raycast_dfs).
+ */
+static uint bvh_packet_raycast_test(const BVHRayCastPacket *packet,
+                                    const BVHNode *node,
+                                    const uint mask)
+{
+  const float *bv = node->bv;
+  float t_near[BVH_BATCH_PACKET_SIZE], t_far[BVH_BATCH_PACKET_SIZE];
+
+  for (int lane = 0; lane < BVH_BATCH_PACKET_SIZE; lane++) {
+    t_near[lane] = -FLT_MAX;
+    t_far[lane] = packet->dist[lane];
+  }
+  for (int axis = 0; axis < 3; axis++, bv += 2) {
+    const float bv_min = bv[0] - packet->radius;
+    const float bv_max = bv[1] + packet->radius;
+    for (int lane = 0; lane < BVH_BATCH_PACKET_SIZE; lane++) {
+      const float t1 = (bv_min - packet->origin[axis][lane]) * packet->idot_axis[axis][lane];
+      const float t2 = (bv_max - packet->origin[axis][lane]) * packet->idot_axis[axis][lane];
+      t_near[lane] = max_ff(t_near[lane], min_ff(t1, t2));
+      t_far[lane] = min_ff(t_far[lane], max_ff(t1, t2));
+    }
+  }
+
+  uint result = 0;
+  for (int lane = 0; lane < BVH_BATCH_PACKET_SIZE; lane++) {
+    result |= (uint)((t_near[lane] <= t_far[lane]) && (t_far[lane] >= 0.0f)) << lane;
+  }
+  return result & mask;
+}
+
+static void bvh_packet_raycast_dfs(BVHRayCastPacket *packet, const BVHNode *node, const uint mask)
+{
+  if (node->totnode == 0) {
+    for (int lane = 0; lane < packet->lanes_len; lane++) {
+      if (mask & (1u << lane)) {
+        BVHRayCastData *data = &packet->data[lane];
+        /* Exact test matching #dfs_raycast. */
+        const float dist = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, node) :
+                                                        ray_nearest_hit(data, node->bv);
+        if (dist >= data->hit.dist) {
+          continue;
+        }
+        if (data->callback) {
+          data->callback(data->userdata, node->index, &data->ray, &data->hit);
+        }
+        else {
+          data->hit.index = node->index;
+          data->hit.dist = dist;
+          madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist);
+        }
+        packet->dist[lane] = data->hit.dist;
+      }
+    }
+  }
+  else {
+    /* Same heuristic as #dfs_raycast, using the first active lane. */
+    const BVHRayCastData *data = &packet->data[bitscan_forward_uint(mask)];
+
+    if (data->ray_dot_axis[node->main_axis] > 0.0f) {
+      for (int i = 0; i != node->totnode; i++) {
+        const uint mask_child = bvh_packet_raycast_test(packet, node->children[i], mask);
+        if (mask_child) {
+          bvh_packet_raycast_dfs(packet, node->children[i], mask_child);
+        }
+      }
+    }
+    else {
+      for (int i = node->totnode - 1; i >= 0; i--) {
+        const uint mask_child = bvh_packet_raycast_test(packet, node->children[i], mask);
+        if (mask_child) {
+          bvh_packet_raycast_dfs(packet, node->children[i], mask_child);
+        }
+      }
+    }
+  }
+}
+
+static void bvhtree_ray_cast_batch_task_cb(void *__restrict userdata,
+                                           const int packet_index,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHBatchData *batch = userdata;
+  const BVHTree *tree = batch->tree;
+  BVHNode *root = tree->nodes[tree->totleaf];
+
+  const int *order = &batch->order[packet_index * BVH_BATCH_PACKET_SIZE];
+  BVHRayCastPacket packet;
+  packet.lanes_len = min_ii(BVH_BATCH_PACKET_SIZE,
+                            batch->order_len - packet_index * BVH_BATCH_PACKET_SIZE);
+  packet.radius = batch->radius;
+
+  for (int lane = 0; lane < BVH_BATCH_PACKET_SIZE; lane++) {
+    if (lane < packet.lanes_len) {
+      BVHRayCastData *data = &packet.data[lane];
+      const int i = order[lane];
+
+      BLI_ASSERT_UNIT_V3(batch->dir[i]);
+
+      data->tree = tree;
+      data->callback = batch->raycast_callback;
+      data->userdata = batch->userdata;
+      copy_v3_v3(data->ray.origin, batch->co[i]);
+      copy_v3_v3(data->ray.direction, batch->dir[i]);
+      data->ray.radius = batch->radius;
+      bvhtree_ray_cast_data_precalc(data, batch->flag);
+      memcpy(&data->hit, &batch->hit[i], sizeof(data->hit));
+
+      for (int axis = 0; axis < 3; axis++) {
+        packet.origin[axis][lane] = data->ray.origin[axis];
+        packet.idot_axis[axis][lane] = data->idot_axis[axis];
+      }
+      packet.dist[lane] = data->hit.dist;
+    }
+    else {
+      /* Unused lanes never pass a node test. */
+      for (int axis = 0; axis < 3; axis++) {
+        packet.origin[axis][lane] = 0.0f;
+        packet.idot_axis[axis][lane] = 1.0f;
+      }
+      packet.dist[lane] = -FLT_MAX;
+    }
+  }
+
+  const uint mask_all = (1u << packet.lanes_len) - 1;
+  const uint mask = bvh_packet_raycast_test(&packet, root, mask_all);
+  if (mask) {
+    bvh_packet_raycast_dfs(&packet, root, mask);
+  }
+
+  for (int lane = 0; lane < packet.lanes_len; lane++) {
+    memcpy(&batch->hit[order[lane]], &packet.data[lane].hit, sizeof(BVHTreeRayHit));
+  }
+}
+
+/**
+ * Cast \a rays_len rays,
+ * this gives the same results as calling #BLI_bvhtree_ray_cast_ex for each ray.
+ *
+ * \param dir: Normalized ray directions.
+ * \param r_hit: Array of \a rays_len items, used as input and output the same way
+ * the `hit` argument of #BLI_bvhtree_ray_cast_ex is.
+ * A ray can be skipped by setting its `dist` to zero.
+ * \param callback: Must be thread-safe.
+ */
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*co)[3],
+                                const float (*dir)[3],
+                                const int rays_len,
+                                float radius,
+                                BVHTreeRayHit *r_hit,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag)
+{
+  if (rays_len == 0 || tree->nodes[tree->totleaf] == NULL) {
+    return;
+  }
+
+  int *order = bvh_batch_sort_order(co, dir, rays_len);
+
+  BVHBatchData batch = {
+      .tree = tree,
+      .co = co,
+      .dir = dir,
+      .radius = radius,
+      .hit = r_hit,
+      .order = order,
+      .order_len = rays_len,
+      .raycast_callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  const int packets_len = (rays_len + BVH_BATCH_PACKET_SIZE - 1) / BVH_BATCH_PACKET_SIZE;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (rays_len > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  BLI_task_parallel_range(0, packets_len, &batch, bvhtree_ray_cast_batch_task_cb, &settings);
+
+  MEM_freeN(order);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
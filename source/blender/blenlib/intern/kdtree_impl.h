@@ -23,6 +23,7 @@
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
 #include "BLI_strict_flags.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #define _CONCAT_AUX(MACRO_ARG1, MACRO_ARG2) MACRO_ARG1##MACRO_ARG2
@@ -58,6 +59,13 @@ struct KDTree {
 
 #define KD_NODE_UNSET ((uint)-1)
 
+/* Balance trees with more nodes than this using threads. */
+#define KD_BALANCE_THREAD_THRESHOLD 10000
+/* Sub-trees smaller than this are balanced in a single task. */
+#define KD_BALANCE_SEGMENT_LEN 4096
+/* Levels split in parallel before balancing the remaining sub-trees (limits the task count). */
+#define KD_BALANCE_DEPTH_MAX 8
+
 /**
  * When set we know all values are unbalanced,
  * otherwise clear them when re-balancing: see T62210.
@@ -145,20 +153,14 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Quick-sort style partitioning around the median of \a axis, returns the median.
+ */
+static uint kdtree_balance_partition(KDTreeNode *nodes, const uint nodes_len, const uint axis)
 {
-  KDTreeNode *node;
   float co;
   uint left, right, median, i, j;
 
-  if (nodes_len <= 0) {
-    return KD_NODE_UNSET;
-  }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
-
-  /* Quick-sort style sorting around median. */
   left = 0;
   right = nodes_len - 1;
   median = nodes_len / 2;
@@ -190,6 +192,23 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  return median;
+}
+
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
   /* set node and sort subnodes */
   node = &nodes[median];
   node->d = axis;
@@ -201,6 +220,113 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Threaded Balancing
+ *
+ * The top levels of the tree are split breadth first, partitioning all sub-trees
+ * of a level in parallel, the remaining sub-trees are then balanced in parallel too.
+ * \{ */
+
+typedef struct KDTreeBalanceSegment {
+  uint nodes_ofs;
+  uint nodes_len;
+  uint axis;
+  /** Where to store the index of the root of this sub-tree. */
+  uint *r_root;
+} KDTreeBalanceSegment;
+
+typedef struct KDTreeBalanceData {
+  KDTreeNode *nodes;
+  const KDTreeBalanceSegment *segments;
+  /** Two segments for each of `segments`, a segment with a NULL `r_root` is unused. */
+  KDTreeBalanceSegment *segments_next;
+  bool is_last_level;
+} KDTreeBalanceData;
+
+static void kdtree_balance_segment_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeBalanceData *data = userdata;
+  const KDTreeBalanceSegment *seg = &data->segments[i];
+  KDTreeBalanceSegment *seg_next = &data->segments_next[i * 2];
+  KDTreeNode *nodes = data->nodes + seg->nodes_ofs;
+
+  seg_next[0].r_root = seg_next[1].r_root = NULL;
+
+  if (data->is_last_level || seg->nodes_len <= KD_BALANCE_SEGMENT_LEN) {
+    *seg->r_root = kdtree_balance(nodes, seg->nodes_len, seg->axis, seg->nodes_ofs);
+    return;
+  }
+
+  const uint median = kdtree_balance_partition(nodes, seg->nodes_len, seg->axis);
+  const uint axis_next = (seg->axis + 1) % KD_DIMS;
+  KDTreeNode *node = &nodes[median];
+  node->d = seg->axis;
+  *seg->r_root = median + seg->nodes_ofs;
+
+  seg_next[0].nodes_ofs = seg->nodes_ofs;
+  seg_next[0].nodes_len = median;
+  seg_next[0].axis = axis_next;
+  seg_next[0].r_root = &node->left;
+
+  seg_next[1].nodes_ofs = seg->nodes_ofs + median + 1;
+  seg_next[1].nodes_len = seg->nodes_len - (median + 1);
+  seg_next[1].axis = axis_next;
+  seg_next[1].r_root = &node->right;
+}
+
+static uint kdtree_balance_threaded(KDTreeNode *nodes, const uint nodes_len)
+{
+  const uint segments_len_max = 1u << KD_BALANCE_DEPTH_MAX;
+  KDTreeBalanceSegment *segments = MEM_mallocN(sizeof(*segments) * segments_len_max, __func__);
+  KDTreeBalanceSegment *segments_next = MEM_mallocN(sizeof(*segments_next) * segments_len_max,
+                                                    __func__);
+  uint root = KD_NODE_UNSET;
+  uint segments_len = 1;
+
+  segments[0].nodes_ofs = 0;
+  segments[0].nodes_len = nodes_len;
+  segments[0].axis = 0;
+  segments[0].r_root = &root;
+
+  KDTreeBalanceData data = {
+      .nodes = nodes,
+      .segments = segments,
+      .segments_next = segments_next,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  for (uint depth = 0; segments_len != 0; depth++) {
+    BLI_assert(segments_len * 2 <= segments_len_max);
+    data.is_last_level = (depth + 1 == KD_BALANCE_DEPTH_MAX);
+    BLI_task_parallel_range(0, (int)segments_len, &data, kdtree_balance_segment_cb, &settings);
+
+    if (data.is_last_level) {
+      break;
+    }
+
+    /* Collect the sub-trees to handle in the next level. */
+    uint segments_next_len = 0;
+    for (uint i = 0; i < segments_len * 2; i++) {
+      if (segments_next[i].r_root != NULL) {
+        segments[segments_next_len++] = segments_next[i];
+      }
+    }
+    segments_len = segments_next_len;
+  }
+
+  MEM_freeN(segments);
+  MEM_freeN(segments_next);
+
+  return root;
+}
+
+/** \} */
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -210,7 +336,12 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len > KD_BALANCE_THREAD_THRESHOLD) {
+    tree->root = kdtree_balance_threaded(tree->nodes, tree->nodes_len);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -600,6 +731,58 @@ int BLI_kdtree_nd_(find_nearest_n)(const KDTree *tree,
       tree, co, r_nearest, nearest_len_capacity, NULL, NULL);
 }
 
+typedef struct KDTreeNearestBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  KDTreeNearest *r_nearest;
+  uint nearest_len_capacity;
+  int *r_nearest_len;
+} KDTreeNearestBatchData;
+
+static void kdtree_find_nearest_n_batch_cb(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeNearestBatchData *data = userdata;
+  const int nearest_len = BLI_kdtree_nd_(find_nearest_n)(
+      data->tree,
+      data->co[i],
+      &data->r_nearest[(size_t)i * data->nearest_len_capacity],
+      data->nearest_len_capacity);
+  if (data->r_nearest_len) {
+    data->r_nearest_len[i] = nearest_len;
+  }
+}
+
+/**
+ * Find the \a nearest_len_capacity nearest points of each of the \a co_len coordinates
+ * (in parallel).
+ *
+ * \param r_nearest: Results of the `i`-th coordinate are stored at
+ * `r_nearest[i * nearest_len_capacity]`, sized at least `co_len * nearest_len_capacity`.
+ * \param r_nearest_len: Optional, number of points found for each coordinate.
+ */
+void BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                          const float (*co)[KD_DIMS],
+                                          const uint co_len,
+                                          KDTreeNearest *r_nearest,
+                                          const uint nearest_len_capacity,
+                                          int *r_nearest_len)
+{
+  KDTreeNearestBatchData data = {
+      .tree = tree,
+      .co = co,
+      .r_nearest = r_nearest,
+      .nearest_len_capacity = nearest_len_capacity,
+      .r_nearest_len = r_nearest_len,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_find_nearest_n_batch_cb, &settings);
+}
+
 static int nearest_cmp_dist(const void *a, const void *b)
 {
   const KDTreeNearest *kda = a;
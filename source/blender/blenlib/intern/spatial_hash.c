@@ -0,0 +1,408 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+/** \file
+ * \ingroup bli
+ *
+ * Points are binned into a uniform grid with cells at least as large as the search range,
+ * so neighbors of a point can only be in the 27 cells around it.
+ * Cells are hashed into as many buckets as there are points, which keeps memory usage
+ * independent of the extent of the points, while building the table is threaded.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_bitmap.h"
+#include "BLI_hash.h"
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_spatial_hash.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "atomic_ops.h"
+
+#include "BLI_strict_flags.h"
+
+/* Limits the grid resolution along each axis, so cell coordinates remain precise as floats. */
+#define SPATIAL_HASH_CELL_BITS 16
+
+/* Use threads when there are more points than this. */
+#define SPATIAL_HASH_ITER_PER_THREAD 1024
+
+typedef struct SpatialHash {
+  const float (*co)[3];
+  const BLI_bitmap *mask;
+  uint points_len;
+
+  float min[3];
+  float cell_size_inv;
+  /** Cell coordinates of each point (unset for points outside of the mask). */
+  uint (*cell)[3];
+
+  uint buckets_len;
+  /** Start of each bucket in #bucket_points, `buckets_len + 1` items. */
+  uint *buckets;
+  uint *bucket_points;
+} SpatialHash;
+
+BLI_INLINE bool spatial_hash_point_test(const SpatialHash *hash, const uint i)
+{
+  return (hash->mask == NULL) || BLI_BITMAP_TEST(hash->mask, i);
+}
+
+BLI_INLINE uint spatial_hash_bucket(const SpatialHash *hash, const uint cell[3])
+{
+  return BLI_hash_int_3d(cell[0], cell[1], cell[2]) & (hash->buckets_len - 1);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Building
+ * \{ */
+
+typedef struct SpatialHashBounds {
+  float min[3], max[3];
+} SpatialHashBounds;
+
+static void spatial_hash_bounds_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict tls)
+{
+  const SpatialHash *hash = userdata;
+  SpatialHashBounds *bounds = tls->userdata_chunk;
+  if (spatial_hash_point_test(hash, (uint)i)) {
+    minmax_v3v3_v3(bounds->min, bounds->max, hash->co[i]);
+  }
+}
+
+static void spatial_hash_bounds_reduce(const void *__restrict UNUSED(userdata),
+                                       void *__restrict chunk_join,
+                                       void *__restrict chunk)
+{
+  SpatialHashBounds *bounds_join = chunk_join;
+  const SpatialHashBounds *bounds = chunk;
+  minmax_v3v3_v3(bounds_join->min, bounds_join->max, bounds->min);
+  minmax_v3v3_v3(bounds_join->min, bounds_join->max, bounds->max);
+}
+
+static void spatial_hash_count_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SpatialHash *hash = userdata;
+  if (!spatial_hash_point_test(hash, (uint)i)) {
+    return;
+  }
+  uint *cell = hash->cell[i];
+  for (int axis = 0; axis < 3; axis++) {
+    cell[axis] = (uint)((hash->co[i][axis] - hash->min[axis]) * hash->cell_size_inv);
+  }
+  atomic_add_and_fetch_uint32(&hash->buckets[spatial_hash_bucket(hash, cell)], 1);
+}
+
+static void spatial_hash_fill_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SpatialHash *hash = userdata;
+  if (!spatial_hash_point_test(hash, (uint)i)) {
+    return;
+  }
+  /* Bucket starts are used as cursors, restored afterwards. */
+  const uint bucket = spatial_hash_bucket(hash, hash->cell[i]);
+  const uint ofs = atomic_fetch_and_add_uint32(&hash->buckets[bucket], 1);
+  hash->bucket_points[ofs] = (uint)i;
+}
+
+static void spatial_hash_build(SpatialHash *hash,
+                               const float (*co)[3],
+                               const uint co_len,
+                               const BLI_bitmap *mask,
+                               const float range)
+{
+  memset(hash, 0, sizeof(*hash));
+  hash->co = co;
+  hash->mask = mask;
+  hash->points_len = co_len;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = SPATIAL_HASH_ITER_PER_THREAD;
+
+  SpatialHashBounds bounds;
+  INIT_MINMAX(bounds.min, bounds.max);
+  settings.userdata_chunk = &bounds;
+  settings.userdata_chunk_size = sizeof(bounds);
+  settings.func_reduce = spatial_hash_bounds_reduce;
+  BLI_task_parallel_range(0, (int)co_len, hash, spatial_hash_bounds_cb, &settings);
+  settings.userdata_chunk = NULL;
+  settings.userdata_chunk_size = 0;
+  settings.func_reduce = NULL;
+
+  /* Cells must be large enough for neighbors to be in adjacent cells only, taking the precision
+   * of cell coordinates into account, and few enough to fit in #SPATIAL_HASH_CELL_BITS. */
+  float extent[3];
+  sub_v3_v3v3(extent, bounds.max, bounds.min);
+  float co_abs_max = 0.0f;
+  for (int axis = 0; axis < 3; axis++) {
+    co_abs_max = max_fff(co_abs_max, fabsf(bounds.min[axis]), fabsf(bounds.max[axis]));
+  }
+  float cell_size = max_ff((range + 2.0f * co_abs_max * FLT_EPSILON) * 1.02f,
+                           max_fff(extent[0], extent[1], extent[2]) /
+                               (float)(1 << SPATIAL_HASH_CELL_BITS));
+  if (!(cell_size > 0.0f)) {
+    /* All points are at the same location (or there are none). */
+    cell_size = 1.0f;
+  }
+  copy_v3_v3(hash->min, bounds.min);
+  hash->cell_size_inv = 1.0f / cell_size;
+
+  hash->buckets_len = power_of_2_max_u(max_uu(co_len, 1));
+  hash->buckets = MEM_callocN(sizeof(*hash->buckets) * (hash->buckets_len + 1), __func__);
+  hash->cell = MEM_mallocN(sizeof(*hash->cell) * max_uu(co_len, 1), __func__);
+  hash->bucket_points = MEM_mallocN(sizeof(*hash->bucket_points) * max_uu(co_len, 1), __func__);
+
+  BLI_task_parallel_range(0, (int)co_len, hash, spatial_hash_count_cb, &settings);
+
+  /* Counts to bucket starts (the extra item is the end of the last bucket). */
+  uint ofs = 0;
+  for (uint i = 0; i <= hash->buckets_len; i++) {
+    const uint count = hash->buckets[i];
+    hash->buckets[i] = ofs;
+    ofs += count;
+  }
+
+  BLI_task_parallel_range(0, (int)co_len, hash, spatial_hash_fill_cb, &settings);
+
+  /* Filling moved each start to the end of its bucket, shift them back. */
+  memmove(&hash->buckets[1], &hash->buckets[0], sizeof(*hash->buckets) * hash->buckets_len);
+  hash->buckets[0] = 0;
+}
+
+static void spatial_hash_free(SpatialHash *hash)
+{
+  MEM_freeN(hash->buckets);
+  MEM_freeN(hash->cell);
+  MEM_freeN(hash->bucket_points);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Neighbor Search
+ * \{ */
+
+/**
+ * Find the points within \a range_sq of point \a i (excluding itself).
+ *
+ * \param r_neighbors: When not NULL, filled with the neighbors.
+ * \return The number of neighbors.
+ */
+static uint spatial_hash_neighbors(const SpatialHash *hash,
+                                   const uint i,
+                                   const float range_sq,
+                                   uint *r_neighbors)
+{
+  const float *co = hash->co[i];
+  const uint *cell = hash->cell[i];
+  uint neighbors_len = 0;
+
+  for (uint dx = 0; dx < 3; dx++) {
+    for (uint dy = 0; dy < 3; dy++) {
+      for (uint dz = 0; dz < 3; dz++) {
+        /* Wraps around for cells before the first one, which are empty anyway. */
+        const uint cell_test[3] = {cell[0] + dx - 1, cell[1] + dy - 1, cell[2] + dz - 1};
+        const uint bucket = spatial_hash_bucket(hash, cell_test);
+        for (uint ofs = hash->buckets[bucket]; ofs < hash->buckets[bucket + 1]; ofs++) {
+          const uint j = hash->bucket_points[ofs];
+          /* Buckets are shared by cells with the same hash. */
+          if ((j == i) || (hash->cell[j][0] != cell_test[0]) ||
+              (hash->cell[j][1] != cell_test[1]) || (hash->cell[j][2] != cell_test[2])) {
+            continue;
+          }
+          if (len_squared_v3v3(co, hash->co[j]) <= range_sq) {
+            if (r_neighbors) {
+              r_neighbors[neighbors_len] = j;
+            }
+            neighbors_len++;
+          }
+        }
+      }
+    }
+  }
+  return neighbors_len;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name BLI_spatial_hash_3d_calc_duplicates
+ * \{ */
+
+/* Neighbors of points are searched in blocks of points (growing from the minimum size while
+ * the neighbors of a whole block fit), stored neighbors are limited to the number of points. */
+#define DUPLICATES_BLOCK_MIN SPATIAL_HASH_ITER_PER_THREAD
+#define DUPLICATES_BLOCK_MAX (1 << 16)
+#define DUPLICATES_NEIGHBORS_MIN (1 << 16)
+
+typedef struct DuplicatesData {
+  const SpatialHash *hash;
+  float range_sq;
+  const int *duplicates;
+  /** First point of the block being searched. */
+  int block_start;
+  /** Start of the neighbors of each point of the block in #neighbors, `block_len + 1` items. */
+  size_t *neighbors_ofs;
+  uint *neighbors;
+} DuplicatesData;
+
+/**
+ * Only points which aren't merged yet can be targets, their neighbors are needed.
+ */
+BLI_INLINE bool duplicates_target_test(const SpatialHash *hash,
+                                       const int *duplicates,
+                                       const int i)
+{
+  return ELEM(duplicates[i], -1, i) && spatial_hash_point_test(hash, (uint)i);
+}
+
+static void duplicates_count_cb(void *__restrict userdata,
+                                const int k,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DuplicatesData *data = userdata;
+  const int i = data->block_start + k;
+  data->neighbors_ofs[k] = duplicates_target_test(data->hash, data->duplicates, i) ?
+                               spatial_hash_neighbors(data->hash, (uint)i, data->range_sq, NULL) :
+                               0;
+}
+
+static void duplicates_fill_cb(void *__restrict userdata,
+                               const int k,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DuplicatesData *data = userdata;
+  if (data->neighbors_ofs[k] != data->neighbors_ofs[k + 1]) {
+    spatial_hash_neighbors(data->hash,
+                           (uint)(data->block_start + k),
+                           data->range_sq,
+                           &data->neighbors[data->neighbors_ofs[k]]);
+  }
+}
+
+/**
+ * Find duplicate points in \a range, a threaded alternative to
+ * #BLI_kdtree_3d_calc_duplicates_fast (giving the same results when using index order).
+ *
+ * Neighbors of a block of points are found in parallel, then the points of the block are
+ * looped over in index order, merging all their neighbors which aren't merged yet into them.
+ * Points merged by an earlier block are skipped, so a cluster of duplicates is searched once.
+ *
+ * \param mask: Optional, only points enabled in the mask are merged or used as targets.
+ * \param duplicates: An array of int's the length of \a co_len
+ * Values initialized to -1 are candidates to me merged.
+ * Setting the index to its own position in the array prevents it from being touched,
+ * although it can still be used as a target.
+ * \returns The number of merges found.
+ *
+ * \note Merging is always a single step (target indices won't be marked for merging).
+ */
+int BLI_spatial_hash_3d_calc_duplicates(const float (*co)[3],
+                                        const int co_len,
+                                        const BLI_bitmap *mask,
+                                        const float range,
+                                        int *duplicates)
+{
+  SpatialHash hash;
+  spatial_hash_build(&hash, co, (uint)co_len, mask, range);
+
+  /* A single point never has more neighbors than this. */
+  const size_t neighbors_max = max_zz((size_t)co_len, DUPLICATES_NEIGHBORS_MIN);
+  DuplicatesData data = {
+      .hash = &hash,
+      .range_sq = square_f(range),
+      .duplicates = duplicates,
+  };
+  data.neighbors_ofs = MEM_mallocN(sizeof(*data.neighbors_ofs) * (DUPLICATES_BLOCK_MAX + 1),
+                                   __func__);
+  data.neighbors = MEM_mallocN(sizeof(*data.neighbors) * neighbors_max, __func__);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = SPATIAL_HASH_ITER_PER_THREAD;
+
+  int found = 0;
+  int block_len_max = DUPLICATES_BLOCK_MIN;
+  for (int block_start = 0; block_start < co_len;) {
+    const int block_len_test = min_ii(block_len_max, co_len - block_start);
+    data.block_start = block_start;
+    BLI_task_parallel_range(0, block_len_test, &data, duplicates_count_cb, &settings);
+
+    /* Counts to offsets, the block ends before its neighbors no longer fit. */
+    size_t neighbors_len = 0;
+    int block_len = 0;
+    for (; block_len < block_len_test; block_len++) {
+      const size_t count = data.neighbors_ofs[block_len];
+      if ((block_len != 0) && (neighbors_len + count > neighbors_max)) {
+        break;
+      }
+      data.neighbors_ofs[block_len] = neighbors_len;
+      neighbors_len += count;
+    }
+    data.neighbors_ofs[block_len] = neighbors_len;
+
+    if (neighbors_len != 0) {
+      BLI_task_parallel_range(0, block_len, &data, duplicates_fill_cb, &settings);
+
+      for (int k = 0; k < block_len; k++) {
+        const int i = block_start + k;
+        if (!duplicates_target_test(&hash, duplicates, i)) {
+          continue;
+        }
+        const int found_prev = found;
+        for (size_t ofs = data.neighbors_ofs[k]; ofs < data.neighbors_ofs[k + 1]; ofs++) {
+          const uint j = data.neighbors[ofs];
+          if (duplicates[j] == -1) {
+            duplicates[j] = i;
+            found++;
+          }
+        }
+        if (found != found_prev) {
+          /* Prevent chains of doubles. */
+          duplicates[i] = i;
+        }
+      }
+    }
+
+    block_start += block_len;
+    block_len_max = (block_len == block_len_test) ?
+                        min_ii(block_len_max * 2, DUPLICATES_BLOCK_MAX) :
+                        max_ii(block_len, DUPLICATES_BLOCK_MIN);
+  }
+
+  MEM_freeN(data.neighbors_ofs);
+  MEM_freeN(data.neighbors);
+  spatial_hash_free(&hash);
+
+  return found;
+}
+
+/** \} */
@@ -66,8 +66,12 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                     float scale,
+                                     int round,
+                                     int random_seed,
+                                     bool optimal = false,
+                                     int balance_flag = 0)
 {
   struct RNG *rng = BLI_rng_new(random_seed);
   BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
@@ -79,7 +83,7 @@ static void find_nearest_points_test(
     rng_v3_round(points[i], 3, rng, round, scale);
     BLI_bvhtree_insert(tree, i, points[i], 1);
   }
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 
   /* first find each point */
   BVHTree_NearestPointCallback callback = optimal ? optimal_check_callback : nullptr;
@@ -132,3 +136,178 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, LinearFindNearest_1)
+{
+  find_nearest_points_test(1, 1.0, 1000, 1234, false, BVH_BALANCE_LINEAR);
+}
+TEST(kdopbvh, LinearFindNearest_2)
+{
+  find_nearest_points_test(2, 1.0, 1000, 123, false, BVH_BALANCE_LINEAR);
+}
+TEST(kdopbvh, LinearFindNearest_5000)
+{
+  find_nearest_points_test(5000, 1.0, 1000, 12, false, BVH_BALANCE_LINEAR);
+}
+TEST(kdopbvh, LinearOptimalFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, true, BVH_BALANCE_LINEAR);
+}
+
+/**
+ * Shuffle the points of a balanced tree, the refit tree should degrade and be rebuilt.
+ */
+TEST(kdopbvh, UpdateTreeRebuild)
+{
+  const int points_len = 2000;
+  struct RNG *rng = BLI_rng_new(1234);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 8);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  /* As cloth & collision trees are built. */
+  BLI_bvhtree_balance_ex(tree, BVH_BALANCE_LINEAR);
+  EXPECT_FLOAT_EQ(BLI_bvhtree_get_cost_ratio(tree), 1.0f);
+
+  /* Moving nothing keeps the same tree. */
+  EXPECT_FALSE(BLI_bvhtree_update_tree_ex(tree, BVH_REBUILD_COST_RATIO_DEFAULT));
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_update_node(tree, i, points[i], nullptr, 1);
+  }
+  /* Without a ratio the tree is only refit. */
+  EXPECT_FALSE(BLI_bvhtree_update_tree_ex(tree, 0.0f));
+  EXPECT_GT(BLI_bvhtree_get_cost_ratio(tree), BVH_REBUILD_COST_RATIO_DEFAULT);
+
+  EXPECT_TRUE(BLI_bvhtree_update_tree_ex(tree, BVH_REBUILD_COST_RATIO_DEFAULT));
+  EXPECT_LT(BLI_bvhtree_get_cost_ratio(tree), BVH_REBUILD_COST_RATIO_DEFAULT);
+
+  for (int i = 0; i < points_len; i++) {
+    const int j = BLI_bvhtree_find_nearest(tree, points[i], nullptr, nullptr, nullptr);
+    EXPECT_GE(j, 0);
+    EXPECT_EQ_ARRAY(points[i], points[j], 3);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+}
+
+/**
+ * Batched queries must give the same result as one query at a time.
+ */
+static void find_nearest_batch_test(int points_len, float scale, int round, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, round, scale);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  const int queries_len = points_len * 2;
+  float(*queries)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * queries_len,
+                                                          __func__);
+  for (int i = 0; i < queries_len; i++) {
+    rng_v3_round(queries[i], 3, rng, round, scale * 1.5f);
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+
+  BLI_bvhtree_find_nearest_batch(tree, queries, queries_len, nearest, nullptr, nullptr, 0);
+
+  for (int i = 0; i < queries_len; i++) {
+    BVHTreeNearest nearest_single;
+    nearest_single.index = -1;
+    nearest_single.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, queries[i], &nearest_single, nullptr, nullptr);
+
+    EXPECT_GE(nearest[i].index, 0);
+    EXPECT_FLOAT_EQ(nearest[i].dist_sq, nearest_single.dist_sq);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(queries);
+  MEM_freeN(nearest);
+}
+
+TEST(kdopbvh, FindNearestBatch_1)
+{
+  find_nearest_batch_test(1, 1.0, 1000, 1234);
+}
+TEST(kdopbvh, FindNearestBatch_500)
+{
+  find_nearest_batch_test(500, 1.0, 1000, 12);
+}
+TEST(kdopbvh, FindNearestBatch_5000)
+{
+  find_nearest_batch_test(5000, 1.0, 1000, 123);
+}
+
+static void ray_cast_batch_test(int points_len, float radius, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.01f, 8, 8);
+
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, co, 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  const int rays_len = points_len;
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  BVHTreeRayHit *hit = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hit) * rays_len, __func__);
+  for (int i = 0; i < rays_len; i++) {
+    rng_v3_round(co[i], 3, rng, 1000, 2.0f);
+    BLI_rng_get_float_unit_v3(rng, dir[i]);
+    hit[i].index = -1;
+    hit[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  BLI_bvhtree_ray_cast_batch(
+      tree, co, dir, rays_len, radius, hit, nullptr, nullptr, BVH_RAYCAST_DEFAULT);
+
+  int hits_len = 0;
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit_single;
+    hit_single.index = -1;
+    hit_single.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, co[i], dir[i], radius, &hit_single, nullptr, nullptr);
+
+    /* Nodes hit at the same distance may be found in a different order. */
+    EXPECT_EQ(hit[i].index == -1, hit_single.index == -1);
+    if (hit_single.index != -1) {
+      EXPECT_FLOAT_EQ(hit[i].dist, hit_single.dist);
+      hits_len++;
+    }
+  }
+  EXPECT_GT(hits_len, 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(hit);
+}
+
+TEST(kdopbvh, RayCastBatch_2000)
+{
+  ray_cast_batch_test(2000, 0.0f, 1234);
+}
+TEST(kdopbvh, RayCastBatchRadius_2000)
+{
+  ray_cast_batch_test(2000, 0.05f, 12);
+}
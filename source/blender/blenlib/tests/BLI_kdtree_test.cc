@@ -0,0 +1,117 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+static KDTree_3d *kdtree_from_random_points(const int points_len,
+                                            const unsigned int seed,
+                                            float (**r_points)[3])
+{
+  RNG *rng = BLI_rng_new(seed);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(*points) * points_len, __func__);
+  KDTree_3d *tree = BLI_kdtree_3d_new(points_len);
+  for (int i = 0; i < points_len; i++) {
+    BLI_rng_get_float_unit_v3(rng, points[i]);
+    mul_v3_fl(points[i], BLI_rng_get_float(rng));
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  BLI_rng_free(rng);
+  *r_points = points;
+  return tree;
+}
+
+static void find_nearest_brute_force_test(const int points_len, const int queries_len)
+{
+  float(*points)[3];
+  KDTree_3d *tree = kdtree_from_random_points(points_len, 1234, &points);
+
+  RNG *rng = BLI_rng_new(4321);
+  for (int i = 0; i < queries_len; i++) {
+    float co[3];
+    BLI_rng_get_float_unit_v3(rng, co);
+
+    float dist_sq_best = FLT_MAX;
+    for (int j = 0; j < points_len; j++) {
+      dist_sq_best = min_ff(dist_sq_best, len_squared_v3v3(co, points[j]));
+    }
+
+    KDTreeNearest_3d nearest;
+    const int index = BLI_kdtree_3d_find_nearest(tree, co, &nearest);
+    ASSERT_NE(index, -1);
+    EXPECT_FLOAT_EQ(len_squared_v3v3(co, points[index]), dist_sq_best);
+  }
+
+  BLI_rng_free(rng);
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(points);
+}
+
+static void find_nearest_n_batch_test(const int points_len, const int queries_len, const int n)
+{
+  float(*points)[3];
+  KDTree_3d *tree = kdtree_from_random_points(points_len, 1234, &points);
+
+  RNG *rng = BLI_rng_new(4321);
+  float(*queries)[3] = (float(*)[3])MEM_mallocN(sizeof(*queries) * queries_len, __func__);
+  for (int i = 0; i < queries_len; i++) {
+    BLI_rng_get_float_unit_v3(rng, queries[i]);
+  }
+
+  KDTreeNearest_3d *nearest_batch = (KDTreeNearest_3d *)MEM_mallocN(
+      sizeof(*nearest_batch) * queries_len * n, __func__);
+  int *nearest_batch_len = (int *)MEM_mallocN(sizeof(int) * queries_len, __func__);
+  BLI_kdtree_3d_find_nearest_n_batch(
+      tree, queries, queries_len, nearest_batch, n, nearest_batch_len);
+
+  KDTreeNearest_3d *nearest = (KDTreeNearest_3d *)MEM_mallocN(sizeof(*nearest) * n, __func__);
+  for (int i = 0; i < queries_len; i++) {
+    const int nearest_len = BLI_kdtree_3d_find_nearest_n(tree, queries[i], nearest, n);
+    EXPECT_EQ(nearest_len, min_ii(n, points_len));
+    ASSERT_EQ(nearest_len, nearest_batch_len[i]);
+    for (int j = 0; j < nearest_len; j++) {
+      EXPECT_EQ(nearest[j].index, nearest_batch[i * n + j].index);
+      EXPECT_EQ(nearest[j].dist, nearest_batch[i * n + j].dist);
+    }
+  }
+
+  MEM_freeN(nearest);
+  MEM_freeN(nearest_batch);
+  MEM_freeN(nearest_batch_len);
+  MEM_freeN(queries);
+  BLI_rng_free(rng);
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(points);
+}
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+TEST(kdtree, FindNearest_100)
+{
+  find_nearest_brute_force_test(100, 100);
+}
+
+/* Large enough to be balanced using threads. */
+TEST(kdtree, FindNearestThreaded_50000)
+{
+  find_nearest_brute_force_test(50000, 100);
+}
+
+TEST(kdtree, FindNearestNBatch_5)
+{
+  find_nearest_n_batch_test(5, 100, 8);
+}
+
+TEST(kdtree, FindNearestNBatch_50000)
+{
+  find_nearest_n_batch_test(50000, 5000, 8);
+}
@@ -0,0 +1,147 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_bitmap.h"
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_spatial_hash.h"
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+/**
+ * Compare with #BLI_kdtree_3d_calc_duplicates_fast using index order,
+ * points are snapped to a grid so many of them are exact duplicates.
+ */
+static void calc_duplicates_test(const int points_len,
+                                 const float range,
+                                 const float offset,
+                                 const bool use_mask,
+                                 const bool use_keep)
+{
+  RNG *rng = BLI_rng_new(1234);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(*points) * points_len, __func__);
+  BLI_bitmap *mask = use_mask ? BLI_BITMAP_NEW(points_len, __func__) : nullptr;
+  int *duplicates_kdtree = (int *)MEM_mallocN(sizeof(int) * points_len, __func__);
+  int *duplicates_hash = (int *)MEM_mallocN(sizeof(int) * points_len, __func__);
+
+  int mask_len = 0;
+  for (int i = 0; i < points_len; i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      points[i][axis] = offset + (float)(BLI_rng_get_int(rng) % 64) * 0.01f;
+    }
+    if (mask && (BLI_rng_get_int(rng) % 4) != 0) {
+      BLI_BITMAP_ENABLE(mask, i);
+    }
+    if (!mask || BLI_BITMAP_TEST(mask, i)) {
+      mask_len++;
+    }
+    duplicates_hash[i] = (use_keep && (BLI_rng_get_int(rng) % 16) == 0) ? i : -1;
+  }
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(mask_len);
+  for (int i = 0; i < points_len; i++) {
+    if (!mask || BLI_BITMAP_TEST(mask, i)) {
+      BLI_kdtree_3d_insert(tree, i, points[i]);
+    }
+  }
+  BLI_kdtree_3d_balance(tree);
+
+  memcpy(duplicates_kdtree, duplicates_hash, sizeof(int) * points_len);
+  int found_kdtree = 0;
+  if (mask == nullptr) {
+    /* Index order requires indices to be aligned with nodes. */
+    found_kdtree = BLI_kdtree_3d_calc_duplicates_fast(tree, range, true, duplicates_kdtree);
+  }
+  const int found_hash = BLI_spatial_hash_3d_calc_duplicates(
+      points, points_len, mask, range, duplicates_hash);
+
+  if (mask == nullptr) {
+    EXPECT_EQ(found_kdtree, found_hash);
+    for (int i = 0; i < points_len; i++) {
+      EXPECT_EQ(duplicates_kdtree[i], duplicates_hash[i]);
+    }
+  }
+  EXPECT_GT(found_hash, 0);
+
+  /* Merged points are within range of their target, targets are never merged. */
+  const float range_sq = range * range;
+  for (int i = 0; i < points_len; i++) {
+    const int target = duplicates_hash[i];
+    if (target == -1 || target == i) {
+      continue;
+    }
+    EXPECT_EQ(duplicates_hash[target], target);
+    EXPECT_LE(len_squared_v3v3(points[i], points[target]), range_sq);
+    if (mask) {
+      EXPECT_TRUE(BLI_BITMAP_TEST(mask, i));
+      EXPECT_TRUE(BLI_BITMAP_TEST(mask, target));
+    }
+  }
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(points);
+  MEM_freeN(duplicates_kdtree);
+  MEM_freeN(duplicates_hash);
+  if (mask) {
+    MEM_freeN(mask);
+  }
+  BLI_rng_free(rng);
+}
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+TEST(spatial_hash, CalcDuplicatesExact)
+{
+  calc_duplicates_test(20000, 1e-6f, 0.0f, false, false);
+}
+
+TEST(spatial_hash, CalcDuplicatesRange)
+{
+  calc_duplicates_test(10000, 0.025f, 0.0f, false, false);
+}
+
+TEST(spatial_hash, CalcDuplicatesOffset)
+{
+  calc_duplicates_test(10000, 0.025f, 1000.0f, false, false);
+}
+
+TEST(spatial_hash, CalcDuplicatesKeep)
+{
+  calc_duplicates_test(10000, 0.025f, 0.0f, false, true);
+}
+
+TEST(spatial_hash, CalcDuplicatesMask)
+{
+  calc_duplicates_test(10000, 0.025f, 0.0f, true, true);
+}
+
+/**
+ * Large clusters of exact duplicates, where the neighbors of a block of points don't fit.
+ */
+TEST(spatial_hash, CalcDuplicatesCluster)
+{
+  const int points_len = 100000;
+  const int clusters_len = 3;
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(*points) * points_len, __func__);
+  int *duplicates = (int *)MEM_mallocN(sizeof(int) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    copy_v3_fl(points[i], (float)(i % clusters_len));
+    duplicates[i] = -1;
+  }
+
+  const int found = BLI_spatial_hash_3d_calc_duplicates(
+      points, points_len, nullptr, 0.001f, duplicates);
+  EXPECT_EQ(found, points_len - clusters_len);
+  for (int i = 0; i < points_len; i++) {
+    EXPECT_EQ(duplicates[i], i % clusters_len);
+  }
+
+  MEM_freeN(points);
+  MEM_freeN(duplicates);
+}
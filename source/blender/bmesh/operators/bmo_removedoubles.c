@@ -23,9 +23,9 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_alloca.h"
-#include "BLI_kdtree.h"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_spatial_hash.h"
 #include "BLI_stack.h"
 #include "BLI_utildefines_stack.h"
 
@@ -652,9 +652,9 @@ static void bmesh_find_doubles_common(BMesh *bm,
 
   int *duplicates = MEM_mallocN(sizeof(int) * verts_len, __func__);
   {
-    KDTree_3d *tree = BLI_kdtree_3d_new(verts_len);
+    float(*verts_co)[3] = MEM_mallocN(sizeof(*verts_co) * verts_len, __func__);
     for (int i = 0; i < verts_len; i++) {
-      BLI_kdtree_3d_insert(tree, i, verts[i]->co);
+      copy_v3_v3(verts_co[i], verts[i]->co);
       if (has_keep_vert && BMO_vert_flag_test(bm, verts[i], VERT_KEEP)) {
         duplicates[i] = i;
       }
@@ -663,9 +663,9 @@ static void bmesh_find_doubles_common(BMesh *bm,
       }
     }
 
-    BLI_kdtree_3d_balance(tree);
-    found_duplicates = BLI_kdtree_3d_calc_duplicates_fast(tree, dist, false, duplicates) != 0;
-    BLI_kdtree_3d_free(tree);
+    found_duplicates = BLI_spatial_hash_3d_calc_duplicates(
+                           verts_co, verts_len, NULL, dist, duplicates) != 0;
+    MEM_freeN(verts_co);
   }
 
   if (found_duplicates) {
@@ -0,0 +1,175 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_kdopbvh.h"
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "bmesh.h"
+#include "bmesh_tools.h"
+
+namespace blender::bmesh::tests {
+
+static float wave_grid_z(const float x, const float y)
+{
+  return 5.0f * sinf(x * 0.1f) * cosf(y * 0.13f);
+}
+
+/* A wavy grid of `size * size` quads. */
+static BMesh *wave_grid_bmesh_create(const int size)
+{
+  BMeshCreateParams bm_params{};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+
+  BMVert **verts = (BMVert **)MEM_mallocN(sizeof(*verts) * (size + 1) * (size + 1), __func__);
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      const float co[3] = {(float)x, (float)y, wave_grid_z(x, y)};
+      verts[y * (size + 1) + x] = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+    }
+  }
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int v = y * (size + 1) + x;
+      BMVert *quad[4] = {verts[v], verts[v + 1], verts[v + size + 2], verts[v + size + 1]};
+      BM_face_create_verts(bm, quad, 4, nullptr, BM_CREATE_NOP, true);
+    }
+  }
+  MEM_freeN(verts);
+
+  BM_mesh_normals_update(bm);
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE);
+  return bm;
+}
+
+static Array<float3> bmesh_vert_coords(BMesh *bm)
+{
+  Array<float3> coords(bm->totvert);
+  BMIter iter;
+  BMVert *v;
+  int i;
+  BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+    coords[i] = v->co;
+  }
+  return coords;
+}
+
+struct DecimateError {
+  float max, mean;
+};
+
+static void tris_nearest_cb(void *userdata, int index, const float co[3], BVHTreeNearest *nearest)
+{
+  const float(*tris)[3][3] = static_cast<const float(*)[3][3]>(userdata);
+  float co_nearest[3];
+  closest_on_tri_to_point_v3(co_nearest, co, UNPACK3(tris[index]));
+  const float dist_sq = len_squared_v3v3(co, co_nearest);
+  if (dist_sq < nearest->dist_sq) {
+    nearest->index = index;
+    nearest->dist_sq = dist_sq;
+    copy_v3_v3(nearest->co, co_nearest);
+  }
+}
+
+/* Distance from the vertices of the grid before decimating to the decimated surface. */
+static DecimateError wave_grid_decimate_error(BMesh *bm, const int size)
+{
+  Array<std::array<float3, 3>> tris(bm->totface);
+  BVHTree *tree = BLI_bvhtree_new(bm->totface, 0.0f, 2, 6);
+  BMIter iter;
+  BMFace *f;
+  int i;
+  BM_ITER_MESH_INDEX (f, &iter, bm, BM_FACES_OF_MESH, i) {
+    BMVert *v_tri[3];
+    BM_face_as_array_vert_tri(f, v_tri);
+    for (int j = 0; j < 3; j++) {
+      tris[i][j] = v_tri[j]->co;
+    }
+    BLI_bvhtree_insert(tree, i, (const float *)tris[i].data(), 3);
+  }
+  BLI_bvhtree_balance(tree);
+
+  DecimateError error = {0.0f, 0.0f};
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      const float co[3] = {(float)x, (float)y, wave_grid_z(x, y)};
+      BVHTreeNearest nearest;
+      nearest.index = -1;
+      nearest.dist_sq = FLT_MAX;
+      BLI_bvhtree_find_nearest(tree, co, &nearest, tris_nearest_cb, tris.data());
+      const float dist = sqrtf(nearest.dist_sq);
+      error.max = max_ff(error.max, dist);
+      error.mean += dist;
+    }
+  }
+  error.mean /= (float)((size + 1) * (size + 1));
+
+  BLI_bvhtree_free(tree);
+  return error;
+}
+
+static BMesh *wave_grid_decimate(const int size, const float factor, const int threads)
+{
+  BLI_system_num_threads_override_set(threads);
+  BLI_task_scheduler_init();
+
+  BMesh *bm = wave_grid_bmesh_create(size);
+  BM_mesh_decimate_collapse(bm, factor, nullptr, 1.0f, true, -1, 0.0f, true);
+
+  BLI_task_scheduler_exit();
+  BLI_system_num_threads_override_set(0);
+  return bm;
+}
+
+TEST(bmesh_decimate_collapse, Batched)
+{
+  /* Enough triangles for many batches. */
+  const int size = 230;
+  BMesh *bm = wave_grid_decimate(size, 0.1f, 4);
+  const int face_tot_target = (int)(size * size * 2 * 0.1f);
+
+  EXPECT_LE(bm->totface, face_tot_target);
+  EXPECT_GE(bm->totface, face_tot_target - 1);
+
+  /* The result must stay manifold & triangulated. */
+  BMIter iter;
+  BMEdge *e;
+  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
+    EXPECT_TRUE(BM_edge_is_manifold(e) || BM_edge_is_boundary(e));
+    EXPECT_EQ(BM_edge_find_double(e), nullptr);
+  }
+  BMFace *f;
+  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+    EXPECT_EQ(f->len, 3);
+    EXPECT_EQ(BM_face_find_double(f), nullptr);
+  }
+
+  /* Error of collapsing edges one at a time (without batches) on the same grid,
+   * batches may collapse in a different order but must stay close to it. */
+  const DecimateError error_ref = {0.169f, 0.0259f};
+  const DecimateError error = wave_grid_decimate_error(bm, size);
+  EXPECT_LE(error.max, error_ref.max * 1.25f);
+  EXPECT_LE(error.mean, error_ref.mean * 1.25f);
+
+  /* Batches don't depend on threading. */
+  BMesh *bm_single_thread = wave_grid_decimate(size, 0.1f, 1);
+  EXPECT_EQ(bm->totface, bm_single_thread->totface);
+  const Array<float3> coords = bmesh_vert_coords(bm);
+  const Array<float3> coords_single_thread = bmesh_vert_coords(bm_single_thread);
+  ASSERT_EQ(coords.size(), coords_single_thread.size());
+  for (const int i : coords.index_range()) {
+    EXPECT_EQ(coords[i], coords_single_thread[i]);
+  }
+
+  BM_mesh_free(bm_single_thread);
+  BM_mesh_free(bm);
+}
+
+}  // namespace blender::bmesh::tests
@@ -0,0 +1,188 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "PIL_time.h"
+
+#include "bmesh.h"
+
+#define DO_PERF_TESTS 0
+
+namespace blender::bmesh::tests {
+
+/* A grid of `size * size` quads, with a float attribute on the vertices. */
+static Mesh *grid_mesh_create(const int size)
+{
+  const int verts_num = (size + 1) * (size + 1);
+  const int polys_num = size * size;
+  Mesh *me = BKE_mesh_new_nomain(verts_num, 0, 0, polys_num * 4, polys_num);
+
+  float *values = (float *)CustomData_add_layer(
+      &me->vdata, CD_PROP_FLOAT, CD_CALLOC, nullptr, verts_num);
+
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      const int i = y * (size + 1) + x;
+      me->mvert[i].co[0] = (float)x;
+      me->mvert[i].co[1] = (float)y;
+      me->mvert[i].flag = (i % 3 == 0) ? SELECT : 0;
+      values[i] = (float)i;
+    }
+  }
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int i = y * size + x;
+      const int v = y * (size + 1) + x;
+      MPoly *mp = &me->mpoly[i];
+      mp->loopstart = i * 4;
+      mp->totloop = 4;
+      mp->mat_nr = (short)(i % 2);
+      MLoop *ml = &me->mloop[mp->loopstart];
+      ml[0].v = v;
+      ml[1].v = v + 1;
+      ml[2].v = v + size + 2;
+      ml[3].v = v + size + 1;
+    }
+  }
+
+  BKE_mesh_calc_edges(me, false, false);
+  return me;
+}
+
+static BMesh *bmesh_from_mesh(const Mesh *me)
+{
+  const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(me);
+  BMeshCreateParams create_params{};
+  BMesh *bm = BM_mesh_create(&allocsize, &create_params);
+
+  BMeshFromMeshParams convert_params{};
+  convert_params.calc_face_normal = true;
+  BM_mesh_bm_from_me(bm, me, &convert_params);
+  return bm;
+}
+
+TEST(bmesh_mesh_convert, RoundTrip)
+{
+  BKE_idtype_init();
+  BLI_task_scheduler_init();
+
+  /* Large enough to run threaded. */
+  const int size = 120;
+  Mesh *me = grid_mesh_create(size);
+  BMesh *bm = bmesh_from_mesh(me);
+
+  EXPECT_EQ(bm->totvert, me->totvert);
+  EXPECT_EQ(bm->totedge, me->totedge);
+  EXPECT_EQ(bm->totface, me->totpoly);
+  EXPECT_EQ(bm->totloop, me->totloop);
+
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_FACE);
+  const int cd_value_offset = CustomData_get_offset(&bm->vdata, CD_PROP_FLOAT);
+  ASSERT_NE(cd_value_offset, -1);
+  for (int i = 0; i < bm->totvert; i++) {
+    BMVert *v = BM_vert_at_index(bm, i);
+    EXPECT_EQ(BM_ELEM_CD_GET_FLOAT(v, cd_value_offset), (float)i);
+    EXPECT_EQ(BM_elem_flag_test_bool(v, BM_ELEM_SELECT), i % 3 == 0);
+  }
+  for (int i = 0; i < bm->totface; i++) {
+    BMFace *f = BM_face_at_index(bm, i);
+    EXPECT_EQ(f->mat_nr, i % 2);
+    EXPECT_EQ(f->no[2], 1.0f);
+  }
+
+  Mesh *me_result = BKE_mesh_from_bmesh_for_eval_nomain(bm, nullptr, me);
+  ASSERT_EQ(me_result->totvert, me->totvert);
+  ASSERT_EQ(me_result->totedge, me->totedge);
+  ASSERT_EQ(me_result->totpoly, me->totpoly);
+  ASSERT_EQ(me_result->totloop, me->totloop);
+
+  const float *values = (const float *)CustomData_get_layer(&me->vdata, CD_PROP_FLOAT);
+  const float *values_result = (const float *)CustomData_get_layer(&me_result->vdata,
+                                                                   CD_PROP_FLOAT);
+  ASSERT_NE(values_result, nullptr);
+  for (int i = 0; i < me->totvert; i++) {
+    EXPECT_EQ(values_result[i], values[i]);
+    EXPECT_V3_NEAR(me_result->mvert[i].co, me->mvert[i].co, 0.0f);
+    EXPECT_EQ(me_result->mvert[i].flag & SELECT, me->mvert[i].flag & SELECT);
+  }
+  for (int i = 0; i < me->totedge; i++) {
+    EXPECT_EQ(me_result->medge[i].v1, me->medge[i].v1);
+    EXPECT_EQ(me_result->medge[i].v2, me->medge[i].v2);
+  }
+  for (int i = 0; i < me->totpoly; i++) {
+    EXPECT_EQ(me_result->mpoly[i].loopstart, me->mpoly[i].loopstart);
+    EXPECT_EQ(me_result->mpoly[i].totloop, me->mpoly[i].totloop);
+    EXPECT_EQ(me_result->mpoly[i].mat_nr, me->mpoly[i].mat_nr);
+  }
+  for (int i = 0; i < me->totloop; i++) {
+    EXPECT_EQ(me_result->mloop[i].v, me->mloop[i].v);
+    EXPECT_EQ(me_result->mloop[i].e, me->mloop[i].e);
+  }
+
+  BKE_id_free(nullptr, me_result);
+  BM_mesh_free(bm);
+  BKE_id_free(nullptr, me);
+
+  BLI_task_scheduler_exit();
+}
+
+#if DO_PERF_TESTS
+
+static void convert_perf_test(const int size)
+{
+  BKE_idtype_init();
+  BLI_task_scheduler_init();
+
+  Mesh *me = grid_mesh_create(size);
+
+  const double time_start = PIL_check_seconds_timer();
+  BMesh *bm = bmesh_from_mesh(me);
+  const double time_from_mesh = PIL_check_seconds_timer();
+  Mesh *me_result = BKE_mesh_from_bmesh_for_eval_nomain(bm, nullptr, me);
+  const double time_to_mesh = PIL_check_seconds_timer();
+
+  std::cout << "Faces: " << me->totpoly << "\n";
+  std::cout << "Mesh -> BMesh time: " << time_from_mesh - time_start << "\n";
+  std::cout << "BMesh -> Mesh time: " << time_to_mesh - time_from_mesh << "\n";
+
+  BKE_id_free(nullptr, me_result);
+  BM_mesh_free(bm);
+  BKE_id_free(nullptr, me);
+
+  BLI_task_scheduler_exit();
+}
+
+TEST(bmesh_mesh_convert_perf, Grid1M)
+{
+  convert_perf_test(1000);
+}
+
+TEST(bmesh_mesh_convert_perf, Grid4M)
+{
+  convert_perf_test(2000);
+}
+
+TEST(bmesh_mesh_convert_perf, Grid10M)
+{
+  convert_perf_test(3163);
+}
+
+#endif
+
+}  // namespace blender::bmesh::tests
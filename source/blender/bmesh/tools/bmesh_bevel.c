@@ -29,8 +29,11 @@
 
 #include "BLI_alloca.h"
 #include "BLI_array.h"
+#include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_curveprofile.h"
@@ -323,6 +326,8 @@ typedef struct BevelParams {
   GHash *face_hash;
   /** Use for all allocs while bevel runs. Note: If we need to free we can switch to mempool. */
   MemArena *mem_arena;
+  /** Arenas used by the threads of the parallel passes, freed along with mem_arena. */
+  LinkNode *thread_arenas;
   /** Profile vertex location and spacings. */
   ProfileSpacing pro_spacing;
   /** Parameter values for evenly spaced profile points for the miter profiles. */
@@ -5688,10 +5693,14 @@ static void bevel_vert_two_edges(BevelParams *bp, BMesh *bm, BevVert *bv)
 
 /* Given that the boundary is built, now make the actual BMVerts
  * for the boundary and the interior of the vertex mesh. */
-static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
+/**
+ * Allocate the vertex mesh of \a bv and calculate its boundary profiles, the part of
+ * #build_vmesh which doesn't change the BMesh. Only data of \a bv is written to,
+ * so this can run for multiple BevVerts in parallel.
+ */
+static void build_vmesh_profiles(BevelParams *bp, BevVert *bv)
 {
   VMesh *vm = bv->vmesh;
-  float co[3];
 
   int n = vm->count;
   int ns = vm->seg;
@@ -5702,16 +5711,12 @@ static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
 
   /* Special case: just two beveled edges welded together. */
   const bool weld = (bv->selcount == 2) && (vm->count == 2);
-  BoundVert *weld1 = NULL; /* Will hold two BoundVerts involved in weld. */
-  BoundVert *weld2 = NULL;
+  BoundVert *weld1 = NULL;
 
-  /* Make (i, 0, 0) mesh verts for all i boundverts. */
   BoundVert *bndv = vm->boundstart;
   do {
     int i = bndv->index;
     copy_v3_v3(mesh_vert(vm, i, 0, 0)->co, bndv->nv.co); /* Mesh NewVert to boundary NewVert. */
-    create_mesh_bmvert(bm, vm, i, 0, 0, bv->v);          /* Create BMVert for that NewVert. */
-    bndv->nv.v = mesh_vert(vm, i, 0, 0)->v; /* Use the BMVert for the BoundVert's NewVert. */
 
     /* Find boundverts and move profile planes if this is a weld case. */
     if (weld && bndv->ebev) {
@@ -5719,10 +5724,9 @@ static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
         weld1 = bndv;
       }
       else { /* Get the last of the two BoundVerts. */
-        weld2 = bndv;
         set_profile_params(bp, bv, weld1);
-        set_profile_params(bp, bv, weld2);
-        move_weld_profile_planes(bv, weld1, weld2);
+        set_profile_params(bp, bv, bndv);
+        move_weld_profile_planes(bv, weld1, bndv);
       }
     }
   } while ((bndv = bndv->next) != vm->boundstart);
@@ -5730,6 +5734,38 @@ static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
   /* It's simpler to calculate all profiles only once at a single moment, so keep just a single
    * profile calculation here, the last point before actual mesh verts are created. */
   calculate_vm_profiles(bp, bv, vm);
+}
+
+/* Expects #build_vmesh_profiles to have been called for \a bv. */
+static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
+{
+  VMesh *vm = bv->vmesh;
+  float co[3];
+
+  int n = vm->count;
+  int ns = vm->seg;
+
+  /* Special case: just two beveled edges welded together. */
+  const bool weld = (bv->selcount == 2) && (vm->count == 2);
+  BoundVert *weld1 = NULL; /* Will hold two BoundVerts involved in weld. */
+  BoundVert *weld2 = NULL;
+
+  /* Make (i, 0, 0) mesh verts for all i boundverts. */
+  BoundVert *bndv = vm->boundstart;
+  do {
+    int i = bndv->index;
+    create_mesh_bmvert(bm, vm, i, 0, 0, bv->v); /* Create BMVert for that NewVert. */
+    bndv->nv.v = mesh_vert(vm, i, 0, 0)->v;     /* Use the BMVert for the BoundVert's NewVert. */
+
+    if (weld && bndv->ebev) {
+      if (!weld1) {
+        weld1 = bndv;
+      }
+      else {
+        weld2 = bndv;
+      }
+    }
+  } while ((bndv = bndv->next) != vm->boundstart);
 
   /* Create new vertices and place them based on the profiles. */
   /* Copy other ends to (i, 0, ns) for all i, and fill in profiles for edges. */
@@ -7440,6 +7476,89 @@ static void bevel_limit_offset(BevelParams *bp, BMesh *bm)
   }
 }
 
+/* Minimum number of BevVerts to run the per-vertex passes in parallel. */
+#define BEVEL_PARALLEL_LIMIT 64
+
+typedef struct BevelParallelData {
+  BevelParams *bp;
+  BevVert **bevverts;
+  /* Protects adding to #BevelParams.thread_arenas. */
+  ThreadMutex mutex;
+} BevelParallelData;
+
+/* Parameters of the current thread, allocating from an arena of its own. */
+static BevelParams *bevel_parallel_params(const TaskParallelTLS *__restrict tls)
+{
+  BevelParams *bp = tls->userdata_chunk;
+  if (bp->mem_arena == NULL) {
+    bp->mem_arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+    BLI_memarena_use_calloc(bp->mem_arena);
+  }
+  return bp;
+}
+
+static void bevel_parallel_free(const void *__restrict userdata, void *__restrict chunk)
+{
+  BevelParallelData *data = (BevelParallelData *)userdata;
+  BevelParams *bp = data->bp;
+  BevelParams *bp_thread = chunk;
+  if (bp_thread->mem_arena) {
+    /* Results are allocated in the arena, keep it until bevel finishes. */
+    BLI_mutex_lock(&data->mutex);
+    BLI_linklist_prepend_arena(&bp->thread_arenas, bp_thread->mem_arena, bp->mem_arena);
+    BLI_mutex_unlock(&data->mutex);
+    bp_thread->mem_arena = NULL;
+  }
+}
+
+static void bevel_build_boundary_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict tls)
+{
+  const BevelParallelData *data = userdata;
+  build_boundary(bevel_parallel_params(tls), data->bevverts[i], true);
+}
+
+static void bevel_build_vmesh_profiles_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict tls)
+{
+  const BevelParallelData *data = userdata;
+  build_vmesh_profiles(bevel_parallel_params(tls), data->bevverts[i]);
+}
+
+/**
+ * Run \a func for all \a bevverts, which may only write to the BevVert it is called for.
+ * Topology changes happen afterwards in serial passes.
+ */
+static void bevel_parallel_bevverts(BevelParams *bp,
+                                    BevVert **bevverts,
+                                    const int bevverts_len,
+                                    TaskParallelRangeFunc func)
+{
+  BevelParallelData data = {
+      .bp = bp,
+      .bevverts = bevverts,
+  };
+  BLI_mutex_init(&data.mutex);
+
+  /* Copied for each thread, which replaces the arena by its own. */
+  BevelParams bp_thread = *bp;
+  bp_thread.mem_arena = NULL;
+  bp_thread.thread_arenas = NULL;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = bevverts_len >= BEVEL_PARALLEL_LIMIT;
+  settings.min_iter_per_thread = BEVEL_PARALLEL_LIMIT / 4;
+  settings.userdata_chunk = &bp_thread;
+  settings.userdata_chunk_size = sizeof(bp_thread);
+  settings.func_free = bevel_parallel_free;
+  BLI_task_parallel_range(0, bevverts_len, &data, func, &settings);
+
+  BLI_mutex_end(&data.mutex);
+}
+
 /**
  * - Currently only bevels BM_ELEM_TAG'd verts and edges.
  *
@@ -7563,12 +7682,14 @@ void BM_mesh_bevel(BMesh *bm,
 
   math_layer_info_init(&bp, bm);
 
-  /* Analyze input vertices, sorting edges and assigning initial new vertex positions. */
+  /* Analyze input vertices, sorting edges. */
+  BevVert **bevverts = BLI_memarena_alloc(bp.mem_arena, sizeof(*bevverts) * bm->totvert);
+  int bevverts_len = 0;
   BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
     if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
       bv = bevel_vert_construct(bm, &bp, v);
-      if (!limit_offset && bv) {
-        build_boundary(&bp, bv, true);
+      if (bv) {
+        bevverts[bevverts_len++] = bv;
       }
     }
   }
@@ -7576,18 +7697,11 @@ void BM_mesh_bevel(BMesh *bm,
   /* Perhaps clamp offset to avoid geometry collisions. */
   if (limit_offset) {
     bevel_limit_offset(&bp, bm);
-
-    /* Assign initial new vertex positions. */
-    BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-      if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
-        bv = find_bevvert(&bp, v);
-        if (bv) {
-          build_boundary(&bp, bv, true);
-        }
-      }
-    }
   }
 
+  /* Assign initial new vertex positions. */
+  bevel_parallel_bevverts(&bp, bevverts, bevverts_len, bevel_build_boundary_cb);
+
   /* Perhaps do a pass to try to even out widths. */
   if (bp.offset_adjust) {
     adjust_offsets(&bp, bm);
@@ -7603,13 +7717,9 @@ void BM_mesh_bevel(BMesh *bm,
   }
 
   /* Build the meshes around vertices, now that positions are final. */
-  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-    if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
-      bv = find_bevvert(&bp, v);
-      if (bv) {
-        build_vmesh(&bp, bm, bv);
-      }
-    }
+  bevel_parallel_bevverts(&bp, bevverts, bevverts_len, bevel_build_vmesh_profiles_cb);
+  for (int i = 0; i < bevverts_len; i++) {
+    build_vmesh(&bp, bm, bevverts[i]);
   }
 
   /* Build polygons for edges. */
@@ -7681,6 +7791,9 @@ void BM_mesh_bevel(BMesh *bm,
   /* Primary free. */
   BLI_ghash_free(bp.vert_hash, NULL, NULL);
   BLI_ghash_free(bp.face_hash, NULL, NULL);
+  for (LinkNode *node = bp.thread_arenas; node; node = node->next) {
+    BLI_memarena_free(node->link);
+  }
   BLI_memarena_free(bp.mem_arena);
 
 #ifdef BEVEL_DEBUG_TIME
@@ -26,7 +26,8 @@ void BM_mesh_decimate_collapse(BMesh *bm,
                                float vweight_factor,
                                const bool do_triangulate,
                                const int symmetry_axis,
-                               const float symmetry_eps);
+                               const float symmetry_eps,
+                               const bool use_batch);
 
 void BM_mesh_decimate_unsubdivide_ex(BMesh *bm, const int iterations, const bool tag_only);
 void BM_mesh_decimate_unsubdivide(BMesh *bm, const int iterations);
@@ -25,6 +25,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_alloca.h"
+#include "BLI_buffer.h"
 #include "BLI_heap.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
@@ -32,6 +33,7 @@
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
 #include "BLI_quadric.h"
+#include "BLI_task.h"
 #include "BLI_utildefines_stack.h"
 
 #include "BKE_customdata.h"
@@ -66,6 +68,13 @@
  */
 #define OPTIMIZE_EPS 1e-8
 #define COST_INVALID FLT_MAX
+/* Cost of edges which must not be collapsed, these are removed from the heap. */
+#define COST_CLEAR -FLT_MAX
+
+/* Maximum number of edges collapsed in one batch, see #bm_decim_collapse_batched. */
+#define BATCH_SIZE 4096
+/* Maximum number of edges which are skipped because they overlap an edge of the batch. */
+#define BATCH_DEFER_MAX 1024
 
 typedef enum CD_UseFlag {
   CD_DO_VERT = (1 << 0),
@@ -76,6 +85,44 @@ typedef enum CD_UseFlag {
 /* BMesh Helper Functions
  * ********************** */
 
+static void bm_decim_face_quadric(BMFace *f, Quadric *r_q)
+{
+  float center[3];
+  double plane_db[4];
+
+  BM_face_calc_center_median(f, center);
+  copy_v3db_v3fl(plane_db, f->no);
+  plane_db[3] = -dot_v3db_v3fl(plane_db, center);
+
+  BLI_quadric_from_plane(r_q, plane_db);
+}
+
+/**
+ * \return false when the boundary edge \a e doesn't define a plane (zero length).
+ */
+static bool bm_decim_boundary_edge_quadric(BMEdge *e, Quadric *r_q)
+{
+  float edge_vector[3];
+  float edge_plane[3];
+  double edge_plane_db[4];
+  sub_v3_v3v3(edge_vector, e->v2->co, e->v1->co);
+
+  cross_v3_v3v3(edge_plane, edge_vector, e->l->f->no);
+  copy_v3db_v3fl(edge_plane_db, edge_plane);
+
+  if (normalize_v3_db(edge_plane_db) > (double)FLT_EPSILON) {
+    float center[3];
+
+    mid_v3_v3v3(center, e->v1->co, e->v2->co);
+
+    edge_plane_db[3] = -dot_v3db_v3fl(edge_plane_db, center);
+    BLI_quadric_from_plane(r_q, edge_plane_db);
+    BLI_quadric_mul(r_q, BOUNDARY_PRESERVE_WEIGHT);
+    return true;
+  }
+  return false;
+}
+
 /**
  * \param vquadrics: must be calloc'd
  */
@@ -88,16 +135,9 @@ static void bm_decim_build_quadrics(BMesh *bm, Quadric *vquadrics)
   BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
     BMLoop *l_first;
     BMLoop *l_iter;
-
-    float center[3];
-    double plane_db[4];
     Quadric q;
 
-    BM_face_calc_center_median(f, center);
-    copy_v3db_v3fl(plane_db, f->no);
-    plane_db[3] = -dot_v3db_v3fl(plane_db, center);
-
-    BLI_quadric_from_plane(&q, plane_db);
+    bm_decim_face_quadric(f, &q);
 
     l_iter = l_first = BM_FACE_FIRST_LOOP(f);
     do {
@@ -108,32 +148,66 @@ static void bm_decim_build_quadrics(BMesh *bm, Quadric *vquadrics)
   /* boundary edges */
   BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
     if (UNLIKELY(BM_edge_is_boundary(e))) {
-      float edge_vector[3];
-      float edge_plane[3];
-      double edge_plane_db[4];
-      sub_v3_v3v3(edge_vector, e->v2->co, e->v1->co);
-      f = e->l->f;
-
-      cross_v3_v3v3(edge_plane, edge_vector, f->no);
-      copy_v3db_v3fl(edge_plane_db, edge_plane);
+      Quadric q;
+      if (bm_decim_boundary_edge_quadric(e, &q)) {
+        BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(e->v1)], &q);
+        BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(e->v2)], &q);
+      }
+    }
+  }
+}
 
-      if (normalize_v3_db(edge_plane_db) > (double)FLT_EPSILON) {
-        Quadric q;
-        float center[3];
+typedef struct DecimQuadricsData {
+  BMesh *bm;
+  Quadric *vquadrics;
+} DecimQuadricsData;
 
-        mid_v3_v3v3(center, e->v1->co, e->v2->co);
+static void bm_decim_build_quadrics_vert_cb(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DecimQuadricsData *data = userdata;
+  BMVert *v = data->bm->vtable[i];
+  Quadric *vq = &data->vquadrics[BM_elem_index_get(v)];
+  Quadric q;
 
-        edge_plane_db[3] = -dot_v3db_v3fl(edge_plane_db, center);
-        BLI_quadric_from_plane(&q, edge_plane_db);
-        BLI_quadric_mul(&q, BOUNDARY_PRESERVE_WEIGHT);
+  BMIter liter;
+  BMLoop *l;
+  BM_ITER_ELEM (l, &liter, v, BM_LOOPS_OF_VERT) {
+    bm_decim_face_quadric(l->f, &q);
+    BLI_quadric_add_qu_qu(vq, &q);
+  }
 
-        BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(e->v1)], &q);
-        BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(e->v2)], &q);
+  if (v->e) {
+    BMEdge *e_iter, *e_first;
+    e_iter = e_first = v->e;
+    do {
+      if (UNLIKELY(BM_edge_is_boundary(e_iter)) && bm_decim_boundary_edge_quadric(e_iter, &q)) {
+        BLI_quadric_add_qu_qu(vq, &q);
       }
-    }
+    } while ((e_iter = BM_DISK_EDGE_NEXT(e_iter, v)) != e_first);
   }
 }
 
+/**
+ * A version of #bm_decim_build_quadrics which gathers the quadrics of each vertex in parallel,
+ * face quadrics are calculated once for each of their vertices instead of being scattered.
+ * Summing in a different order gives slightly different values.
+ */
+static void bm_decim_build_quadrics_parallel(BMesh *bm, Quadric *vquadrics)
+{
+  BM_mesh_elem_table_ensure(bm, BM_VERT);
+
+  DecimQuadricsData data = {
+      .bm = bm,
+      .vquadrics = vquadrics,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = bm->totvert >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(0, bm->totvert, &data, bm_decim_build_quadrics_vert_cb, &settings);
+}
+
 static void bm_decim_calc_target_co_db(BMEdge *e, double optimize_co[3], const Quadric *vquadrics)
 {
   /* compute an edge contraction target for edge 'e'
@@ -236,18 +310,20 @@ static float bm_decim_build_edge_cost_single__topology(BMEdge *e)
 
 #endif /* USE_TOPOLOGY_FALLBACK */
 
-static void bm_decim_build_edge_cost_single(BMEdge *e,
-                                            const Quadric *vquadrics,
-                                            const float *vweights,
-                                            const float vweight_factor,
-                                            Heap *eheap,
-                                            HeapNode **eheap_table)
+/**
+ * \return The cost of collapsing \a e or #COST_CLEAR when it can't be collapsed.
+ * Only reads the mesh, so costs can be calculated in parallel.
+ */
+static float bm_decim_calc_edge_cost(BMEdge *e,
+                                     const Quadric *vquadrics,
+                                     const float *vweights,
+                                     const float vweight_factor)
 {
   float cost;
 
   if (UNLIKELY(vweights && ((vweights[BM_elem_index_get(e->v1)] == 0.0f) ||
                             (vweights[BM_elem_index_get(e->v2)] == 0.0f)))) {
-    goto clear;
+    return COST_CLEAR;
   }
 
   /* check we can collapse, some edges we better not touch */
@@ -257,7 +333,7 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
     else {
       /* only collapse tri's */
-      goto clear;
+      return COST_CLEAR;
     }
   }
   else if (BM_edge_is_manifold(e)) {
@@ -266,11 +342,11 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
     else {
       /* only collapse tri's */
-      goto clear;
+      return COST_CLEAR;
     }
   }
   else {
-    goto clear;
+    return COST_CLEAR;
   }
   /* end sanity check */
 
@@ -322,16 +398,36 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
   }
 
-  BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
-  return;
+  return cost;
+}
+
+static void bm_decim_edge_cost_apply(BMEdge *e,
+                                     const float cost,
+                                     Heap *eheap,
+                                     HeapNode **eheap_table)
+{
+  if (cost != COST_CLEAR) {
+    BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
+    return;
+  }
 
-clear:
   if (eheap_table[BM_elem_index_get(e)]) {
     BLI_heap_remove(eheap, eheap_table[BM_elem_index_get(e)]);
   }
   eheap_table[BM_elem_index_get(e)] = NULL;
 }
 
+static void bm_decim_build_edge_cost_single(BMEdge *e,
+                                            const Quadric *vquadrics,
+                                            const float *vweights,
+                                            const float vweight_factor,
+                                            Heap *eheap,
+                                            HeapNode **eheap_table)
+{
+  const float cost = bm_decim_calc_edge_cost(e, vquadrics, vweights, vweight_factor);
+  bm_decim_edge_cost_apply(e, cost, eheap, eheap_table);
+}
+
 /* use this for degenerate cases - add back to the heap with an invalid cost,
  * this way it may be calculated again if surrounding geometry changes */
 static void bm_decim_invalid_edge_cost_single(BMEdge *e, Heap *eheap, HeapNode **eheap_table)
@@ -340,6 +436,45 @@ static void bm_decim_invalid_edge_cost_single(BMEdge *e, Heap *eheap, HeapNode *
   eheap_table[BM_elem_index_get(e)] = BLI_heap_insert(eheap, COST_INVALID, e);
 }
 
+typedef struct DecimEdgeCostData {
+  BMEdge **edges;
+  float *costs;
+  const Quadric *vquadrics;
+  const float *vweights;
+  float vweight_factor;
+} DecimEdgeCostData;
+
+static void bm_decim_calc_edge_cost_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DecimEdgeCostData *data = userdata;
+  data->costs[i] = bm_decim_calc_edge_cost(
+      data->edges[i], data->vquadrics, data->vweights, data->vweight_factor);
+}
+
+/* Calculate the costs of \a edges in parallel, writing them to \a r_costs. */
+static void bm_decim_calc_edge_cost_array(BMEdge **edges,
+                                          const int edges_len,
+                                          const Quadric *vquadrics,
+                                          const float *vweights,
+                                          const float vweight_factor,
+                                          float *r_costs)
+{
+  DecimEdgeCostData data = {
+      .edges = edges,
+      .costs = r_costs,
+      .vquadrics = vquadrics,
+      .vweights = vweights,
+      .vweight_factor = vweight_factor,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = edges_len >= BM_OMP_LIMIT;
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, edges_len, &data, bm_decim_calc_edge_cost_cb, &settings);
+}
+
 static void bm_decim_build_edge_cost(BMesh *bm,
                                      const Quadric *vquadrics,
                                      const float *vweights,
@@ -347,15 +482,20 @@ static void bm_decim_build_edge_cost(BMesh *bm,
                                      Heap *eheap,
                                      HeapNode **eheap_table)
 {
-  BMIter iter;
-  BMEdge *e;
-  uint i;
+  BM_mesh_elem_table_ensure(bm, BM_EDGE);
 
-  BM_ITER_MESH_INDEX (e, &iter, bm, BM_EDGES_OF_MESH, i) {
+  /* Costs are calculated in parallel, filling the heap isn't thread safe. */
+  float *costs = MEM_malloc_arrayN((size_t)bm->totedge, sizeof(*costs), __func__);
+  bm_decim_calc_edge_cost_array(
+      bm->etable, bm->totedge, vquadrics, vweights, vweight_factor, costs);
+
+  for (int i = 0; i < bm->totedge; i++) {
     /* keep sanity check happy */
     eheap_table[i] = NULL;
-    bm_decim_build_edge_cost_single(e, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+    bm_decim_edge_cost_apply(bm->etable[i], costs[i], eheap, eheap_table);
   }
+
+  MEM_freeN(costs);
 }
 
 #ifdef USE_SYMMETRY
@@ -1119,6 +1259,8 @@ static bool bm_edge_collapse(BMesh *bm,
 /**
  * Collapse e the edge, removing e->v2
  *
+ * \param edges_update: When set, edges which need their cost updated are appended
+ * instead of being updated in the heap.
  * \return true when the edge was collapsed.
  */
 static bool bm_decim_edge_collapse(BMesh *bm,
@@ -1133,7 +1275,8 @@ static bool bm_decim_edge_collapse(BMesh *bm,
 #endif
                                    const CD_UseFlag customdata_flag,
                                    float optimize_co[3],
-                                   bool optimize_co_calc)
+                                   bool optimize_co_calc,
+                                   BLI_Buffer *edges_update)
 {
   int e_clear_other[2];
   BMVert *v_other = e->v1;
@@ -1235,8 +1378,13 @@ static bool bm_decim_edge_collapse(BMesh *bm,
       e_iter = e_first = v_other->e;
       do {
         BLI_assert(BM_edge_find_double(e_iter) == NULL);
-        bm_decim_build_edge_cost_single(
-            e_iter, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+        if (edges_update) {
+          BLI_buffer_append(edges_update, BMEdge *, e_iter);
+        }
+        else {
+          bm_decim_build_edge_cost_single(
+              e_iter, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+        }
       } while ((e_iter = bmesh_disk_edge_next(e_iter, v_other)) != e_first);
     }
 
@@ -1260,8 +1408,13 @@ static bool bm_decim_edge_collapse(BMesh *bm,
 
           BLI_assert(BM_vert_in_edge(e_outer, l->v) == false);
 
-          bm_decim_build_edge_cost_single(
-              e_outer, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+          if (edges_update) {
+            BLI_buffer_append(edges_update, BMEdge *, e_outer);
+          }
+          else {
+            bm_decim_build_edge_cost_single(
+                e_outer, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+          }
         }
       }
     }
@@ -1274,6 +1427,198 @@ static bool bm_decim_edge_collapse(BMesh *bm,
   return false;
 }
 
+/* Batched Edge Collapse
+ * ********************* */
+
+typedef struct DecimBatchItem {
+  BMEdge *e;
+  float optimize_co[3];
+  bool is_valid;
+} DecimBatchItem;
+
+typedef struct DecimBatchData {
+  DecimBatchItem *items;
+  const Quadric *vquadrics;
+} DecimBatchData;
+
+/**
+ * Stamp the vertices read or modified by collapsing \a e with \a batch
+ * (the closed 1-ring of both vertices, faces are triangulated so this includes their vertices).
+ *
+ * \return false when the region overlaps an edge already in the batch.
+ */
+static bool bm_decim_batch_region_claim(BMEdge *e, int *vert_batch, const int batch)
+{
+  BMVert *verts[2] = {e->v1, e->v2};
+  for (int i = 0; i < 2; i++) {
+    BMEdge *e_iter, *e_first;
+    if (vert_batch[BM_elem_index_get(verts[i])] == batch) {
+      return false;
+    }
+    e_iter = e_first = verts[i]->e;
+    do {
+      if (vert_batch[BM_elem_index_get(BM_edge_other_vert(e_iter, verts[i]))] == batch) {
+        return false;
+      }
+    } while ((e_iter = bmesh_disk_edge_next(e_iter, verts[i])) != e_first);
+  }
+
+  for (int i = 0; i < 2; i++) {
+    BMEdge *e_iter, *e_first;
+    vert_batch[BM_elem_index_get(verts[i])] = batch;
+    e_iter = e_first = verts[i]->e;
+    do {
+      vert_batch[BM_elem_index_get(BM_edge_other_vert(e_iter, verts[i]))] = batch;
+    } while ((e_iter = bmesh_disk_edge_next(e_iter, verts[i])) != e_first);
+  }
+  return true;
+}
+
+static void bm_decim_batch_check_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DecimBatchData *data = userdata;
+  DecimBatchItem *item = &data->items[i];
+
+  /* Tags are only written to elements in the region claimed by this edge. */
+  item->is_valid = false;
+  if (UNLIKELY(bm_edge_collapse_is_degenerate_topology(item->e))) {
+    return;
+  }
+  bm_decim_calc_target_co_fl(item->e, item->optimize_co, data->vquadrics);
+  if (UNLIKELY(bm_edge_collapse_is_degenerate_flip(item->e, item->optimize_co))) {
+    return;
+  }
+  item->is_valid = true;
+}
+
+/**
+ * Collapse edges in order of cost like the non-mirror loop in #BM_mesh_decimate_collapse,
+ * in batches of edges which don't touch each others 1-ring.
+ *
+ * Collapsing an edge only reads & writes its region, so the edges of a batch can be checked
+ * and have their surrounding costs updated in parallel. Changing the mesh and the heap isn't
+ * thread safe and remains serial, in the order of the batch, so the result doesn't depend on
+ * threading.
+ *
+ * The order of collapses differs from collapsing the cheapest edge one at a time: edges of a
+ * batch are chosen before the costs around the previous edges of the batch are updated, and
+ * edges overlapping them wait for the next batch. Collapses are still mostly in order of cost,
+ * the decimated mesh has a similar (not identical) error.
+ */
+static void bm_decim_collapse_batched(BMesh *bm,
+                                      const int face_tot_target,
+                                      Quadric *vquadrics,
+                                      float *vweights,
+                                      const float vweight_factor,
+                                      Heap *eheap,
+                                      HeapNode **eheap_table,
+                                      const CD_UseFlag customdata_flag)
+{
+  struct {
+    BMEdge *e;
+    float cost;
+  } *deferred = MEM_malloc_arrayN(BATCH_DEFER_MAX, sizeof(*deferred), __func__);
+  DecimBatchItem *items = MEM_malloc_arrayN(BATCH_SIZE, sizeof(*items), __func__);
+  int *vert_batch = MEM_calloc_arrayN((size_t)bm->totvert, sizeof(*vert_batch), __func__);
+  BLI_buffer_declare_static(BMEdge *, edges_update, 0, 512);
+  BLI_buffer_declare_static(float, edges_update_cost, 0, 512);
+  int batch = 0;
+
+  DecimBatchData data = {
+      .items = items,
+      .vquadrics = vquadrics,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+
+  while ((bm->totface > face_tot_target) && (BLI_heap_is_empty(eheap) == false) &&
+         (BLI_heap_top_value(eheap) != COST_INVALID)) {
+    /* Each collapse removes two faces, don't collapse (much) more than the target. */
+    const int items_max = min_ii(BATCH_SIZE, max_ii(1, (bm->totface - face_tot_target) / 2));
+    int items_len = 0, deferred_len = 0;
+
+    batch++;
+
+    /* Take the cheapest edges which don't overlap,
+     * the first edge always succeeds so each batch collapses at least one edge. */
+    while ((items_len < items_max) && (deferred_len < BATCH_DEFER_MAX) &&
+           (BLI_heap_is_empty(eheap) == false) && (BLI_heap_top_value(eheap) != COST_INVALID)) {
+      const float cost = BLI_heap_top_value(eheap);
+      BMEdge *e = BLI_heap_pop_min(eheap);
+      eheap_table[BM_elem_index_get(e)] = NULL;
+
+      if (bm_decim_batch_region_claim(e, vert_batch, batch)) {
+        items[items_len++].e = e;
+      }
+      else {
+        deferred[deferred_len].e = e;
+        deferred[deferred_len].cost = cost;
+        deferred_len++;
+      }
+    }
+
+    /* Add skipped edges back before collapsing, so they're handled like any other edge
+     * in the heap (removed when collapsing kills them, updated when their cost changes). */
+    for (int i = 0; i < deferred_len; i++) {
+      BMEdge *e = deferred[i].e;
+      eheap_table[BM_elem_index_get(e)] = BLI_heap_insert(eheap, deferred[i].cost, e);
+    }
+
+    settings.use_threading = items_len >= settings.min_iter_per_thread;
+    BLI_task_parallel_range(0, items_len, &data, bm_decim_batch_check_cb, &settings);
+
+    BLI_buffer_clear(&edges_update);
+    for (int i = 0; i < items_len; i++) {
+      DecimBatchItem *item = &items[i];
+      if (!item->is_valid) {
+        /* add back with a high cost */
+        bm_decim_invalid_edge_cost_single(item->e, eheap, eheap_table);
+        continue;
+      }
+      bm_decim_edge_collapse(bm,
+                             item->e,
+                             vquadrics,
+                             vweights,
+                             vweight_factor,
+                             eheap,
+                             eheap_table,
+#ifdef USE_SYMMETRY
+                             NULL,
+#endif
+                             customdata_flag,
+                             item->optimize_co,
+                             false,
+                             &edges_update);
+    }
+
+    const int edges_update_len = (int)edges_update.count;
+    if (edges_update_len == 0) {
+      continue;
+    }
+    float *costs = BLI_buffer_reinit_data(&edges_update_cost, float, edges_update_len);
+    bm_decim_calc_edge_cost_array(BLI_buffer_array(&edges_update, BMEdge *),
+                                  edges_update_len,
+                                  vquadrics,
+                                  vweights,
+                                  vweight_factor,
+                                  costs);
+    for (int i = 0; i < edges_update_len; i++) {
+      BMEdge *e = BLI_buffer_at(&edges_update, BMEdge *, i);
+      BLI_assert(BM_edge_find_double(e) == NULL);
+      bm_decim_edge_cost_apply(e, costs[i], eheap, eheap_table);
+    }
+  }
+
+  BLI_buffer_free(&edges_update);
+  BLI_buffer_free(&edges_update_cost);
+  MEM_freeN(vert_batch);
+  MEM_freeN(items);
+  MEM_freeN(deferred);
+}
+
 /* Main Decimate Function
  * ********************** */
 
@@ -1285,6 +1630,9 @@ static bool bm_decim_edge_collapse(BMesh *bm,
  *        a vertex group is the usual source for this.
  * \param symmetry_axis: Axis of symmetry, -1 to disable mirror decimate.
  * \param symmetry_eps: Threshold when matching mirror verts.
+ * \param use_batch: Collapse edges in parallel batches, see #bm_decim_collapse_batched.
+ * The result doesn't depend on the number of threads but differs slightly from collapsing
+ * edges one at a time. Not supported with symmetry.
  *
  * \note The caller is responsible for recalculating face and vertex normals.
  * - Vertex normals are maintained while decimating,
@@ -1297,7 +1645,8 @@ void BM_mesh_decimate_collapse(BMesh *bm,
                                float vweight_factor,
                                const bool do_triangulate,
                                const int symmetry_axis,
-                               const float symmetry_eps)
+                               const float symmetry_eps,
+                               const bool use_batch)
 {
   /* edge heap */
   Heap *eheap;
@@ -1323,6 +1672,13 @@ void BM_mesh_decimate_collapse(BMesh *bm,
   UNUSED_VARS(do_triangulate);
 #endif
 
+  /* Mirror decimate collapses edges in pairs, which batches don't handle. */
+  const bool use_batch_collapse = use_batch
+#ifdef USE_SYMMETRY
+                                  && (use_symmetry == false)
+#endif
+      ;
+
   /* Allocate variables. */
   vquadrics = MEM_callocN(sizeof(Quadric) * bm->totvert, __func__);
   /* Since some edges may be degenerate, we might be over allocating a little here. */
@@ -1331,7 +1687,12 @@ void BM_mesh_decimate_collapse(BMesh *bm,
   tot_edge_orig = bm->totedge;
 
   /* build initial edge collapse cost data */
-  bm_decim_build_quadrics(bm, vquadrics);
+  if (use_batch_collapse) {
+    bm_decim_build_quadrics_parallel(bm, vquadrics);
+  }
+  else {
+    bm_decim_build_quadrics(bm, vquadrics);
+  }
 
   bm_decim_build_edge_cost(bm, vquadrics, vweights, vweight_factor, eheap, eheap_table);
 
@@ -1359,8 +1720,20 @@ void BM_mesh_decimate_collapse(BMesh *bm,
 #endif
 
   /* iterative edge collapse and maintain the eheap */
+  if (use_batch_collapse) {
+    bm_decim_collapse_batched(bm,
+                              face_tot_target,
+                              vquadrics,
+                              vweights,
+                              vweight_factor,
+                              eheap,
+                              eheap_table,
+                              customdata_flag);
+  }
 #ifdef USE_SYMMETRY
-  if (use_symmetry == false)
+  else if (use_symmetry == false)
+#else
+  else
 #endif
   {
     /* simple non-mirror case */
@@ -1388,7 +1761,8 @@ void BM_mesh_decimate_collapse(BMesh *bm,
 #endif
                              customdata_flag,
                              optimize_co,
-                             true);
+                             true,
+                             NULL);
     }
   }
 #ifdef USE_SYMMETRY
@@ -1472,7 +1846,8 @@ void BM_mesh_decimate_collapse(BMesh *bm,
                                  edge_symmetry_map,
                                  customdata_flag,
                                  optimize_co,
-                                 false)) {
+                                 false,
+                                 NULL)) {
         if (e_mirr && (eheap_table[e_index_mirr])) {
           BLI_assert(e_index_mirr != e_index);
           BLI_heap_remove(eheap, eheap_table[e_index_mirr]);
@@ -1488,7 +1863,8 @@ void BM_mesh_decimate_collapse(BMesh *bm,
                                  edge_symmetry_map,
                                  customdata_flag,
                                  optimize_co,
-                                 false);
+                                 false,
+                                 NULL);
         }
       }
       else {
@@ -164,6 +164,34 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float ctime);
 /* Data changed recalculation entry point. */
 void DEG_evaluate_on_refresh(Depsgraph *graph);
 
+/* Multi-frame Evaluation  ----------------------- */
+
+/* Called for every frame evaluated by DEG_evaluate_frames(), with a dependency graph which is
+ * fully evaluated for that frame.
+ *
+ * NOTE: Is called from worker threads, possibly for several frames at once and not in the order
+ * of the frames array. The graph is only valid until the callback returns. */
+typedef void (*DEG_FrameEvaluatedCb)(struct Depsgraph *depsgraph,
+                                     const int frame_index,
+                                     const float ctime,
+                                     void *user_data);
+
+/* Check whether evaluation of a frame does not depend on the evaluation of previous frames, which
+ * is not the case for point caches, simulations and rigid body worlds. */
+bool DEG_graph_is_time_independent(const Depsgraph *graph);
+
+/* Evaluate the given frames with copies of the given graph, which is left untouched.
+ *
+ * When the graph is time independent the frames are evaluated concurrently using up to
+ * max_graphs copies of the graph (all threads when 0), otherwise they are evaluated in the order
+ * of the frames array with a single copy. */
+void DEG_evaluate_frames(Depsgraph *graph,
+                         const float *frames,
+                         const int num_frames,
+                         const int max_graphs,
+                         DEG_FrameEvaluatedCb callback,
+                         void *user_data);
+
 /* Editors Integration  -------------------------- */
 
 /* Mechanism to allow editors to be informed of depsgraph updates,
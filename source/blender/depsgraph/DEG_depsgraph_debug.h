@@ -62,6 +62,11 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* Write timeline of operations evaluation recorded with G_DEBUG_DEPSGRAPH_TIMELINE in the
+ * Trace Event Format (JSON), which can be loaded into chrome://tracing or Perfetto. */
+void DEG_debug_timeline_chrome_trace(const struct Depsgraph *graph, FILE *fp);
+void DEG_debug_timeline_clear(struct Depsgraph *graph);
+
 /* ************************************************ */
 
 /* Compare two dependency graphs. */
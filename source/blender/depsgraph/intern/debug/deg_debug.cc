@@ -44,6 +44,11 @@ bool DepsgraphDebug::do_time_debug() const
   return ((G.debug & G_DEBUG_DEPSGRAPH_TIME) != 0);
 }
 
+bool DepsgraphDebug::do_timeline_debug() const
+{
+  return ((G.debug & G_DEBUG_DEPSGRAPH_TIMELINE) != 0);
+}
+
 void DepsgraphDebug::begin_graph_evaluation()
 {
   if (!do_time_debug()) {
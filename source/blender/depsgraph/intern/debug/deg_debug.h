@@ -33,11 +33,14 @@
 namespace blender {
 namespace deg {
 
+struct Depsgraph;
+
 class DepsgraphDebug {
  public:
   DepsgraphDebug();
 
   bool do_time_debug() const;
+  bool do_timeline_debug() const;
 
   void begin_graph_evaluation();
   void end_graph_evaluation();
@@ -53,6 +56,29 @@ class DepsgraphDebug {
    * This is NOT an indication that depsgraph is at its evaluated state. */
   bool is_ever_evaluated;
 
+  /* Evaluation of a single operation, as recorded in the timeline. */
+  struct TimelineOperation {
+    /* Name of the ID, type of the component and name of the operation. */
+    string id_name;
+    const char *component_type;
+    string name;
+    double start_time;
+    double end_time;
+    size_t thread_id;
+  };
+
+  /* Single evaluation of the entire graph, as recorded in the timeline. */
+  struct TimelineEvaluation {
+    double start_time;
+    double end_time;
+    float frame;
+  };
+
+  /* Timeline of all graph evaluations since the timeline was last cleared.
+   * Only recorded when G_DEBUG_DEPSGRAPH_TIMELINE is enabled. */
+  Vector<TimelineEvaluation> timeline_evaluations;
+  Vector<TimelineOperation> timeline_operations;
+
  protected:
   /* Maximum number of counters used to calculate frame rate of depsgraph update. */
   static const constexpr int MAX_FPS_COUNTERS = 64;
@@ -86,6 +112,9 @@ class DepsgraphDebug {
     fflush(stderr); \
   } while (0)
 
+/* Save recorded timeline to a file in the temporary directory. */
+void deg_debug_timeline_save(const Depsgraph *graph);
+
 bool terminal_do_color(void);
 string color_for_pointer(const void *pointer);
 string color_end(void);
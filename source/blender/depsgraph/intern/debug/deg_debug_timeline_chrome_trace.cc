@@ -0,0 +1,233 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Export of the recorded evaluation timeline in the Trace Event Format, which is understood by
+ * chrome://tracing and Perfetto.
+ */
+
+#include "DEG_depsgraph_debug.h"
+
+#include <cstdarg>
+
+#include "BLI_compiler_attrs.h"
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+#include "BKE_appdir.h"
+
+#include "atomic_ops.h"
+
+#include "intern/debug/deg_debug.h"
+#include "intern/depsgraph.h"
+
+#define NL "\n"
+
+namespace deg = blender::deg;
+
+namespace blender::deg {
+namespace {
+
+/* Process identifier used for all events. */
+const int TRACE_PID = 1;
+/* Thread identifier used for the events of entire graph evaluation. */
+const int TRACE_TID_EVALUATION = 0;
+
+struct DebugContext {
+  FILE *file;
+  const Depsgraph *graph;
+  /* Point in time all timestamps are relative to. */
+  double start_time;
+  /* Whether an event was written already, used to separate events with a comma. */
+  bool has_events;
+};
+
+void deg_debug_fprintf(const DebugContext &ctx, const char *fmt, ...) ATTR_PRINTF_FORMAT(2, 3);
+void deg_debug_fprintf(const DebugContext &ctx, const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(ctx.file, fmt, args);
+  va_end(args);
+}
+
+string json_escape(const string &str)
+{
+  string result;
+  result.reserve(str.length());
+  for (const char ch : str) {
+    if (ch == '"' || ch == '\\') {
+      result += '\\';
+      result += ch;
+    }
+    else if ((unsigned char)ch < 0x20) {
+      char buffer[8];
+      BLI_snprintf(buffer, sizeof(buffer), "\\u%04x", (int)ch);
+      result += buffer;
+    }
+    else {
+      result += ch;
+    }
+  }
+  return result;
+}
+
+/* Timestamps of the Trace Event Format are in microseconds. */
+double trace_timestamp(const DebugContext &ctx, const double time)
+{
+  return (time - ctx.start_time) * 1e6;
+}
+
+void begin_event(DebugContext &ctx)
+{
+  deg_debug_fprintf(ctx, ctx.has_events ? "," NL : NL);
+  ctx.has_events = true;
+}
+
+void write_metadata_event(DebugContext &ctx, const char *type, const int tid, const string &name)
+{
+  begin_event(ctx);
+  deg_debug_fprintf(ctx,
+                    R"({"name":"%s","ph":"M","pid":%d,"tid":%d,"args":{"name":"%s"}})",
+                    type,
+                    TRACE_PID,
+                    tid,
+                    json_escape(name).c_str());
+}
+
+void write_complete_event(DebugContext &ctx,
+                          const string &name,
+                          const char *category,
+                          const int tid,
+                          const double start_time,
+                          const double end_time,
+                          const string &args)
+{
+  begin_event(ctx);
+  deg_debug_fprintf(ctx,
+                    R"({"name":"%s","cat":"%s","ph":"X","pid":%d,"tid":%d,"ts":%.3f,"dur":%.3f,)"
+                    R"("args":{%s}})",
+                    json_escape(name).c_str(),
+                    category,
+                    TRACE_PID,
+                    tid,
+                    trace_timestamp(ctx, start_time),
+                    (end_time - start_time) * 1e6,
+                    args.c_str());
+}
+
+void deg_debug_timeline_chrome_trace(DebugContext &ctx)
+{
+  const DepsgraphDebug &debug = ctx.graph->debug;
+  ctx.start_time = debug.timeline_evaluations.is_empty() ?
+                       0.0 :
+                       debug.timeline_evaluations.first().start_time;
+  ctx.has_events = false;
+  deg_debug_fprintf(ctx, R"({"displayTimeUnit":"ms","traceEvents":[)");
+  write_metadata_event(
+      ctx, "process_name", TRACE_TID_EVALUATION, debug.name.empty() ? "Depsgraph" : debug.name);
+  write_metadata_event(ctx, "thread_name", TRACE_TID_EVALUATION, "Evaluation");
+  /* Entire graph evaluations, one per update. */
+  for (const DepsgraphDebug::TimelineEvaluation &evaluation : debug.timeline_evaluations) {
+    char name[64], args[64];
+    BLI_snprintf(name, sizeof(name), "Frame %.2f", evaluation.frame);
+    BLI_snprintf(args, sizeof(args), R"("frame":%f)", evaluation.frame);
+    write_complete_event(ctx,
+                         name,
+                         "evaluation",
+                         TRACE_TID_EVALUATION,
+                         evaluation.start_time,
+                         evaluation.end_time,
+                         args);
+  }
+  /* Operations, mapping threads to compact identifiers in order of their first appearance. */
+  Map<size_t, int> thread_tids;
+  for (const DepsgraphDebug::TimelineOperation &operation : debug.timeline_operations) {
+    const int tid = thread_tids.lookup_or_add_cb(operation.thread_id, [&]() {
+      const int new_tid = thread_tids.size() + 1;
+      char thread_name[64];
+      BLI_snprintf(thread_name, sizeof(thread_name), "Thread %d", new_tid);
+      write_metadata_event(ctx, "thread_name", new_tid, thread_name);
+      return new_tid;
+    });
+    const string args = R"("id":")" + json_escape(operation.id_name) + R"(","component":")" +
+                        operation.component_type + "\"";
+    write_complete_event(ctx,
+                         operation.id_name.substr(2) + " " + operation.name,
+                         operation.component_type,
+                         tid,
+                         operation.start_time,
+                         operation.end_time,
+                         args);
+  }
+  deg_debug_fprintf(ctx, NL "]}" NL);
+}
+
+}  // namespace
+
+void deg_debug_timeline_save(const Depsgraph *graph)
+{
+  const DepsgraphDebug &debug = graph->debug;
+  if (debug.timeline_evaluations.is_empty()) {
+    return;
+  }
+  /* Different dependency graphs might share the same name, so make file name unique. */
+  static uint32_t file_counter = 0;
+  const uint32_t file_index = atomic_fetch_and_add_uint32(&file_counter, 1);
+  char filename[FILE_MAXFILE];
+  BLI_snprintf(filename,
+               sizeof(filename),
+               "depsgraph_timeline_%s_%u.json",
+               debug.name.empty() ? "unnamed" : debug.name.c_str(),
+               file_index);
+  BLI_filename_make_safe(filename);
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_base(), filename);
+  FILE *fp = BLI_fopen(filepath, "w");
+  if (fp == nullptr) {
+    DEG_ERROR_PRINTF("Error saving depsgraph timeline to %s\n", filepath);
+    return;
+  }
+  DEG_debug_timeline_chrome_trace(reinterpret_cast<const ::Depsgraph *>(graph), fp);
+  fclose(fp);
+  printf("Depsgraph timeline saved to %s\n", filepath);
+}
+
+}  // namespace blender::deg
+
+void DEG_debug_timeline_chrome_trace(const Depsgraph *depsgraph, FILE *fp)
+{
+  if (depsgraph == nullptr) {
+    return;
+  }
+  deg::DebugContext ctx;
+  ctx.file = fp;
+  ctx.graph = (deg::Depsgraph *)depsgraph;
+  deg::deg_debug_timeline_chrome_trace(ctx);
+}
+
+void DEG_debug_timeline_clear(Depsgraph *depsgraph)
+{
+  deg::Depsgraph *deg_graph = (deg::Depsgraph *)depsgraph;
+  deg_graph->debug.timeline_evaluations.clear_and_make_inline();
+  deg_graph->debug.timeline_operations.clear_and_make_inline();
+}
@@ -85,6 +85,9 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
 
 Depsgraph::~Depsgraph()
 {
+  if (debug.do_timeline_debug()) {
+    deg_debug_timeline_save(this);
+  }
   clear_id_nodes();
   delete time_source;
   BLI_spin_end(&lock);
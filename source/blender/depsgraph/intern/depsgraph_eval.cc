@@ -26,7 +26,10 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_listbase.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_scene.h"
 
@@ -34,12 +37,17 @@
 #include "DNA_scene_types.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_query.h"
 
+#include "atomic_ops.h"
+
 #include "intern/eval/deg_eval.h"
 #include "intern/eval/deg_eval_flush.h"
 
 #include "intern/node/deg_node.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
 #include "intern/node/deg_node_operation.h"
 #include "intern/node/deg_node_time.h"
 
@@ -81,3 +89,135 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float ctime)
   deg_graph->ctime = ctime;
   deg_flush_updates_and_refresh(deg_graph);
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Multi-frame Evaluation
+ * \{ */
+
+namespace {
+
+struct FramesEvaluationState {
+  blender::Span<Depsgraph *> graphs;
+  const float *frames;
+  int num_frames;
+  /* Index of the next frame which is to be picked up by any of the graphs. */
+  int next_frame_index;
+  DEG_FrameEvaluatedCb callback;
+  void *user_data;
+};
+
+/* Create a graph for the same input as the given one, containing all of its IDs. The copy is not
+ * active, so its evaluation never writes back to the original data-blocks. */
+Depsgraph *deg_graph_copy_for_frames(const deg::Depsgraph *deg_graph)
+{
+  Depsgraph *graph_copy = DEG_graph_new(
+      deg_graph->bmain, deg_graph->scene, deg_graph->view_layer, deg_graph->mode);
+  blender::Vector<ID *> ids;
+  ids.reserve(deg_graph->id_nodes.size());
+  for (const deg::IDNode *id_node : deg_graph->id_nodes) {
+    ids.append(id_node->id_orig);
+  }
+  DEG_graph_build_from_ids(graph_copy, ids.data(), ids.size());
+  if (!deg_graph->debug.name.empty()) {
+    DEG_debug_name_set(graph_copy, (deg_graph->debug.name + " (frames)").c_str());
+  }
+  return graph_copy;
+}
+
+void deg_evaluate_frames_task_run(FramesEvaluationState *state, const int graph_index)
+{
+  Depsgraph *graph = state->graphs[graph_index];
+  /* Frames are picked up dynamically, so graphs which happen to evaluate faster take more. */
+  while (true) {
+    const int frame_index = (int)atomic_fetch_and_add_int32(&state->next_frame_index, 1);
+    if (frame_index >= state->num_frames) {
+      break;
+    }
+    const float ctime = state->frames[frame_index];
+    DEG_evaluate_on_framechange(graph, ctime);
+    state->callback(graph, frame_index, ctime, state->user_data);
+  }
+}
+
+void deg_evaluate_frames_task(TaskPool *__restrict pool, void *taskdata)
+{
+  FramesEvaluationState *state = (FramesEvaluationState *)BLI_task_pool_user_data(pool);
+  deg_evaluate_frames_task_run(state, POINTER_AS_INT(taskdata));
+}
+
+}  // namespace
+
+bool DEG_graph_is_time_independent(const Depsgraph *graph)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  for (const deg::IDNode *id_node : deg_graph->id_nodes) {
+    for (const deg::ComponentNode *comp_node : id_node->components.values()) {
+      /* Caches and simulations step from the state of the previous frame. */
+      if (ELEM(comp_node->type, deg::NodeType::POINT_CACHE, deg::NodeType::SIMULATION)) {
+        return false;
+      }
+      for (const deg::OperationNode *op_node : comp_node->operations) {
+        if (ELEM(op_node->opcode,
+                 deg::OperationCode::RIGIDBODY_REBUILD,
+                 deg::OperationCode::RIGIDBODY_SIM)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void DEG_evaluate_frames(Depsgraph *graph,
+                         const float *frames,
+                         const int num_frames,
+                         const int max_graphs,
+                         DEG_FrameEvaluatedCb callback,
+                         void *user_data)
+{
+  if (num_frames == 0) {
+    return;
+  }
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+
+  /* Every copy of the graph holds its own copy-on-write data-blocks, which is only worth the
+   * memory when the frames can actually be evaluated independently from each other. */
+  int num_graphs = 1;
+  if (DEG_graph_is_time_independent(graph)) {
+    num_graphs = (max_graphs > 0) ? max_graphs : BLI_system_thread_count();
+    num_graphs = min_ii(num_graphs, num_frames);
+  }
+
+  blender::Vector<Depsgraph *> graphs;
+  for (int i = 0; i < num_graphs; i++) {
+    graphs.append(deg_graph_copy_for_frames(deg_graph));
+  }
+
+  FramesEvaluationState state;
+  state.graphs = graphs;
+  state.frames = frames;
+  state.num_frames = num_frames;
+  state.next_frame_index = 0;
+  state.callback = callback;
+  state.user_data = user_data;
+
+  if (num_graphs == 1) {
+    deg_evaluate_frames_task_run(&state, 0);
+  }
+  else {
+    /* Evaluation of every graph is threaded on its own, graphs only fill in the gaps which are
+     * left by operations which can not run in parallel within a single frame. */
+    TaskPool *task_pool = BLI_task_pool_create(&state, TASK_PRIORITY_HIGH);
+    for (int i = 0; i < num_graphs; i++) {
+      BLI_task_pool_push(task_pool, deg_evaluate_frames_task, POINTER_FROM_INT(i), false, nullptr);
+    }
+    BLI_task_pool_work_and_wait(task_pool);
+    BLI_task_pool_free(task_pool);
+  }
+
+  for (Depsgraph *graph_copy : graphs) {
+    DEG_graph_free(graph_copy);
+  }
+}
+
+/** \} */
@@ -0,0 +1,152 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_collection.h"
+#include "BKE_fcurve.h"
+#include "BKE_idtype.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "RNA_define.h"
+
+#include "CLG_log.h"
+
+namespace blender::deg::tests {
+
+class DepsgraphEvalFramesTest : public testing::Test {
+ public:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  Object *object = nullptr;
+
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    BLI_threadapi_init();
+    BLI_task_scheduler_init();
+    BKE_idtype_init();
+    DEG_register_node_types();
+    RNA_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    RNA_exit();
+    DEG_free_node_types();
+    BLI_task_scheduler_exit();
+    BLI_threadapi_exit();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    object = BKE_object_add_only_object(bmain, OB_EMPTY, "Empty");
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+
+    /* Linear motion along X: `location.x = frame - 1`. */
+    FCurve *fcu = BKE_fcurve_create();
+    fcu->rna_path = BLI_strdup("location");
+    fcu->array_index = 0;
+    fcu->totvert = 2;
+    fcu->bezt = static_cast<BezTriple *>(MEM_callocN(sizeof(BezTriple) * 2, __func__));
+    for (int i = 0; i < 2; i++) {
+      BezTriple *bezt = &fcu->bezt[i];
+      bezt->vec[1][0] = 1.0f + i * 8.0f;
+      bezt->vec[1][1] = i * 8.0f;
+      bezt->ipo = BEZT_IPO_LIN;
+    }
+    bAction *action = BKE_action_add(bmain, "Action");
+    BLI_addtail(&action->curves, fcu);
+    AnimData *adt = BKE_animdata_add_id(&object->id);
+    adt->action = action;
+    id_us_plus(&action->id);
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+  }
+};
+
+struct FramesResult {
+  Object *object;
+  float location_x[8];
+};
+
+static void frame_evaluated_cb(Depsgraph *depsgraph,
+                               const int frame_index,
+                               const float UNUSED(ctime),
+                               void *user_data)
+{
+  FramesResult *result = static_cast<FramesResult *>(user_data);
+  const Object *object_eval = DEG_get_evaluated_object(depsgraph, result->object);
+  result->location_x[frame_index] = object_eval->obmat[3][0];
+}
+
+/* Frames evaluated with copies of the graph match evaluating the graph itself at those frames. */
+TEST_F(DepsgraphEvalFramesTest, evaluate_frames)
+{
+  Depsgraph *depsgraph = DEG_graph_new(
+      bmain, scene, BKE_view_layer_default_view(scene), DAG_EVAL_VIEWPORT);
+  ID *ids[1] = {&object->id};
+  DEG_graph_build_from_ids(depsgraph, ids, 1);
+  EXPECT_TRUE(DEG_graph_is_time_independent(depsgraph));
+
+  const float frames[8] = {4.0f, 1.0f, 9.0f, 2.0f, 5.0f, 7.0f, 3.0f, 6.0f};
+  for (const int max_graphs : {1, 3}) {
+    FramesResult result = {object, {0.0f}};
+    DEG_evaluate_frames(depsgraph, frames, 8, max_graphs, frame_evaluated_cb, &result);
+
+    for (int i = 0; i < 8; i++) {
+      DEG_evaluate_on_framechange(depsgraph, frames[i]);
+      const Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+      EXPECT_FLOAT_EQ(object_eval->obmat[3][0], frames[i] - 1.0f);
+      EXPECT_FLOAT_EQ(result.location_x[i], object_eval->obmat[3][0]);
+    }
+  }
+
+  DEG_graph_free(depsgraph);
+}
+
+}  // namespace blender::deg::tests
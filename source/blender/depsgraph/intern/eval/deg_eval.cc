@@ -25,11 +25,16 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <queue>
+#include <thread>
+
 #include "PIL_time.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_math_base.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -69,10 +74,14 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-}
+/* Operations which are expected to take less time than this are not worth the overhead of a
+ * dedicated task: they are evaluated right away by the task which made them ready. */
+#define DEG_EVAL_TINY_OPERATION_TIME 5e-6f
+
+/* Weight of the most recent measurement in the estimated operation time. */
+#define DEG_EVAL_ESTIMATED_TIME_FACTOR 0.25f
+
+typedef Vector<OperationNode *, 16> OperationBatch;
 
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
@@ -91,13 +100,75 @@ enum class EvaluationStage {
   SINGLE_THREADED_WORKAROUND,
 };
 
+struct OperationCriticalPathCompare {
+  bool operator()(const OperationNode *a, const OperationNode *b) const
+  {
+    return a->critical_path_time < b->critical_path_time;
+  }
+};
+
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
+  bool do_timeline;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Operations which are ready to be evaluated by threaded tasks, the one with the longest
+   * critical path on top. Every operation pushed here has a matching task in the pool. */
+  std::priority_queue<OperationNode *, std::vector<OperationNode *>, OperationCriticalPathCompare>
+      ready_operations;
+  ThreadMutex ready_operations_mutex;
 };
 
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  BLI_mutex_lock(&state->ready_operations_mutex);
+  state->ready_operations.push(node);
+  BLI_mutex_unlock(&state->ready_operations_mutex);
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+OperationNode *pop_ready_operation(DepsgraphEvalState *state)
+{
+  BLI_mutex_lock(&state->ready_operations_mutex);
+  BLI_assert(!state->ready_operations.empty());
+  OperationNode *node = state->ready_operations.top();
+  state->ready_operations.pop();
+  BLI_mutex_unlock(&state->ready_operations_mutex);
+  return node;
+}
+
+bool is_tiny_operation(const OperationNode *node)
+{
+  return node->estimated_time >= 0.0f && node->estimated_time < DEG_EVAL_TINY_OPERATION_TIME;
+}
+
+/* Tiny operations are batched into the current task instead of getting a task of their own. */
+void schedule_node_to_pool_or_batch(OperationNode *node,
+                                    const int thread_id,
+                                    TaskPool *pool,
+                                    OperationBatch *batch)
+{
+  if (is_tiny_operation(node)) {
+    batch->append(node);
+  }
+  else {
+    schedule_node_to_pool(node, thread_id, pool);
+  }
+}
+
+void update_estimated_time(OperationNode *operation_node, const float time)
+{
+  if (operation_node->estimated_time < 0.0f) {
+    operation_node->estimated_time = time;
+  }
+  else {
+    operation_node->estimated_time += (time - operation_node->estimated_time) *
+                                      DEG_EVAL_ESTIMATED_TIME_FACTOR;
+  }
+}
+
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
@@ -105,27 +176,38 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
-  if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
+  if (!state->do_stats) {
     operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    return;
   }
-  else {
-    operation_node->evaluate(depsgraph);
+  /* The measured time is also used as cost estimate for scheduling. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double end_time = PIL_check_seconds_timer();
+  update_estimated_time(operation_node, end_time - start_time);
+  operation_node->stats.current_time += end_time - start_time;
+  if (state->do_timeline) {
+    operation_node->stats.current_start_time = start_time;
+    operation_node->stats.current_end_time = end_time;
+    operation_node->stats.current_thread_id = std::hash<std::thread::id>()(
+        std::this_thread::get_id());
   }
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void deg_task_run_func(TaskPool *pool, void * /*taskdata*/)
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
-
-  /* Schedule children. */
-  schedule_children(state, operation_node, schedule_node_to_pool, pool);
+  /* Tasks are not bound to a specific operation: evaluate the ready operation with the longest
+   * critical path, followed by tiny operations which became ready as a result. */
+  OperationBatch batch;
+  batch.append(pop_ready_operation(state));
+  while (!batch.is_empty()) {
+    OperationNode *operation_node = batch.pop_last();
+    evaluate_node(state, operation_node);
+    schedule_children(state, operation_node, schedule_node_to_pool_or_batch, pool, &batch);
+  }
 }
 
 bool check_operation_node_visible(OperationNode *op_node)
@@ -178,10 +260,68 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+/* Estimated time of the operation during the current evaluation. */
+float operation_time_get(OperationNode *node)
+{
+  if (node->is_noop() || node->estimated_time < 0.0f) {
+    return 0.0f;
+  }
+  if ((node->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0 || !check_operation_node_visible(node)) {
+    return 0.0f;
+  }
+  return node->estimated_time;
+}
+
+/* Calculate critical path time of all operations, visiting them in reverse topological order so
+ * that all children of an operation are handled prior to the operation itself.
+ * Operations which are part of a dependency cycle only account their own time. */
+void calculate_critical_path_times(Depsgraph *graph)
+{
+  Vector<OperationNode *> queue;
+  for (OperationNode *node : graph->operations) {
+    node->critical_path_time = operation_time_get(node);
+    /* Use custom flags to count children which are not handled yet. */
+    node->custom_flags = 0;
+    for (Relation *rel : node->outlinks) {
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        ++node->custom_flags;
+      }
+    }
+    if (node->custom_flags == 0) {
+      queue.append(node);
+    }
+  }
+  while (!queue.is_empty()) {
+    OperationNode *node = queue.pop_last();
+    float children_time = 0.0f;
+    for (Relation *rel : node->outlinks) {
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        const OperationNode *child = (OperationNode *)rel->to;
+        children_time = max_ff(children_time, child->critical_path_time);
+      }
+    }
+    node->critical_path_time = operation_time_get(node) + children_time;
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *parent = (OperationNode *)rel->from;
+      if (--parent->custom_flags == 0) {
+        queue.append(parent);
+      }
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  /* Operations are only timed along with the statistics, without them there is nothing new to
+   * estimate the critical paths from: the ones of the last timed evaluation are kept. */
+  if (do_stats) {
+    calculate_critical_path_times(graph);
+  }
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -374,14 +514,17 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   }
 
   graph->debug.begin_graph_evaluation();
+  const double evaluation_start_time = PIL_check_seconds_timer();
 
   graph->is_evaluating = true;
   depsgraph_ensure_view_layer(graph);
   /* Set up evaluation state. */
   DepsgraphEvalState state;
   state.graph = graph;
-  state.do_stats = graph->debug.do_time_debug();
+  state.do_timeline = graph->debug.do_timeline_debug();
+  state.do_stats = graph->debug.do_time_debug() || state.do_timeline;
   state.need_single_thread_pass = false;
+  BLI_mutex_init(&state.ready_operations_mutex);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
@@ -404,6 +547,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
     state.stage = EvaluationStage::SINGLE_THREADED_WORKAROUND;
     evaluate_graph_single_threaded(&state);
   }
+  BLI_assert(state.ready_operations.empty());
+  BLI_mutex_end(&state.ready_operations_mutex);
 
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
@@ -411,6 +556,9 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
   }
+  if (state.do_timeline) {
+    deg_eval_stats_record_timeline(graph, evaluation_start_time, PIL_check_seconds_timer());
+  }
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
   graph->is_evaluating = false;
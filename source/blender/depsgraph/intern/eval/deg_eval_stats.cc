@@ -54,4 +54,32 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+void deg_eval_stats_record_timeline(Depsgraph *graph,
+                                    const double start_time,
+                                    const double end_time)
+{
+  DepsgraphDebug &debug = graph->debug;
+  DepsgraphDebug::TimelineEvaluation evaluation;
+  evaluation.start_time = start_time;
+  evaluation.end_time = end_time;
+  evaluation.frame = graph->ctime;
+  debug.timeline_evaluations.append(evaluation);
+  for (OperationNode *op_node : graph->operations) {
+    /* Operations which were not evaluated have no timing information. */
+    if (op_node->stats.current_end_time == 0.0) {
+      continue;
+    }
+    const ComponentNode *comp_node = op_node->owner;
+    const IDNode *id_node = comp_node->owner;
+    DepsgraphDebug::TimelineOperation operation;
+    operation.id_name = id_node->id_orig->name;
+    operation.component_type = nodeTypeAsString(comp_node->type);
+    operation.name = op_node->identifier();
+    operation.start_time = op_node->stats.current_start_time;
+    operation.end_time = op_node->stats.current_end_time;
+    operation.thread_id = op_node->stats.current_thread_id;
+    debug.timeline_operations.append(operation);
+  }
+}
+
 }  // namespace blender::deg
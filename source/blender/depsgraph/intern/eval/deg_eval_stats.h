@@ -31,5 +31,8 @@ struct Depsgraph;
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Append timings of operations evaluated during the current graph evaluation to the timeline. */
+void deg_eval_stats_record_timeline(Depsgraph *graph, double start_time, double end_time);
+
 }  // namespace deg
 }  // namespace blender
@@ -163,6 +163,12 @@ struct Node {
     void reset_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Points in time when evaluation of this node began and ended during current graph
+     * evaluation, and a hash of the thread it was evaluated in.
+     * Only filled in for operations when evaluation timeline is being recorded. */
+    double current_start_time;
+    double current_end_time;
+    size_t current_thread_id;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
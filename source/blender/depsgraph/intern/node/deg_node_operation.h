@@ -272,6 +272,14 @@ struct OperationNode : public Node {
   /* (OperationFlag) extra settings affecting evaluation. */
   int flag;
 
+  /* Estimated time needed to evaluate this operation, in seconds. It is a moving average of the
+   * times measured during previous evaluations with time statistics enabled
+   * (#G_DEBUG_DEPSGRAPH_TIME or #G_DEBUG_DEPSGRAPH_TIMELINE), negative if it was never measured. */
+  float estimated_time;
+  /* Estimated time needed to evaluate this operation and the longest chain of operations which
+   * depend on it. Ready operations with the longest critical path are evaluated first. */
+  float critical_path_time;
+
   DEG_DEPSNODE_DECLARE;
 };
 
@@ -153,6 +153,10 @@ typedef struct MeshBufferCache {
   } ibo;
   /* Index buffer per material. These are subranges of `ibo.tris` */
   GPUIndexBuf **tris_per_mat;
+  /* Faces which vertices moved since `vbo.pos_nor` was extracted, their loops are updated in
+   * place on the next extraction instead of extracting the whole buffer again.
+   * Empty when both values are equal. See #BKE_MESH_BATCH_DIRTY_DEFORM. */
+  int pos_nor_update_face_range[2];
 } MeshBufferCache;
 
 /**
@@ -86,7 +86,7 @@ class ExtractorRunDatas : public Vector<ExtractorRunData> {
         continue;
       }
       if ((iter_type & MR_ITER_POLY) && extractor->iter_poly_bm) {
-        BLI_assert(extractor->iter_poly_mesh);
+        BLI_assert(extractor->iter_poly_mesh || extractor->iter_poly_mesh_range);
         result.append(data);
         continue;
       }
@@ -265,62 +265,96 @@ static void extract_task_reduce(const void *__restrict userdata,
   }
 }
 
+/* Looptris and polygons are extracted in batches: all extractors process a batch in turn, so the
+ * elements are only loaded once and every extractor runs a tight loop over them. */
+
+BLI_INLINE void extract_batch_range(const int batch, const int elems_len, int *r_start, int *r_end)
+{
+  *r_start = batch * EXTRACT_BATCH_LEN;
+  *r_end = min_ii(*r_start + EXTRACT_BATCH_LEN, elems_len);
+}
+
 static void extract_range_iter_looptri_bm(void *__restrict userdata,
-                                          const int iter,
+                                          const int batch,
                                           const TaskParallelTLS *__restrict tls)
 {
   const ExtractorIterData *data = static_cast<ExtractorIterData *>(userdata);
   void *extract_data = tls->userdata_chunk;
   const MeshRenderData *mr = data->mr;
-  BMLoop **elt = ((BMLoop * (*)[3]) data->elems)[iter];
+  BMLoop *(*looptris)[3] = (BMLoop * (*)[3]) data->elems;
+  int start, end;
+  extract_batch_range(batch, mr->tri_len, &start, &end);
   for (const ExtractorRunData &run_data : data->extractors) {
-    run_data.extractor->iter_looptri_bm(
-        mr, elt, iter, POINTER_OFFSET(extract_data, run_data.data_offset));
+    ExtractTriBMeshFn *iter_looptri_bm = run_data.extractor->iter_looptri_bm;
+    void *extractor_data = POINTER_OFFSET(extract_data, run_data.data_offset);
+    for (int iter = start; iter < end; iter++) {
+      iter_looptri_bm(mr, looptris[iter], iter, extractor_data);
+    }
   }
 }
 
 static void extract_range_iter_looptri_mesh(void *__restrict userdata,
-                                            const int iter,
+                                            const int batch,
                                             const TaskParallelTLS *__restrict tls)
 {
   void *extract_data = tls->userdata_chunk;
 
   const ExtractorIterData *data = static_cast<ExtractorIterData *>(userdata);
   const MeshRenderData *mr = data->mr;
-  const MLoopTri *mlt = &((const MLoopTri *)data->elems)[iter];
+  const MLoopTri *mlooptri = (const MLoopTri *)data->elems;
+  int start, end;
+  extract_batch_range(batch, mr->tri_len, &start, &end);
   for (const ExtractorRunData &run_data : data->extractors) {
-    run_data.extractor->iter_looptri_mesh(
-        mr, mlt, iter, POINTER_OFFSET(extract_data, run_data.data_offset));
+    ExtractTriMeshFn *iter_looptri_mesh = run_data.extractor->iter_looptri_mesh;
+    void *extractor_data = POINTER_OFFSET(extract_data, run_data.data_offset);
+    for (int iter = start; iter < end; iter++) {
+      iter_looptri_mesh(mr, &mlooptri[iter], iter, extractor_data);
+    }
   }
 }
 
 static void extract_range_iter_poly_bm(void *__restrict userdata,
-                                       const int iter,
+                                       const int batch,
                                        const TaskParallelTLS *__restrict tls)
 {
   void *extract_data = tls->userdata_chunk;
 
   const ExtractorIterData *data = static_cast<ExtractorIterData *>(userdata);
   const MeshRenderData *mr = data->mr;
-  const BMFace *f = ((const BMFace **)data->elems)[iter];
+  const BMFace **ftable = (const BMFace **)data->elems;
+  int start, end;
+  extract_batch_range(batch, mr->poly_len, &start, &end);
   for (const ExtractorRunData &run_data : data->extractors) {
-    run_data.extractor->iter_poly_bm(
-        mr, f, iter, POINTER_OFFSET(extract_data, run_data.data_offset));
+    ExtractPolyBMeshFn *iter_poly_bm = run_data.extractor->iter_poly_bm;
+    void *extractor_data = POINTER_OFFSET(extract_data, run_data.data_offset);
+    for (int iter = start; iter < end; iter++) {
+      iter_poly_bm(mr, ftable[iter], iter, extractor_data);
+    }
   }
 }
 
 static void extract_range_iter_poly_mesh(void *__restrict userdata,
-                                         const int iter,
+                                         const int batch,
                                          const TaskParallelTLS *__restrict tls)
 {
   void *extract_data = tls->userdata_chunk;
 
   const ExtractorIterData *data = static_cast<ExtractorIterData *>(userdata);
   const MeshRenderData *mr = data->mr;
-  const MPoly *mp = &((const MPoly *)data->elems)[iter];
+  const MPoly *mpoly = (const MPoly *)data->elems;
+  int start, end;
+  extract_batch_range(batch, mr->poly_len, &start, &end);
   for (const ExtractorRunData &run_data : data->extractors) {
-    run_data.extractor->iter_poly_mesh(
-        mr, mp, iter, POINTER_OFFSET(extract_data, run_data.data_offset));
+    const MeshExtract *extractor = run_data.extractor;
+    void *extractor_data = POINTER_OFFSET(extract_data, run_data.data_offset);
+    if (extractor->iter_poly_mesh_range) {
+      extractor->iter_poly_mesh_range(mr, start, end, extractor_data);
+      continue;
+    }
+    ExtractPolyMeshFn *iter_poly_mesh = extractor->iter_poly_mesh;
+    for (int iter = start; iter < end; iter++) {
+      iter_poly_mesh(mr, &mpoly[iter], iter, extractor_data);
+    }
   }
 }
 
@@ -397,18 +431,21 @@ BLI_INLINE void extract_task_range_run_iter(const MeshRenderData *mr,
   ExtractorIterData range_data;
   range_data.mr = mr;
 
+  TaskParallelSettings range_settings = *settings;
   TaskParallelRangeFunc func;
   int stop;
   switch (iter_type) {
     case MR_ITER_LOOPTRI:
       range_data.elems = is_mesh ? mr->mlooptri : (void *)mr->edit_bmesh->looptris;
       func = is_mesh ? extract_range_iter_looptri_mesh : extract_range_iter_looptri_bm;
-      stop = mr->tri_len;
+      stop = (int)divide_ceil_u((uint)mr->tri_len, EXTRACT_BATCH_LEN);
+      range_settings.min_iter_per_thread = max_ii(MIN_RANGE_LEN / EXTRACT_BATCH_LEN, 1);
       break;
     case MR_ITER_POLY:
       range_data.elems = is_mesh ? mr->mpoly : (void *)mr->bm->ftable;
       func = is_mesh ? extract_range_iter_poly_mesh : extract_range_iter_poly_bm;
-      stop = mr->poly_len;
+      stop = (int)divide_ceil_u((uint)mr->poly_len, EXTRACT_BATCH_LEN);
+      range_settings.min_iter_per_thread = max_ii(MIN_RANGE_LEN / EXTRACT_BATCH_LEN, 1);
       break;
     case MR_ITER_LEDGE:
       range_data.loose_elems = mr->ledges;
@@ -428,7 +465,7 @@ BLI_INLINE void extract_task_range_run_iter(const MeshRenderData *mr,
   }
 
   extractors->filter_into(range_data.extractors, iter_type);
-  BLI_task_parallel_range(0, stop, &range_data, func, settings);
+  BLI_task_parallel_range(0, stop, &range_data, func, &range_settings);
 }
 
 static void extract_task_range_run(void *__restrict taskdata)
@@ -676,7 +713,12 @@ static void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
 
 #undef EXTRACT_ADD_REQUESTED
 
-  if (extractors.is_empty()) {
+  /* Only some vertices moved since `vbo.pos_nor` was extracted, update it in place. */
+  int *pos_nor_update_range = mbc->pos_nor_update_face_range;
+  bool do_pos_nor_update = (pos_nor_update_range[0] != pos_nor_update_range[1]) &&
+                           (mbc->vbo.pos_nor != nullptr) && !DRW_vbo_requested(mbc->vbo.pos_nor);
+
+  if (extractors.is_empty() && !do_pos_nor_update) {
     return;
   }
 
@@ -697,10 +739,44 @@ static void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
                                                do_uvedit,
                                                ts,
                                                iter_type);
+
+  if (do_pos_nor_update && mr->extract_type != MR_EXTRACT_BMESH) {
+    /* The range is in #BMesh faces, but this mesh isn't extracted from the #BMesh (an object
+     * sharing the edit-mesh without being in edit-mode for example). Extract all of
+     * `vbo.pos_nor` again instead, in place since batches already use it. */
+    do_pos_nor_update = false;
+    extractors.append(
+        mesh_extract_override_get(&extract_pos_nor, do_hq_normals, override_single_mat));
+    iter_type = extractors.iter_types();
+    data_flag = extractors.data_types();
+
+    mesh_render_data_free(mr);
+    mr = mesh_render_data_create(me,
+                                 extraction_cache,
+                                 is_editmode,
+                                 is_paint_mode,
+                                 is_mode_active,
+                                 obmat,
+                                 do_final,
+                                 do_uvedit,
+                                 ts,
+                                 iter_type);
+  }
   mr->use_hide = use_hide;
   mr->use_subsurf_fdots = use_subsurf_fdots;
   mr->use_final_mesh = do_final;
 
+  if (do_pos_nor_update) {
+    mesh_extract_pos_nor_update_bm_range(
+        mr, mbc->vbo.pos_nor, do_hq_normals, pos_nor_update_range);
+  }
+  pos_nor_update_range[0] = pos_nor_update_range[1] = 0;
+
+  if (extractors.is_empty()) {
+    mesh_render_data_free(mr);
+    return;
+  }
+
 #ifdef DEBUG_TIME
   double rdata_end = PIL_check_seconds_timer();
 #endif
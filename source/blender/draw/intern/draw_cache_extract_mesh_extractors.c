@@ -65,7 +65,8 @@ eMRIterType mesh_extract_iter_type(const MeshExtract *ext)
 {
   eMRIterType type = 0;
   SET_FLAG_FROM_TEST(type, (ext->iter_looptri_bm || ext->iter_looptri_mesh), MR_ITER_LOOPTRI);
-  SET_FLAG_FROM_TEST(type, (ext->iter_poly_bm || ext->iter_poly_mesh), MR_ITER_POLY);
+  SET_FLAG_FROM_TEST(
+      type, (ext->iter_poly_bm || ext->iter_poly_mesh || ext->iter_poly_mesh_range), MR_ITER_POLY);
   SET_FLAG_FROM_TEST(type, (ext->iter_ledge_bm || ext->iter_ledge_mesh), MR_ITER_LEDGE);
   SET_FLAG_FROM_TEST(type, (ext->iter_lvert_bm || ext->iter_lvert_mesh), MR_ITER_LVERT);
   return type;
@@ -188,33 +189,36 @@ static void extract_pos_nor_iter_poly_bm(const MeshRenderData *mr,
   } while ((l_iter = l_iter->next) != l_first);
 }
 
-static void extract_pos_nor_iter_poly_mesh(const MeshRenderData *mr,
-                                           const MPoly *mp,
-                                           const int UNUSED(mp_index),
-                                           void *_data)
+static void extract_pos_nor_iter_poly_mesh_range(const MeshRenderData *mr,
+                                                 const int mp_index_start,
+                                                 const int mp_index_end,
+                                                 void *_data)
 {
   MeshExtract_PosNor_Data *data = _data;
-
+  PosNorLoop *vbo_data = data->vbo_data;
+  const GPUNormal *normals = data->normals;
+  const MVert *mvert = mr->mvert;
   const MLoop *mloop = mr->mloop;
-  const int ml_index_end = mp->loopstart + mp->totloop;
-  for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index += 1) {
-    const MLoop *ml = &mloop[ml_index];
-
-    PosNorLoop *vert = &data->vbo_data[ml_index];
-    const MVert *mv = &mr->mvert[ml->v];
-    copy_v3_v3(vert->pos, mv->co);
-    vert->nor = data->normals[ml->v].low;
-    /* Flag for paint mode overlay. */
-    if (mp->flag & ME_HIDE || mv->flag & ME_HIDE ||
-        ((mr->extract_type == MR_EXTRACT_MAPPED) && (mr->v_origindex) &&
-         (mr->v_origindex[ml->v] == ORIGINDEX_NONE))) {
-      vert->nor.w = -1;
-    }
-    else if (mv->flag & SELECT) {
-      vert->nor.w = 1;
-    }
-    else {
-      vert->nor.w = 0;
+  const int *v_origindex = (mr->extract_type == MR_EXTRACT_MAPPED) ? mr->v_origindex : NULL;
+
+  for (int mp_index = mp_index_start; mp_index < mp_index_end; mp_index++) {
+    const MPoly *mp = &mr->mpoly[mp_index];
+    const bool poly_hidden = (mp->flag & ME_HIDE) != 0;
+    const int ml_index_end = mp->loopstart + mp->totloop;
+    for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+      const uint v = mloop[ml_index].v;
+      const MVert *mv = &mvert[v];
+      PosNorLoop *vert = &vbo_data[ml_index];
+      copy_v3_v3(vert->pos, mv->co);
+      vert->nor = normals[v].low;
+      /* Flag for paint mode overlay. */
+      if (poly_hidden || (mv->flag & ME_HIDE) ||
+          (v_origindex && v_origindex[v] == ORIGINDEX_NONE)) {
+        vert->nor.w = -1;
+      }
+      else {
+        vert->nor.w = (mv->flag & SELECT) ? 1 : 0;
+      }
     }
   }
 }
@@ -289,7 +293,7 @@ static void extract_pos_nor_finish(const MeshRenderData *UNUSED(mr),
 const MeshExtract extract_pos_nor = {
     .init = extract_pos_nor_init,
     .iter_poly_bm = extract_pos_nor_iter_poly_bm,
-    .iter_poly_mesh = extract_pos_nor_iter_poly_mesh,
+    .iter_poly_mesh_range = extract_pos_nor_iter_poly_mesh_range,
     .iter_ledge_bm = extract_pos_nor_iter_ledge_bm,
     .iter_ledge_mesh = extract_pos_nor_iter_ledge_mesh,
     .iter_lvert_bm = extract_pos_nor_iter_lvert_bm,
@@ -491,6 +495,73 @@ const MeshExtract extract_pos_nor_hq = {
     .use_threading = true,
     .mesh_buffer_offset = offsetof(MeshBufferCache, vbo.pos_nor)};
 
+/** \} */
+
+/* ---------------------------------------------------------------------- */
+/** \name Update Position and Vertex Normal
+ *
+ * Update the loops of a range of faces in an already extracted `vbo.pos_nor`,
+ * used when edit-mode vertices are only moved (see #BKE_MESH_BATCH_DIRTY_DEFORM).
+ * \{ */
+
+void mesh_extract_pos_nor_update_bm_range(const MeshRenderData *mr,
+                                          GPUVertBuf *vbo,
+                                          const bool do_hq_normals,
+                                          const int face_range[2])
+{
+  BLI_assert(mr->extract_type == MR_EXTRACT_BMESH);
+  const int f_start = max_ii(face_range[0], 0);
+  const int f_end = min_ii(face_range[1], mr->poly_len);
+  if (f_start >= f_end) {
+    return;
+  }
+
+  /* Loop indices are contiguous in face order. */
+  const BMFace *f_last = BM_face_at_index(mr->bm, f_end - 1);
+  const int l_start = BM_elem_index_get(BM_FACE_FIRST_LOOP(BM_face_at_index(mr->bm, f_start)));
+  const int l_end = BM_elem_index_get(BM_FACE_FIRST_LOOP(f_last)) + f_last->len;
+  const uint stride = do_hq_normals ? sizeof(PosNorHQLoop) : sizeof(PosNorLoop);
+  BLI_assert(GPU_vertbuf_get_format(vbo)->stride == stride);
+
+  PosNorLoop *vbo_data = NULL;
+  PosNorHQLoop *vbo_data_hq = NULL;
+  void *data = MEM_mallocN(stride * (uint)(l_end - l_start), __func__);
+  if (do_hq_normals) {
+    vbo_data_hq = data;
+  }
+  else {
+    vbo_data = data;
+  }
+
+  for (int f_index = f_start; f_index < f_end; f_index++) {
+    const BMFace *f = BM_face_at_index(mr->bm, f_index);
+    const short hidden = BM_elem_flag_test(f, BM_ELEM_HIDDEN) ? -1 : 0;
+    BMLoop *l_iter, *l_first;
+    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+    do {
+      const int l_index = BM_elem_index_get(l_iter) - l_start;
+      const float *no = bm_vert_no_get(mr, l_iter->v);
+      if (do_hq_normals) {
+        PosNorHQLoop *vert = &vbo_data_hq[l_index];
+        copy_v3_v3(vert->pos, bm_vert_co_get(mr, l_iter->v));
+        normal_float_to_short_v3(vert->nor, no);
+        vert->nor[3] = hidden;
+      }
+      else {
+        PosNorLoop *vert = &vbo_data[l_index];
+        copy_v3_v3(vert->pos, bm_vert_co_get(mr, l_iter->v));
+        vert->nor = GPU_normal_convert_i10_v3(no);
+        vert->nor.w = hidden;
+      }
+    } while ((l_iter = l_iter->next) != l_first);
+  }
+
+  /* Binds the buffer (uploading it first when it never was). */
+  GPU_vertbuf_use(vbo);
+  GPU_vertbuf_update_sub(vbo, stride * (uint)l_start, stride * (uint)(l_end - l_start), data);
+  MEM_freeN(data);
+}
+
 /** \} */
 /* ---------------------------------------------------------------------- */
 /** \name Extract HQ Loop Normal
@@ -633,38 +704,54 @@ static void extract_lnor_iter_poly_bm(const MeshRenderData *mr,
   } while ((l_iter = l_iter->next) != l_first);
 }
 
-static void extract_lnor_iter_poly_mesh(const MeshRenderData *mr,
-                                        const MPoly *mp,
-                                        const int mp_index,
-                                        void *data)
+static void extract_lnor_iter_poly_mesh_range(const MeshRenderData *mr,
+                                              const int mp_index_start,
+                                              const int mp_index_end,
+                                              void *data)
 {
+  GPUPackedNormal *vbo_data = *(GPUPackedNormal **)data;
+  const float(*loop_normals)[3] = mr->loop_normals;
+  const MVert *mvert = mr->mvert;
   const MLoop *mloop = mr->mloop;
-  const int ml_index_end = mp->loopstart + mp->totloop;
-  for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index += 1) {
-    const MLoop *ml = &mloop[ml_index];
-    GPUPackedNormal *lnor_data = &(*(GPUPackedNormal **)data)[ml_index];
-    if (mr->loop_normals) {
-      *lnor_data = GPU_normal_convert_i10_v3(mr->loop_normals[ml_index]);
+  const int *v_origindex = (mr->edit_bmesh && mr->extract_type == MR_EXTRACT_MAPPED) ?
+                               mr->v_origindex :
+                               NULL;
+
+  for (int mp_index = mp_index_start; mp_index < mp_index_end; mp_index++) {
+    const MPoly *mp = &mr->mpoly[mp_index];
+    const int ml_index_start = mp->loopstart;
+    const int ml_index_end = mp->loopstart + mp->totloop;
+
+    if (loop_normals) {
+      for (int ml_index = ml_index_start; ml_index < ml_index_end; ml_index++) {
+        vbo_data[ml_index] = GPU_normal_convert_i10_v3(loop_normals[ml_index]);
+      }
     }
     else if (mp->flag & ME_SMOOTH) {
-      *lnor_data = GPU_normal_convert_i10_s3(mr->mvert[ml->v].no);
+      for (int ml_index = ml_index_start; ml_index < ml_index_end; ml_index++) {
+        vbo_data[ml_index] = GPU_normal_convert_i10_s3(mvert[mloop[ml_index].v].no);
+      }
     }
     else {
-      *lnor_data = GPU_normal_convert_i10_v3(mr->poly_normals[mp_index]);
+      const GPUPackedNormal poly_nor = GPU_normal_convert_i10_v3(mr->poly_normals[mp_index]);
+      for (int ml_index = ml_index_start; ml_index < ml_index_end; ml_index++) {
+        vbo_data[ml_index] = poly_nor;
+      }
     }
 
     /* Flag for paint mode overlay.
      * Only use MR_EXTRACT_MAPPED in edit mode where it is used to display the edge-normals.
      * In paint mode it will use the un-mapped data to draw the wire-frame. */
-    if (mp->flag & ME_HIDE || (mr->edit_bmesh && mr->extract_type == MR_EXTRACT_MAPPED &&
-                               (mr->v_origindex) && mr->v_origindex[ml->v] == ORIGINDEX_NONE)) {
-      lnor_data->w = -1;
-    }
-    else if (mp->flag & ME_FACE_SEL) {
-      lnor_data->w = 1;
-    }
-    else {
-      lnor_data->w = 0;
+    const int w = (mp->flag & ME_HIDE) ? -1 : ((mp->flag & ME_FACE_SEL) ? 1 : 0);
+    for (int ml_index = ml_index_start; ml_index < ml_index_end; ml_index++) {
+      vbo_data[ml_index].w = w;
+    }
+    if (v_origindex && w != -1) {
+      for (int ml_index = ml_index_start; ml_index < ml_index_end; ml_index++) {
+        if (v_origindex[mloop[ml_index].v] == ORIGINDEX_NONE) {
+          vbo_data[ml_index].w = -1;
+        }
+      }
     }
   }
 }
@@ -672,7 +759,7 @@ static void extract_lnor_iter_poly_mesh(const MeshRenderData *mr,
 const MeshExtract extract_lnor = {
     .init = extract_lnor_init,
     .iter_poly_bm = extract_lnor_iter_poly_bm,
-    .iter_poly_mesh = extract_lnor_iter_poly_mesh,
+    .iter_poly_mesh_range = extract_lnor_iter_poly_mesh_range,
     .data_type = MR_DATA_LOOP_NOR,
     .data_size = sizeof(GPUPackedNormal *),
     .use_threading = true,
@@ -3536,40 +3623,68 @@ static void extract_vert_idx_iter_lvert_bm(const MeshRenderData *mr,
   (*(uint32_t **)data)[offset + lvert_index] = BM_elem_index_get(eve);
 }
 
-static void extract_poly_idx_iter_poly_mesh(const MeshRenderData *mr,
-                                            const MPoly *mp,
-                                            const int mp_index,
-                                            void *data)
+static void extract_poly_idx_iter_poly_mesh_range(const MeshRenderData *mr,
+                                                  const int mp_index_start,
+                                                  const int mp_index_end,
+                                                  void *data)
 {
-  const int ml_index_end = mp->loopstart + mp->totloop;
-  for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index += 1) {
-    (*(uint32_t **)data)[ml_index] = (mr->p_origindex) ? mr->p_origindex[mp_index] : mp_index;
+  uint32_t *vbo_data = *(uint32_t **)data;
+  const int *p_origindex = mr->p_origindex;
+  for (int mp_index = mp_index_start; mp_index < mp_index_end; mp_index++) {
+    const MPoly *mp = &mr->mpoly[mp_index];
+    const uint32_t p_orig = (uint32_t)(p_origindex ? p_origindex[mp_index] : mp_index);
+    const int ml_index_end = mp->loopstart + mp->totloop;
+    for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+      vbo_data[ml_index] = p_orig;
+    }
   }
 }
 
-static void extract_edge_idx_iter_poly_mesh(const MeshRenderData *mr,
-                                            const MPoly *mp,
-                                            const int UNUSED(mp_index),
-                                            void *data)
+static void extract_edge_idx_iter_poly_mesh_range(const MeshRenderData *mr,
+                                                  const int mp_index_start,
+                                                  const int mp_index_end,
+                                                  void *data)
 {
+  uint32_t *vbo_data = *(uint32_t **)data;
   const MLoop *mloop = mr->mloop;
-  const int ml_index_end = mp->loopstart + mp->totloop;
-  for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index += 1) {
-    const MLoop *ml = &mloop[ml_index];
-    (*(uint32_t **)data)[ml_index] = (mr->e_origindex) ? mr->e_origindex[ml->e] : ml->e;
+  const int *e_origindex = mr->e_origindex;
+  for (int mp_index = mp_index_start; mp_index < mp_index_end; mp_index++) {
+    const MPoly *mp = &mr->mpoly[mp_index];
+    const int ml_index_end = mp->loopstart + mp->totloop;
+    if (e_origindex) {
+      for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+        vbo_data[ml_index] = (uint32_t)e_origindex[mloop[ml_index].e];
+      }
+    }
+    else {
+      for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+        vbo_data[ml_index] = mloop[ml_index].e;
+      }
+    }
   }
 }
 
-static void extract_vert_idx_iter_poly_mesh(const MeshRenderData *mr,
-                                            const MPoly *mp,
-                                            const int UNUSED(mp_index),
-                                            void *data)
+static void extract_vert_idx_iter_poly_mesh_range(const MeshRenderData *mr,
+                                                  const int mp_index_start,
+                                                  const int mp_index_end,
+                                                  void *data)
 {
+  uint32_t *vbo_data = *(uint32_t **)data;
   const MLoop *mloop = mr->mloop;
-  const int ml_index_end = mp->loopstart + mp->totloop;
-  for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index += 1) {
-    const MLoop *ml = &mloop[ml_index];
-    (*(uint32_t **)data)[ml_index] = (mr->v_origindex) ? mr->v_origindex[ml->v] : ml->v;
+  const int *v_origindex = mr->v_origindex;
+  for (int mp_index = mp_index_start; mp_index < mp_index_end; mp_index++) {
+    const MPoly *mp = &mr->mpoly[mp_index];
+    const int ml_index_end = mp->loopstart + mp->totloop;
+    if (v_origindex) {
+      for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+        vbo_data[ml_index] = (uint32_t)v_origindex[mloop[ml_index].v];
+      }
+    }
+    else {
+      for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+        vbo_data[ml_index] = mloop[ml_index].v;
+      }
+    }
   }
 }
 
@@ -3610,7 +3725,7 @@ static void extract_vert_idx_iter_lvert_mesh(const MeshRenderData *mr,
 const MeshExtract extract_poly_idx = {
     .init = extract_select_idx_init,
     .iter_poly_bm = extract_poly_idx_iter_poly_bm,
-    .iter_poly_mesh = extract_poly_idx_iter_poly_mesh,
+    .iter_poly_mesh_range = extract_poly_idx_iter_poly_mesh_range,
     .data_type = 0,
     .data_size = sizeof(uint32_t *),
     .use_threading = true,
@@ -3619,7 +3734,7 @@ const MeshExtract extract_poly_idx = {
 const MeshExtract extract_edge_idx = {
     .init = extract_select_idx_init,
     .iter_poly_bm = extract_edge_idx_iter_poly_bm,
-    .iter_poly_mesh = extract_edge_idx_iter_poly_mesh,
+    .iter_poly_mesh_range = extract_edge_idx_iter_poly_mesh_range,
     .iter_ledge_bm = extract_edge_idx_iter_ledge_bm,
     .iter_ledge_mesh = extract_edge_idx_iter_ledge_mesh,
     .data_type = 0,
@@ -3630,7 +3745,7 @@ const MeshExtract extract_edge_idx = {
 const MeshExtract extract_vert_idx = {
     .init = extract_select_idx_init,
     .iter_poly_bm = extract_vert_idx_iter_poly_bm,
-    .iter_poly_mesh = extract_vert_idx_iter_poly_mesh,
+    .iter_poly_mesh_range = extract_vert_idx_iter_poly_mesh_range,
     .iter_ledge_bm = extract_vert_idx_iter_ledge_bm,
     .iter_ledge_mesh = extract_vert_idx_iter_ledge_mesh,
     .iter_lvert_bm = extract_vert_idx_iter_lvert_bm,
@@ -39,6 +39,11 @@ extern "C" {
 #endif
 
 #define MIN_RANGE_LEN 1024
+/**
+ * Number of looptris or polygons all extractors process in turn, small enough for the elements to
+ * remain in cache between extractors.
+ */
+#define EXTRACT_BATCH_LEN 256
 
 /* ---------------------------------------------------------------------- */
 /** \name Mesh Render Data
@@ -182,6 +187,14 @@ typedef void(ExtractPolyMeshFn)(const MeshRenderData *mr,
                                 const MPoly *mp,
                                 const int mp_index,
                                 void *data);
+/**
+ * Extract the polygons `[mp_index_start, mp_index_end)` at once, allowing to hoist checks which
+ * are the same for all polygons out of the loops. Used instead of #ExtractPolyMeshFn when set.
+ */
+typedef void(ExtractPolyMeshRangeFn)(const MeshRenderData *mr,
+                                     const int mp_index_start,
+                                     const int mp_index_end,
+                                     void *data);
 typedef void(ExtractLEdgeBMeshFn)(const MeshRenderData *mr,
                                   const BMEdge *eed,
                                   const int ledge_index,
@@ -216,6 +229,8 @@ typedef struct MeshExtract {
   ExtractTriMeshFn *iter_looptri_mesh;
   ExtractPolyBMeshFn *iter_poly_bm;
   ExtractPolyMeshFn *iter_poly_mesh;
+  /** Batched version of `iter_poly_mesh` for extractors with tight loops, used instead of it. */
+  ExtractPolyMeshRangeFn *iter_poly_mesh_range;
   ExtractLEdgeBMeshFn *iter_ledge_bm;
   ExtractLEdgeMeshFn *iter_ledge_mesh;
   ExtractLVertBMeshFn *iter_lvert_bm;
@@ -260,6 +275,11 @@ void mesh_render_data_update_looptris(MeshRenderData *mr,
 /* draw_cache_extract_mesh_extractors.c */
 void *mesh_extract_buffer_get(const MeshExtract *extractor, MeshBufferCache *mbc);
 eMRIterType mesh_extract_iter_type(const MeshExtract *ext);
+void mesh_extract_pos_nor_update_bm_range(const MeshRenderData *mr,
+                                          GPUVertBuf *vbo,
+                                          const bool do_hq_normals,
+                                          const int face_range[2]);
+
 const MeshExtract *mesh_extract_override_get(const MeshExtract *extractor,
                                              const bool do_hq_normals,
                                              const bool do_single_mat);
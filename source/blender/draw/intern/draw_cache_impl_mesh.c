@@ -784,6 +784,74 @@ static void mesh_batch_cache_discard_uvedit_select(MeshBatchCache *cache)
   mesh_batch_cache_discard_batch(cache, batch_map);
 }
 
+/* Only vertex positions and normals changed, keep buffers which only depend on topology. */
+static void mesh_batch_cache_discard_deform(Mesh *me, MeshBatchCache *cache)
+{
+  const BMEditMesh *em = me->edit_mesh;
+  const Mesh *me_final = em->mesh_eval_final;
+  const Mesh *me_cage = em->mesh_eval_cage;
+  /* Constructive modifiers may change topology based on positions (merge by distance). */
+  if (me_final == NULL || me_cage == NULL ||
+      me_final->runtime.wrapper_type != ME_WRAPPER_TYPE_BMESH ||
+      me_cage->runtime.wrapper_type != ME_WRAPPER_TYPE_BMESH) {
+    cache->is_dirty = true;
+    return;
+  }
+  /* Deform modifiers can move any vertex, only update the moved range without them. */
+  const EditMeshData *emd_final = me_final->runtime.edit_data;
+  const EditMeshData *emd_cage = me_cage->runtime.edit_data;
+  const bool use_range = (em->deform_update == EM_DEFORM_UPDATE_RANGE) &&
+                         !(emd_final && emd_final->vertexCos) &&
+                         !(emd_cage && emd_cage->vertexCos);
+
+  FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+    int *range = mbufcache->pos_nor_update_face_range;
+    if (use_range && mbufcache->vbo.pos_nor != NULL) {
+      if (range[0] == range[1]) {
+        copy_v2_v2_int(range, em->deform_update_face_range);
+      }
+      else {
+        range[0] = min_ii(range[0], em->deform_update_face_range[0]);
+        range[1] = max_ii(range[1], em->deform_update_face_range[1]);
+      }
+    }
+    else {
+      GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.pos_nor);
+      range[0] = range[1] = 0;
+    }
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.lnor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.tan);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edge_fac);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edituv_stretch_area);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edituv_stretch_angle);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.mesh_analysis);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_pos);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_nor);
+    /* The triangulation of faces depends on their shape. */
+    GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.tris);
+    GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.lines_adjacency);
+    GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.edituv_tris);
+  }
+  /* These are sub-ranges of `ibo.tris`. */
+  for (int i = 0; i < cache->mat_len; i++) {
+    GPU_INDEXBUF_DISCARD_SAFE(cache->final.tris_per_mat[i]);
+  }
+
+  DRWBatchFlag batch_map = MDEPS_CREATE_MAP(vbo.lnor,
+                                            vbo.tan,
+                                            vbo.edge_fac,
+                                            vbo.edituv_stretch_area,
+                                            vbo.edituv_stretch_angle,
+                                            vbo.mesh_analysis,
+                                            vbo.fdots_pos,
+                                            vbo.fdots_nor);
+  batch_map |= MDEPS_CREATE_MAP(ibo.tris, ibo.lines_adjacency, ibo.edituv_tris, tris_per_mat);
+  if (!use_range) {
+    batch_map |= MDEPS_CREATE_MAP(vbo.pos_nor);
+  }
+  mesh_batch_cache_discard_batch(cache, batch_map);
+}
+
 void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
 {
   MeshBatchCache *cache = me->runtime.batch_cache;
@@ -832,6 +900,13 @@ void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
       batch_map = MDEPS_CREATE_MAP(vbo.edituv_data, vbo.fdots_edituv_data);
       mesh_batch_cache_discard_batch(cache, batch_map);
       break;
+    case BKE_MESH_BATCH_DIRTY_DEFORM:
+      if (me->edit_mesh == NULL) {
+        cache->is_dirty = true;
+        break;
+      }
+      mesh_batch_cache_discard_deform(me, cache);
+      break;
     default:
       BLI_assert(0);
   }
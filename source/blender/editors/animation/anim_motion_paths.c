@@ -25,6 +25,7 @@
 #include "BLI_dlrbTree.h"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_threads.h"
 
 #include "DNA_anim_types.h"
 #include "DNA_armature_types.h"
@@ -32,6 +33,7 @@
 
 #include "BKE_action.h"
 #include "BKE_anim_data.h"
+#include "BKE_callbacks.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
 
@@ -49,6 +51,10 @@
 
 static CLG_LogRef LOG = {"ed.anim.motion_paths"};
 
+/* Maximum number of dependency graph copies evaluating frames concurrently, every copy holds its
+ * own evaluated data of the whole scene. */
+#define MOTIONPATH_FRAMES_EVAL_GRAPHS_MAX 4
+
 /* Motion path needing to be baked (mpt) */
 typedef struct MPathTarget {
   struct MPathTarget *next, *prev;
@@ -138,80 +144,99 @@ void animviz_get_object_motionpaths(Object *ob, ListBase *targets)
 
 /* ........ */
 
-/* perform baking for the targets on the current frame */
-static void motionpaths_calc_bake_targets(ListBase *targets, int cframe)
+/* perform baking for a target on the given frame, using its evaluated object for that frame
+ * - update_eval: also update the path of the evaluated object, only from the main thread
+ */
+static void motionpaths_calc_bake_target(MPathTarget *mpt,
+                                         Object *ob_eval,
+                                         int cframe,
+                                         const bool update_eval)
 {
-  MPathTarget *mpt;
-
-  /* for each target, check if it can be baked on the current frame */
-  for (mpt = targets->first; mpt; mpt = mpt->next) {
-    bMotionPath *mpath = mpt->mpath;
+  bMotionPath *mpath = mpt->mpath;
 
-    /* current frame must be within the range the cache works for
-     * - is inclusive of the first frame, but not the last otherwise we get buffer overruns
-     */
-    if ((cframe < mpath->start_frame) || (cframe >= mpath->end_frame)) {
-      continue;
-    }
-
-    /* get the relevant cache vert to write to */
-    bMotionPathVert *mpv = mpath->points + (cframe - mpath->start_frame);
-
-    Object *ob_eval = mpt->ob_eval;
+  /* current frame must be within the range the cache works for
+   * - is inclusive of the first frame, but not the last otherwise we get buffer overruns
+   */
+  if ((cframe < mpath->start_frame) || (cframe >= mpath->end_frame)) {
+    return;
+  }
 
-    /* Lookup evaluated pose channel, here because the depsgraph
-     * evaluation can change them so they are not cached in mpt. */
-    bPoseChannel *pchan_eval = NULL;
-    if (mpt->pchan) {
-      pchan_eval = BKE_pose_channel_find_name(ob_eval->pose, mpt->pchan->name);
-    }
+  /* get the relevant cache vert to write to */
+  bMotionPathVert *mpv = mpath->points + (cframe - mpath->start_frame);
 
-    /* pose-channel or object path baking? */
-    if (pchan_eval) {
-      /* heads or tails */
-      if (mpath->flag & MOTIONPATH_FLAG_BHEAD) {
-        copy_v3_v3(mpv->co, pchan_eval->pose_head);
-      }
-      else {
-        copy_v3_v3(mpv->co, pchan_eval->pose_tail);
-      }
+  /* Lookup evaluated pose channel, here because the depsgraph
+   * evaluation can change them so they are not cached in mpt. */
+  bPoseChannel *pchan_eval = NULL;
+  if (mpt->pchan) {
+    pchan_eval = BKE_pose_channel_find_name(ob_eval->pose, mpt->pchan->name);
+  }
 
-      /* result must be in worldspace */
-      mul_m4_v3(ob_eval->obmat, mpv->co);
+  /* pose-channel or object path baking? */
+  if (pchan_eval) {
+    /* heads or tails */
+    if (mpath->flag & MOTIONPATH_FLAG_BHEAD) {
+      copy_v3_v3(mpv->co, pchan_eval->pose_head);
     }
     else {
-      /* worldspace object location */
-      copy_v3_v3(mpv->co, ob_eval->obmat[3]);
+      copy_v3_v3(mpv->co, pchan_eval->pose_tail);
     }
 
-    float mframe = (float)(cframe);
+    /* result must be in worldspace */
+    mul_m4_v3(ob_eval->obmat, mpv->co);
+  }
+  else {
+    /* worldspace object location */
+    copy_v3_v3(mpv->co, ob_eval->obmat[3]);
+  }
 
-    /* Tag if it's a keyframe */
-    if (BLI_dlrbTree_search_exact(&mpt->keys, compare_ak_cfraPtr, &mframe)) {
-      mpv->flag |= MOTIONPATH_VERT_KEY;
-    }
-    else {
-      mpv->flag &= ~MOTIONPATH_VERT_KEY;
-    }
+  float mframe = (float)(cframe);
 
-    /* Incremental update on evaluated object if possible, for fast updating
-     * while dragging in transform. */
-    bMotionPath *mpath_eval = NULL;
-    if (mpt->pchan) {
-      mpath_eval = (pchan_eval) ? pchan_eval->mpath : NULL;
-    }
-    else {
-      mpath_eval = ob_eval->mpath;
-    }
+  /* Tag if it's a keyframe */
+  if (BLI_dlrbTree_search_exact(&mpt->keys, compare_ak_cfraPtr, &mframe)) {
+    mpv->flag |= MOTIONPATH_VERT_KEY;
+  }
+  else {
+    mpv->flag &= ~MOTIONPATH_VERT_KEY;
+  }
 
-    if (mpath_eval && mpath_eval->length == mpath->length) {
-      bMotionPathVert *mpv_eval = mpath_eval->points + (cframe - mpath_eval->start_frame);
-      *mpv_eval = *mpv;
+  /* Incremental update on evaluated object if possible, for fast updating
+   * while dragging in transform. */
+  bMotionPath *mpath_eval = NULL;
+  if (mpt->pchan) {
+    mpath_eval = (pchan_eval) ? pchan_eval->mpath : NULL;
+  }
+  else {
+    mpath_eval = ob_eval->mpath;
+  }
 
-      GPU_VERTBUF_DISCARD_SAFE(mpath_eval->points_vbo);
-      GPU_BATCH_DISCARD_SAFE(mpath_eval->batch_line);
-      GPU_BATCH_DISCARD_SAFE(mpath_eval->batch_points);
-    }
+  if (update_eval && mpath_eval && mpath_eval->length == mpath->length) {
+    bMotionPathVert *mpv_eval = mpath_eval->points + (cframe - mpath_eval->start_frame);
+    *mpv_eval = *mpv;
+
+    GPU_VERTBUF_DISCARD_SAFE(mpath_eval->points_vbo);
+    GPU_BATCH_DISCARD_SAFE(mpath_eval->batch_line);
+    GPU_BATCH_DISCARD_SAFE(mpath_eval->batch_points);
+  }
+}
+
+/* perform baking for the targets on the current frame */
+static void motionpaths_calc_bake_targets(ListBase *targets, int cframe)
+{
+  LISTBASE_FOREACH (MPathTarget *, mpt, targets) {
+    motionpaths_calc_bake_target(mpt, mpt->ob_eval, cframe, true);
+  }
+}
+
+/* Bake targets for a frame evaluated by DEG_evaluate_frames(), each frame fills its own points. */
+static void motionpaths_calc_frame_evaluated_cb(struct Depsgraph *depsgraph,
+                                                const int UNUSED(frame_index),
+                                                const float ctime,
+                                                void *user_data)
+{
+  ListBase *targets = user_data;
+  LISTBASE_FOREACH (MPathTarget *, mpt, targets) {
+    Object *ob_eval = DEG_get_evaluated_object(depsgraph, mpt->ob);
+    motionpaths_calc_bake_target(mpt, ob_eval, (int)ctime, false);
   }
 }
 
@@ -464,18 +489,40 @@ void animviz_calc_motionpaths(Depsgraph *depsgraph,
             sfra,
             efra,
             efra - sfra + 1);
-  for (CFRA = sfra; CFRA <= efra; CFRA++) {
-    if (range == ANIMVIZ_CALC_RANGE_CURRENT_FRAME) {
-      /* For current frame, only update tagged. */
-      BKE_scene_graph_update_tagged(depsgraph, bmain);
-    }
-    else {
-      /* Update relevant data for new frame. */
-      motionpaths_calc_update_scene(depsgraph);
+  /* Unless there are simulations, frames don't depend on each other: evaluate them concurrently
+   * with copies of the dependency graph, which itself stays at the current frame.
+   * Frame change handlers can modify the scene on every frame, which only happens when changing
+   * the frame of the scene itself. */
+  const int graphs_num = min_ii(BLI_system_thread_count(), MOTIONPATH_FRAMES_EVAL_GRAPHS_MAX);
+  const bool use_frames_eval = (range != ANIMVIZ_CALC_RANGE_CURRENT_FRAME) && (sfra < efra) &&
+                               (graphs_num > 1) &&
+                               !BKE_callback_poll(BKE_CB_EVT_FRAME_CHANGE_PRE) &&
+                               !BKE_callback_poll(BKE_CB_EVT_FRAME_CHANGE_POST) &&
+                               DEG_graph_is_time_independent(depsgraph);
+  if (use_frames_eval) {
+    const int frames_num = efra - sfra + 1;
+    float *frames = MEM_malloc_arrayN(frames_num, sizeof(*frames), __func__);
+    for (int i = 0; i < frames_num; i++) {
+      frames[i] = (float)(sfra + i);
     }
+    DEG_evaluate_frames(
+        depsgraph, frames, frames_num, graphs_num, motionpaths_calc_frame_evaluated_cb, targets);
+    MEM_freeN(frames);
+  }
+  else {
+    for (CFRA = sfra; CFRA <= efra; CFRA++) {
+      if (range == ANIMVIZ_CALC_RANGE_CURRENT_FRAME) {
+        /* For current frame, only update tagged. */
+        BKE_scene_graph_update_tagged(depsgraph, bmain);
+      }
+      else {
+        /* Update relevant data for new frame. */
+        motionpaths_calc_update_scene(depsgraph);
+      }
 
-    /* perform baking for targets */
-    motionpaths_calc_bake_targets(targets, CFRA);
+      /* perform baking for targets */
+      motionpaths_calc_bake_targets(targets, CFRA);
+    }
   }
 
   /* reset original environment */
@@ -483,7 +530,7 @@ void animviz_calc_motionpaths(Depsgraph *depsgraph,
    * may be a temporary one that works on a subset of the data.
    * We always have to restore the current frame though. */
   CFRA = cfra;
-  if (range != ANIMVIZ_CALC_RANGE_CURRENT_FRAME && restore) {
+  if (range != ANIMVIZ_CALC_RANGE_CURRENT_FRAME && restore && !use_frames_eval) {
     motionpaths_calc_update_scene(depsgraph);
   }
 
@@ -1457,6 +1457,9 @@ void EDBM_update(Mesh *mesh, const struct EDBMUpdate_Params *params)
   DEG_id_tag_update(&mesh->id, ID_RECALC_GEOMETRY);
   WM_main_add_notifier(NC_GEOM | ND_DATA, &mesh->id);
 
+  /* Any kind of change may have been made, not only moving vertices. */
+  BKE_editmesh_deform_update_clear(em);
+
   if (params->calc_normals && params->calc_looptri) {
     /* Calculating both has some performance gains. */
     BKE_editmesh_looptri_and_normals_calc(em);
@@ -1049,6 +1049,9 @@ void ED_mesh_update(Mesh *mesh, bContext *C, bool calc_edges, bool calc_edges_lo
 
   BKE_mesh_calc_normals(mesh);
 
+  /* Loops, polys or edges may have been edited in place from Python. */
+  BKE_mesh_loop_fan_cache_release(&mesh->runtime.loop_fan_cache);
+
   DEG_id_tag_update(&mesh->id, 0);
   WM_event_add_notifier(C, NC_GEOM | ND_DATA, mesh);
 }
@@ -151,8 +151,13 @@ static int voxel_remesh_exec(bContext *C, wmOperator *op)
     isovalue = mesh->remesh_voxel_size * 0.3f;
   }
 
-  new_mesh = BKE_mesh_remesh_voxel_to_mesh_nomain(
-      mesh, mesh->remesh_voxel_size, mesh->remesh_voxel_adaptivity, isovalue);
+  if (mesh->flag & ME_REMESH_TILED) {
+    new_mesh = BKE_mesh_remesh_voxel_tiled_to_mesh_nomain(mesh, mesh->remesh_voxel_size, isovalue);
+  }
+  else {
+    new_mesh = BKE_mesh_remesh_voxel_to_mesh_nomain(
+        mesh, mesh->remesh_voxel_size, mesh->remesh_voxel_adaptivity, isovalue);
+  }
 
   if (!new_mesh) {
     BKE_report(op->reports, RPT_ERROR, "Voxel remesher failed to create mesh");
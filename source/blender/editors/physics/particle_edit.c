@@ -3210,9 +3210,12 @@ static int remove_doubles_exec(bContext *C, wmOperator *op)
   ParticleSystem *psys = edit->psys;
   ParticleSystemModifierData *psmd_eval;
   KDTree_3d *tree;
-  KDTreeNearest_3d nearest[10];
+  KDTreeNearest_3d *nearest;
+  float(*cos)[3];
+  int *cos_point, *nearest_len;
+  const uint nearest_len_capacity = 10;
   POINT_P;
-  float mat[4][4], co[3], threshold = RNA_float_get(op->ptr, "threshold");
+  float mat[4][4], threshold = RNA_float_get(op->ptr, "threshold");
   int n, totn, removed, totremoved;
 
   if (psys->flag & PSYS_GLOBAL_HAIR) {
@@ -3227,30 +3230,39 @@ static int remove_doubles_exec(bContext *C, wmOperator *op)
     removed = 0;
 
     tree = BLI_kdtree_3d_new(psys->totpart);
+    cos = MEM_mallocN(sizeof(*cos) * (size_t)edit->totpoint, __func__);
+    cos_point = MEM_mallocN(sizeof(*cos_point) * (size_t)edit->totpoint, __func__);
+    int cos_len = 0;
 
     /* insert particles into kd tree */
     LOOP_SELECTED_POINTS {
       psys_mat_hair_to_object(
           ob, psmd_eval->mesh_final, psys->part->from, psys->particles + p, mat);
+      float *co = cos[cos_len];
       copy_v3_v3(co, point->keys->co);
       mul_m4_v3(mat, co);
       BLI_kdtree_3d_insert(tree, p, co);
+      cos_point[cos_len++] = p;
     }
 
     BLI_kdtree_3d_balance(tree);
 
-    /* tag particles to be removed */
-    LOOP_SELECTED_POINTS {
-      psys_mat_hair_to_object(
-          ob, psmd_eval->mesh_final, psys->part->from, psys->particles + p, mat);
-      copy_v3_v3(co, point->keys->co);
-      mul_m4_v3(mat, co);
+    /* Search the neighbors of all points at once (threaded). */
+    nearest = MEM_mallocN(sizeof(*nearest) * nearest_len_capacity * (size_t)cos_len, __func__);
+    nearest_len = MEM_mallocN(sizeof(*nearest_len) * (size_t)cos_len, __func__);
+    BLI_kdtree_3d_find_nearest_n_batch(
+        tree, (const float(*)[3])cos, (uint)cos_len, nearest, nearest_len_capacity, nearest_len);
 
-      totn = BLI_kdtree_3d_find_nearest_n(tree, co, nearest, 10);
+    /* tag particles to be removed */
+    for (int i = 0; i < cos_len; i++) {
+      p = cos_point[i];
+      point = edit->points + p;
+      totn = nearest_len[i];
 
       for (n = 0; n < totn; n++) {
+        const KDTreeNearest_3d *nearest_test = &nearest[(size_t)i * nearest_len_capacity + n];
         /* this needs a custom threshold still */
-        if (nearest[n].index > p && nearest[n].dist < threshold) {
+        if (nearest_test->index > p && nearest_test->dist < threshold) {
           if (!(point->flag & PEP_TAG)) {
             point->flag |= PEP_TAG;
             removed++;
@@ -3260,6 +3272,10 @@ static int remove_doubles_exec(bContext *C, wmOperator *op)
     }
 
     BLI_kdtree_3d_free(tree);
+    MEM_freeN(cos);
+    MEM_freeN(cos_point);
+    MEM_freeN(nearest);
+    MEM_freeN(nearest_len);
 
     /* remove tagged particles - don't do mirror here! */
     remove_tagged_particles(ob, psys, 0);
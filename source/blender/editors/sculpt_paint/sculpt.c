@@ -564,6 +564,7 @@ void SCULPT_visibility_sync_all_face_sets_to_vertices(Object *ob)
 {
   SculptSession *ss = ob->sculpt;
   Mesh *mesh = BKE_object_get_original_mesh(ob);
+  BKE_sculptsession_free_geodesic_cache(ss);
   switch (BKE_pbvh_type(ss->pbvh)) {
     case PBVH_FACES: {
       BKE_sculpt_sync_face_sets_visibility_to_base_mesh(mesh);
@@ -597,6 +598,7 @@ static void UNUSED_FUNCTION(sculpt_visibility_sync_vertex_to_face_sets)(SculptSe
 
 void SCULPT_visibility_sync_all_vertex_to_face_sets(SculptSession *ss)
 {
+  BKE_sculptsession_free_geodesic_cache(ss);
   if (BKE_pbvh_type(ss->pbvh) == PBVH_FACES) {
     for (int i = 0; i < ss->totfaces; i++) {
       MPoly *poly = &ss->mpoly[i];
@@ -7749,6 +7751,10 @@ void SCULPT_flush_update_step(bContext *C, SculptUpdateType update_flags)
 
   DEG_id_tag_update(&ob->id, ID_RECALC_SHADING);
 
+  if (update_flags & (SCULPT_UPDATE_COORDS | SCULPT_UPDATE_VISIBILITY)) {
+    BKE_sculptsession_free_geodesic_cache(ss);
+  }
+
   /* Only current viewport matters, slower update for all viewports will
    * be done in sculpt_flush_update_done. */
   if (!BKE_sculptsession_use_pbvh_draw(ob, v3d)) {
@@ -23,9 +23,11 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_blenlib.h"
-#include "BLI_linklist_stack.h"
 #include "BLI_math.h"
+#include "BLI_sort_utils.h"
 #include "BLI_task.h"
 
 #include "BLT_translation.h"
@@ -76,11 +78,39 @@
 #include <stdlib.h>
 #define SCULPT_GEODESIC_VERTEX_NONE -1
 
+/* Number of distance arrays kept in #SculptSession.geodesic_cache. */
+#define SCULPT_GEODESIC_CACHE_SIZE 2
+
+/* Edges added to the next front are collected per thread in blocks of this size. */
+#define SCULPT_GEODESIC_FRONT_BLOCK_SIZE 256
+
+/* Lower the distance atomically, return true when \a dist was lowered.
+ * Distances are positive so their bit patterns are ordered like the floats. */
+static bool sculpt_geodesic_dist_min(float *dist, const float value)
+{
+  uint32_t value_bits;
+  memcpy(&value_bits, &value, sizeof(value_bits));
+  uint32_t *dist_bits = (uint32_t *)dist;
+  uint32_t old_bits = *dist_bits;
+  while (value_bits < old_bits) {
+    const uint32_t prev_bits = atomic_cas_uint32(dist_bits, old_bits, value_bits);
+    if (prev_bits == old_bits) {
+      return true;
+    }
+    old_bits = prev_bits;
+  }
+  return false;
+}
+
 /* Propagate distance from v1 and v2 to v0. */
-static bool sculpt_geodesic_mesh_test_dist_add(
-    MVert *mvert, const int v0, const int v1, const int v2, float *dists, GSet *initial_vertices)
+static bool sculpt_geodesic_mesh_test_dist_add(const MVert *mvert,
+                                               const int v0,
+                                               const int v1,
+                                               const int v2,
+                                               float *dists,
+                                               const BLI_bitmap *initial_vertices)
 {
-  if (BLI_gset_haskey(initial_vertices, POINTER_FROM_INT(v0))) {
+  if (BLI_BITMAP_TEST(initial_vertices, v0)) {
     return false;
   }
 
@@ -104,67 +134,234 @@ static bool sculpt_geodesic_mesh_test_dist_add(
     dist0 = dists[v1] + len_v3(vec);
   }
 
-  if (dist0 < dists[v0]) {
-    dists[v0] = dist0;
-    return true;
-  }
-
-  return false;
+  return sculpt_geodesic_dist_min(&dists[v0], dist0);
 }
 
-static float *SCULPT_geodesic_mesh_create(Object *ob,
-                                          GSet *initial_vertices,
-                                          const float limit_radius)
+/* -------------------------------------------------------------------- */
+/** \name Parallel Front Propagation
+ *
+ * Distances are propagated in passes over a front of edges. All edges of the front are
+ * processed in parallel, lowering the distances of the vertices of their faces. Edges around
+ * vertices whose distance was lowered form the front of the next pass, until no distance changes.
+ * \{ */
+
+typedef struct SculptGeodesicData {
+  const Mesh *mesh;
+  const MVert *verts;
+  const MEdge *edges;
+  const MeshElemMap *epmap;
+  const MeshElemMap *vemap;
+  const int *face_sets;
+
+  const BLI_bitmap *initial_vertices;
+  BLI_bitmap *affected_vertex;
+  /* Edges of the next front, so they are not added twice. */
+  BLI_bitmap *edge_tag;
+  float *dists;
+
+  const int *initial_vertices_array;
+  int initial_vertices_len;
+  float limit_radius_sq;
+
+  const int *front;
+  int *front_next;
+  int *front_next_len;
+} SculptGeodesicData;
+
+typedef struct SculptGeodesicFrontTLS {
+  int edges[SCULPT_GEODESIC_FRONT_BLOCK_SIZE];
+  int len;
+} SculptGeodesicFrontTLS;
+
+static void sculpt_geodesic_front_flush(const SculptGeodesicData *data,
+                                        SculptGeodesicFrontTLS *front_tls)
 {
-  SculptSession *ss = ob->sculpt;
-  Mesh *mesh = BKE_object_get_original_mesh(ob);
+  if (front_tls->len == 0) {
+    return;
+  }
+  const int start = atomic_fetch_and_add_int32(data->front_next_len, front_tls->len);
+  memcpy(&data->front_next[start], front_tls->edges, sizeof(int) * (size_t)front_tls->len);
+  front_tls->len = 0;
+}
 
-  const int totvert = mesh->totvert;
-  const int totedge = mesh->totedge;
+static void sculpt_geodesic_front_push(const SculptGeodesicData *data,
+                                       SculptGeodesicFrontTLS *front_tls,
+                                       const int e)
+{
+  if (front_tls->len == SCULPT_GEODESIC_FRONT_BLOCK_SIZE) {
+    sculpt_geodesic_front_flush(data, front_tls);
+  }
+  front_tls->edges[front_tls->len++] = e;
+}
 
-  const float limit_radius_sq = limit_radius * limit_radius;
+static void sculpt_geodesic_front_free(const void *__restrict userdata, void *__restrict chunk)
+{
+  sculpt_geodesic_front_flush(userdata, chunk);
+}
 
-  MEdge *edges = mesh->medge;
-  MVert *verts = SCULPT_mesh_deformed_mverts_get(ss);
+/* Edges are only tagged while a pass fills the next front, untag them once it is done. */
+static void sculpt_geodesic_front_tag_clear(BLI_bitmap *edge_tag,
+                                            const int *front,
+                                            const int front_len)
+{
+  for (int i = 0; i < front_len; i++) {
+    BLI_BITMAP_DISABLE(edge_tag, front[i]);
+  }
+}
 
-  float *dists = MEM_malloc_arrayN(totvert, sizeof(float), "distances");
-  BLI_bitmap *edge_tag = BLI_BITMAP_NEW(totedge, "edge tag");
+/* Masks vertices that are further than limit radius from an initial vertex. As there is no need
+ * to define a distance to them the algorithm can stop earlier by skipping them.
+ * Each iteration handles one block of the bitmap. */
+static void sculpt_geodesic_affected_vertex_task_cb(void *__restrict userdata,
+                                                    const int block,
+                                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SculptGeodesicData *data = userdata;
+  const int totvert = data->mesh->totvert;
+  const int v_start = block << _BITMAP_POWER;
+  const int v_end = min_ii(v_start + (1 << _BITMAP_POWER), totvert);
+
+  for (int i = v_start; i < v_end; i++) {
+    for (int j = 0; j < data->initial_vertices_len; j++) {
+      const float *v_co = data->verts[data->initial_vertices_array[j]].co;
+      if (len_squared_v3v3(v_co, data->verts[i].co) <= data->limit_radius_sq) {
+        BLI_BITMAP_ENABLE(data->affected_vertex, i);
+        break;
+      }
+    }
+  }
+}
 
-  if (!ss->epmap) {
-    BKE_mesh_edge_poly_map_create(&ss->epmap,
-                                  &ss->epmap_mem,
-                                  mesh->medge,
-                                  mesh->totedge,
-                                  mesh->mpoly,
-                                  mesh->totpoly,
-                                  mesh->mloop,
-                                  mesh->totloop);
+/* Add edges adjacent to an initial vertex to the front. */
+static void sculpt_geodesic_front_init_task_cb(void *__restrict userdata,
+                                               const int e,
+                                               const TaskParallelTLS *__restrict tls)
+{
+  SculptGeodesicData *data = userdata;
+  const int v1 = data->edges[e].v1;
+  const int v2 = data->edges[e].v2;
+  if (!BLI_BITMAP_TEST(data->affected_vertex, v1) &&
+      !BLI_BITMAP_TEST(data->affected_vertex, v2)) {
+    return;
   }
-  if (!ss->vemap) {
-    BKE_mesh_vert_edge_map_create(
-        &ss->vemap, &ss->vemap_mem, mesh->medge, mesh->totvert, mesh->totedge);
+  if (data->dists[v1] != FLT_MAX || data->dists[v2] != FLT_MAX) {
+    if (!BLI_BITMAP_TEST_AND_SET_ATOMIC(data->edge_tag, e)) {
+      sculpt_geodesic_front_push(data, tls->userdata_chunk, e);
+    }
   }
+}
 
-  /* Both contain edge indices encoded as *void. */
-  BLI_LINKSTACK_DECLARE(queue, void *);
-  BLI_LINKSTACK_DECLARE(queue_next, void *);
-
-  BLI_LINKSTACK_INIT(queue);
-  BLI_LINKSTACK_INIT(queue_next);
+static void sculpt_geodesic_front_step_task_cb(void *__restrict userdata,
+                                               const int n,
+                                               const TaskParallelTLS *__restrict tls)
+{
+  SculptGeodesicData *data = userdata;
+  const MVert *verts = data->verts;
+  const MEdge *edges = data->edges;
+  const MeshElemMap *epmap = data->epmap;
+  const MeshElemMap *vemap = data->vemap;
+  float *dists = data->dists;
+
+  const int e = data->front[n];
+  int v1 = edges[e].v1;
+  int v2 = edges[e].v2;
+
+  if (dists[v1] == FLT_MAX || dists[v2] == FLT_MAX) {
+    if (dists[v1] > dists[v2]) {
+      SWAP(int, v1, v2);
+    }
+    sculpt_geodesic_mesh_test_dist_add(
+        verts, v2, v1, SCULPT_GEODESIC_VERTEX_NONE, dists, data->initial_vertices);
+  }
 
-  for (int i = 0; i < totvert; i++) {
-    if (BLI_gset_haskey(initial_vertices, POINTER_FROM_INT(i))) {
-      dists[i] = 0.0f;
+  for (int poly_map_index = 0; poly_map_index < epmap[e].count; poly_map_index++) {
+    const int poly = epmap[e].indices[poly_map_index];
+    if (data->face_sets[poly] <= 0) {
+      continue;
     }
-    else {
-      dists[i] = FLT_MAX;
+    const MPoly *mpoly = &data->mesh->mpoly[poly];
+
+    for (int loop_index = 0; loop_index < mpoly->totloop; loop_index++) {
+      const MLoop *mloop = &data->mesh->mloop[loop_index + mpoly->loopstart];
+      const int v_other = mloop->v;
+      if (ELEM(v_other, v1, v2)) {
+        continue;
+      }
+      if (!sculpt_geodesic_mesh_test_dist_add(
+              verts, v_other, v1, v2, dists, data->initial_vertices)) {
+        continue;
+      }
+      for (int edge_map_index = 0; edge_map_index < vemap[v_other].count; edge_map_index++) {
+        const int e_other = vemap[v_other].indices[edge_map_index];
+        int ev_other;
+        if (edges[e_other].v1 == (uint)v_other) {
+          ev_other = edges[e_other].v2;
+        }
+        else {
+          ev_other = edges[e_other].v1;
+        }
+
+        if (e_other == e || (epmap[e_other].count != 0 && dists[ev_other] == FLT_MAX)) {
+          continue;
+        }
+        if (!BLI_BITMAP_TEST(data->affected_vertex, v_other) &&
+            !BLI_BITMAP_TEST(data->affected_vertex, ev_other)) {
+          continue;
+        }
+        if (!BLI_BITMAP_TEST_AND_SET_ATOMIC(data->edge_tag, e_other)) {
+          sculpt_geodesic_front_push(data, tls->userdata_chunk, e_other);
+        }
+      }
     }
   }
+}
+
+static float *sculpt_geodesic_mesh_compute(Object *ob,
+                                           const int *initial_vertices,
+                                           const int initial_vertices_len,
+                                           const float limit_radius)
+{
+  SculptSession *ss = ob->sculpt;
+  Mesh *mesh = BKE_object_get_original_mesh(ob);
+
+  const int totvert = mesh->totvert;
+  const int totedge = mesh->totedge;
 
-  /* Masks vertices that are further than limit radius from an initial vertex. As there is no need
-   * to define a distance to them the algorithm can stop earlier by skipping them. */
+  float *dists = MEM_malloc_arrayN(totvert, sizeof(float), "distances");
+  BLI_bitmap *initial_vertices_tag = BLI_BITMAP_NEW(totvert, "initial vertices");
   BLI_bitmap *affected_vertex = BLI_BITMAP_NEW(totvert, "affected vertex");
-  GSetIterator gs_iter;
+  BLI_bitmap *edge_tag = BLI_BITMAP_NEW(totedge, "edge tag");
+  int *front = MEM_malloc_arrayN(totedge, sizeof(int), "geodesic front");
+  int *front_next = MEM_malloc_arrayN(totedge, sizeof(int), "geodesic front next");
+  int front_len = 0;
+
+  copy_vn_fl(dists, totvert, FLT_MAX);
+  for (int i = 0; i < initial_vertices_len; i++) {
+    BLI_BITMAP_ENABLE(initial_vertices_tag, initial_vertices[i]);
+    dists[initial_vertices[i]] = 0.0f;
+  }
+
+  SculptGeodesicData data = {
+      .mesh = mesh,
+      .verts = SCULPT_mesh_deformed_mverts_get(ss),
+      .edges = mesh->medge,
+      .epmap = ss->epmap,
+      .vemap = ss->vemap,
+      .face_sets = ss->face_sets,
+      .initial_vertices = initial_vertices_tag,
+      .affected_vertex = affected_vertex,
+      .edge_tag = edge_tag,
+      .dists = dists,
+      .initial_vertices_array = initial_vertices,
+      .initial_vertices_len = initial_vertices_len,
+      .limit_radius_sq = limit_radius * limit_radius,
+      .front_next = front,
+      .front_next_len = &front_len,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
 
   if (limit_radius == FLT_MAX) {
     /* In this case, no need to loop through all initial vertices to check distances as they are
@@ -175,102 +372,139 @@ static float *SCULPT_geodesic_mesh_create(Object *ob,
     /* This is an O(n^2) loop used to limit the geodesic distance calculation to a radius. When
      * this optimization is needed, it is expected for the tool to request the distance to a low
      * number of vertices (usually just 1 or 2). */
-    GSET_ITER (gs_iter, initial_vertices) {
-      const int v = POINTER_AS_INT(BLI_gsetIterator_getKey(&gs_iter));
-      float *v_co = verts[v].co;
-      for (int i = 0; i < totvert; i++) {
-        if (len_squared_v3v3(v_co, verts[i].co) <= limit_radius_sq) {
-          BLI_BITMAP_ENABLE(affected_vertex, i);
-        }
-      }
-    }
+    TaskParallelSettings settings_blocks = settings;
+    settings_blocks.min_iter_per_thread = 32;
+    BLI_task_parallel_range(0,
+                            (int)_BITMAP_NUM_BLOCKS(totvert),
+                            &data,
+                            sculpt_geodesic_affected_vertex_task_cb,
+                            &settings_blocks);
   }
 
-  /* Add edges adjacent to an initial vertex to the queue. */
-  for (int i = 0; i < totedge; i++) {
-    const int v1 = edges[i].v1;
-    const int v2 = edges[i].v2;
-    if (!BLI_BITMAP_TEST(affected_vertex, v1) && !BLI_BITMAP_TEST(affected_vertex, v2)) {
-      continue;
-    }
-    if (dists[v1] != FLT_MAX || dists[v2] != FLT_MAX) {
-      BLI_LINKSTACK_PUSH(queue, POINTER_FROM_INT(i));
-    }
+  SculptGeodesicFrontTLS front_tls = {{0}};
+  settings.userdata_chunk = &front_tls;
+  settings.userdata_chunk_size = sizeof(front_tls);
+  settings.func_free = sculpt_geodesic_front_free;
+
+  BLI_task_parallel_range(0, totedge, &data, sculpt_geodesic_front_init_task_cb, &settings);
+  sculpt_geodesic_front_tag_clear(edge_tag, front, front_len);
+
+  while (front_len != 0) {
+    SWAP(int *, front, front_next);
+    data.front = front;
+    data.front_next = front_next;
+    const int len = front_len;
+    front_len = 0;
+
+    settings.min_iter_per_thread = 64;
+    BLI_task_parallel_range(0, len, &data, sculpt_geodesic_front_step_task_cb, &settings);
+    sculpt_geodesic_front_tag_clear(edge_tag, front_next, front_len);
   }
 
-  do {
-    while (BLI_LINKSTACK_SIZE(queue)) {
-      const int e = POINTER_AS_INT(BLI_LINKSTACK_POP(queue));
-      int v1 = edges[e].v1;
-      int v2 = edges[e].v2;
+  MEM_freeN(front);
+  MEM_freeN(front_next);
+  MEM_freeN(edge_tag);
+  MEM_freeN(affected_vertex);
+  MEM_freeN(initial_vertices_tag);
 
-      if (dists[v1] == FLT_MAX || dists[v2] == FLT_MAX) {
-        if (dists[v1] > dists[v2]) {
-          SWAP(int, v1, v2);
-        }
-        sculpt_geodesic_mesh_test_dist_add(
-            verts, v2, v1, SCULPT_GEODESIC_VERTEX_NONE, dists, initial_vertices);
-      }
+  return dists;
+}
 
-      if (ss->epmap[e].count != 0) {
-        for (int poly_map_index = 0; poly_map_index < ss->epmap[e].count; poly_map_index++) {
-          const int poly = ss->epmap[e].indices[poly_map_index];
-          if (ss->face_sets[poly] <= 0) {
-            continue;
-          }
-          const MPoly *mpoly = &mesh->mpoly[poly];
-
-          for (int loop_index = 0; loop_index < mpoly->totloop; loop_index++) {
-            const MLoop *mloop = &mesh->mloop[loop_index + mpoly->loopstart];
-            const int v_other = mloop->v;
-            if (ELEM(v_other, v1, v2)) {
-              continue;
-            }
-            if (sculpt_geodesic_mesh_test_dist_add(
-                    verts, v_other, v1, v2, dists, initial_vertices)) {
-              for (int edge_map_index = 0; edge_map_index < ss->vemap[v_other].count;
-                   edge_map_index++) {
-                const int e_other = ss->vemap[v_other].indices[edge_map_index];
-                int ev_other;
-                if (edges[e_other].v1 == (uint)v_other) {
-                  ev_other = edges[e_other].v2;
-                }
-                else {
-                  ev_other = edges[e_other].v1;
-                }
-
-                if (e_other != e && !BLI_BITMAP_TEST(edge_tag, e_other) &&
-                    (ss->epmap[e_other].count == 0 || dists[ev_other] != FLT_MAX)) {
-                  if (BLI_BITMAP_TEST(affected_vertex, v_other) ||
-                      BLI_BITMAP_TEST(affected_vertex, ev_other)) {
-                    BLI_BITMAP_ENABLE(edge_tag, e_other);
-                    BLI_LINKSTACK_PUSH(queue_next, POINTER_FROM_INT(e_other));
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-    }
+/** \} */
 
-    for (LinkNode *lnk = queue_next; lnk; lnk = lnk->next) {
-      const int e = POINTER_AS_INT(lnk->link);
-      BLI_BITMAP_DISABLE(edge_tag, e);
+/* -------------------------------------------------------------------- */
+/** \name Distances Cache
+ *
+ * Tools like expand request the distances from the same initial vertices several times. The
+ * results are kept in #SculptSession.geodesic_cache, which is freed with the PBVH when the
+ * topology changes, and with #BKE_sculptsession_free_geodesic_cache when the coordinates or the
+ * face visibility are updated.
+ * \{ */
+
+static SculptGeodesicCache *sculpt_geodesic_cache_find(SculptSession *ss,
+                                                       const int *initial_vertices,
+                                                       const int initial_vertices_len,
+                                                       const float limit_radius)
+{
+  LISTBASE_FOREACH (SculptGeodesicCache *, cache, &ss->geodesic_cache) {
+    if (cache->limit_radius == limit_radius &&
+        cache->initial_vertices_len == initial_vertices_len &&
+        memcmp(cache->initial_vertices,
+               initial_vertices,
+               sizeof(int) * (size_t)initial_vertices_len) == 0) {
+      return cache;
     }
+  }
+  return NULL;
+}
 
-    BLI_LINKSTACK_SWAP(queue, queue_next);
+static float *SCULPT_geodesic_mesh_create(Object *ob,
+                                          GSet *initial_vertices,
+                                          const float limit_radius)
+{
+  SculptSession *ss = ob->sculpt;
+  Mesh *mesh = BKE_object_get_original_mesh(ob);
 
-  } while (BLI_LINKSTACK_SIZE(queue));
+  if (!ss->epmap) {
+    BKE_mesh_edge_poly_map_create(&ss->epmap,
+                                  &ss->epmap_mem,
+                                  mesh->medge,
+                                  mesh->totedge,
+                                  mesh->mpoly,
+                                  mesh->totpoly,
+                                  mesh->mloop,
+                                  mesh->totloop);
+  }
+  if (!ss->vemap) {
+    BKE_mesh_vert_edge_map_create(
+        &ss->vemap, &ss->vemap_mem, mesh->medge, mesh->totvert, mesh->totedge);
+  }
 
-  BLI_LINKSTACK_FREE(queue);
-  BLI_LINKSTACK_FREE(queue_next);
-  MEM_SAFE_FREE(edge_tag);
-  MEM_SAFE_FREE(affected_vertex);
+  /* Sorted, so the same set of vertices always gives the same key. */
+  const int initial_vertices_len = (int)BLI_gset_len(initial_vertices);
+  int *initial_vertices_array = MEM_malloc_arrayN(
+      max_ii(initial_vertices_len, 1), sizeof(int), "geodesic initial vertices");
+  int i = 0;
+  GSetIterator gs_iter;
+  GSET_ITER (gs_iter, initial_vertices) {
+    initial_vertices_array[i++] = POINTER_AS_INT(BLI_gsetIterator_getKey(&gs_iter));
+  }
+  qsort(initial_vertices_array, (size_t)initial_vertices_len, sizeof(int), BLI_sortutil_cmp_int);
 
-  return dists;
+  SculptGeodesicCache *cache = sculpt_geodesic_cache_find(
+      ss, initial_vertices_array, initial_vertices_len, limit_radius);
+
+  if (cache) {
+    MEM_freeN(initial_vertices_array);
+  }
+  else {
+    cache = MEM_callocN(sizeof(*cache), "SculptGeodesicCache");
+    cache->initial_vertices = initial_vertices_array;
+    cache->initial_vertices_len = initial_vertices_len;
+    cache->limit_radius = limit_radius;
+    cache->dists = sculpt_geodesic_mesh_compute(
+        ob, initial_vertices_array, initial_vertices_len, limit_radius);
+    BLI_addhead(&ss->geodesic_cache, cache);
+
+    if (BLI_listbase_count_at_most(&ss->geodesic_cache, SCULPT_GEODESIC_CACHE_SIZE + 1) >
+        SCULPT_GEODESIC_CACHE_SIZE) {
+      SculptGeodesicCache *cache_last = ss->geodesic_cache.last;
+      BLI_remlink(&ss->geodesic_cache, cache_last);
+      MEM_freeN(cache_last->initial_vertices);
+      MEM_freeN(cache_last->dists);
+      MEM_freeN(cache_last);
+    }
+  }
+
+  /* Most recently used first. */
+  BLI_remlink(&ss->geodesic_cache, cache);
+  BLI_addhead(&ss->geodesic_cache, cache);
+
+  return MEM_dupallocN(cache->dists);
 }
 
+/** \} */
+
 /* For sculpt mesh data that does not support a geodesic distances algorithm, fallback to the
  * distance to each vertex. In this case, only one of the initial vertices will be used to
  * calculate the distance. */
@@ -39,6 +39,7 @@
 struct AutomaskingCache;
 struct KeyBlock;
 struct Object;
+struct SculptUndoDelta;
 struct SculptUndoNode;
 struct bContext;
 
@@ -672,6 +673,9 @@ typedef struct SculptUndoNode {
   /* Sculpt Face Sets */
   int *face_sets;
 
+  /* Compressed coordinates or mask once the step is pushed, replaces #co or #mask. */
+  struct SculptUndoDelta *delta;
+
   size_t undo_size;
 } SculptUndoNode;
 
@@ -26,6 +26,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
@@ -113,9 +115,17 @@ typedef struct UndoSculpt {
   ListBase nodes;
 
   size_t undo_size;
+
+  /* Object the nodes are pushed for, only valid while the step is being pushed. */
+  Object *object;
+
+  /* Background encoding of the node deltas, see #sculpt_undo_delta_encode_begin. */
+  TaskPool *delta_pool;
+  int delta_pending;
 } UndoSculpt;
 
 static UndoSculpt *sculpt_undo_get_nodes(void);
+static void sculpt_undosys_stack_delta_encode_end(UndoStack *ustack);
 
 static void update_cb(PBVHNode *node, void *rebuild)
 {
@@ -160,6 +170,452 @@ static void update_cb_partial(PBVHNode *node, void *userdata)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Delta Compression
+ *
+ * Once a step is pushed, the coordinates and masks of its nodes are only needed for undo and
+ * redo. They are replaced by the bitwise XOR with the current values of the mesh. Applying the
+ * XOR to the mesh swaps between both states, like #swap_v3_v3 does for uncompressed nodes, so
+ * the same delta serves undo and redo and never has to be encoded again.
+ *
+ * Unchanged vertices XOR to zero and are skipped. Values of a vertex before and after a stroke
+ * mostly share sign, exponent and high mantissa bits, so only their non-zero low bytes are kept.
+ * The encoded stream is a sequence of runs, each made of:
+ *  - The number of unchanged elements (variable length integer).
+ *  - The number of changed elements (variable length integer).
+ *  - Per changed element, a byte holding the byte length (0..4) of each of its values in base 5,
+ *    followed by the low bytes of the values.
+ *
+ * Encoding happens in a background task pool of the step. Restoring the step waits for it.
+ * \{ */
+
+typedef struct SculptUndoDelta {
+  /** Values per element, 3 for coordinates and 1 for masks. */
+  int elem_size;
+  int elem_len;
+  /** XOR of the stored and the current values, freed once encoded. */
+  uint *values;
+  size_t values_size;
+  /** Encoded stream, NULL when nothing changed. */
+  uchar *data;
+  size_t data_len;
+} SculptUndoDelta;
+
+#define SCULPT_UNDO_DELTA_ELEM_SIZE_MAX 3
+
+BLI_INLINE void sculpt_undo_delta_xor_float(float *value, const uint delta)
+{
+  uint bits;
+  memcpy(&bits, value, sizeof(bits));
+  bits ^= delta;
+  memcpy(value, &bits, sizeof(bits));
+}
+
+BLI_INLINE uint sculpt_undo_delta_float_bits(const float value)
+{
+  uint bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static int sculpt_undo_delta_value_len(const uint value)
+{
+  if (value == 0) {
+    return 0;
+  }
+  if (value <= 0xff) {
+    return 1;
+  }
+  if (value <= 0xffff) {
+    return 2;
+  }
+  if (value <= 0xffffff) {
+    return 3;
+  }
+  return 4;
+}
+
+static bool sculpt_undo_delta_elem_changed(const uint *elem, const int elem_size)
+{
+  for (int j = 0; j < elem_size; j++) {
+    if (elem[j] != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Write to \a data when not NULL, return the offset past the written bytes. */
+static size_t sculpt_undo_delta_uint_write(uchar *data, size_t offset, uint value)
+{
+  do {
+    const uchar byte = (uchar)(value & 0x7f);
+    value >>= 7;
+    if (data) {
+      data[offset] = (value != 0) ? (byte | 0x80) : byte;
+    }
+    offset++;
+  } while (value != 0);
+  return offset;
+}
+
+static uint sculpt_undo_delta_uint_read(const uchar **p)
+{
+  uint value = 0;
+  int shift = 0;
+  uchar byte;
+  do {
+    byte = *(*p)++;
+    value |= (uint)(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return value;
+}
+
+/* Encode into \a data when not NULL, return the length of the encoded stream. */
+static size_t sculpt_undo_delta_encode(const SculptUndoDelta *delta, uchar *data)
+{
+  const int elem_size = delta->elem_size;
+  const uint *values = delta->values;
+  size_t offset = 0;
+
+  int i = 0;
+  while (i < delta->elem_len) {
+    const int run_start = i;
+    while (i < delta->elem_len &&
+           !sculpt_undo_delta_elem_changed(&values[i * elem_size], elem_size)) {
+      i++;
+    }
+    if (i == delta->elem_len) {
+      /* Trailing unchanged elements are implicit. */
+      break;
+    }
+    const int changed_start = i;
+    while (i < delta->elem_len &&
+           sculpt_undo_delta_elem_changed(&values[i * elem_size], elem_size)) {
+      i++;
+    }
+
+    offset = sculpt_undo_delta_uint_write(data, offset, (uint)(changed_start - run_start));
+    offset = sculpt_undo_delta_uint_write(data, offset, (uint)(i - changed_start));
+
+    for (int e = changed_start; e < i; e++) {
+      const uint *elem = &values[e * elem_size];
+      int lens[SCULPT_UNDO_DELTA_ELEM_SIZE_MAX];
+      int code = 0;
+      for (int j = elem_size - 1; j >= 0; j--) {
+        lens[j] = sculpt_undo_delta_value_len(elem[j]);
+        code = code * 5 + lens[j];
+      }
+      if (data) {
+        data[offset] = (uchar)code;
+      }
+      offset++;
+      for (int j = 0; j < elem_size; j++) {
+        for (int b = 0; b < lens[j]; b++) {
+          if (data) {
+            data[offset] = (uchar)(elem[j] >> (b * 8));
+          }
+          offset++;
+        }
+      }
+    }
+  }
+
+  return offset;
+}
+
+typedef struct SculptUndoDeltaIter {
+  const uchar *p, *end;
+  int elem_size;
+  int index;
+  int changed_len;
+} SculptUndoDeltaIter;
+
+static void sculpt_undo_delta_iter_init(SculptUndoDeltaIter *iter, const SculptUndoDelta *delta)
+{
+  iter->p = delta->data;
+  iter->end = delta->data + delta->data_len;
+  iter->elem_size = delta->elem_size;
+  iter->index = 0;
+  iter->changed_len = 0;
+}
+
+/* Step to the next changed element, return false when there are no more. */
+static bool sculpt_undo_delta_iter_step(SculptUndoDeltaIter *iter,
+                                        int *r_index,
+                                        uint r_elem[SCULPT_UNDO_DELTA_ELEM_SIZE_MAX])
+{
+  if (iter->changed_len == 0) {
+    if (iter->p == iter->end) {
+      return false;
+    }
+    iter->index += (int)sculpt_undo_delta_uint_read(&iter->p);
+    iter->changed_len = (int)sculpt_undo_delta_uint_read(&iter->p);
+  }
+
+  int code = *iter->p++;
+  for (int j = 0; j < iter->elem_size; j++) {
+    const int len = code % 5;
+    code /= 5;
+    r_elem[j] = 0;
+    for (int b = 0; b < len; b++) {
+      r_elem[j] |= (uint)(*iter->p++) << (b * 8);
+    }
+  }
+
+  *r_index = iter->index++;
+  iter->changed_len--;
+  return true;
+}
+
+/* Only plain coordinates and masks of the mesh or the multires grids are delta compressed.
+ * Shape keys and deform modifiers store coordinates in several places which are written on
+ * restore, geometry nodes of the same step replace the data the delta is relative to. */
+static bool sculpt_undo_delta_supported(const SculptSession *ss, const SculptUndoNode *unode)
+{
+  if (unode->maxvert) {
+    if (unode->maxvert != ss->totvert) {
+      return false;
+    }
+  }
+  else if (unode->maxgrid) {
+    if (ss->subdiv_ccg == NULL || ss->subdiv_ccg->num_grids != unode->maxgrid ||
+        ss->subdiv_ccg->grid_size != unode->gridsize) {
+      return false;
+    }
+  }
+  else {
+    return false;
+  }
+
+  switch (unode->type) {
+    case SCULPT_UNDO_COORDS:
+      return unode->co && !unode->orig_co && unode->shapeName[0] == '\0' &&
+             (unode->maxgrid || ss->mvert);
+    case SCULPT_UNDO_MASK:
+      if (unode->maxgrid) {
+        CCGKey key;
+        BKE_subdiv_ccg_key_top_level(&key, ss->subdiv_ccg);
+        return unode->mask && key.has_mask;
+      }
+      return unode->mask && ss->vmask;
+    default:
+      return false;
+  }
+}
+
+typedef struct SculptUndoDeltaCreateData {
+  SculptSession *ss;
+  SculptUndoNode **unodes;
+} SculptUndoDeltaCreateData;
+
+static void sculpt_undo_delta_create_task_cb(void *__restrict userdata,
+                                             const int n,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SculptUndoDeltaCreateData *data = userdata;
+  SculptSession *ss = data->ss;
+  SculptUndoNode *unode = data->unodes[n];
+  SculptUndoDelta *delta = unode->delta;
+  const int elem_size = delta->elem_size;
+  const bool is_coords = (unode->type == SCULPT_UNDO_COORDS);
+  float *values = is_coords ? (float *)unode->co : unode->mask;
+
+  if (unode->maxvert) {
+    for (int i = 0; i < unode->totvert; i++) {
+      const float *current = is_coords ? ss->mvert[unode->index[i]].co :
+                                         &ss->vmask[unode->index[i]];
+      for (int j = 0; j < elem_size; j++) {
+        sculpt_undo_delta_xor_float(&values[i * elem_size + j],
+                                    sculpt_undo_delta_float_bits(current[j]));
+      }
+    }
+  }
+  else {
+    SubdivCCG *subdiv_ccg = ss->subdiv_ccg;
+    const int gridarea = subdiv_ccg->grid_size * subdiv_ccg->grid_size;
+    CCGKey key;
+    BKE_subdiv_ccg_key_top_level(&key, subdiv_ccg);
+
+    float *value = values;
+    for (int g = 0; g < unode->totgrid; g++) {
+      CCGElem *grid = subdiv_ccg->grids[unode->grids[g]];
+      for (int i = 0; i < gridarea; i++) {
+        const float *current = is_coords ? CCG_elem_offset_co(&key, grid, i) :
+                                           CCG_elem_offset_mask(&key, grid, i);
+        for (int j = 0; j < elem_size; j++, value++) {
+          sculpt_undo_delta_xor_float(value, sculpt_undo_delta_float_bits(current[j]));
+        }
+      }
+    }
+  }
+
+  delta->values = (uint *)values;
+  delta->values_size = MEM_allocN_len(values);
+  if (is_coords) {
+    unode->co = NULL;
+  }
+  else {
+    unode->mask = NULL;
+  }
+}
+
+/* Replace stored values of the nodes by their XOR with the current mesh state,
+ * the stroke must not need them as original data anymore. */
+static void sculpt_undo_delta_create(UndoSculpt *usculpt)
+{
+  Object *ob = usculpt->object;
+  if (ob == NULL || ob->sculpt == NULL || ob->sculpt->bm) {
+    return;
+  }
+  SculptSession *ss = ob->sculpt;
+
+  int unodes_len = 0;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    if (!STREQ(unode->idname, ob->id.name) || unode->type == SCULPT_UNDO_GEOMETRY) {
+      return;
+    }
+    unodes_len++;
+  }
+  if (unodes_len == 0) {
+    return;
+  }
+
+  SculptUndoNode **unodes = MEM_mallocN(sizeof(*unodes) * (size_t)unodes_len, __func__);
+  int delta_len = 0;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    if (!sculpt_undo_delta_supported(ss, unode)) {
+      continue;
+    }
+    SculptUndoDelta *delta = MEM_callocN(sizeof(*delta), "SculptUndoDelta");
+    delta->elem_size = (unode->type == SCULPT_UNDO_COORDS) ? 3 : 1;
+    delta->elem_len = unode->maxvert ? unode->totvert :
+                                       unode->totgrid * unode->gridsize * unode->gridsize;
+    usculpt->undo_size += sizeof(*delta);
+    unode->delta = delta;
+    unodes[delta_len++] = unode;
+  }
+
+  SculptUndoDeltaCreateData data = {
+      .ss = ss,
+      .unodes = unodes,
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, delta_len);
+  BLI_task_parallel_range(0, delta_len, &data, sculpt_undo_delta_create_task_cb, &settings);
+
+  MEM_freeN(unodes);
+}
+
+static void sculpt_undo_delta_encode_task(TaskPool *__restrict pool, void *taskdata)
+{
+  UndoSculpt *usculpt = BLI_task_pool_user_data(pool);
+  SculptUndoDelta *delta = taskdata;
+
+  delta->data_len = sculpt_undo_delta_encode(delta, NULL);
+  if (delta->data_len) {
+    delta->data = MEM_mallocN(delta->data_len, "SculptUndoDelta.data");
+    sculpt_undo_delta_encode(delta, delta->data);
+  }
+  MEM_freeN(delta->values);
+  delta->values = NULL;
+
+  atomic_sub_and_fetch_int32(&usculpt->delta_pending, 1);
+}
+
+/* Encode all deltas of the step in the background. */
+static void sculpt_undo_delta_encode_begin(UndoSculpt *usculpt)
+{
+  BLI_assert(usculpt->delta_pool == NULL);
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    if (unode->delta == NULL) {
+      continue;
+    }
+    if (usculpt->delta_pool == NULL) {
+      usculpt->delta_pool = BLI_task_pool_create_background(usculpt, TASK_PRIORITY_LOW);
+    }
+    atomic_add_and_fetch_int32(&usculpt->delta_pending, 1);
+    BLI_task_pool_push(
+        usculpt->delta_pool, sculpt_undo_delta_encode_task, unode->delta, false, NULL);
+  }
+}
+
+/* Account for the encoded size once the background encoding is done.
+ * Return false when \a wait is false and encoding is still running. */
+static bool sculpt_undo_delta_encode_end(UndoSculpt *usculpt, const bool wait)
+{
+  if (usculpt->delta_pool == NULL) {
+    return true;
+  }
+  if (!wait && atomic_add_and_fetch_int32(&usculpt->delta_pending, 0) != 0) {
+    return false;
+  }
+
+  BLI_task_pool_work_and_wait(usculpt->delta_pool);
+  BLI_task_pool_free(usculpt->delta_pool);
+  usculpt->delta_pool = NULL;
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    if (unode->delta) {
+      usculpt->undo_size -= unode->delta->values_size;
+      usculpt->undo_size += unode->delta->data_len;
+    }
+  }
+  return true;
+}
+
+static void sculpt_undo_delta_free(SculptUndoDelta *delta)
+{
+  MEM_SAFE_FREE(delta->values);
+  MEM_SAFE_FREE(delta->data);
+  MEM_freeN(delta);
+}
+
+/* Apply the delta to the mesh, swapping between the stored and the current state. */
+static void sculpt_undo_delta_restore(SculptSession *ss, SculptUndoNode *unode)
+{
+  const SculptUndoDelta *delta = unode->delta;
+  BLI_assert(delta->values == NULL);
+  const bool is_coords = (unode->type == SCULPT_UNDO_COORDS);
+  SculptUndoDeltaIter iter;
+  uint elem[SCULPT_UNDO_DELTA_ELEM_SIZE_MAX];
+  int index;
+
+  sculpt_undo_delta_iter_init(&iter, delta);
+
+  if (unode->maxvert) {
+    MVert *mvert = ss->mvert;
+    while (sculpt_undo_delta_iter_step(&iter, &index, elem)) {
+      const int v = unode->index[index];
+      float *current = is_coords ? mvert[v].co : &ss->vmask[v];
+      for (int j = 0; j < delta->elem_size; j++) {
+        sculpt_undo_delta_xor_float(&current[j], elem[j]);
+      }
+      mvert[v].flag |= ME_VERT_PBVH_UPDATE;
+    }
+  }
+  else {
+    SubdivCCG *subdiv_ccg = ss->subdiv_ccg;
+    const int gridarea = subdiv_ccg->grid_size * subdiv_ccg->grid_size;
+    CCGKey key;
+    BKE_subdiv_ccg_key_top_level(&key, subdiv_ccg);
+
+    while (sculpt_undo_delta_iter_step(&iter, &index, elem)) {
+      CCGElem *grid = subdiv_ccg->grids[unode->grids[index / gridarea]];
+      float *current = is_coords ? CCG_elem_offset_co(&key, grid, index % gridarea) :
+                                   CCG_elem_offset_mask(&key, grid, index % gridarea);
+      for (int j = 0; j < delta->elem_size; j++) {
+        sculpt_undo_delta_xor_float(&current[j], elem[j]);
+      }
+    }
+  }
+}
+
+/** \} */
+
 static bool test_swap_v3_v3(float a[3], float b[3])
 {
   /* No need for float comparison here (memory is exactly equal or not). */
@@ -189,6 +645,16 @@ static bool sculpt_undo_restore_coords(bContext *C, Depsgraph *depsgraph, Sculpt
   MVert *mvert;
   int *index;
 
+  if (unode->delta) {
+    if (ss->shapekey_active) {
+      /* Shape key has been added before calling undo operator, the delta is relative to the
+       * mesh coordinates. */
+      return false;
+    }
+    sculpt_undo_delta_restore(ss, unode);
+    return true;
+  }
+
   if (unode->maxvert) {
     /* Regular mesh restore. */
 
@@ -352,6 +818,11 @@ static bool sculpt_undo_restore_mask(bContext *C, SculptUndoNode *unode)
   float *vmask;
   int *index;
 
+  if (unode->delta) {
+    sculpt_undo_delta_restore(ss, unode);
+    return true;
+  }
+
   if (unode->maxvert) {
     /* Regular mesh restore. */
 
@@ -806,6 +1277,7 @@ static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase
     };
     BKE_pbvh_search_callback(ss->pbvh, NULL, NULL, update_cb_partial, &data);
     BKE_pbvh_update_bounds(ss->pbvh, PBVH_UpdateBB | PBVH_UpdateOriginalBB | PBVH_UpdateRedraw);
+    BKE_sculptsession_free_geodesic_cache(ss);
 
     if (update_mask) {
       BKE_pbvh_update_vertex_data(ss->pbvh, PBVH_UpdateMask);
@@ -898,6 +1370,10 @@ static void sculpt_undo_free_list(ListBase *lb)
       MEM_freeN(unode->face_sets);
     }
 
+    if (unode->delta) {
+      sculpt_undo_delta_free(unode->delta);
+    }
+
     MEM_freeN(unode);
 
     unode = unode_next;
@@ -1018,6 +1494,7 @@ static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node, Sculpt
 
   SculptUndoNode *unode = sculpt_undo_alloc_node_type(ob, type);
   unode->node = node;
+  usculpt->object = ob;
 
   if (node) {
     BKE_pbvh_node_num_verts(ss->pbvh, node, &totvert, &allvert);
@@ -1418,8 +1895,10 @@ void SCULPT_undo_push_end_ex(const bool use_nested_undo)
   wmWindowManager *wm = G_MAIN->wm.first;
   if (wm->op_undo_depth == 0 || use_nested_undo) {
     UndoStack *ustack = ED_undo_stack_get();
+    sculpt_undo_delta_create(usculpt);
     BKE_undosys_step_push(ustack, NULL, NULL);
     if (wm->op_undo_depth == 0) {
+      sculpt_undosys_stack_delta_encode_end(ustack);
       BKE_undosys_stack_limit_steps_and_memory_defaults(ustack);
     }
     WM_file_tag_modified();
@@ -1450,6 +1929,8 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
   /* Dummy, encoding is done along the way by adding tiles
    * to the current 'SculptUndoStep' added by encode_init. */
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+  us->data.object = NULL;
+  sculpt_undo_delta_encode_begin(&us->data);
   us->step.data_size = us->data.undo_size;
 
   SculptUndoNode *unode = us->data.nodes.last;
@@ -1465,11 +1946,41 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
   return true;
 }
 
+static void sculpt_undosys_step_delta_encode_end(SculptUndoStep *us, const bool wait)
+{
+  if (sculpt_undo_delta_encode_end(&us->data, wait)) {
+    us->step.data_size = us->data.undo_size;
+  }
+}
+
+/* Update the size of steps which finished encoding in the background. When the memory limit
+ * would remove steps, wait for the encoding so they are limited by their compressed size. */
+static void sculpt_undosys_stack_delta_encode_end(UndoStack *ustack)
+{
+  size_t data_size_all = 0;
+  LISTBASE_FOREACH (UndoStep *, us, &ustack->steps) {
+    if (us->type == BKE_UNDOSYS_TYPE_SCULPT) {
+      sculpt_undosys_step_delta_encode_end((SculptUndoStep *)us, false);
+    }
+    data_size_all += us->data_size;
+  }
+
+  if (U.undomemory == 0 || data_size_all <= (size_t)U.undomemory * 1024 * 1024) {
+    return;
+  }
+  LISTBASE_FOREACH (UndoStep *, us, &ustack->steps) {
+    if (us->type == BKE_UNDOSYS_TYPE_SCULPT) {
+      sculpt_undosys_step_delta_encode_end((SculptUndoStep *)us, true);
+    }
+  }
+}
+
 static void sculpt_undosys_step_decode_undo_impl(struct bContext *C,
                                                  Depsgraph *depsgraph,
                                                  SculptUndoStep *us)
 {
   BLI_assert(us->step.is_applied == true);
+  sculpt_undosys_step_delta_encode_end(us, true);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
   us->step.is_applied = false;
 }
@@ -1479,6 +1990,7 @@ static void sculpt_undosys_step_decode_redo_impl(struct bContext *C,
                                                  SculptUndoStep *us)
 {
   BLI_assert(us->step.is_applied == false);
+  sculpt_undosys_step_delta_encode_end(us, true);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
   us->step.is_applied = true;
 }
@@ -1583,6 +2095,10 @@ static void sculpt_undosys_step_decode(
 static void sculpt_undosys_step_free(UndoStep *us_p)
 {
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+  if (us->data.delta_pool) {
+    BLI_task_pool_cancel(us->data.delta_pool);
+    BLI_task_pool_free(us->data.delta_pool);
+  }
   sculpt_undo_free_list(&us->data.nodes);
 }
 
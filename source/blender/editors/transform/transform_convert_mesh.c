@@ -1950,6 +1950,43 @@ static void tc_mesh_partial_types_calc(TransInfo *t,
   *r_partial_for_normals = partial_for_normals;
 }
 
+/**
+ * Let the draw cache know only vertex positions and normals changed,
+ * so buffers which depend on topology are kept and only moved vertices are updated.
+ */
+static void tc_mesh_deform_update_tag(TransDataContainer *tc,
+                                      enum ePartialType partial_for_normals)
+{
+  BMEditMesh *em = BKE_editmesh_from_object(tc->obedit);
+  struct TransCustomDataMesh *tcmd = tc->custom.type.data;
+
+  if (tcmd && tcmd->cd_layer_correct) {
+    /* UV's are modified too. */
+    BKE_editmesh_deform_update_clear(em);
+    return;
+  }
+
+  const BMPartialUpdate *bmpinfo = tcmd ? tcmd->partial_update[PARTIAL_TYPE_GROUP].cache : NULL;
+  if ((partial_for_normals != PARTIAL_TYPE_GROUP) || (bmpinfo == NULL) ||
+      (em->bm->totvert == em->bm->totvertsel)) {
+    BKE_editmesh_deform_update_tag_all(em);
+    return;
+  }
+
+  /* Vertices of the group are moved while normals only change around its boundary. */
+  TransData *td = tc->data;
+  for (int i = 0; i < tc->data_len; i++, td++) {
+    BKE_editmesh_deform_update_tag(em, td->extra);
+  }
+  TransDataMirror *td_mirror = tc->data_mirror;
+  for (int i = 0; i < tc->data_mirror_len; i++, td_mirror++) {
+    BKE_editmesh_deform_update_tag(em, td_mirror->extra);
+  }
+  for (int i = 0; i < bmpinfo->verts_len; i++) {
+    BKE_editmesh_deform_update_tag(em, bmpinfo->verts[i]);
+  }
+}
+
 static void tc_mesh_partial_update(TransInfo *t,
                                    TransDataContainer *tc,
                                    enum ePartialType partial_for_looptri,
@@ -2066,6 +2103,7 @@ void recalcData_mesh(TransInfo *t)
     DEG_id_tag_update(tc->obedit->data, ID_RECALC_GEOMETRY);
 
     tc_mesh_partial_update(t, tc, partial_for_looptri, partial_for_normals);
+    tc_mesh_deform_update_tag(tc, partial_for_normals);
   }
 }
 /** \} */
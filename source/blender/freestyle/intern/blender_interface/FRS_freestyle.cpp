@@ -93,7 +93,8 @@ static bCallbackFuncStore load_post_callback_funcstore = {
     nullptr,            /* next, prev */
     load_post_callback, /* func */
     nullptr,            /* arg */
-    0                   /* alloc */
+    0,                  /* alloc */
+    nullptr             /* poll */
 };
 
 //=======================================================
@@ -39,8 +39,10 @@ struct MCol;
 struct MEdge;
 struct MFace;
 struct MLoop;
+struct MLoopFanCache;
 struct MLoopCol;
 struct MLoopTri;
+struct MLoopTriNgonCache;
 struct MLoopUV;
 struct MPoly;
 struct MVert;
@@ -86,6 +88,10 @@ typedef struct Mesh_Runtime {
   void *batch_cache;
 
   struct SubdivCCG *subdiv_ccg;
+  /** Smooth fans of split normals, shared with copies of the mesh, see BKE_mesh.h. */
+  struct MLoopFanCache *loop_fan_cache;
+  /** Triangles of ngons, shared with copies of the mesh, see BKE_mesh.h. */
+  struct MLoopTriNgonCache *looptri_ngon_cache;
   void *_pad1;
   int subdiv_ccg_tot_level;
   char _pad2[4];
@@ -285,7 +291,7 @@ enum {
 
 /* me->flag */
 enum {
-  ME_FLAG_UNUSED_0 = 1 << 0,     /* cleared */
+  ME_REMESH_TILED = 1 << 0,
   ME_FLAG_UNUSED_1 = 1 << 1,     /* cleared */
   ME_FLAG_DEPRECATED_2 = 1 << 2, /* deprecated */
   ME_FLAG_UNUSED_3 = 1 << 3,     /* cleared */
@@ -644,6 +644,8 @@ enum {
   /** for dissolve only. collapse all verts between 2 faces */
   MOD_DECIM_FLAG_ALL_BOUNDARY_VERTS = (1 << 2),
   MOD_DECIM_FLAG_SYMMETRY = (1 << 3),
+  /** For collapse only. collapse edges in parallel batches. */
+  MOD_DECIM_FLAG_BATCH = (1 << 4),
 };
 
 enum {
@@ -252,6 +252,24 @@ static void rna_Depsgraph_debug_stats_gnuplot(Depsgraph *depsgraph,
   fclose(f);
 }
 
+static void rna_Depsgraph_debug_timeline_chrome_trace(Depsgraph *depsgraph,
+                                                      ReportList *reports,
+                                                      const char *filename)
+{
+  FILE *f = fopen(filename, "w");
+  if (f == NULL) {
+    BKE_reportf(reports, RPT_ERROR, "Cannot open file '%s' for writing", filename);
+    return;
+  }
+  DEG_debug_timeline_chrome_trace(depsgraph, f);
+  fclose(f);
+}
+
+static void rna_Depsgraph_debug_timeline_clear(Depsgraph *depsgraph)
+{
+  DEG_debug_timeline_clear(depsgraph);
+}
+
 static void rna_Depsgraph_debug_tag_update(Depsgraph *depsgraph)
 {
   DEG_graph_tag_relations_update(depsgraph);
@@ -665,6 +683,20 @@ static void rna_def_depsgraph(BlenderRNA *brna)
                                   "File name where gnuplot script will save the result");
   RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
 
+  func = RNA_def_function(
+      srna, "debug_timeline_chrome_trace", "rna_Depsgraph_debug_timeline_chrome_trace");
+  RNA_def_function_ui_description(
+      func,
+      "Save per-operation evaluation timeline recorded with bpy.app.debug_depsgraph_timeline, "
+      "in the Trace Event Format used by chrome://tracing and Perfetto");
+  RNA_def_function_flag(func, FUNC_USE_REPORTS);
+  parm = RNA_def_string_file_path(
+      func, "filename", NULL, FILE_MAX, "File Name", "Output path for the JSON trace file");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
+  func = RNA_def_function(srna, "debug_timeline_clear", "rna_Depsgraph_debug_timeline_clear");
+  RNA_def_function_ui_description(func, "Clear recorded evaluation timeline");
+
   func = RNA_def_function(srna, "debug_tag_update", "rna_Depsgraph_debug_tag_update");
 
   func = RNA_def_function(srna, "debug_stats", "rna_Depsgraph_debug_stats");
@@ -235,6 +235,11 @@ static void rna_Mesh_update_data_legacy_deg_tag_all(Main *UNUSED(bmain),
     return;
   }
 
+  /* Sharp edges or smooth faces may have been edited in place. */
+  if (GS(id->name) == ID_ME) {
+    BKE_mesh_loop_fan_cache_release(&((Mesh *)id)->runtime.loop_fan_cache);
+  }
+
   DEG_id_tag_update(id, 0);
   WM_main_add_notifier(NC_GEOM | ND_DATA, id);
 }
@@ -3278,6 +3283,15 @@ static void rna_def_mesh(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Fix Poles", "Produces less poles and a better topology flow");
   RNA_def_property_update(prop, 0, "rna_Mesh_update_draw");
 
+  prop = RNA_def_property(srna, "use_remesh_tiled", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", ME_REMESH_TILED);
+  RNA_def_property_ui_text(prop,
+                           "Tiled",
+                           "Generate the new mesh in blocks of voxels in parallel, using less "
+                           "memory for large meshes and small voxel sizes. Adaptivity is not "
+                           "used");
+  RNA_def_property_update(prop, 0, "rna_Mesh_update_draw");
+
   prop = RNA_def_property(srna, "use_remesh_preserve_volume", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", ME_REMESH_REPROJECT_VOLUME);
   RNA_def_property_ui_text(
@@ -2317,6 +2317,14 @@ static void rna_def_modifier_decimate(BlenderRNA *brna)
       prop, "Triangulate", "Keep triangulated faces resulting from decimation (collapse only)");
   RNA_def_property_update(prop, 0, "rna_Modifier_update");
 
+  prop = RNA_def_property(srna, "use_collapse_batch", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", MOD_DECIM_FLAG_BATCH);
+  RNA_def_property_ui_text(prop,
+                           "Batch",
+                           "Collapse edges in parallel batches, faster on dense meshes but the "
+                           "result differs slightly (collapse only, without symmetry)");
+  RNA_def_property_update(prop, 0, "rna_Modifier_update");
+
   prop = RNA_def_property(srna, "use_symmetry", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", MOD_DECIM_FLAG_SYMMETRY);
   RNA_def_property_ui_text(prop, "Symmetry", "Maintain symmetry on an axis");
@@ -185,13 +185,15 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
       const bool do_triangulate = (dmd->flag & MOD_DECIM_FLAG_TRIANGULATE) != 0;
       const int symmetry_axis = (dmd->flag & MOD_DECIM_FLAG_SYMMETRY) ? dmd->symmetry_axis : -1;
       const float symmetry_eps = 0.00002f;
+      const bool use_batch = (dmd->flag & MOD_DECIM_FLAG_BATCH) != 0;
       BM_mesh_decimate_collapse(bm,
                                 dmd->percent,
                                 vweights,
                                 dmd->defgrp_factor,
                                 do_triangulate,
                                 symmetry_axis,
-                                symmetry_eps);
+                                symmetry_eps,
+                                use_batch);
       break;
     }
     case MOD_DECIM_MODE_UNSUBDIV: {
@@ -257,6 +259,10 @@ static void panel_draw(const bContext *UNUSED(C), Panel *panel)
 
     uiItemR(layout, ptr, "use_collapse_triangulate", 0, NULL, ICON_NONE);
 
+    sub = uiLayoutRow(layout, true);
+    uiLayoutSetActive(sub, !RNA_boolean_get(ptr, "use_symmetry"));
+    uiItemR(sub, ptr, "use_collapse_batch", 0, NULL, ICON_NONE);
+
     modifier_vgroup_ui(layout, ptr, &ob_ptr, "vertex_group", "invert_vertex_group", NULL);
     sub = uiLayoutRow(layout, true);
     bool has_vertex_group = RNA_string_length(ptr, "vertex_group") != 0;
@@ -37,8 +37,9 @@
 
 #include "BLI_alloca.h"
 #include "BLI_bitmap.h"
-#include "BLI_kdtree.h"
 #include "BLI_math.h"
+#include "BLI_spatial_hash.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -1545,6 +1546,119 @@ static void customdata_weld(
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Weld Compaction
+ *
+ * Copying vertices and edges to the result is threaded, in chunks of source elements.
+ * \{ */
+
+#define WELD_COMPACT_CHUNK_SIZE 4096
+
+struct WeldCompactData {
+  const CustomData *source;
+  CustomData *dest;
+  /** Weld group of each source element, #OUT_OF_CONTEXT or #ELEM_MERGED. */
+  const uint *elem_groups;
+  /** Index of each source element in the result. */
+  const uint *elem_dest;
+  uint elem_len;
+  const uint *groups_buffer;
+
+  /* Vertices only. */
+  const struct WeldGroup *groups;
+
+  /* Edges only. */
+  const struct WeldGroupEdge *edge_groups;
+  const uint *vert_final;
+  MEdge *medge_dest;
+};
+
+/**
+ * Calculate the index of source elements in the result (in order),
+ * returns the number of elements in the result.
+ */
+static int weld_compact_dest_calc(const uint *elem_groups, const uint elem_len, uint *r_elem_dest)
+{
+  uint dest_index = 0;
+  for (uint i = 0; i < elem_len; i++) {
+    r_elem_dest[i] = (elem_groups[i] == ELEM_MERGED) ? OUT_OF_CONTEXT : dest_index++;
+  }
+  return (int)dest_index;
+}
+
+/* Number of consecutive elements from `i` (within the chunk) not in the weld context. */
+static uint weld_compact_run_len(const struct WeldCompactData *data, const uint i, const uint end)
+{
+  uint count = 1;
+  while (i + count < end && data->elem_groups[i + count] == OUT_OF_CONTEXT) {
+    count++;
+  }
+  return count;
+}
+
+static void weld_compact_verts_cb(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldCompactData *data = userdata;
+  const uint start = (uint)chunk * WELD_COMPACT_CHUNK_SIZE;
+  const uint end = min_uu(start + WELD_COMPACT_CHUNK_SIZE, data->elem_len);
+
+  for (uint i = start; i < end; i++) {
+    const uint group = data->elem_groups[i];
+    if (group == OUT_OF_CONTEXT) {
+      const uint count = weld_compact_run_len(data, i, end);
+      CustomData_copy_data(data->source, data->dest, i, data->elem_dest[i], count);
+      i += count - 1;
+    }
+    else if (group != ELEM_MERGED) {
+      const struct WeldGroup *wgroup = &data->groups[group];
+      customdata_weld(data->source,
+                      data->dest,
+                      &data->groups_buffer[wgroup->ofs],
+                      wgroup->len,
+                      data->elem_dest[i]);
+    }
+  }
+}
+
+static void weld_compact_edges_cb(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldCompactData *data = userdata;
+  const uint start = (uint)chunk * WELD_COMPACT_CHUNK_SIZE;
+  const uint end = min_uu(start + WELD_COMPACT_CHUNK_SIZE, data->elem_len);
+
+  for (uint i = start; i < end; i++) {
+    const uint group = data->elem_groups[i];
+    if (group == OUT_OF_CONTEXT) {
+      uint count = weld_compact_run_len(data, i, end);
+      CustomData_copy_data(data->source, data->dest, i, data->elem_dest[i], count);
+      MEdge *me = &data->medge_dest[data->elem_dest[i]];
+      i += count - 1;
+      for (; count--; me++) {
+        me->v1 = data->vert_final[me->v1];
+        me->v2 = data->vert_final[me->v2];
+      }
+    }
+    else if (group != ELEM_MERGED) {
+      const struct WeldGroupEdge *wegrp = &data->edge_groups[group];
+      customdata_weld(data->source,
+                      data->dest,
+                      &data->groups_buffer[wegrp->group.ofs],
+                      wegrp->group.len,
+                      data->elem_dest[i]);
+      MEdge *me = &data->medge_dest[data->elem_dest[i]];
+      me->v1 = data->vert_final[wegrp->v1];
+      me->v2 = data->vert_final[wegrp->v2];
+      me->flag |= ME_LOOSEEDGE;
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Weld Modifier Main
  * \{ */
@@ -1694,18 +1808,14 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
   }
 #else
   {
-    KDTree_3d *tree = BLI_kdtree_3d_new(v_mask ? v_mask_act : totvert);
+    float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, NULL);
     for (uint i = 0; i < totvert; i++) {
-      if (!v_mask || BLI_BITMAP_TEST(v_mask, i)) {
-        BLI_kdtree_3d_insert(tree, i, mvert[i].co);
-      }
       vert_dest_map[i] = OUT_OF_CONTEXT;
     }
 
-    BLI_kdtree_3d_balance(tree);
-    vert_kill_len = BLI_kdtree_3d_calc_duplicates_fast(
-        tree, wmd->merge_dist, false, (int *)vert_dest_map);
-    BLI_kdtree_3d_free(tree);
+    vert_kill_len = BLI_spatial_hash_3d_calc_duplicates(
+        vert_coords, totvert, v_mask, wmd->merge_dist, (int *)vert_dest_map);
+    MEM_freeN(vert_coords);
   }
 #endif
   else {
@@ -1809,83 +1919,55 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     /* Vertices */
 
     uint *vert_final = vert_dest_map;
-    uint *index_iter = &vert_final[0];
-    int dest_index = 0;
-    for (uint i = 0; i < totvert; i++, index_iter++) {
-      int source_index = i;
-      int count = 0;
-      while (i < totvert && *index_iter == OUT_OF_CONTEXT) {
-        *index_iter = dest_index + count;
-        index_iter++;
-        count++;
-        i++;
-      }
-      if (count) {
-        CustomData_copy_data(&mesh->vdata, &result->vdata, source_index, dest_index, count);
-        dest_index += count;
-      }
-      if (i == totvert) {
-        break;
-      }
-      if (*index_iter != ELEM_MERGED) {
-        struct WeldGroup *wgroup = &weld_mesh.vert_groups[*index_iter];
-        customdata_weld(&mesh->vdata,
-                        &result->vdata,
-                        &weld_mesh.vert_groups_buffer[wgroup->ofs],
-                        wgroup->len,
-                        dest_index);
-        *index_iter = dest_index;
-        dest_index++;
-      }
-    }
-
+    uint *elem_dest = MEM_malloc_arrayN(max_uu(totvert, totedge), sizeof(*elem_dest), __func__);
+    int dest_index = weld_compact_dest_calc(vert_final, totvert, elem_dest);
     BLI_assert(dest_index == result_nverts);
 
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+
+    struct WeldCompactData compact_data = {
+        .source = &mesh->vdata,
+        .dest = &result->vdata,
+        .elem_groups = vert_final,
+        .elem_dest = elem_dest,
+        .elem_len = totvert,
+        .groups = weld_mesh.vert_groups,
+        .groups_buffer = weld_mesh.vert_groups_buffer,
+    };
+    BLI_task_parallel_range(0,
+                            (int)divide_ceil_u(totvert, WELD_COMPACT_CHUNK_SIZE),
+                            &compact_data,
+                            weld_compact_verts_cb,
+                            &settings);
+    memcpy(vert_final, elem_dest, sizeof(*vert_final) * totvert);
+
     /* Edges */
 
     uint *edge_final = weld_mesh.edge_groups_map;
-    index_iter = &edge_final[0];
-    dest_index = 0;
-    for (uint i = 0; i < totedge; i++, index_iter++) {
-      int source_index = i;
-      int count = 0;
-      while (i < totedge && *index_iter == OUT_OF_CONTEXT) {
-        *index_iter = dest_index + count;
-        index_iter++;
-        count++;
-        i++;
-      }
-      if (count) {
-        CustomData_copy_data(&mesh->edata, &result->edata, source_index, dest_index, count);
-        MEdge *me = &result->medge[dest_index];
-        dest_index += count;
-        for (; count--; me++) {
-          me->v1 = vert_final[me->v1];
-          me->v2 = vert_final[me->v2];
-        }
-      }
-      if (i == totedge) {
-        break;
-      }
-      if (*index_iter != ELEM_MERGED) {
-        struct WeldGroupEdge *wegrp = &weld_mesh.edge_groups[*index_iter];
-        customdata_weld(&mesh->edata,
-                        &result->edata,
-                        &weld_mesh.edge_groups_buffer[wegrp->group.ofs],
-                        wegrp->group.len,
-                        dest_index);
-        MEdge *me = &result->medge[dest_index];
-        me->v1 = vert_final[wegrp->v1];
-        me->v2 = vert_final[wegrp->v2];
-        me->flag |= ME_LOOSEEDGE;
-
-        *index_iter = dest_index;
-        dest_index++;
-      }
-    }
-
+    dest_index = weld_compact_dest_calc(edge_final, totedge, elem_dest);
     BLI_assert(dest_index == result_nedges);
 
+    compact_data = (struct WeldCompactData){
+        .source = &mesh->edata,
+        .dest = &result->edata,
+        .elem_groups = edge_final,
+        .elem_dest = elem_dest,
+        .elem_len = totedge,
+        .edge_groups = weld_mesh.edge_groups,
+        .groups_buffer = weld_mesh.edge_groups_buffer,
+        .vert_final = vert_final,
+        .medge_dest = result->medge,
+    };
+    BLI_task_parallel_range(0,
+                            (int)divide_ceil_u(totedge, WELD_COMPACT_CHUNK_SIZE),
+                            &compact_data,
+                            weld_compact_edges_cb,
+                            &settings);
+    memcpy(edge_final, elem_dest, sizeof(*edge_final) * totedge);
+    MEM_freeN(elem_dest);
+    UNUSED_VARS_NDEBUG(dest_index);
+
     /* Polys/Loops */
 
     mp = &mpoly[0];
@@ -216,6 +216,12 @@ static PyObject *make_app_cb_info(void)
   return app_cb_info;
 }
 
+/* The generic callback only does something when handlers are registered from Python. */
+static bool bpy_app_generic_callback_poll(void *arg)
+{
+  return PyList_GET_SIZE(py_cb_array[POINTER_AS_INT(arg)]) > 0;
+}
+
 PyObject *BPY_app_handlers_struct(void)
 {
   PyObject *ret;
@@ -247,6 +253,7 @@ PyObject *BPY_app_handlers_struct(void)
     for (pos = 0; pos < BKE_CB_EVT_TOT; pos++) {
       funcstore = &funcstore_array[pos];
       funcstore->func = bpy_app_generic_callback;
+      funcstore->poll = bpy_app_generic_callback_poll;
       funcstore->alloc = 0;
       funcstore->arg = POINTER_FROM_INT(pos);
       BKE_callback_add(funcstore, pos);
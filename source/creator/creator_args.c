@@ -587,6 +587,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-tag");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-no-threads");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-time");
+  BLI_args_print_arg_doc(ba, "--debug-depsgraph-timeline");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-pretty");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-uuid");
   BLI_args_print_arg_doc(ba, "--debug-ghost");
@@ -991,6 +992,10 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_eval[] =
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_no_threads[] =
     "\n\t"
     "Switch dependency graph to a single threaded evaluation.";
+static const char arg_handle_debug_mode_generic_set_doc_depsgraph_timeline[] =
+    "\n\t"
+    "Record per-operation dependency graph evaluation timeline.\n"
+    "\tTimelines are saved in the temporary directory as JSON files for chrome://tracing.";
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_pretty[] =
     "\n\t"
     "Enable colors for dependency graph debug messages.";
@@ -2184,6 +2189,11 @@ void main_args_setup(bContext *C, bArgs *ba)
                CB_EX(arg_handle_debug_mode_generic_set, depsgraph_time),
                (void *)G_DEBUG_DEPSGRAPH_TIME);
   BLI_args_add(ba,
+               NULL,
+               "--debug-depsgraph-timeline",
+               CB_EX(arg_handle_debug_mode_generic_set, depsgraph_timeline),
+               (void *)G_DEBUG_DEPSGRAPH_TIMELINE);
+  BLI_args_add(ba,
 
                NULL,
                "--debug-depsgraph-no-threads",